@@ -45,6 +45,36 @@
 ---------------------------------------------------------------------------
  */
 
+/*
+---------------------------------------------------------------------------
+	Threading
+---------------------------------------------------------------------------
+	An EEL state, as returned by eel_open(), is NOT thread safe;
+
+		* All calls on a VM, and on any objects, values or
+		  strings belonging to it, must be serialized by
+		  the application. A VM may be handed over to
+		  another thread between calls.
+
+		* Objects and values MUST NOT be passed between
+		  VMs, not even between VMs in the same thread.
+		  Use the 'channel' class to send copies.
+
+	Different VMs share no mutable state, and may run at the same
+	time in different threads without any locking. The only state
+	shared by all VMs of the process is the exception registry
+	(eel_x_register()), the registry of channel names, and the count
+	of open states, all of which are locked internally.
+
+	Microthreads and generators are cooperative, and always run in
+	the thread that is currently calling into their VM.
+
+	Native modules must keep any mutable state in the moduledata
+	of their module instance (eel_get_moduledata()), rather than
+	in static variables, or they will break this contract.
+---------------------------------------------------------------------------
+ */
+
 #ifndef EEL_H
 #define EEL_H
 
@@ -104,11 +134,11 @@ EELAPI(EEL_object *)eel_ps_find(EEL_vm *vm, const char *s);
 /* Convenience inline for generating a string reference value */
 static inline void eel_s2v(EEL_vm *vm, EEL_value *v, const char *s)
 {
-	v->objref.v = eel_ps_new(vm, s);
-	if(v->objref.v)
-		v->classid = EEL_COBJREF;
+	EEL_object *o = eel_ps_new(vm, s);
+	if(o)
+		eel_o2v(v, o);
 	else
-		v->classid = EEL_CNIL;
+		eel_nil2v(v);
 }
 
 /*
@@ -413,10 +413,10 @@ static inline EEL_object *t##2o(t *o)	\
  */
 static inline EEL_classes EEL_CLASS(const EEL_value *v)
 {
-	if(EEL_IS_OBJREF(v->classid))
-		return v->objref.v->classid;
+	if(EEL_IS_OBJREF(EEL_VCLASS(v)))
+		return eel_v2o(v)->classid;
 	else
-		return v->classid;
+		return EEL_VCLASS(v);
 }
 
 
@@ -441,12 +441,12 @@ EELAPI(void)eel_disown(EEL_object *o);
  */
 static inline void eel_v_own(EEL_value *value)
 {
-	if(value->classid == EEL_COBJREF)
-		eel_own(value->objref.v);
+	if(EEL_VCLASS(value) == EEL_COBJREF)
+		eel_own(eel_v2o(value));
 #ifdef DEBUG
-	else if(value->classid == EEL_CILLEGAL)
+	else if(EEL_VCLASS(value) == EEL_CILLEGAL)
 		fprintf(stderr, "INTERNAL ERROR: eel_v_own(): ILLEGAL value! "
-				"(Source: %d)", value->integer.v);
+				"(Source: %d)", EEL_VINT(value));
 #endif
 }
 
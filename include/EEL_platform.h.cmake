@@ -55,6 +55,11 @@ extern "C" {
 #define	EEL_SOEXT	"@EEL_SOEXT@"
 #define	EEL_DIRSEP	'@EEL_DIRSEP@'
 
+/*
+ * 8 byte NaN-boxed EEL_value. (See EEL_value.h.)
+ */
+#cmakedefine	EEL_NANBOX
+
 /*
  * 'inline'
  */
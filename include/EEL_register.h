@@ -179,6 +179,27 @@ EELAPI(EEL_object *)eel_export_cfunction(EEL_object *module,
 		int reqargs, int optargs, int tupargs,
 		EEL_cfunc_cb func);
 
+/*
+ * C callback for "leaf" functions. 'args' points at the arguments, and the
+ * result is to be written to 'result'. Return 0, or an exception number.
+ */
+typedef EEL_xno (*EEL_cleaf_cb)(EEL_value *args, EEL_value *result);
+
+/*
+ * Export "leaf" C function 'func' from 'module', named 'name'. The function
+ * takes exactly 'args' arguments, and returns exactly one result.
+ *
+ * Leaf functions are called directly from the VM, with no call frame, and
+ * the arguments are read in place from the caller's registers when possible.
+ * Therefore, a leaf function must NOT call back into the VM, allocate or
+ * create objects, or return an object reference.
+ *
+ * SUCCESS: Returns the EEL_function object.
+ * FAILURE: Returns NULL.
+ */
+EELAPI(EEL_object *)eel_export_cleaf(EEL_object *module,
+		const char *name, int args, EEL_cleaf_cb func);
+
 /*
  * Same as eel_export_cfunction(), except the function is NOT added to the
  * module export table, so it will only be directly visible to script code
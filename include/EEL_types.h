@@ -24,6 +24,8 @@
 #ifndef EEL_TYPES_H
 #define EEL_TYPES_H
 
+#include "EEL_platform.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -35,6 +37,8 @@ typedef unsigned short	EEL_uint16;
 typedef signed short	EEL_int16;
 typedef unsigned int	EEL_uint32;
 typedef signed int	EEL_int32;
+typedef unsigned long long EEL_uint64;
+typedef signed long long EEL_int64;
 
 /* Make sure the types really have the right sizes */
 #define EEL_COMPILE_TIME_ASSERT(name, x)               \
@@ -45,6 +49,8 @@ EEL_COMPILE_TIME_ASSERT(uint16, sizeof(EEL_uint16) == 2);
 EEL_COMPILE_TIME_ASSERT(sint16, sizeof(EEL_int16) == 2);
 EEL_COMPILE_TIME_ASSERT(uint32, sizeof(EEL_uint32) == 4);
 EEL_COMPILE_TIME_ASSERT(sint32, sizeof(EEL_int32) == 4);
+EEL_COMPILE_TIME_ASSERT(uint64, sizeof(EEL_uint64) == 8);
+EEL_COMPILE_TIME_ASSERT(sint64, sizeof(EEL_int64) == 8);
 #undef EEl_COMPILE_TIME_ASSERT
 
 /*
@@ -64,7 +70,11 @@ typedef EEL_uint32 EEL_uinteger;/* For some ops on 'integer' values */
 typedef	EEL_int32 EEL_index;	/* For indices in the heap, lists etc */
 
 /* Size of the EEL_value struct in bytes */
-#define	EEL_VALUE_SIZE		16
+#ifdef EEL_NANBOX
+#  define	EEL_VALUE_SIZE		8
+#else
+#  define	EEL_VALUE_SIZE		16
+#endif
 
 /*
  * List of integer constants, for eel_export_lconstants(),
@@ -25,6 +25,7 @@
 #define EEL_VALUE_H
 
 #include <math.h>
+#include <stddef.h>
 #include "EEL_export.h"
 #include "EEL_types.h"
 
@@ -89,6 +90,40 @@ typedef enum
 
 
 /* Data element */
+#ifdef EEL_NANBOX
+/*
+ * NaN-boxed data element, 8 bytes. Reals are stored as is. All other values
+ * live in the NaN space, with (0xfff8 + classid) in the top 16 bits, and the
+ * integer or object pointer in the low 48 bits. Real NaNs are stored as the
+ * one canonical NaN, which is not used as a tag. The lowest bit of weakref
+ * pointers flags unwired weakrefs.
+ *
+ * NOTE:
+ *	Use the EEL_V*() macros and inlines below to access values. The
+ *	fields of this union are not the ones of the default 16 byte
+ *	representation!
+ */
+union EEL_value
+{
+	EEL_uint64	bits;
+	EEL_real	real;
+	char sizecheck[EEL_VALUE_SIZE];
+};
+
+#define	EEL_NB_TAG(cid)		((EEL_uint64)(0xfff8 + (cid)) << 48)
+#define	EEL_NB_PAYLOAD		0x0000ffffffffffffULL
+#define	EEL_NB_NAN		0x7ff8000000000000ULL
+
+static inline EEL_classes eel__nbclass(const EEL_value *v)
+{
+	unsigned tag = (unsigned)(v->bits >> 48);
+	return tag >= 0xfff7 ? (EEL_classes)((int)tag - 0xfff8) : EEL_CREAL;
+}
+
+#define	EEL_VCLASS(x)	eel__nbclass(x)
+#define	EEL_VINT(x)	((EEL_integer)(EEL_uint32)(x)->bits)
+#define	EEL_VREAL(x)	((EEL_real)(x)->real)
+#else
 union EEL_value
 {
 	EEL_classes	classid;
@@ -119,6 +154,17 @@ union EEL_value
 
 	char sizecheck[EEL_VALUE_SIZE];
 };
+
+/*
+ * Raw value access. These don't check or convert anything; the value must be
+ * of a class that has the field in question. (For object references, use
+ * eel_v2o().) Code that is to build with EEL_NANBOX has to use these and the
+ * inlines further down, rather than the fields of the union.
+ */
+#define	EEL_VCLASS(x)	((x)->classid)
+#define	EEL_VINT(x)	((x)->integer.v)
+#define	EEL_VREAL(x)	((x)->real.v)
+#endif
 #define EEL_COMPILE_TIME_ASSERT(name, x)               \
        typedef int EEL_dummy_ ## name[(x) * 2 - 1]
 EEL_COMPILE_TIME_ASSERT(eel_data, sizeof(EEL_value) == EEL_VALUE_SIZE);
@@ -131,9 +177,13 @@ EEL_COMPILE_TIME_ASSERT(eel_data, sizeof(EEL_value) == EEL_VALUE_SIZE);
  */
 #define	EEL_IS_OBJREF(x)	((x) >= EEL_COBJREF)
 
-static inline EEL_object *eel_v2o(EEL_value *v)
+static inline EEL_object *eel_v2o(const EEL_value *v)
 {
+#ifdef EEL_NANBOX
+	return (EEL_object *)(size_t)(v->bits & (EEL_NB_PAYLOAD - 1));
+#else
 	return v->objref.v;
+#endif
 }
 
 
@@ -142,6 +192,11 @@ static inline EEL_object *eel_v2o(EEL_value *v)
  * its target.
  */
 #define	EEL_WEAKREF_UNWIRED	(-1)
+#ifdef EEL_NANBOX
+#  define	EEL_VUNWIRED(x)	(((x)->bits & 1) != 0)
+#else
+#  define	EEL_VUNWIRED(x)	((x)->objref.index == EEL_WEAKREF_UNWIRED)
+#endif
 
 
 /*
@@ -157,36 +212,36 @@ EELAPI(long int)eel__v2l(EEL_value *v);
 EELAPI(double)eel__v2d(EEL_value *v);
 static inline long int eel_v2l(EEL_value *v)
 {
-	switch(v->classid)
+	switch(EEL_VCLASS(v))
 	{
 	  case EEL_CNIL:
 		return 0;
 	  case EEL_CREAL:
 #ifdef __cplusplus
-		return (long int)floor(v->real.v);
+		return (long int)floor(EEL_VREAL(v));
 #else
-		return floor(v->real.v);
+		return floor(EEL_VREAL(v));
 #endif
 	  case EEL_CINTEGER:
 	  case EEL_CBOOLEAN:
 	  case EEL_CCLASSID:
-		return v->integer.v;
+		return EEL_VINT(v);
 	  default:
 		return eel__v2l(v);
 	}
 }
 static inline double eel_v2d(EEL_value *v)
 {
-	switch(v->classid)
+	switch(EEL_VCLASS(v))
 	{
 	  case EEL_CNIL:
 		return 0.0f;
 	  case EEL_CREAL:
-		return v->real.v;
+		return EEL_VREAL(v);
 	  case EEL_CINTEGER:
 	  case EEL_CBOOLEAN:
 	  case EEL_CCLASSID:
-		return v->integer.v;
+		return EEL_VINT(v);
 	  default:
 		return eel__v2d(v);
 	}
@@ -199,31 +254,54 @@ static inline double eel_v2d(EEL_value *v)
 
 static inline void eel_nil2v(EEL_value *v)
 {
+#ifdef EEL_NANBOX
+	v->bits = EEL_NB_TAG(EEL_CNIL);
+#else
 	v->classid = EEL_CNIL;
+#endif
 }
 
 static inline void eel_b2v(EEL_value *v, int b)
 {
+#ifdef EEL_NANBOX
+	v->bits = EEL_NB_TAG(EEL_CBOOLEAN) | (b ? 1 : 0);
+#else
 	v->classid = EEL_CBOOLEAN;
 	v->integer.v = b ? 1 : 0;
+#endif
 }
 
 static inline void eel_l2v(EEL_value *v, long l)
 {
+#ifdef EEL_NANBOX
+	v->bits = EEL_NB_TAG(EEL_CINTEGER) | (EEL_uint32)l;
+#else
 	v->classid = EEL_CINTEGER;
 	v->integer.v = l;
+#endif
 }
 
 static inline void eel_d2v(EEL_value *v, double d)
 {
+#ifdef EEL_NANBOX
+	if(d == d)
+		v->real = d;
+	else
+		v->bits = EEL_NB_NAN;
+#else
 	v->classid = EEL_CREAL;
 	v->real.v = d;
+#endif
 }
 
 static inline void eel_o2v(EEL_value *v, EEL_object *o)
 {
+#ifdef EEL_NANBOX
+	v->bits = EEL_NB_TAG(EEL_COBJREF) | (size_t)o;
+#else
 	v->classid = EEL_COBJREF;
 	v->objref.v = o;
+#endif
 }
 
 /*
@@ -233,9 +311,41 @@ static inline void eel_o2v(EEL_value *v, EEL_object *o)
  */
 static inline void eel_o2wr(EEL_value *v, EEL_object *o)
 {
+#ifdef EEL_NANBOX
+	v->bits = EEL_NB_TAG(EEL_CWEAKREF) | (size_t)o | 1;
+#else
 	v->classid = EEL_CWEAKREF;
 	v->objref.index = EEL_WEAKREF_UNWIRED;
 	v->objref.v = o;
+#endif
+}
+
+/*
+ * Set a value of class 'cid', which is one of the classes with an integer
+ * field (EEL_CINTEGER, EEL_CBOOLEAN, EEL_CCLASSID), or EEL_CNIL or
+ * EEL_CILLEGAL, which just ignore 'i'.
+ */
+static inline void eel_i2v(EEL_value *v, EEL_classes cid, EEL_integer i)
+{
+#ifdef EEL_NANBOX
+	v->bits = EEL_NB_TAG(cid) | (EEL_uint32)i;
+#else
+	v->classid = cid;
+	v->integer.v = i;
+#endif
+}
+
+/*
+ * Change the class of a value, keeping the integer or object reference.
+ * (Not for EEL_CREAL, in either direction!)
+ */
+static inline void eel_v_setclass(EEL_value *v, EEL_classes cid)
+{
+#ifdef EEL_NANBOX
+	v->bits = (v->bits & EEL_NB_PAYLOAD) | EEL_NB_TAG(cid);
+#else
+	v->classid = cid;
+#endif
 }
 
 #ifdef __cplusplus
@@ -161,6 +161,20 @@ EELAPI(EEL_xno)eel_callf(EEL_vm *vm, EEL_object *f, const char *fmt, ...);
 EELAPI(EEL_xno)eel_callnf(EEL_vm *vm, EEL_object *m, const char *fn,
 		const char *fmt, ...);
 
+/*
+ * Like eel_call(), but only enters 'f', leaving it to eel_run_slice() to
+ * actually run it. C functions are still run right away. The caller's
+ * result and argument registers are restored when the call returns or fails,
+ * as with eel_call().
+ *
+ * NOTE:
+ *	A C function that begins a call must run it to the end before it
+ *	returns to the VM.
+ *
+ * Returns 0 upon success, or a VM exception code if there was an error.
+ */
+EELAPI(EEL_xno)eel_begin_call(EEL_vm *vm, EEL_object *f);
+
 /*
  * Run 'vm', continuing from whatever state it is in.
  *
@@ -171,6 +185,54 @@ EELAPI(EEL_xno)eel_callnf(EEL_vm *vm, EEL_object *m, const char *fn,
  */
 EELAPI(EEL_xno)eel_run(EEL_vm *vm);
 
+/*
+ * Run the current call of 'vm', as set up by eel_begin_call(), for a limited
+ * time. The VM counts a tick for every backward jump (loop iteration) and
+ * every function call, and stops after 'budget' ticks, or when 'max_ns'
+ * nanoseconds have passed, whichever comes first. A value of 0 means no limit.
+ *
+ * Code between ticks is straight code, so the time spent in EEL code between
+ * checks is bounded by the function sizes. The deadline is checked every
+ * EEL_SLICE_POLL ticks. C functions, and EEL functions called by them through
+ * eel_call() and the like, are not interrupted.
+ *
+ * Returns EEL_XCOUNTER if the slice was used up before the call returned, in
+ * which case another eel_run_slice() picks up where this one stopped, 0 if
+ * the call returned, or an exception code if the call failed.
+ */
+EELAPI(EEL_xno)eel_run_slice(EEL_vm *vm, int budget, long long max_ns);
+
+/*
+ * Enable (1) or disable (0) compiling hot EEL functions into native code.
+ * Disabling also throws away all native code compiled so far.
+ *
+ * Returns the previous setting, or -1 if native code is not supported on
+ * this platform, or in this build.
+ */
+EELAPI(int)eel_set_jit(EEL_vm *vm, int enable);
+
+/*
+ * Make sure there are at least 'values' heap values available above the
+ * current argument stack top, and touch them, so that calls and argument
+ * pushes that stay within that space never allocate memory. Intended for hard
+ * real time applications, before entering the real time context.
+ *
+ * Returns 0 (EEL_XNONE) on success, or EEL_XMEMORY.
+ */
+EELAPI(EEL_xno)eel_reserve_heap(EEL_vm *vm, int values);
+
+/*
+ * Make sure at least 'count' objects with an implementation struct of 'size'
+ * bytes, of any class registered before the call, can be created without
+ * calling the memory manager. Objects that are too large for the object slabs
+ * (see EEL_SLAB_MAXSIZE) can't be reserved.
+ *
+ * Returns 0 (EEL_XNONE) on success, EEL_XHIGHVALUE if 'size' is too large,
+ * EEL_XNOTIMPLEMENTED if EEL was built without the object slabs, or
+ * EEL_XMEMORY.
+ */
+EELAPI(EEL_xno)eel_reserve_objects(EEL_vm *vm, int size, int count);
+
 
 /*----------------------------------------------------------
 	Memory management
@@ -199,6 +261,156 @@ static inline void eel_free(EEL_vm *vm, void *block)
 EELAPI(EEL_vm *)eel_open(int argc, const char *argv[]);
 EELAPI(void)eel_close(EEL_vm *vm);
 
+/*
+ * Like eel_open(), but have the VM memory manager (eel_malloc() etc) allocate
+ * from the 'size' bytes at 'pool', using a built-in TLSF (Two-Level
+ * Segregated Fit) allocator. Allocations and frees run in bounded time, with
+ * no locking and no system calls, so this is intended for EEL running on
+ * real time threads. The compiler and a few other parts of EEL still use the
+ * C library allocator, though.
+ *
+ * The VM heaps (registers and argument stacks) are allocated from the pool as
+ * well. They grow, and may move, when calls nest deeper than before, so use
+ * eel_reserve_heap() to allocate the space needed before going real time.
+ *
+ * The pool is not touched after eel_close(), and is not freed by EEL.
+ *
+ * Returns NULL if EEL could not be initialized, or if the pool is too small.
+ */
+EELAPI(EEL_vm *)eel_open_pool(int argc, const char *argv[],
+		void *pool, int size);
+
+/* Memory pool statistics */
+typedef struct
+{
+	int	size;		/* Size of the pool */
+	int	used;		/* Bytes allocated, including block headers */
+	int	peak;		/* High-water mark of 'used' */
+	int	free;		/* Bytes in free blocks */
+	int	largest;	/* Largest free block */
+	int	freeblocks;	/* Number of free blocks */
+	int	fails;		/* Number of failed allocations */
+	double	fragmentation;	/* 1 - largest / free; 0 if not fragmented */
+} EEL_poolstats;
+
+/*
+ * Get statistics for the memory pool of 'vm'. This does NOT run in constant
+ * time, as it walks all free blocks, so the time taken grows with the number
+ * of free blocks, and thus with fragmentation. Do not call it from the real
+ * time path; sample it from a monitoring or housekeeping thread instead.
+ *
+ * Returns 0 (EEL_XNONE) on success, or EEL_XBADCONTEXT if 'vm' was not opened
+ * with eel_open_pool().
+ */
+EELAPI(EEL_xno)eel_pool_stats(EEL_vm *vm, EEL_poolstats *ps);
+
+/* Memory statistics for the objects of one class */
+typedef struct
+{
+	int		objects;	/* Live objects */
+	long long	bytes;		/* Object memory held by live objects */
+	long long	allocs;		/* Objects created */
+	long long	frees;		/* Objects destroyed */
+} EEL_classmemstats;
+
+/* Memory statistics of a VM */
+typedef struct
+{
+	/* Objects of all classes */
+	int		objects;	/* Live objects */
+	long long	bytes;		/* Object memory held by live objects */
+	long long	allocs;		/* Objects created */
+	long long	frees;		/* Objects destroyed */
+	double		allocrate;	/* Objects created per second */
+	double		freerate;	/* Objects destroyed per second */
+
+	/* String pool */
+	int		strings;	/* Strings in the pool, including cached */
+	int		cachedstrings;	/* Dead strings kept for reuse */
+	long long	stringbytes;	/* Size of the string buffers */
+
+	/* VM heap (registers and argument stacks) */
+	int		heapsize;	/* Current size, in values */
+	int		heappeak;	/* Largest size so far, in values */
+	int		valuesize;	/* Size of a value, in bytes */
+
+	/* Cycle collector (eel_collect_cycles()) */
+	int		cyclecands;	/* Objects in the candidate buffer */
+	long long	cyclefrees;	/* Objects freed by the collector */
+
+	/* Deferred destruction (eel_defer_destruction()) */
+	long long	deferreditems;	/* Items waiting to be released */
+} EEL_memstats;
+
+/*
+ * Get memory statistics for 'vm'. These are always maintained, regardless of
+ * build configuration, and are cheap enough to read in production.
+ *
+ * "Object memory" is the object header and implementation struct, as
+ * allocated by eel_o_alloc(). Memory allocated separately by classes, such as
+ * string contents and array or table storage, is not included.
+ *
+ * The rates are averages over the time since the previous call, or since the
+ * VM was opened, if this is the first call.
+ */
+EELAPI(void)eel_get_memstats(EEL_vm *vm, EEL_memstats *ms);
+
+/*
+ * Get memory statistics for objects of class 'cid'.
+ *
+ * Returns 0 (EEL_XNONE) on success, or EEL_XBADCLASS if 'cid' is not a
+ * registered class.
+ */
+EELAPI(EEL_xno)eel_get_classmemstats(EEL_vm *vm, EEL_classes cid,
+		EEL_classmemstats *cms);
+
+/*
+ * Find and free tables and arrays that are only kept alive by reference
+ * cycles, which refcounting alone can never free.
+ *
+ * Tables and arrays are remembered as candidates as the VM runs, whenever
+ * their refcounts are decremented to a non-zero value. A collection examines
+ * the candidates, and everything they reference, in steps of about 'budget'
+ * units of work, where one unit is one object or one table or array item
+ * examined. The VM can be used as usual between steps. The final check of the
+ * objects that look like garbage is done in one step, though, regardless of
+ * 'budget', and takes time proportional to the amount of garbage found.
+ *
+ * A 'budget' of 0 or less finishes the collection in progress, or does a
+ * complete collection if there is none. No call starts more than one new
+ * collection.
+ *
+ * Returns 1 if there is more work to do, or 0 if the collector is idle, and
+ * there are no new candidates.
+ */
+EELAPI(int)eel_collect_cycles(EEL_vm *vm, int budget);
+
+/*
+ * Defer destruction of tables and arrays with 'minitems' or more items. When
+ * such a container dies, it doesn't release its items right away, but hands
+ * them over to a queue, which is drained by eel_collect(). This keeps the cost
+ * of dropping large object graphs out of time critical code.
+ *
+ * A 'minitems' of 0 disables deferred destruction, which is the default.
+ * Containers that are already queued are still released by eel_collect().
+ * Everything left in the queue is released by eel_close().
+ *
+ * Returns the previous 'minitems' setting.
+ */
+EELAPI(int)eel_defer_destruction(EEL_vm *vm, int minitems);
+
+/*
+ * Release up to about 'budget' items from the deferred destruction queue, and
+ * spend any remaining budget on the cycle collector, as eel_collect_cycles().
+ *
+ * A 'budget' of 0 or less empties the queue, and finishes a complete cycle
+ * collection.
+ *
+ * Returns 1 if there is more work to do, or 0 if the queue is empty, and the
+ * cycle collector is idle.
+ */
+EELAPI(int)eel_collect(EEL_vm *vm, int budget);
+
 /*
  * Get an version of 'base' with a decimal number
  * appended, guaranteeing that the result is a
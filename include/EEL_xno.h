@@ -47,7 +47,7 @@ extern "C" {
 \
   /* VM exceptions */		\
   EEL_DEFEX(XYIELD,		"Give up VM if there is other work")\
-  EEL_DEFEX(XCOUNTER,		"Runlimit instruction counter exhausted")\
+  EEL_DEFEX(XCOUNTER,		"Time slice used up")\
   EEL_DEFEX(XEND,		"Thread returns from top level")\
   EEL_DEFEX(XRETURN,		"Return from actual function")\
   EEL_DEFEX(XREFUSE,		"Object refused to destruct")\
@@ -261,11 +261,56 @@ const char *eel_i_stringrep(EEL_state *es, EEL_object *fo, int pc,
 		while(count < 24)
 			buf[count++] = ' ';
 		snprintf(buf + count, BS-24, "; (PC + %d)", B);
+	  EEL_IJUMPEQ
+		count = snprintf(buf, BS, "R%d, R%d, %d", A, B, pc + C);
+		while(count < 24)
+			buf[count++] = ' ';
+		snprintf(buf + count, BS-24, "; (PC + %d)", C);
+	  EEL_IJUMPNE
+		count = snprintf(buf, BS, "R%d, R%d, %d", A, B, pc + C);
+		while(count < 24)
+			buf[count++] = ' ';
+		snprintf(buf + count, BS-24, "; (PC + %d)", C);
+	  EEL_IJUMPGE
+		count = snprintf(buf, BS, "R%d, R%d, %d", A, B, pc + C);
+		while(count < 24)
+			buf[count++] = ' ';
+		snprintf(buf + count, BS-24, "; (PC + %d)", C);
+	  EEL_IJUMPLE
+		count = snprintf(buf, BS, "R%d, R%d, %d", A, B, pc + C);
+		while(count < 24)
+			buf[count++] = ' ';
+		snprintf(buf + count, BS-24, "; (PC + %d)", C);
+	  EEL_IJUMPGT
+		count = snprintf(buf, BS, "R%d, R%d, %d", A, B, pc + C);
+		while(count < 24)
+			buf[count++] = ' ';
+		snprintf(buf + count, BS-24, "; (PC + %d)", C);
+	  EEL_IJUMPLT
+		count = snprintf(buf, BS, "R%d, R%d, %d", A, B, pc + C);
+		while(count < 24)
+			buf[count++] = ' ';
+		snprintf(buf + count, BS-24, "; (PC + %d)", C);
+	  EEL_IJUMPZARGI
+		count = snprintf(buf, BS, "ARGS[%d], %d", A, pc + B);
+		while(count < 24)
+			buf[count++] = ' ';
+		snprintf(buf + count, BS-24, "; (PC + %d)", B);
+	  EEL_IJUMPNZARGI
+		count = snprintf(buf, BS, "ARGS[%d], %d", A, pc + B);
+		while(count < 24)
+			buf[count++] = ' ';
+		snprintf(buf + count, BS-24, "; (PC + %d)", B);
 	  EEL_ISWITCH
 		count = snprintf(buf, BS, "R%d, C%d, %d", A, B, pc + C);
 		while(count < 24)
 			buf[count++] = ' ';
 		snprintf(buf + count, BS-24, "; (PC + %d)", C);
+	  EEL_ISWITCHD
+		count = snprintf(buf, BS, "R%d, C%d, %d", A, B, pc + C);
+		while(count < 24)
+			buf[count++] = ' ';
+		snprintf(buf + count, BS-24, "; (PC + %d)", C);
 	  EEL_IPRELOOP
 		count = snprintf(buf, BS, "R%d, R%d, R%d, %d",
 				A, B, C, pc + D);
@@ -278,6 +323,18 @@ const char *eel_i_stringrep(EEL_state *es, EEL_object *fo, int pc,
 		while(count < 24)
 			buf[count++] = ' ';
 		snprintf(buf + count, BS-24, "; (PC + %d)", D);
+	  EEL_IIPRELOOP
+		count = snprintf(buf, BS, "R%d, R%d, R%d, %d",
+				A, B, C, pc + D);
+		while(count < 24)
+			buf[count++] = ' ';
+		snprintf(buf + count, BS-24, "; (PC + %d)", D);
+	  EEL_IILOOP
+		count = snprintf(buf, BS, "R%d, R%d, R%d, %d",
+				A, B, C, pc + D);
+		while(count < 24)
+			buf[count++] = ' ';
+		snprintf(buf + count, BS-24, "; (PC + %d)", D);
 
 	  /* Argument stack operations */
 	  EEL_IPUSH
@@ -324,6 +381,15 @@ const char *eel_i_stringrep(EEL_state *es, EEL_object *fo, int pc,
 		snprintf(buf, BS, "R%d^%d", A, B);
 	  EEL_IPHARGS
 	  EEL_IPUSHTUP
+	  EEL_IPUSHA
+		snprintf(buf, BS, "R%d", A);
+	  EEL_IPUSHAS
+		if(C)
+			snprintf(buf, BS, "R%d[%d..%d]", A, B, B + C - 1);
+		else
+			snprintf(buf, BS, "R%d[%d..]", A, B);
+	  EEL_IPUSHASR
+		snprintf(buf, BS, "R%d[R%d, R%d]", A, B, C);
 
 	  /* Function calls */
 	  EEL_ICALL
@@ -336,7 +402,7 @@ const char *eel_i_stringrep(EEL_state *es, EEL_object *fo, int pc,
 			buf[count++] = ' ';
 		snprintf(buf + count, BS-24, "; (%s)",
 				o2EEL_string(o2EEL_function(
-				f->e.constants[B].objref.v)->
+				eel_v2o(&f->e.constants[B]))->
 				common.name)->buffer);
 	  EEL_ICCALLR
 		count = snprintf(buf, BS, "C%d, R%d, %d", C, B, A);
@@ -344,11 +410,46 @@ const char *eel_i_stringrep(EEL_state *es, EEL_object *fo, int pc,
 			buf[count++] = ' ';
 		snprintf(buf + count, BS-24, "; (%s)",
 				o2EEL_string(o2EEL_function(
-				f->e.constants[C].objref.v)->
+				eel_v2o(&f->e.constants[C]))->
 				common.name)->buffer);
+	  EEL_ITAILCALL
+		snprintf(buf, BS, "R%d, R%d", A, B);
+	  EEL_ICTAILCALL
+		count = snprintf(buf, BS, "C%d, R%d, %d", C, B, A);
+		while(count < 24)
+			buf[count++] = ' ';
+		snprintf(buf + count, BS-24, "; (%s)",
+				o2EEL_string(o2EEL_function(
+				eel_v2o(&f->e.constants[C]))->
+				common.name)->buffer);
+	  EEL_ICALLRW
+		snprintf(buf, BS, "R%d, R%d..%d", A, B, B + C - 1);
+	  EEL_ICALLRWR
+		snprintf(buf, BS, "R%d, R%d, R%d..%d", A, B, C, C + D - 1);
+	  EEL_ICCALLRW
+		count = snprintf(buf, BS, "C%d, R%d..%d", C, A, A + B - 1);
+		while(count < 24)
+			buf[count++] = ' ';
+		snprintf(buf + count, BS-24, "; (%s)",
+				o2EEL_string(o2EEL_function(
+				eel_v2o(&f->e.constants[C]))->
+				common.name)->buffer);
+	  EEL_ICCALLRWR
+		count = snprintf(buf, BS, "C%d, R%d, R%d..%d", D, A, B,
+				B + C - 1);
+		while(count < 24)
+			buf[count++] = ' ';
+		snprintf(buf + count, BS-24, "; (%s)",
+				o2EEL_string(o2EEL_function(
+				eel_v2o(&f->e.constants[D]))->
+				common.name)->buffer);
+	  EEL_ITAILCALLRW
+		snprintf(buf, BS, "R%d, R%d, R%d..%d", A, B, C, C + D - 1);
 	  EEL_IRETURN
 	  EEL_IRETURNR
 		snprintf(buf, BS, "R%d", A);
+	  EEL_IYIELD
+		snprintf(buf, BS, "R%d", A);
 
 	  /* Memory management */
 	  EEL_ICLEAN
@@ -453,6 +554,12 @@ const char *eel_i_stringrep(EEL_state *es, EEL_object *fo, int pc,
 		snprintf(buf, BS, "ARGS[%d], ARGS[%d]", A, B);
 	  EEL_ISETARGI
 		snprintf(buf, BS, "R%d, ARGS[%d]", A, B);
+	  EEL_IARGINDGETC
+		count = snprintf(buf, BS, "ARGS[%d][C%d], R%d", B, C, A);
+		tmp = eel_v_stringrep(es->vm, &f->e.constants[C]);
+		while(count < 24)
+			buf[count++] = ' ';
+		snprintf(buf + count, BS-24, "; C%d = %s", C, tmp);
 #if 0
 	  EEL_IGETARG
 		snprintf(buf, BS, "ARGS[R%d], R%d", B, A);
@@ -563,38 +670,8 @@ const char *eel_i_stringrep(EEL_state *es, EEL_object *fo, int pc,
 		snprintf(buf, BS, "R%d, R%d", B, A);
 
 	  /* Exception handling */
-	  EEL_ITRY
-	  {
-		const char *catcher = "<nil>";
-		count = snprintf(buf, BS, "C%d, C%d", B, A);
-		while(count < 24)
-			buf[count++] = ' ';
-		if(EEL_IS_OBJREF(f->e.constants[A].classid))
-			catcher = o2EEL_string(o2EEL_function(
-					f->e.constants[A].objref.v)->
-					common.name)->buffer;
-		snprintf(buf + count, BS-24, "; (%s), (%s)",
-				o2EEL_string(o2EEL_function(
-				f->e.constants[B].objref.v)
-				->common.name)->buffer,
-				catcher);
-	  }
-	  EEL_IUNTRY
-	  {
-		count = snprintf(buf, BS, "C%d", A);
-		while(count < 24)
-			buf[count++] = ' ';
-		snprintf(buf + count, BS-24, "; (%s)",
-				o2EEL_string(o2EEL_function(
-				f->e.constants[A].objref.v)
-				->common.name)->buffer);
-	  }
 	  EEL_ITHROW
 		snprintf(buf, BS, "R%d", A);
-	  EEL_IRETRY
-	  EEL_IRETX
-	  EEL_IRETXR
-		snprintf(buf, BS, "R%d", A);
 		break;
 	  }
 	}
@@ -646,6 +723,11 @@ int eel_coder_close(EEL_coder *cdr)
 	eel_coder_realloc_code(cdr, f->e.codesize);
 	eel_coder_realloc_lines(cdr, f->e.nlines);
 	eel_coder_realloc_constants(cdr, f->e.nconstants);
+#ifdef EEL_VM_PREDECODE
+	/* Any pre-decoded code is stale now. Let the VM redo it as needed. */
+	eel_free(cdr->f->vm, f->e.dcode);
+	f->e.dcode = NULL;
+#endif
 	while(cdr->firstml)
 		eel_ml_close(cdr->firstml);
 	free(cdr->registers);
@@ -672,7 +754,7 @@ void eel_coder_realloc_code(EEL_coder *cdr, int size)
 	if(ns == cdr->maxcode)
 		return;
 
-	nc = (unsigned char *)realloc(f->e.code, ns);
+	nc = (unsigned char *)eel_realloc(cdr->f->vm, f->e.code, ns);
 	if(!nc)
 		eel_serror(cdr->state, "Could not reallocate code buffer!");
 
@@ -699,7 +781,8 @@ void eel_coder_realloc_lines(EEL_coder *cdr, int size)
 	if(ns == cdr->maxlines)
 		return;
 
-	nl = (EEL_int32 *)realloc(f->e.lines, sizeof(EEL_int32) * ns);
+	nl = (EEL_int32 *)eel_realloc(cdr->f->vm, f->e.lines,
+			sizeof(EEL_int32) * ns);
 	if(!nl)
 		eel_serror(cdr->state, "Could not reallocate line number table!");
 
@@ -726,7 +809,8 @@ void eel_coder_realloc_constants(EEL_coder *cdr, int size)
 	if(ns == cdr->maxconstants)
 		return;
 
-	nc = (EEL_value *)realloc(f->e.constants, sizeof(EEL_value) * ns);
+	nc = (EEL_value *)eel_realloc(cdr->f->vm, f->e.constants,
+			sizeof(EEL_value) * ns);
 	if(!nc)
 		eel_serror(cdr->state, "Could not reallocate constant table!");
 
@@ -739,18 +823,30 @@ static int objects_equal(EEL_object *o1, EEL_object *o2)
 {
 	EEL_xno x;
 	EEL_value v2, r;
-	v2.classid = EEL_COBJREF;
-	v2.objref.v = o2;
+	eel_o2v(&v2, o2);
 	x = eel_o__metamethod(o1, EEL_MM_COMPARE, &v2, &r);
 	if(x)
 		return 0;
-	if(0 == r.integer.v)
+	if(0 == EEL_VINT(&r))
 		return 1;
 	else
 		return 0;
 }
 
 
+/*
+ * Constant tables take ownership of constant
+ * objects, except functions in the same module!
+ */
+static inline int constant_owned(EEL_function *f, EEL_value *value)
+{
+	return EEL_IS_OBJREF(EEL_VCLASS(value)) &&
+			((eel_v2o(value)->classid != EEL_CFUNCTION) ||
+			(o2EEL_function(eel_v2o(value))->common.module !=
+					f->common.module));
+}
+
+
 int eel_coder_add_constant(EEL_coder *cdr, EEL_value *value)
 {
 	int i;
@@ -768,29 +864,29 @@ int eel_coder_add_constant(EEL_coder *cdr, EEL_value *value)
 /*FIXME: Can be time consuming when compiling large programs... */
 	for(i = 0; i < f->e.nconstants; ++i)
 	{
-		if(c[i].classid != value->classid)
+		if(EEL_VCLASS(&c[i]) != EEL_VCLASS(value))
 			continue;
-		switch(value->classid)
+		switch(EEL_VCLASS(value))
 		{
 		  case EEL_CNIL:
 			return i;
 		  case EEL_CREAL:
-			if(c[i].real.v == value->real.v)
+			if(EEL_VREAL(&c[i]) == EEL_VREAL(value))
 				return i;
 			break;
 		  case EEL_CINTEGER:
 		  case EEL_CBOOLEAN:
 		  case EEL_CCLASSID:
-			if(c[i].integer.v == value->integer.v)
+			if(EEL_VINT(&c[i]) == EEL_VINT(value))
 				return i;
 			break;
 		  case EEL_COBJREF:
 		  case EEL_CWEAKREF:
-			if(c[i].objref.v == value->objref.v)
+			if(eel_v2o(&c[i]) == eel_v2o(value))
 				return i;
-			if(c[i].objref.v->classid != value->objref.v->classid)
+			if(eel_v2o(&c[i])->classid != eel_v2o(value)->classid)
 				break;
-			if(objects_equal(c[i].objref.v, value->objref.v))
+			if(objects_equal(eel_v2o(&c[i]), eel_v2o(value)))
 				return i;
 			break;
 		  default:
@@ -802,20 +898,29 @@ int eel_coder_add_constant(EEL_coder *cdr, EEL_value *value)
 	 * Ok, add a new one...
 	 */
 	eel_v_qcopy(&c[f->e.nconstants], value);
-	/*
-	 * Constant tables take ownership of constant
-	 * objects, except functions in the same module!
-	 */
-	if(EEL_IS_OBJREF(value->classid) &&
-			((value->objref.v->classid != EEL_CFUNCTION) ||
-			(o2EEL_function(value->objref.v)->common.module !=
-					f->common.module)))
+	if(constant_owned(f, value))
 		eel_v_own(&c[f->e.nconstants]);
 
 	return f->e.nconstants++;
 }
 
 
+void eel_coder_set_constant(EEL_coder *cdr, int index, EEL_value *value)
+{
+	EEL_value *c;
+	EEL_function *f = o2EEL_function(cdr->f);
+	if((index < 0) || (index >= f->e.nconstants))
+		eel_ierror(cdr->state, "eel_coder_set_constant(): Constant "
+				"index %d out of range!", index);
+	c = f->e.constants + index;
+	if(constant_owned(f, c))
+		eel_v_disown(c);
+	eel_v_qcopy(c, value);
+	if(constant_owned(f, value))
+		eel_v_own(c);
+}
+
+
 void eel_coder_realloc_variables(EEL_coder *cdr, int size)
 {
 	EEL_value *nv;
@@ -833,7 +938,8 @@ void eel_coder_realloc_variables(EEL_coder *cdr, int size)
 	}
 	if(ns == m->maxvariables)
 		return;
-	nv = (EEL_value *)realloc(m->variables, sizeof(EEL_value) * ns);
+	nv = (EEL_value *)eel_realloc(cdr->f->vm, m->variables,
+			sizeof(EEL_value) * ns);
 	if(!nv)
 		eel_serror(cdr->state, "Could not reallocate variable table!");
 
@@ -854,12 +960,32 @@ int eel_coder_add_variable(EEL_coder *cdr, EEL_value *value)
 	if(value)
 		eel_v_copy(v, value);
 	else
-		v->classid = EEL_CNIL;
+		eel_nil2v(v);
 
 	return m->nvariables++;
 }
 
 
+void eel_coder_add_xregion(EEL_coder *cdr, int start, int end, int handler,
+		int clean, int xreg)
+{
+	EEL_xregion *xr;
+	EEL_function *f = o2EEL_function(cdr->f);
+	xr = (EEL_xregion *)eel_realloc(cdr->f->vm, f->e.xregions,
+			sizeof(EEL_xregion) * (f->e.nxregions + 1));
+	if(!xr)
+		eel_serror(cdr->state, "Could not reallocate exception "
+				"region table!");
+	f->e.xregions = xr;
+	xr += f->e.nxregions++;
+	xr->start = start;
+	xr->end = end;
+	xr->handler = handler;
+	xr->clean = clean;
+	xr->xreg = xreg;
+}
+
+
 void eel_coder_finalize_module(EEL_coder *cdr)
 {
 	EEL_module *m = o2EEL_module(o2EEL_function(cdr->f)->e.module);
@@ -1144,25 +1270,44 @@ static inline int code(EEL_coder *cdr, unsigned char *ins, int len)
 	  case EEL_OJUMP_sAx:
 	  case EEL_OJUMPZ_AsBx:
 	  case EEL_OJUMPNZ_AsBx:
+	  case EEL_OJUMPEQ_ABsCx:
+	  case EEL_OJUMPNE_ABsCx:
+	  case EEL_OJUMPGE_ABsCx:
+	  case EEL_OJUMPLE_ABsCx:
+	  case EEL_OJUMPGT_ABsCx:
+	  case EEL_OJUMPLT_ABsCx:
+	  case EEL_OJUMPZARGI_AsBx:
+	  case EEL_OJUMPNZARGI_AsBx:
 	  case EEL_OSWITCH_ABxsCx:
+	  case EEL_OSWITCHD_ABxsCx:
 	  case EEL_OPRELOOP_ABCsDx:
 	  case EEL_OLOOP_ABCsDx:
+	  case EEL_OIPRELOOP_ABCsDx:
+	  case EEL_OILOOP_ABCsDx:
 	  case EEL_ORETURN_0:
 	  case EEL_ORETURNR_A:
 	  case EEL_OTHROW_A:
-	  case EEL_ORETRY_0:
-	  case EEL_ORETX_0:
-	  case EEL_ORETXR_A:
 		/*
 		 * As of now, the optimizer never removes any of these
 		 * instructions, so we can assume our new instruction
 		 * is still the last instruction in the fragment, unless
-		 * it was removed by dead code elimination.
+		 * it was removed by dead code elimination. It may however
+		 * be fused with the instruction before it, changing its
+		 * size and position, so we look it up after optimizing.
 		 */
 		if(ipos < 0)
 			return ipos;
 		else
-			return eel_code_target(cdr) - len;
+		{
+			unsigned char *c;
+			int end;
+			ipos = cdr->fragstart;
+			end = eel_code_target(cdr);
+			c = o2EEL_function(cdr->f)->e.code;
+			while(ipos + eel_i_size(c[ipos]) < end)
+				ipos += eel_i_size(c[ipos]);
+			return ipos;
+		}
 	  default:
 		/*
 		 * No one's business where normal instructions go, as
@@ -1377,6 +1522,9 @@ int eel_codeABCD(EEL_coder *cdr, EEL_opcodes op, int a, int b, int c, int d)
 	  case EEL_OIPBOP_ABCD:
 		EEL_REGUSE(op, a, EEL_RUTEMPORARY, "A")
 		break;
+	  case EEL_OCALLRWR_ABCD:
+		EEL_REGUSE(op, b, EEL_RUTEMPORARY, "B")
+		break;
 	  default:
 		break;
 	}
@@ -1640,6 +1788,8 @@ int eel_codeABCsDx(EEL_coder *cdr, EEL_opcodes op, int a, int b, int c, int d)
 	{
 	  case EEL_OPRELOOP_ABCsDx:
 	  case EEL_OLOOP_ABCsDx:
+	  case EEL_OIPRELOOP_ABCsDx:
+	  case EEL_OILOOP_ABCsDx:
 		EEL_REGUSE(op, a, EEL_RUVARIABLE, "A")
 		break;
 	  case EEL_OBOPS_ABCsDx:
@@ -1674,13 +1824,26 @@ static inline int eel_get_offset_pos(unsigned char opcode, int *isize)
 		return EEL_OSIZE_sAx - 2;
 	  case EEL_OJUMPZ_AsBx:
 	  case EEL_OJUMPNZ_AsBx:
+	  case EEL_OJUMPZARGI_AsBx:
+	  case EEL_OJUMPNZARGI_AsBx:
 		*isize = EEL_OSIZE_AsBx;
 		return EEL_OSIZE_AsBx - 2;
+	  case EEL_OJUMPEQ_ABsCx:
+	  case EEL_OJUMPNE_ABsCx:
+	  case EEL_OJUMPGE_ABsCx:
+	  case EEL_OJUMPLE_ABsCx:
+	  case EEL_OJUMPGT_ABsCx:
+	  case EEL_OJUMPLT_ABsCx:
+		*isize = EEL_OSIZE_ABsCx;
+		return EEL_OSIZE_ABsCx - 2;
 	  case EEL_OSWITCH_ABxsCx:
+	  case EEL_OSWITCHD_ABxsCx:
 		*isize = EEL_OSIZE_ABxsCx;
 		return EEL_OSIZE_ABxsCx - 2;
 	  case EEL_OPRELOOP_ABCsDx:
 	  case EEL_OLOOP_ABCsDx:
+	  case EEL_OIPRELOOP_ABCsDx:
+	  case EEL_OILOOP_ABCsDx:
 		*isize = EEL_OSIZE_ABCsDx;
 		return EEL_OSIZE_ABCsDx - 2;
 	  default:
@@ -1713,6 +1876,21 @@ void eel_code_setjump(EEL_coder *cdr, int pos, int whereto)
 }
 
 
+void eel_code_setop(EEL_coder *cdr, int pos, EEL_opcodes op)
+{
+	unsigned char *ins;
+	if(pos < 0)
+		return;		/* Code generation was disabled! --> */
+
+	ins = o2EEL_function(cdr->f)->e.code + pos;
+	if(eel_i_operands(ins[0]) != eel_i_operands(op))
+		eel_ierror(cdr->state, "eel_code_setop() cannot change %s "
+				"into %s! (Different operand layouts.)",
+				eel_i_name(ins[0]), eel_i_name(op));
+	ins[0] = op;
+}
+
+
 int eel_code_getjump(EEL_coder *cdr, int pos)
 {
 	int isize, offspos, whereto;
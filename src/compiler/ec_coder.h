@@ -85,12 +85,26 @@ void eel_coder_finalize_module(EEL_coder *cdr);
 /* Add value 'v' to the constant table. Returns it's index. */
 int eel_coder_add_constant(EEL_coder *cdr, EEL_value *value);
 
+/*
+ * Replace constant 'index' with 'value'. No checking for duplicates is done,
+ * so this is only safe for constants that are never shared, such as 'switch'
+ * jump tables.
+ */
+void eel_coder_set_constant(EEL_coder *cdr, int index, EEL_value *value);
+
 /*
  * Add a variable to the variables table and initialize it
  * to 'value'. Returns the index of the variable.
  */
 int eel_coder_add_variable(EEL_coder *cdr, EEL_value *value);
 
+/*
+ * Add an exception handling region to the function. (See EEL_xregion.)
+ * Regions must be added innermost first.
+ */
+void eel_coder_add_xregion(EEL_coder *cdr, int start, int end, int handler,
+		int clean, int xreg);
+
 
 /*----------------------------------------------------------
 	Register allocation
@@ -192,6 +206,12 @@ int eel_code_target(EEL_coder *cdr);
  */
 void eel_code_setjump(EEL_coder *cdr, int pos, int whereto);
 
+/*
+ * Change the opcode of the instruction at 'pos' to 'op', which must have the
+ * same operand layout as the original instruction.
+ */
+void eel_code_setop(EEL_coder *cdr, int pos, EEL_opcodes op);
+
 /*
  * If the instruction at 'pos' is a branch instruction, the target PC is
  * returned, unless the target position has not yet been calculated, in which
@@ -26,7 +26,6 @@
 #include "ec_symtab.h"
 #include "e_state.h"
 #include "e_string.h"
-#include "e_function.h"
 
 /*----------------------------------------------------------
 	Compiler Context
@@ -218,7 +217,7 @@ void eel_context_push(EEL_state *es, int flags, const char *name)
 	if(c->flags & ECTX_ROOT)	printf("ROOT ");
 	if(c->flags & ECTX_CATCHER)	printf("CATCHER ");
 	if(c->flags & ECTX_WRAPPED)	printf("WRAPPED ");
-	if(c->flags & ECTX_DUMMY)	printf("DUMMY ");
+	if(c->flags & ECTX_TRY)		printf("TRY ");
 	if(c->flags & ECTX_KEEP)	printf("KEEP ");
 	if(c->flags & ECTX_OWNS_BIO)	printf("OWNS_BIO ");
 	if(c->flags & ECTX_OWNS_CODER)	printf("OWNS_CODER ");
@@ -248,12 +247,6 @@ void eel_context_pop(EEL_state *es)
 			eel_e_merge_up(c);
 		break;
 	  case ECTX_FUNCTION:
-		if(c->coder && c->coder->f)
-		{
-			EEL_function *f = o2EEL_function(c->coder->f);
-			if(f->common.flags & EEL_FF_XBLOCK)
-				eel_e_move_up_xblock(c);
-		}
 		break;
 	}
 
@@ -266,7 +259,7 @@ void eel_context_pop(EEL_state *es)
 	 * Restore the previous context
 	 */
 	es->context = c->previous;
-	free(c);
+	eel_free(es->vm, c);
 	if(es->jumpbufs)
 		--es->jumpbufs->contexts;
 }
@@ -95,34 +95,6 @@ void eel_e_move_up(EEL_context *c)
 }
 
 
-/* Used when popping XBLOCK function contexts */
-void eel_e_move_up_xblock(EEL_context *c)
-{
-	int i;
-	EEL_cevlist *e = c->firstel;
-	DBGB(printf("MOVING EVENT LIST %p FROM CONTEXT %p TO CONTEXT %p.\n",
-			e, c, c->previous);)
-	/* Delete everything but RETURN events... */
-	for(i = 0; i < EEL__EVENTS; ++i)
-		switch(i)
-		{
-		  case EEL_ERETURN:
-			DBGB(printf("  RETURN event escaped xblock.\n");)
-			break;
-		  case EEL_ERESULT:
-			DBGB(printf("  RESULT event escaped xblock.\n");)
-			break;
-		  default:
-			e->events[i] = EEL_ENO;
-			break;
-		}
-	/* Add the list as the last list of the previous context */
-	e_unlink(e->parent, e);
-	e->parent = c->previous;
-	e_link(c->previous, e);
-}
-
-
 /* Used when popping non-CONDITIONAL contexts */
 void eel_e_merge_up(EEL_context *c)
 {
@@ -400,17 +372,38 @@ void eel_e_target(EEL_state *es, EEL_cestate st)
 void eel_e_init(EEL_state *es, EEL_symbol *s)
 {
 	EEL_cevlist *e = es->context->firstel;
+	EEL_context *c;
 	DBGB(printf("EVENT: INIT R[%d] ('%s')\n",
 			s->v.var.location, s->name);)
 	if(eel_test_init(es, s))
 		eel_ierror(es, "Variable '%s' has already been initialized!",
 				eel_o2s(s->name));
+	/*
+	 * An exception can cut a 'try' block short, and 'except' blocks
+	 * only run sometimes, so outer variables can't be initialized there.
+	 */
+	for(c = es->context; c && (c->type != ECTX_FUNCTION); c = c->previous)
+	{
+		if(c->symtab == s->parent)
+			break;
+		if(c->flags & (ECTX_TRY | ECTX_CATCHER))
+			eel_cerror(es, "Variable '%s' must be initialized "
+					"before the 'try' statement!",
+					eel_o2s(s->name));
+	}
 	if((s->v.var.location < 0) || (s->v.var.location > EEL_MAXREG))
 		eel_ierror(es, "Variable '%s' is located in an out of range "
 				"register!", eel_o2s(s->name));
 	e->events[s->v.var.location] = EEL_EYES;
 }
 
+void eel_e_init_reg(EEL_state *es, int r)
+{
+	EEL_cevlist *e = es->context->firstel;
+	DBGB(printf("EVENT: INIT R[%d]\n", r);)
+	e->events[r] = EEL_EYES;
+}
+
 void eel_e_result(EEL_state *es)
 {
 	EEL_cevlist *e = es->context->firstel;
@@ -51,9 +51,7 @@
  *	* EXIT and TARGET events are dropped.
  *	* INIT events never escape the context their
  *	  respective variables were declared in.
- *	* No events escape FUNCTION contexts, except
- *	  RESULT and RETURN events that can escape
- *	  XBLOCK functions.
+ *	* No events escape FUNCTION contexts.
  *
  *    When a CONDITIONAL context is popped, it's event list
  * is moved to the parent context's list of event lists. The
@@ -109,12 +107,12 @@ void eel_e_close(EEL_cevlist *el);
  * new event list in the context previous to 'c'.
  */
 void eel_e_move_up(EEL_context *c);
-void eel_e_move_up_xblock(EEL_context *c);
 
 /* Add event to the current context */
 void eel_e_exit(EEL_state *es);
 void eel_e_return(EEL_state *es);
 void eel_e_init(EEL_state *es, EEL_symbol *s);
+void eel_e_init_reg(EEL_state *es, int r);	/* Unnamed variable */
 void eel_e_result(EEL_state *es);
 void eel_e_target(EEL_state *es, EEL_cestate st);
 
@@ -67,6 +67,7 @@ typedef enum
 	TK_KW_BREAK,
 	TK_KW_CONTINUE,
 	TK_KW_REPEAT,
+	TK_KW_YIELD,
 
 	TK_KW_TRY,
 	TK_KW_UNTRY,
@@ -111,6 +112,7 @@ typedef enum
 	case TK_KW_BREAK:	\
 	case TK_KW_CONTINUE:	\
 	case TK_KW_REPEAT:	\
+	case TK_KW_YIELD:	\
 	\
 	case TK_KW_TRY:		\
 	case TK_KW_UNTRY:	\
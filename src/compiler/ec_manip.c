@@ -150,8 +150,7 @@ void eel_m_tuparg(EEL_mlist *ml, EEL_symbol *s, int level)
 void eel_m_object(EEL_mlist *ml, EEL_object *o)
 {
 	EEL_value v;
-	v.classid = EEL_COBJREF;
-	v.objref.v = o;
+	eel_o2v(&v, o);
 	eel_m_constant(ml, &v);
 }
 
@@ -254,6 +253,21 @@ void eel_m_tupargs(EEL_mlist *ml)
 }
 
 
+void eel_m_spread(EEL_mlist *ml, EEL_manipulator *object,
+		EEL_manipulator *first, EEL_manipulator *count)
+{
+	EEL_manipulator *m = m_open(ml, EEL_MSPREAD);
+	m->v.spread.object = object;
+	m->v.spread.first = first;
+	m->v.spread.count = count;
+	++object->refcount;
+	if(first)
+		++first->refcount;
+	if(count)
+		++count->refcount;
+}
+
+
 /*
  * Detach manipulator from any list it's in.
  * The refcount is either taken over from the list,
@@ -318,6 +332,13 @@ void eel_m_delete(EEL_manipulator *m)
 	  case EEL_MARGS:
 	  case EEL_MTUPARGS:
 		break;
+	  case EEL_MSPREAD:
+		m_release(m->v.spread.object);
+		if(m->v.spread.first)
+			m_release(m->v.spread.first);
+		if(m->v.spread.count)
+			m_release(m->v.spread.count);
+		break;
 	}
 	free(m);
 }
@@ -352,6 +373,7 @@ int eel_m_writable(EEL_manipulator *m)
 	  case EEL_MARGUMENT:
 	  case EEL_MOPTARG:
 	  case EEL_MTUPARG:
+	  case EEL_MSPREAD:
 		return 0;
 	  case EEL_MVARIABLE:
 	  case EEL_MSTATVAR:
@@ -407,6 +429,7 @@ int eel_m_direct_read(EEL_manipulator *m)
 	  case EEL_MINDEX:
 	  case EEL_MARGS:
 	  case EEL_MTUPARGS:
+	  case EEL_MSPREAD:
 		return -1;
 	}
 	return -1;
@@ -438,6 +461,7 @@ FIXME: Initializing variables with simple values is ok as well.
 	  case EEL_MINDEX:
 	  case EEL_MARGS:
 	  case EEL_MTUPARGS:
+	  case EEL_MSPREAD:
 		return -1;
 	}
 	return -1;
@@ -449,13 +473,13 @@ int eel_m_direct_uint8(EEL_manipulator *m)
 	switch(m->kind)
 	{
 	  case EEL_MCONSTANT:
-		if(m->v.constant.v.classid != EEL_CINTEGER)
+		if(EEL_VCLASS(&m->v.constant.v) != EEL_CINTEGER)
 			return -1;
-		if(m->v.constant.v.integer.v < 0)
+		if(EEL_VINT(&m->v.constant.v) < 0)
 			return -1;
-		if(m->v.constant.v.integer.v > 255)
+		if(EEL_VINT(&m->v.constant.v) > 255)
 			return -1;
-		return m->v.constant.v.integer.v;
+		return EEL_VINT(&m->v.constant.v);
 	  case EEL_MVOID:
 	  case EEL_MRESULT:
 	  case EEL_MREGISTER:
@@ -469,6 +493,7 @@ int eel_m_direct_uint8(EEL_manipulator *m)
 	  case EEL_MINDEX:
 	  case EEL_MARGS:
 	  case EEL_MTUPARGS:
+	  case EEL_MSPREAD:
 		break;
 	}
 	return -1;
@@ -480,13 +505,13 @@ int eel_m_direct_short(EEL_manipulator *m)
 	switch(m->kind)
 	{
 	  case EEL_MCONSTANT:
-		if(m->v.constant.v.classid != EEL_CINTEGER)
+		if(EEL_VCLASS(&m->v.constant.v) != EEL_CINTEGER)
 			return -100000;
-		if(m->v.constant.v.integer.v < -32768)
+		if(EEL_VINT(&m->v.constant.v) < -32768)
 			return -100000;
-		if(m->v.constant.v.integer.v > 32767)
+		if(EEL_VINT(&m->v.constant.v) > 32767)
 			return -100000;
-		return m->v.constant.v.integer.v;
+		return EEL_VINT(&m->v.constant.v);
 	  case EEL_MVOID:
 	  case EEL_MRESULT:
 	  case EEL_MREGISTER:
@@ -500,6 +525,7 @@ int eel_m_direct_short(EEL_manipulator *m)
 	  case EEL_MINDEX:
 	  case EEL_MARGS:
 	  case EEL_MTUPARGS:
+	  case EEL_MSPREAD:
 		break;
 	}
 	return -100000;
@@ -511,16 +537,16 @@ int eel_m_direct_bool(EEL_manipulator *m)
 	switch(m->kind)
 	{
 	  case EEL_MCONSTANT:
-		switch(m->v.constant.v.classid)
+		switch(EEL_VCLASS(&m->v.constant.v))
 		{
 		  case EEL_CNIL:
 			return 0;
 		  case EEL_CREAL:
-			return m->v.constant.v.real.v != 0.0;
+			return EEL_VREAL(&m->v.constant.v) != 0.0;
 		  case EEL_CINTEGER:
-			return m->v.constant.v.integer.v != 0;
+			return EEL_VINT(&m->v.constant.v) != 0;
 		  case EEL_CBOOLEAN:
-			return m->v.constant.v.integer.v;
+			return EEL_VINT(&m->v.constant.v);
 		  case EEL_CCLASSID:
 			return 1;
 		  case EEL_COBJREF:
@@ -543,6 +569,7 @@ int eel_m_direct_bool(EEL_manipulator *m)
 	  case EEL_MINDEX:
 	  case EEL_MARGS:
 	  case EEL_MTUPARGS:
+	  case EEL_MSPREAD:
 		break;
 	}
 	return -1;
@@ -568,6 +595,50 @@ int eel_m_is_constant(EEL_manipulator *m)
 	  case EEL_MINDEX:
 	  case EEL_MARGS:
 	  case EEL_MTUPARGS:
+	  case EEL_MSPREAD:
+		break;
+	}
+	return 0;
+}
+
+
+int eel_m_is_integer(EEL_manipulator *m)
+{
+	switch(m->kind)
+	{
+	  case EEL_MCONSTANT:
+		return EEL_VCLASS(&m->v.constant.v) == EEL_CINTEGER;
+	  case EEL_MCAST:
+		return m->v.cast.classid == EEL_CINTEGER;
+	  case EEL_MOP:
+		switch(m->v.op.op)
+		{
+		  case EEL_OP_ADD:
+		  case EEL_OP_SUB:
+		  case EEL_OP_MUL:
+			return m->v.op.left &&
+					eel_m_is_integer(m->v.op.left) &&
+					eel_m_is_integer(m->v.op.right);
+		  case EEL_OP_NEG:
+			return eel_m_is_integer(m->v.op.right);
+		  case EEL_OP_CASTI:
+		  case EEL_OP_SIZEOF:
+			return 1;
+		  default:
+			return 0;
+		}
+	  case EEL_MVOID:
+	  case EEL_MRESULT:
+	  case EEL_MREGISTER:
+	  case EEL_MVARIABLE:
+	  case EEL_MSTATVAR:
+	  case EEL_MARGUMENT:
+	  case EEL_MOPTARG:
+	  case EEL_MTUPARG:
+	  case EEL_MINDEX:
+	  case EEL_MARGS:
+	  case EEL_MTUPARGS:
+	  case EEL_MSPREAD:
 		break;
 	}
 	return 0;
@@ -595,6 +666,7 @@ void eel_m_get_constant(EEL_manipulator *m, EEL_value *v)
 	  case EEL_MINDEX:
 	  case EEL_MARGS:
 	  case EEL_MTUPARGS:
+	  case EEL_MSPREAD:
 		break;
 	}
 	eel_ierror(cdr->state, "eel_m_get_constant() used on something"
@@ -612,6 +684,7 @@ int eel_m_independent(EEL_manipulator *m1, EEL_manipulator *m2)
 	  case EEL_MCAST:
 	  case EEL_MARGS:
 	  case EEL_MTUPARGS:
+	  case EEL_MSPREAD:
 		/* These are immutable or otherwise uninteresting here. */
 		return 1;
 	  case EEL_MRESULT:
@@ -654,7 +727,7 @@ int eel_m_independent(EEL_manipulator *m1, EEL_manipulator *m2)
 		if((x = eel_op_eq(&v1, &v2, &r)))
 			eel_ierror(m1->coder->state, "Could not compare index "
 					"values in eel_m_independent()!");
-		return !r.integer.v;
+		return !EEL_VINT(&r);
 	  }
 	}
 	return 1;
@@ -826,8 +899,7 @@ static void do_cast(EEL_manipulator *m, int r)
 		{
 			EEL_value v;
 			int c;
-			v.classid = EEL_CCLASSID;
-			v.integer.v = m->v.cast.classid;
+			eel_i2v(&v, EEL_CCLASSID, m->v.cast.classid);
 			c = eel_coder_add_constant(cdr, &v);
 			eel_codeABx(cdr, EEL_OLDC_ABx, cr, c);
 			eel_codeABC(cdr, EEL_OCAST_ABC, r, dr, cr);
@@ -976,13 +1048,13 @@ int eel_m_prepare_constant(EEL_manipulator *m)
 	ci = &m->v.constant.index;
 	if(*ci >= 0)
 		return *ci;
-	switch(cv->classid)
+	switch(EEL_VCLASS(cv))
 	{
 	  case EEL_CNIL:
 	  case EEL_CBOOLEAN:
 		return -1;
 	  case EEL_CINTEGER:
-		if((cv->integer.v >= -32768) && (cv->integer.v <= 32767))
+		if((EEL_VINT(cv) >= -32768) && (EEL_VINT(cv) <= 32767))
 			return -1;
 		return (*ci = eel_coder_add_constant(cdr, cv));
 	  case EEL_CCLASSID:
@@ -1016,16 +1088,16 @@ static void read_constant(EEL_manipulator *m, int r)
 	 * No constant in table! We're supposed to issue an instruction with
 	 * immediate data encoded.
 	 */
-	switch(cv->classid)
+	switch(EEL_VCLASS(cv))
 	{
 	  case EEL_CNIL:
 		eel_codeA(cdr, EEL_OLDNIL_A, r);
 		return;
 	  case EEL_CINTEGER:
-		eel_codeAsBx(cdr, EEL_OLDI_AsBx, r, cv->integer.v);
+		eel_codeAsBx(cdr, EEL_OLDI_AsBx, r, EEL_VINT(cv));
 		return;
 	  case EEL_CBOOLEAN:
-		if(cv->integer.v)
+		if(EEL_VINT(cv))
 			eel_codeA(cdr, EEL_OLDTRUE_A, r);
 		else
 			eel_codeA(cdr, EEL_OLDFALSE_A, r);
@@ -1060,28 +1132,28 @@ static void push_constant(EEL_manipulator *m)
 	 * Lets figure out some nice way to
 	 * generate this value or something.
 	 */
-	switch(cv->classid)
+	switch(EEL_VCLASS(cv))
 	{
 	  case EEL_CNIL:
 		eel_code0(cdr, EEL_OPUSHNIL_0);
 		return;
 	  case EEL_CINTEGER:
-		if((cv->integer.v >= -32768) && (cv->integer.v <= 32767))
+		if((EEL_VINT(cv) >= -32768) && (EEL_VINT(cv) <= 32767))
 		{
-			eel_codesAx(cdr, EEL_OPUSHI_sAx, cv->integer.v);
+			eel_codesAx(cdr, EEL_OPUSHI_sAx, EEL_VINT(cv));
 			return;
 		}
 	  case EEL_CBOOLEAN:
-		if(cv->integer.v)
+		if(EEL_VINT(cv))
 			eel_code0(cdr, EEL_OPHTRUE_0);
 		else
 			eel_code0(cdr, EEL_OPHFALSE_0);
 		return;
 #if 0
 	  case EEL_CCLASSID:
-		if(cv->integer.v <= 255)
+		if(EEL_VINT(cv) <= 255)
 		{
-			eel_codeAB(cdr, EEL_OLDTYPE_AB, r, cv->integer.v);
+			eel_codeAB(cdr, EEL_OLDTYPE_AB, r, EEL_VINT(cv));
 			return;
 		}
 #endif
@@ -1164,10 +1236,60 @@ void eel_m_read(EEL_manipulator *m, int r)
 	  case EEL_MTUPARGS:
 		eel_ierror(cdr->state, "Tried to read tuple argument list into "
 				"register!");
+	  case EEL_MSPREAD:
+		eel_cerror(cdr->state, "Item list expansion can only be used "
+				"in argument lists!");
 	}
 }
 
 
+/*
+ * Read 'm' into a new temporary register, unless it can be read directly.
+ * Temporary registers are added to 'temps', which is advanced.
+ */
+static int read_temp(EEL_manipulator *m, int **temps)
+{
+	int r = eel_m_direct_read(m);
+	if(r >= 0)
+		return r;
+	r = eel_r_alloc(m->coder, 1, EEL_RUTEMPORARY);
+	eel_m_read(m, r);
+	*(*temps)++ = r;
+	return r;
+}
+
+static void do_push_spread(EEL_manipulator *m)
+{
+	EEL_coder *cdr = m->coder;
+	EEL_manipulator *fm = m->v.spread.first;
+	EEL_manipulator *cm = m->v.spread.count;
+	int or, fr, cr, fv, cv;
+	int tempregs[3];
+	int *temps = tempregs;
+	or = read_temp(m->v.spread.object, &temps);
+	fv = fm ? eel_m_direct_uint8(fm) : 0;
+	cv = cm ? eel_m_direct_uint8(cm) : 0;
+	if(!fm)
+		eel_codeA(cdr, EEL_OPUSHA_A, or);
+	else if((fv >= 0) && (!cm || (cv > 0)))
+		eel_codeABC(cdr, EEL_OPUSHAS_ABC, or, fv, cv);
+	else
+	{
+		fr = read_temp(fm, &temps);
+		if(cm)
+			cr = read_temp(cm, &temps);
+		else
+		{
+			cr = eel_r_alloc(cdr, 1, EEL_RUTEMPORARY);
+			eel_codeA(cdr, EEL_OLDNIL_A, cr);
+			*temps++ = cr;
+		}
+		eel_codeABC(cdr, EEL_OPUSHASR_ABC, or, fr, cr);
+	}
+	while(temps > tempregs)
+		eel_r_free(cdr, *--temps, 1);
+}
+
 void eel_m_push(EEL_manipulator *m)
 {
 	EEL_coder *cdr = m->coder;
@@ -1238,6 +1360,9 @@ FIXME: peephole optimizer make use of the shortcut instructions?
 	  case EEL_MTUPARGS:
 		eel_code0(cdr, EEL_OPUSHTUP_0);
 		break;
+	  case EEL_MSPREAD:
+		do_push_spread(m);
+		break;
 	}
 }
 
@@ -1324,6 +1449,8 @@ FIXME: Is this actually an internal error now...?
 		eel_ierror(cdr->state, "Tried to write to argument list!");
 	  case EEL_MTUPARGS:
 		eel_ierror(cdr->state, "Tried to write to tuple argument list!");
+	  case EEL_MSPREAD:
+		eel_cerror(cdr->state, "Assignment to item list expansion!");
 	}
 }
 
@@ -1350,6 +1477,7 @@ static int can_write_weakref(EEL_manipulator *m)
 		return 1;
 	  case EEL_MARGS:
 	  case EEL_MTUPARGS:
+	  case EEL_MSPREAD:
 		return 0;
 	}
 	return 0;
@@ -42,7 +42,8 @@ typedef enum
 	EEL_MCAST,		/* Cast operator. (RO) */
 	EEL_MINDEX,		/* Indexed object. (R/W) */
 	EEL_MARGS,		/* Full argument list of current func (R/W) */
-	EEL_MTUPARGS		/* Tuple argument list of current func (R/W) */
+	EEL_MTUPARGS,		/* Tuple argument list of current func (R/W) */
+	EEL_MSPREAD		/* Items of indexable object (push only) */
 } EEL_manipkinds;
 
 struct EEL_manipulator
@@ -92,6 +93,12 @@ struct EEL_manipulator
 			EEL_manipulator	*object;
 			EEL_manipulator	*index;
 		} index;
+		struct
+		{
+			EEL_manipulator	*object;
+			EEL_manipulator	*first;	/* NULL for 0 */
+			EEL_manipulator	*count;	/* NULL for "to the end" */
+		} spread;
 	} v;
 };
 
@@ -169,6 +176,14 @@ void eel_m_transfer(EEL_manipulator *m, EEL_mlist *ml);
 void eel_m_args(EEL_mlist *ml);
 void eel_m_tupargs(EEL_mlist *ml);
 
+/*
+ * Add 'count' items of 'object', starting at item 'first'. 'first' and 'count'
+ * may be NULL, for all items from 0, and all items to the end, respectively.
+ * This can only be pushed, as it generates any number of values.
+ */
+void eel_m_spread(EEL_mlist *ml, EEL_manipulator *object,
+		EEL_manipulator *first, EEL_manipulator *count);
+
 
 /*----------------------------------------------------------
 	Manipulator information
@@ -220,6 +235,13 @@ int eel_m_direct_bool(EEL_manipulator *m);
  */
 int eel_m_is_constant(EEL_manipulator *m);
 
+/*
+ * Returns 1 if 'm' is known at compile time to evaluate to an integer value.
+ * (Integer constants, casts and sizeof, and integer arithmetic on those.)
+ * Otherwise, it returns 0.
+ */
+int eel_m_is_integer(EEL_manipulator *m);
+
 /*
  * Read value of 'm' into 'v'. 'm' has to be a constant that can be evaluated
  * at compile time.
@@ -78,6 +78,67 @@ int eel_ml_push(EEL_mlist *ml)
 }
 
 
+int eel_ml_window(EEL_mlist *ml, int avoid, int *temps)
+{
+#ifdef EEL_CALLRW_MAXARGS
+	int i, first;
+	EEL_manipulator *m;
+	*temps = 0;
+	if(!ml->length || (ml->length > EEL_CALLRW_MAXARGS))
+		return -1;
+	m = ml->args;
+	for(i = 0; i < ml->length; ++i)
+	{
+		switch(m->kind)
+		{
+		  case EEL_MOP:
+		  case EEL_MCAST:
+		  case EEL_MINDEX:
+			/*
+			 * The PH* instructions put new values on the stack,
+			 * whereas results in registers are left for the
+			 * limbo to clean up.
+			 */
+		  case EEL_MARGS:
+		  case EEL_MTUPARGS:
+		  case EEL_MSPREAD:
+			return -1;
+		  default:
+			break;
+		}
+		m = m->next;
+	}
+
+	/* Already in place? */
+	first = eel_m_direct_read(ml->args);
+	m = ml->args;
+	for(i = 0; (first >= 0) && (i < ml->length); ++i)
+	{
+		if((eel_m_direct_read(m) != first + i) ||
+				(first + i == avoid))
+			first = -1;
+		m = m->next;
+	}
+	if(first >= 0)
+		return first;
+
+	/* Nope. Read them into temporaries. */
+	first = eel_r_alloc(ml->coder, ml->length, EEL_RUTEMPORARY);
+	m = ml->args;
+	for(i = 0; i < ml->length; ++i)
+	{
+		DBG9(printf("; WINDOW element[%d]:\n", i);)
+		eel_m_read(m, first + i);
+		m = m->next;
+	}
+	*temps = ml->length;
+	return first;
+#else
+	return -1;
+#endif
+}
+
+
 void eel_ml_transfer(EEL_mlist *from, EEL_mlist *to)
 {
 	while(from->length)
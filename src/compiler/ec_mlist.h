@@ -57,6 +57,20 @@ EEL_manipulator *eel_ml_get(EEL_mlist *ml, int a);
  */
 int eel_ml_push(EEL_mlist *ml);
 
+/*
+ * Get the arguments in 'ml' into a window of consecutive registers, for the
+ * CALLRW and CCALLRW instructions. If the arguments are already in consecutive
+ * registers, those are used as is. Otherwise, the arguments are read into new
+ * temporary registers, and '*temps' is set to the number of registers to free
+ * after the call. Register 'avoid' (-1 for none) is never part of the window.
+ *
+ * Returns the first register of the window, or -1, without coding anything,
+ * if the arguments cannot be passed that way. (Operator, cast and index
+ * arguments are better off pushed, as the push instructions take ownership of
+ * new values directly.)
+ */
+int eel_ml_window(EEL_mlist *ml, int avoid, int *temps);
+
 /* Transfer all manipulators from 'from' to 'to'. */
 void eel_ml_transfer(EEL_mlist *from, EEL_mlist *to);
 
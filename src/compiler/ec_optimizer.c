@@ -40,6 +40,38 @@
  *	   area.
  */
 
+/*
+ * Return the compare-and-branch instruction that jumps if the comparison
+ * 'op' is true, or if it is false when 'negate' is set. Returns
+ * EEL_OILLEGAL_0 if 'op' is not a comparison.
+ *
+ * NOTE:
+ *	Negating is exact, as the VM implements NE, LT and LE as !EQ, !GE
+ *	and !GT respectively, so the fused branch behaves exactly like the
+ *	BOP + JUMPZ/JUMPNZ sequence it replaces.
+ */
+static inline EEL_opcodes eel_cmp_jump(int op, int negate)
+{
+	switch(op)
+	{
+	  case EEL_OP_EQ:
+		return negate ? EEL_OJUMPNE_ABsCx : EEL_OJUMPEQ_ABsCx;
+	  case EEL_OP_NE:
+		return negate ? EEL_OJUMPEQ_ABsCx : EEL_OJUMPNE_ABsCx;
+	  case EEL_OP_GT:
+		return negate ? EEL_OJUMPLE_ABsCx : EEL_OJUMPGT_ABsCx;
+	  case EEL_OP_GE:
+		return negate ? EEL_OJUMPLT_ABsCx : EEL_OJUMPGE_ABsCx;
+	  case EEL_OP_LT:
+		return negate ? EEL_OJUMPGE_ABsCx : EEL_OJUMPLT_ABsCx;
+	  case EEL_OP_LE:
+		return negate ? EEL_OJUMPGT_ABsCx : EEL_OJUMPLE_ABsCx;
+	  default:
+		return EEL_OILLEGAL_0;
+	}
+}
+
+
 /*
  * Attempt to make a peephole substitution at the indicated position.
  * Returns 1 if a substitution was made.
@@ -125,6 +157,43 @@ static inline int eel_pair_subst(EEL_coder *cdr, int pc, unsigned flags)
 			return 0;
 		eel_codeAsBx(cdr, EEL_OJUMPZ_AsBx, i1[2], 0);
 		break;
+	  case EEL_MKOPT(EEL_OBOP_ABCD, EEL_OJUMPZ_AsBx):
+	  case EEL_MKOPT(EEL_OBOP_ABCD, EEL_OJUMPNZ_AsBx):
+	  {
+		/*
+		 *	BOP R[x] < R[y], R[z]	JUMPGE R[x], R[y], ?
+		 *	JUMPZ R[z], ?
+		 *
+		 *	BOP R[x] < R[y], R[z]	JUMPLT R[x], R[y], ?
+		 *	JUMPNZ R[z], ?
+		 *
+		 * (Same for all comparison operators.)
+		 */
+		EEL_opcodes op = eel_cmp_jump(i1[3],
+				i2[0] == EEL_OJUMPZ_AsBx);
+		if(keepregs || (i1[1] != i2[1]) || (op == EEL_OILLEGAL_0))
+			return 0;
+		eel_codeABsCx(cdr, op, i1[2], i1[4], 0);
+		break;
+	  }
+	  case EEL_MKOPT(EEL_OGETARGI_AB, EEL_OJUMPZ_AsBx):
+		/*
+		 *	GETARGI args[?], R[x]	JUMPZARGI args[?], ?
+		 *	JUMPZ R[x], ?
+		 */
+		if(keepregs || (i1[1] != i2[1]))
+			return 0;
+		eel_codeAsBx(cdr, EEL_OJUMPZARGI_AsBx, i1[2], 0);
+		break;
+	  case EEL_MKOPT(EEL_OGETARGI_AB, EEL_OJUMPNZ_AsBx):
+		/*
+		 *	GETARGI args[?], R[x]	JUMPNZARGI args[?], ?
+		 *	JUMPNZ R[x], ?
+		 */
+		if(keepregs || (i1[1] != i2[1]))
+			return 0;
+		eel_codeAsBx(cdr, EEL_OJUMPNZARGI_AsBx, i1[2], 0);
+		break;
 	  case EEL_MKOPT(EEL_OLDI_AsBx, EEL_OINIT_AB):
 		/*
 		 *	LDI ?, R[x]		INITI ?, R[x]
@@ -188,6 +257,16 @@ static inline int eel_pair_subst(EEL_coder *cdr, int pc, unsigned flags)
 			return 0;
 		eel_codeA(cdr, EEL_OPHARGI_A, i1[2]);
 		break;
+	  case EEL_MKOPT(EEL_OGETARGI_AB, EEL_OINDGETC_ABCx):
+		/*
+		 *	GETARGI args[y], R[x]	ARGINDGETC args[y][Cz], R[w]
+		 *	INDGETC R[x][Cz], R[w]
+		 */
+		if(keepregs || (i1[1] != i2[2]))
+			return 0;
+		eel_codeABCx(cdr, EEL_OARGINDGETC_ABCx, i2[1], i1[2],
+				EEL_O16(i2, 3));
+		break;
 	  case EEL_MKOPT(EEL_OPHARGI_A, EEL_OPHARGI_A):
 		/*
 		 *	PHARGI args[x]		PHARGI2 args[x], args[y]
@@ -34,6 +34,7 @@
 #include "e_string.h"
 #include "e_object.h"
 #include "e_table.h"
+#include "e_vector.h"
 
 #if DBGH2(1)+0 == 1
 static inline int eel__tk(const char *tkn, int tkc, int line)
@@ -53,6 +54,7 @@ static inline int eel__tk(const char *tkn, int tkc, int line)
 static int expression2(EEL_state *es, int limit, EEL_mlist *al,
 		int wantresult);
 static int expression(EEL_state *es, EEL_mlist *al, int wantresult);
+static int simplexp(EEL_state *es, EEL_mlist *al, int wantresult);
 static int body(EEL_state *es, int flags);
 static void argdeflist(EEL_state *es, EEL_varkinds kind);
 static int block(EEL_state *es);
@@ -147,6 +149,21 @@ static EEL_context *find_context_flags(EEL_state *es, int flags)
 }
 
 
+/*
+ * Find the nearest context with specified flag(s) set, without leaving the
+ * current function. Returns NULL if there is no such context.
+ */
+static EEL_context *find_local_context_flags(EEL_state *es, int flags)
+{
+	EEL_context *ctx;
+	for(ctx = es->context; ctx && (ctx->type != ECTX_FUNCTION);
+			ctx = ctx->previous)
+		if(ctx->flags & flags)
+			return ctx;
+	return NULL;
+}
+
+
 /*
  * Break out of the specified block (NULL = nearest breakable)
  */
@@ -169,7 +186,7 @@ static void code_break(EEL_state *es, EEL_context *ctx)
 	DBGE(printf("Breaking out of context %p\n", ctx);)
 	code_leave_context(es, ctx);
 	jump_out = eel_codesAx(es->context->coder, EEL_OJUMP_sAx, 0);
-	cm = (EEL_codemark *)malloc(sizeof(EEL_codemark));
+	cm = (EEL_codemark *)eel_malloc(es->vm, sizeof(EEL_codemark));
 	if(!cm)
 		eel_ierror(es, "Could not create codemark for 'break' jump!");
 	cm->pos = jump_out;
@@ -207,7 +224,7 @@ FIXME: We could make room for LOOP a instruction and an end jump instead,
 FIXME: to avoid an extra jump when continuing.
 */
 	jump_out = eel_codesAx(es->context->coder, EEL_OJUMP_sAx, 0);
-	cm = (EEL_codemark *)malloc(sizeof(EEL_codemark));
+	cm = (EEL_codemark *)eel_malloc(es->vm, sizeof(EEL_codemark));
 	if(!cm)
 		eel_ierror(es, "Could not create codemark for 'continue' jump!");
 	cm->pos = jump_out;
@@ -234,7 +251,7 @@ static void code_fixup_continuations(EEL_state *es)
 		eel_code_setjump(cdr, cm->pos, pos);
 		eel_e_target(es, cm->xstate);
 		cj_unlink(c, cm);
-		free(cm);
+		eel_free(es->vm, cm);
 	}
 	DBGD(printf("  Done!\n");)
 }
@@ -257,7 +274,7 @@ static void code_fixup_breaks(EEL_state *es)
 		eel_code_setjump(cdr, cm->pos, pos);
 		eel_e_target(es, cm->xstate);
 		ej_unlink(c, cm);
-		free(cm);
+		eel_free(es->vm, cm);
 	}
 	DBGD(printf("  Done!\n");)
 }
@@ -340,11 +357,11 @@ static void forward_exports(EEL_object *from, EEL_object *to, int symcheck)
 					"item with a non-string name!");
 
 		/* Don't forward any special module "private" stuff! */
-		if(k->objref.v == im)
+		if(eel_v2o(k) == im)
 			continue;
-		if(k->objref.v == mn)
+		if(eel_v2o(k) == mn)
 			continue;
-		if(k->objref.v == fn)
+		if(eel_v2o(k) == fn)
 			continue;
 
 		if(symcheck)
@@ -352,7 +369,7 @@ static void forward_exports(EEL_object *from, EEL_object *to, int symcheck)
 			/* Name must not exist in current scope! */
 			eel_finder_init(es, &ef, es->context->symtab,
 					ESTF_NAME | ESTF_TYPES);
-			ef.name = k->objref.v;
+			ef.name = eel_v2o(k);
 			ef.types = EEL_SMFUNCTION;
 			s = eel_finder_go(&ef);
 			if(s)
@@ -369,7 +386,7 @@ static void forward_exports(EEL_object *from, EEL_object *to, int symcheck)
 			}
 		}
 
-		add_export(to, v, eel_o2s(k->objref.v));
+		add_export(to, v, eel_o2s(eel_v2o(k)));
 	}
 	eel_o_disown_nz(im);
 	eel_o_disown_nz(mn);
@@ -503,17 +520,11 @@ static int declare_func(EEL_state *es, const char *name, EEL_mlist *al,
 		EEL_symbol *decl, int flags, const char *symname)
 {
 	EEL_xno x;
-	int pflags;
 	EEL_coder *nc;
 	EEL_object *fo;
 	EEL_function *f;
 	EEL_symbol *st = es->context->symtab;
 
-	if(es->context->coder && es->context->coder->f)
-		pflags = o2EEL_function(es->context->coder->f)->common.flags;
-	else
-		pflags = 0;
-
 	if(decl)
 	{
 		/* Fill in the predeclared function! */
@@ -530,8 +541,8 @@ static int declare_func(EEL_state *es, const char *name, EEL_mlist *al,
 		if(EEL_CLASS(&fov) != EEL_CFUNCTION)
 			eel_ierror(es, "FUNCTION constructor returned %s "
 					"instance!", eel_typename(es->vm,
-					fov.classid));
-		fo = fov.objref.v;
+					EEL_VCLASS(&fov)));
+		fo = eel_v2o(&fov);
 		f = o2EEL_function(fo);
 		f->common.module = es->context->module;
 		add_object_to_module(es, fo);
@@ -545,13 +556,6 @@ static int declare_func(EEL_state *es, const char *name, EEL_mlist *al,
 	if(es->qualifiers & EEL_QEXPORT)
 		f->common.flags |= EEL_FF_EXPORT;
 
-	/*
-	 * If this is an xblock, mark as XBLOCK and inherit
-	 * the parent's RESULTS flag.
-	 */
-	if(flags & EEL_FF_XBLOCK)
-		f->common.flags |= (pflags & EEL_FF_RESULTS);
-
 	/* Move code generation to a local coder for the function */
 	nc = eel_coder_open(es, fo);
 	if(!nc)
@@ -644,8 +648,9 @@ static void declare_func_args(EEL_state *es, int has_result)
 		eel_cerror(es, "Incomplete set of defaults for tuple!");
 	if(f->common.flags & (EEL_FF_OPTDEFAULTS | EEL_FF_TUPDEFAULTS))
 	{
-		int *ad = f->e.argdefaults = malloc((f->common.optargs +
-				f->common.tupargs) * sizeof(int));
+		int *ad = f->e.argdefaults = eel_malloc(es->vm,
+				(f->common.optargs + f->common.tupargs) *
+				sizeof(int));
 		if(!ad)
 			eel_serror(es, "Could not allocate argument defaults "
 					"array!");
@@ -790,9 +795,18 @@ static void do_getvar(EEL_state *es, EEL_symbol *s, EEL_mlist *al)
 	if(uv)
 	{
 		EEL_function *f = o2EEL_function(es->context->coder->f);
+		EEL_symbol *fs;
 		f->common.flags |= EEL_FF_UPVALUES;
-		if((EEL_SVARIABLE == s->type) &&
-				!(f->common.flags & EEL_FF_XBLOCK))
+		/*
+		 * The functions we're nested in, up to the one that owns the
+		 * variable, need their upvalue links for us to get there.
+		 */
+		for(fs = es->context->symtab; fs && (fs->uvlevel > s->uvlevel);
+				fs = fs->parent)
+			if((EEL_SFUNCTION == fs->type) && fs->v.object)
+				o2EEL_function(fs->v.object)->common.flags |=
+						EEL_FF_UPVALUES;
+		if(EEL_SVARIABLE == s->type)
 			eel_cerror(es, "Implicit upvalue '%s'.",
 					eel_o2s(s->name));
 	}
@@ -841,9 +855,8 @@ static void do_index(EEL_state *es, EEL_mlist *obj, EEL_mlist *ind,
  */
 static void v_set_string(EEL_state *es, const char *s, EEL_value *v)
 {
-	v->classid = EEL_COBJREF;
-	v->objref.v = eel_ps_new(es->vm, s);
-	if(!v->objref.v)
+	eel_o2v(v, eel_ps_new(es->vm, s));
+	if(!eel_v2o(v))
 		eel_serror(es, "Could not create string object!");
 }
 
@@ -853,9 +866,8 @@ static void v_set_string(EEL_state *es, const char *s, EEL_value *v)
  */
 static void v_set_string_n(EEL_state *es, const char *s, int len, EEL_value *v)
 {
-	v->classid = EEL_COBJREF;
-	v->objref.v = eel_ps_nnew(es->vm, s, len);
-	if(!v->objref.v)
+	eel_o2v(v, eel_ps_nnew(es->vm, s, len));
+	if(!eel_v2o(v))
 		eel_serror(es, "Could not create string object "
 				"for string literal!");
 }
@@ -1053,12 +1065,34 @@ static int explist(EEL_state *es, EEL_mlist *al, int wantresult)
 	call rule
 ----------------------------------------------------------*/
 
+/*
+ * Returns the number of argument expansions (#arguments, #tuples and #object)
+ * in 'args'. These generate any number of arguments each.
+ */
+static int count_expansions(EEL_mlist *args)
+{
+	int i, n = 0;
+	for(i = 0; i < args->length; ++i)
+		switch(eel_ml_get(args, i)->kind)
+		{
+		  case EEL_MARGS:
+		  case EEL_MTUPARGS:
+		  case EEL_MSPREAD:
+			++n;
+			break;
+		  default:
+			break;
+		}
+	return n;
+}
+
+
 static void call_member(EEL_state *es, EEL_manipulator *fnref,
 		EEL_manipulator *self, EEL_mlist *al, int wantresult)
 {
 	EEL_coder *cdr = es->context->coder;
 	EEL_mlist *args;
-	int r;
+	int r, w, temps;
 
 	/* Generate arguments */
 	args = eel_ml_open(cdr);
@@ -1108,14 +1142,27 @@ static void call_member(EEL_state *es, EEL_manipulator *fnref,
 		printf("=== result and funcref in R[%d]\n", r);
 	else
 		printf("=== funcref in R[%d]\n", r);)
-	eel_ml_push(args);
-	if(wantresult)
-		eel_codeAB(cdr, EEL_OCALLR_AB, r, r);
+	w = eel_ml_window(args, r, &temps);
+	if(w >= 0)
+	{
+		if(wantresult)
+			eel_codeABCD(cdr, EEL_OCALLRWR_ABCD, r, r, w,
+					args->length);
+		else
+			eel_codeABC(cdr, EEL_OCALLRW_ABC, r, w, args->length);
+		if(temps)
+			eel_r_free(cdr, w, temps);
+	}
 	else
 	{
-		eel_codeA(cdr, EEL_OCALL_A, r);
-		eel_r_free(cdr, r, 1);
+		eel_ml_push(args);
+		if(wantresult)
+			eel_codeAB(cdr, EEL_OCALLR_AB, r, r);
+		else
+			eel_codeA(cdr, EEL_OCALL_A, r);
 	}
+	if(!wantresult)
+		eel_r_free(cdr, r, 1);
 
 	/* Cleanup */
 	eel_ml_close(args);
@@ -1145,7 +1192,7 @@ static int call(EEL_state *es, EEL_mlist *al)
 	EEL_value fnref;
 	EEL_symbol *s;
 	EEL_mlist *args;
-	int fnconst, result, uvlevel;
+	int fnconst, result, uvlevel, w, temps, nargs, nexp;
 	if(TK_SYM_FUNCTION != es->token)
 		return TK(WRONG);
 
@@ -1165,8 +1212,7 @@ static int call(EEL_state *es, EEL_mlist *al)
 	printf("%d tuple arguments.\n", f->common.tupargs);
     })
 	/* Find/add a constant for that function */
-	fnref.classid = EEL_COBJREF;
-	fnref.objref.v = fo;
+	eel_o2v(&fnref, fo);
 	fnconst = eel_coder_add_constant(cdr, &fnref);
 	DBGG(printf("=== func const in C[%d]\n", fnconst);)
 	eel_lex(es, 0);
@@ -1193,21 +1239,26 @@ static int call(EEL_state *es, EEL_mlist *al)
 		eel_cerror(es, "Argument generates no value!");
 	}
 
-	/* Check argument count */
-	if(args->length < f->common.reqargs)
+	/*
+	 * Check argument count. With argument expansions, we only know how
+	 * many arguments there are at least.
+	 */
+	nexp = count_expansions(args);
+	nargs = args->length - nexp;
+	if(!nexp && (nargs < f->common.reqargs))
 		eel_cerror(es, "Too few arguments to function '%s'!",
 				eel_o2s(s->name));
 	if(f->common.tupargs)
 	{
-		if((args->length >= f->common.reqargs + f->common.optargs) &&
-				((args->length - f->common.reqargs -
+		if(!nexp && (nargs >= f->common.reqargs + f->common.optargs) &&
+				((nargs - f->common.reqargs -
 				f->common.optargs) % f->common.tupargs))
 			eel_cerror(es, "Incorrect number of arguments"
 					" to function '%s'!"
 					" (Incomplete tuple.)",
 					eel_o2s(s->name));
 	}
-	else if((f->common.optargs != 255) && (args->length >
+	else if((f->common.optargs != 255) && (nargs >
 			f->common.reqargs + f->common.optargs))
 		eel_cerror(es, "Too many arguments to function '%s'!",
 				eel_o2s(s->name));
@@ -1217,20 +1268,56 @@ static int call(EEL_state *es, EEL_mlist *al)
 		result = eel_m_result(al);
 	else
 		result = -1;
-	eel_ml_push(args);
-
-	/* Make the call! */
-	DBGE(printf("=== caller level: %d (%p)\n",
-			es->context->symtab->uvlevel, es->context->symtab);)
-	DBGE(printf("=== function level: %d (%p)\n", s->uvlevel, s);)
-	if(f->common.flags & EEL_FF_UPVALUES)
-		uvlevel = es->context->symtab->uvlevel - s->uvlevel + 1;
+
+	/* C functions can read their arguments from a register window */
+	if(f->common.flags & EEL_FF_CFUNC)
+		w = eel_ml_window(args, result, &temps);
 	else
-		uvlevel = 0;
-	if(result >= 0)
-		eel_codeABCx(cdr, EEL_OCCALLR_ABCx, uvlevel, result, fnconst);
+		w = -1;
+	if(w >= 0)
+	{
+		if(result >= 0)
+			eel_codeABCDx(cdr, EEL_OCCALLRWR_ABCDx, result, w,
+					args->length, fnconst);
+		else
+			eel_codeABCx(cdr, EEL_OCCALLRW_ABCx, w, args->length,
+					fnconst);
+		if(temps)
+			eel_r_free(cdr, w, temps);
+	}
 	else
-		eel_codeABx(cdr, EEL_OCCALL_ABx, uvlevel, fnconst);
+	{
+		eel_ml_push(args);
+
+		/* Make the call! */
+		DBGE(printf("=== caller level: %d (%p)\n",
+				es->context->symtab->uvlevel,
+				es->context->symtab);)
+		DBGE(printf("=== function level: %d (%p)\n", s->uvlevel, s);)
+		if(f->common.flags & EEL_FF_UPVALUES)
+			uvlevel = es->context->symtab->uvlevel - s->uvlevel + 1;
+		else
+			uvlevel = 0;
+		if(nexp && !uvlevel)
+		{
+			/*
+			 * The argument count can only be checked at run time,
+			 * so we make an indirect call, as those are checked.
+			 */
+			int fr = eel_r_alloc(cdr, 1, EEL_RUTEMPORARY);
+			eel_codeABx(cdr, EEL_OLDC_ABx, fr, fnconst);
+			if(result >= 0)
+				eel_codeAB(cdr, EEL_OCALLR_AB, fr, result);
+			else
+				eel_codeA(cdr, EEL_OCALL_A, fr);
+			eel_r_free(cdr, fr, 1);
+		}
+		else if(result >= 0)
+			eel_codeABCx(cdr, EEL_OCCALLR_ABCx, uvlevel, result,
+					fnconst);
+		else
+			eel_codeABx(cdr, EEL_OCCALL_ABx, uvlevel, fnconst);
+	}
 
 	/* Cleanup */
 	eel_ml_close(args);
@@ -1544,8 +1631,7 @@ static int funcdef(EEL_state *es, EEL_mlist *al, int local)
 	if(es->token == ')')
 	{
 		EEL_value v;
-		v.classid = EEL_CCLASSID;
-		v.integer.v = EEL_CFUNCTION;
+		eel_i2v(&v, EEL_CCLASSID, EEL_CFUNCTION);
 		eel_m_constant(al, &v);
 		return TK(SIMPLEXP);
 	}
@@ -1566,48 +1652,45 @@ static int funcdef(EEL_state *es, EEL_mlist *al, int local)
 ----------------------------------------------------------*/
 /*
 	xblock:
-		block
+		statement
 		;
 */
-static void xblock(EEL_state *es, const char *basename, EEL_mlist *al,
-		int flags)
+/*
+ * 'try', 'untry' and 'except' blocks are compiled inline, in contexts of their
+ * own. The VM finds them through the region table of the function when an
+ * exception is thrown, so entering a block costs nothing.
+ *
+ * 'start' is the start of the 'try' block, which is where 'retry' jumps to.
+ * The context is left on the stack, for the caller to add code to and pop.
+ */
+static void xblock(EEL_state *es, const char *basename, int flags,
+		int start, int xreg)
 {
-	char *name = eel_unique(es->vm, basename);
-	eel_context_push(es, ECTX_FUNCTION | flags, NULL);
-	declare_func(es, name, al, NULL, EEL_FF_XBLOCK, NULL);
-	eel_sfree(es, name);
+	char *n = eel_unique(es->vm, basename);
+	eel_context_push(es, ECTX_BODY | ECTX_CONDITIONAL | flags, n);
+	eel_sfree(es, n);
+	es->context->startpos = start;
 
-	/*
-	 * Catchers use R[0] for 'exception' - and that needs cleaning!
-	 * Try blocks don't need R[0] at all.
-	 */
+	/* The VM puts the exception in 'xreg' before entering the catcher */
 	if(flags & ECTX_CATCHER)
-		eel_r_alloc_reg(es->context->coder, 0, EEL_RUVARIABLE);
-
-	if(!(flags & ECTX_DUMMY))
-		/* Compile function body */
-		switch(statement(es, ECTX_FUNCTION))
-		{
-		  case TK_STATEMENT:
-			break;
-		  case TK_VOID:
-			eel_cwarning(es, "Empty exception handling block.");
-			break;
-		  default:
-			eel_cerror(es, "Expected exception handling "
-					"statement or body!");
-		}
-
-	eel_code0(es->context->coder, EEL_ORETURN_0);
-
-	eel_context_pop(es);
+	{
+		es->context->xreg = xreg;
+		eel_e_init_reg(es, xreg);
+	}
 
-	if(!(flags & ECTX_DUMMY))
+	switch(statement(es, 0))
 	{
-		/* The token was lexed in the function's context. Re-lex! */
-		eel_unlex(es);
-		eel_lex(es, 0);
+	  case TK_STATEMENT:
+	  case TK_EMPTY:
+		break;
+	  case TK_VOID:
+		eel_cwarning(es, "Empty exception handling block.");
+		break;
+	  default:
+		eel_cerror(es, "Expected exception handling "
+				"statement or body!");
 	}
+	code_leave_context(es, es->context);
 }
 
 
@@ -1926,7 +2009,7 @@ static int tablector(EEL_state *es, EEL_mlist *al, int terminator)
 		else if(funcdef(es, inits, 1) != TK_WRONG)
 		{
 			EEL_manipulator *fm = eel_ml_get(inits, -1);
-			EEL_object *fo = fm->v.constant.v.objref.v;
+			EEL_object *fo = eel_v2o(&fm->v.constant.v);
 			EEL_function *f = o2EEL_function(fo);
 			eel_m_object(inits, f->common.name);
 			eel_m_transfer(fm, inits);	/* Move last! */
@@ -2091,6 +2174,7 @@ static int ctor(EEL_state *es, EEL_mlist *al)
 		| KW_EXCEPTION
 		| '#' KW_ARGUMENTS
 		| '#' KW_TUPLES
+		| '#' simplexp
 		| '(' explist ')'
 		| '(' TYPENAME ')' simplexp
 		| call
@@ -2117,16 +2201,14 @@ static int simplexp2(EEL_state *es, EEL_mlist *al, int wantresult)
 	{
 	  case TK_INUM:
 		no_qualifiers(es);
-		v.classid = EEL_CINTEGER;
-		v.integer.v = es->lval.v.i;
+		eel_l2v(&v, es->lval.v.i);
 		eel_m_constant(al, &v);
 		eel_lex(es, 0);
 		return TK(SIMPLEXP);
 
 	  case TK_RNUM:
 		no_qualifiers(es);
-		v.classid = EEL_CREAL;
-		v.real.v = es->lval.v.r;
+		eel_d2v(&v, es->lval.v.r);
 		eel_m_constant(al, &v);
 		eel_lex(es, 0);
 		return TK(SIMPLEXP);
@@ -2142,15 +2224,13 @@ static int simplexp2(EEL_state *es, EEL_mlist *al, int wantresult)
 		{
 		  case TK_INUM:
 			no_qualifiers(es);
-			v.classid = EEL_CINTEGER;
-			v.integer.v = -es->lval.v.i;
+			eel_l2v(&v, -es->lval.v.i);
 			eel_m_constant(al, &v);
 			eel_lex(es, 0);
 			return TK(SIMPLEXP);
 		  case TK_RNUM:
 			no_qualifiers(es);
-			v.classid = EEL_CREAL;
-			v.real.v = -es->lval.v.r;
+			eel_d2v(&v, -es->lval.v.r);
 			eel_m_constant(al, &v);
 			eel_lex(es, 0);
 			return TK(SIMPLEXP);
@@ -2161,23 +2241,21 @@ static int simplexp2(EEL_state *es, EEL_mlist *al, int wantresult)
 
 	  case TK_KW_TRUE:
 		no_qualifiers(es);
-		v.classid = EEL_CBOOLEAN;
-		v.integer.v = 1;
+		eel_b2v(&v, 1);
 		eel_m_constant(al, &v);
 		eel_lex(es, 0);
 		return TK(SIMPLEXP);
 
 	  case TK_KW_FALSE:
 		no_qualifiers(es);
-		v.classid = EEL_CBOOLEAN;
-		v.integer.v = 0;
+		eel_b2v(&v, 0);
 		eel_m_constant(al, &v);
 		eel_lex(es, 0);
 		return TK(SIMPLEXP);
 
 	  case TK_KW_NIL:
 		no_qualifiers(es);
-		v.classid = EEL_CNIL;
+		eel_nil2v(&v);
 		eel_m_constant(al, &v);
 		eel_lex(es, 0);
 		return TK(SIMPLEXP);
@@ -2210,13 +2288,11 @@ static int simplexp2(EEL_state *es, EEL_mlist *al, int wantresult)
 
 	  case TK_KW_EXCEPTION:
 	  {
-		EEL_context *fctx = eel_find_function_context(es->context);
-		if(!fctx)
-			eel_ierror(es, "'exception' outside function context!?");
-		if(!(fctx->flags & ECTX_CATCHER))
+		EEL_context *xctx = find_local_context_flags(es, ECTX_CATCHER);
+		if(!xctx)
 			eel_cerror(es, "'exception' used outside 'except' block!");
 		no_qualifiers(es);
-		eel_m_register(al, 0);
+		eel_m_register(al, xctx->xreg);
 		eel_lex(es, 0);
 		return TK(SIMPLEXP);
 	  }
@@ -2239,7 +2315,34 @@ static int simplexp2(EEL_state *es, EEL_mlist *al, int wantresult)
 			eel_lex(es, 0);
 			return TK(SIMPLEXP);
 		  default:
-			eel_cerror(es, "Invalid argument expansion expression!");
+		  {
+			/* Items of an indexable object, or a range of them */
+			EEL_mlist *sub = eel_ml_open(cdr);
+			if(TK_WRONG == simplexp(es, sub, 1))
+				eel_cerror(es, "Invalid argument expansion "
+						"expression!");
+			switch(sub->length)
+			{
+			  case 1:
+				eel_m_spread(al, eel_ml_get(sub, 0), NULL, NULL);
+				break;
+			  case 2:
+				eel_m_spread(al, eel_ml_get(sub, 0),
+						eel_ml_get(sub, 1), NULL);
+				break;
+			  case 3:
+				eel_m_spread(al, eel_ml_get(sub, 0),
+						eel_ml_get(sub, 1),
+						eel_ml_get(sub, 2));
+				break;
+			  default:
+				eel_cerror(es, "Expected '#object', "
+						"'#(object, first)' or "
+						"'#(object, first, count)'!");
+			}
+			eel_ml_close(sub);
+			return TK(SIMPLEXP);
+		  }
 		}
 	  }
 
@@ -2261,11 +2364,11 @@ static int simplexp2(EEL_state *es, EEL_mlist *al, int wantresult)
 		else
 			lastm = NULL;
 		if(lastm && (EEL_MCONSTANT == lastm->kind) &&
-				(lastm->v.constant.v.classid == EEL_CCLASSID) &&
-				(lastm->v.constant.v.integer.v != EEL_CFUNCTION))
+				(EEL_VCLASS(&lastm->v.constant.v) == EEL_CCLASSID) &&
+				(EEL_VINT(&lastm->v.constant.v) != EEL_CFUNCTION))
 		{
 			int i;
-			EEL_classes cid = lastm->v.constant.v.integer.v;
+			EEL_classes cid = EEL_VINT(&lastm->v.constant.v);
 			EEL_mlist *src = eel_ml_open(cdr);
 			/* FIXME: Temporary operator precedence disabler! */
 			if(TK_WRONG == expression2(es,
@@ -2307,8 +2410,7 @@ static int simplexp2(EEL_state *es, EEL_mlist *al, int wantresult)
 	/* TYPENAME */
 	if(es->token == TK_SYM_CLASS)
 	{
-		v.classid = EEL_CCLASSID;
-		v.integer.v = eel_class_cid(es->lval.v.symbol->v.object);
+		eel_i2v(&v, EEL_CCLASSID, eel_class_cid(es->lval.v.symbol->v.object));
 		eel_m_constant(al, &v);
 		eel_lex(es, 0);
 		return TK(SIMPLEXP);
@@ -3290,6 +3392,74 @@ static void caselist(EEL_state *es, EEL_object *jtab)
 	}
 }
 
+#ifdef EEL_SWITCH_DENSITY
+/*
+ * If the case values in 'jtab' (constant 'jtabc') are all integers, or all
+ * type IDs, and they're dense enough, replace the table with a flat jump
+ * table, and change the SWITCH instruction at 'pos' into a SWITCHD. Values
+ * without a case inside the range of the table jump to 'deftarget'.
+ *
+ * Flat jump table layout (vector_s32):
+ *	[0]	Class ID of the case values
+ *	[1]	Lowest case value
+ *	[2...]	Target PCs for all values from the lowest to the highest
+ */
+static void switch_dense(EEL_state *es, EEL_object *jtab, int jtabc, int pos,
+		int deftarget)
+{
+	int i;
+	EEL_value v;
+	EEL_object *jo;
+	EEL_int32 *jt;
+	EEL_classes cid;
+	EEL_integer min, max;
+	EEL_uint32 span, maxspan;
+	EEL_coder *cdr = es->context->coder;
+	EEL_table *t = o2EEL_table(jtab);
+	if(!t->length)
+		return;
+	cid = EEL_VCLASS(&t->items[0].key);
+	if((cid != EEL_CINTEGER) && (cid != EEL_CCLASSID))
+		return;
+	min = max = EEL_VINT(&t->items[0].key);
+	for(i = 1; i < t->length; ++i)
+	{
+		EEL_value *k = &t->items[i].key;
+		if(EEL_VCLASS(k) != cid)
+			return;
+		if(EEL_VINT(k) < min)
+			min = EEL_VINT(k);
+		else if(EEL_VINT(k) > max)
+			max = EEL_VINT(k);
+	}
+
+	/* 'span' is the table size - 1, so we don't overflow */
+	span = (EEL_uint32)max - (EEL_uint32)min;
+	maxspan = t->length * EEL_SWITCH_DENSITY;
+	if(maxspan < EEL_SWITCH_DENSE_MIN)
+		maxspan = EEL_SWITCH_DENSE_MIN;
+	if(span >= maxspan)
+		return;
+
+	jo = eel_cv_new_noinit(es->vm, EEL_CVECTOR_S32, span + 3);
+	if(!jo)
+		eel_ierror(es, "Could not create switch() jump table!");
+	jt = o2EEL_vector(jo)->buffer.s32;
+	jt[0] = cid;
+	jt[1] = min;
+	for(i = 0; i <= (int)span; ++i)
+		jt[2 + i] = deftarget;
+	for(i = 0; i < t->length; ++i)
+		jt[2 + (EEL_uint32)EEL_VINT(&t->items[i].key) -
+				(EEL_uint32)min] = EEL_VINT(&t->items[i].value);
+
+	eel_o2v(&v, jo);
+	eel_coder_set_constant(cdr, jtabc, &v);
+	eel_o_disown_nz(jo);
+	eel_code_setop(cdr, pos, EEL_OSWITCHD_ABxsCx);
+}
+#endif
+
 /*
 	switchstat:
 		  KW_SWITCH expression caselist
@@ -3299,7 +3469,7 @@ static void caselist(EEL_state *es, EEL_object *jtab)
 static int switchstat(EEL_state *es)
 {
 	EEL_mlist *expr;
-	int jump_else, r, jtabc;
+	int jump_else, r, jtabc, pos;
 	char *n;
 	EEL_object *jtab;
 	EEL_coder *cdr = es->context->coder;
@@ -3329,7 +3499,7 @@ static int switchstat(EEL_state *es)
 	x = eel_o_construct(es->vm, EEL_CTABLE, NULL, 0, &v);
 	if(x)
 		eel_ierror(es, "Could not construct switch() jump table!");
-	jtab = v.objref.v;
+	jtab = eel_v2o(&v);
 	jtabc = eel_coder_add_constant(cdr, &v);
 	eel_o_disown(&jtab);
 
@@ -3362,7 +3532,11 @@ static int switchstat(EEL_state *es)
 	caselist(es, jtab);
 
 	/* default section? */
-	eel_code_setjump(cdr, jump_else, eel_code_target(cdr));
+	pos = eel_code_target(cdr);
+	eel_code_setjump(cdr, jump_else, pos);
+#ifdef EEL_SWITCH_DENSITY
+	switch_dense(es, jtab, jtabc, jump_else, pos);
+#endif
 	if(es->token == TK_KW_DEFAULT)
 	{
 		eel_lex(es, 0);
@@ -3612,7 +3786,7 @@ static int forstat(EEL_state *es)
 	EEL_mlist *iter, *params;
 	EEL_coder *cdr = es->context->coder;
 	int preloop, loopstart, loopjump;
-	int i, limit, incr;
+	int i, limit, incr, intloop;
 	if(TK_KW_FOR != es->token)
 		return TK(WRONG);
 	eel_lex(es, 0);
@@ -3646,6 +3820,15 @@ static int forstat(EEL_state *es)
 	if((params->length < 2) || (params->length > 3))
 		eel_cerror(es, "'for' needs 2 or 3 parameters!");
 
+	/*
+	 * Integer start, limit and step (the default step of 1 is integer)
+	 * mean we can use the integer loop instructions.
+	 */
+	intloop = eel_m_is_integer(eel_ml_get(params, 0)) &&
+			eel_m_is_integer(eel_ml_get(params, 1)) &&
+			((params->length < 3) ||
+			eel_m_is_integer(eel_ml_get(params, 2)));
+
 	/* Initialize the iteration variable */
 	eel_m_copy(eel_ml_get(params, 0), eel_ml_get(iter, 0));
 	i = eel_m_direct_read(eel_ml_get(iter, 0));
@@ -3662,7 +3845,8 @@ static int forstat(EEL_state *es)
 		eel_codeAsBx(cdr, EEL_OLDI_AsBx, incr, 1);
 
 	/* Cast values and handle the "end is before start" case */
-	preloop = eel_codeABCsDx(cdr, EEL_OPRELOOP_ABCsDx, i, incr, limit, 0);
+	preloop = eel_codeABCsDx(cdr, intloop ? EEL_OIPRELOOP_ABCsDx :
+			EEL_OPRELOOP_ABCsDx, i, incr, limit, 0);
 
 	/* Grab the loop start point! */
 	loopstart = eel_code_target(cdr);
@@ -3686,7 +3870,8 @@ static int forstat(EEL_state *es)
 	code_fixup_continuations(es);
 
 	/* Update the iteration variable, test and (maybe) loop */
-	loopjump = eel_codeABCsDx(cdr, EEL_OLOOP_ABCsDx, i, incr, limit, 0);
+	loopjump = eel_codeABCsDx(cdr, intloop ? EEL_OILOOP_ABCsDx :
+			EEL_OLOOP_ABCsDx, i, incr, limit, 0);
 	eel_code_setjump(cdr, loopjump, loopstart);
 	eel_code_setjump(cdr, preloop, eel_code_target(cdr));
 
@@ -3825,6 +4010,47 @@ static int repeatstat(EEL_state *es)
 /*----------------------------------------------------------
 	returnstat rule
 ----------------------------------------------------------*/
+/*
+ * If the last instruction coded is a CALLR, CCALLR or CALLRWR with the result
+ * in R[r], turn it into the corresponding tail call instruction. The RETURNR
+ * R[r] that should follow is left in place, for when the VM cannot do a tail
+ * call.
+ */
+static void code_tail_call(EEL_state *es, int r)
+{
+	EEL_coder *cdr = es->context->coder;
+	EEL_function *f = o2EEL_function(cdr->f);
+	unsigned char *ins;
+	int pc, last = -1;
+	if(eel_test_exit(es) == EEL_EYES)
+		return;		/* Dead code! */
+	if(find_local_context_flags(es, ECTX_TRY))
+		return;		/* The frame is needed for catching exceptions */
+	for(pc = cdr->fragstart; pc < f->e.codesize;
+			pc += eel_i_size(f->e.code[pc]))
+		last = pc;
+	if(last < 0)
+		return;
+	ins = f->e.code + last;
+	switch((EEL_opcodes)ins[0])
+	{
+	  case EEL_OCALLR_AB:
+		if(ins[2] == r)
+			eel_code_setop(cdr, last, EEL_OTAILCALL_AB);
+		break;
+	  case EEL_OCCALLR_ABCx:
+		if(ins[2] == r)
+			eel_code_setop(cdr, last, EEL_OCTAILCALL_ABCx);
+		break;
+	  case EEL_OCALLRWR_ABCD:
+		if(ins[2] == r)
+			eel_code_setop(cdr, last, EEL_OTAILCALLRW_ABCD);
+		break;
+	  default:
+		break;
+	}
+}
+
 /*
 	returnstat:
 		  KW_RETURN ';'
@@ -3877,10 +4103,8 @@ static int returnstat(EEL_state *es)
 			r = eel_r_alloc(cdr, 1, EEL_RUTEMPORARY);
 			eel_m_read(m, r);
 		}
-		if(flags & EEL_FF_XBLOCK)
-			eel_codeA(cdr, EEL_ORETXR_A, r);
-		else
-			eel_codeA(cdr, EEL_ORETURNR_A, r);
+		code_tail_call(es, r);
+		eel_codeA(cdr, EEL_ORETURNR_A, r);
 		eel_e_result(es);
 		eel_e_return(es);
 		expect(es, ';', "Expected ';' after 'return' statement!");
@@ -3889,10 +4113,7 @@ static int returnstat(EEL_state *es)
 	{
 		if((rres != TK_VOID) && result->length)
 			eel_cerror(es, "A procedure cannot return a value!");
-		if(flags & EEL_FF_XBLOCK)
-			eel_code0(es->context->coder, EEL_ORETX_0);
-		else
-			eel_code0(es->context->coder, EEL_ORETURN_0);
+		eel_code0(es->context->coder, EEL_ORETURN_0);
 		eel_e_return(es);
 		expect(es, ';', "Expected ';' after procedure return statement.");
 	}
@@ -3912,8 +4133,7 @@ static int returnstat(EEL_state *es)
 */
 static int trystat(EEL_state *es)
 {
-	int tf, xf;
-	EEL_mlist *fl;
+	int start, handler, clean, jump_out, xreg;
 	EEL_coder *cdr = es->context->coder;
 	if(TK_KW_TRY != es->token)
 		return TK(WRONG);
@@ -3921,45 +4141,49 @@ static int trystat(EEL_state *es)
 	DBGH(printf("## trystat\n");)
 	eel_lex(es, 0);
 
-	fl = eel_ml_open(cdr);
-	xblock(es, "__try", fl, 0);
-	tf = eel_m_prepare_constant(eel_ml_get(fl, 0));
-
+	/* 'try' block */
+	clean = eel_initializations(es->context);
+	start = eel_code_target(cdr);
+	xblock(es, "__try", ECTX_TRY, start, -1);
 	if(TK_KW_EXCEPT == es->token)
-	{
-		eel_lex(es, 0);
-		xblock(es, "__except", fl, ECTX_CATCHER);
-		xf = eel_m_prepare_constant(eel_ml_get(fl, 1));
-	}
+		jump_out = eel_codesAx(cdr, EEL_OJUMP_sAx, 0);
 	else
+		jump_out = -1;
+	eel_context_pop(es);
+	handler = eel_code_target(cdr);
+
+	if(TK_KW_EXCEPT != es->token)
 	{
-		xblock(es, "__except", fl, ECTX_CATCHER | ECTX_DUMMY);
-		xf = eel_m_prepare_constant(eel_ml_get(fl, 1));
+		/* No 'except' block; just drop the exception */
+		if(handler > start)
+			eel_coder_add_xregion(cdr, start, handler, handler,
+					clean, -1);
+		eel_e_merge(es->context, EEL_EMAYBE);
+		eel_initializations(es->context);
+		return TK(STATEMENT);
 	}
 
 	/*
-	 * Must code this before merging the events!
-	 * It actually belongs *before* the bodies,
-	 * but it's easier getting the operands into
-	 * the TRY instruction this way.
+	 * 'except' block. Regions must be added innermost first, so this one
+	 * goes in before any 'try' statements inside the 'except' block.
 	 */
-	eel_codeAxBx(cdr, EEL_OTRY_AxBx, xf, tf);
-
-	eel_ml_close(fl);
+	eel_lex(es, 0);
+	xreg = eel_r_alloc(cdr, 1, EEL_RUVARIABLE);
+	if(handler > start)
+		eel_coder_add_xregion(cdr, start, handler, handler, clean, xreg);
+	xblock(es, "__except", ECTX_CATCHER, start, xreg);
+	eel_context_pop(es);
+	eel_r_free(cdr, xreg, 1);
+	eel_code_setjump(cdr, jump_out, eel_code_target(cdr));
 
 	/*
 	 * Note that since exceptions can abort the 'try'
-	 * block at any time (*), most events are useless!
-	 * All we care about is the single case where both
-	 * blocks definitely end by throwing exceptions.
-	 *
-	 * (*) An exception can abort anything at any time,
-	 *     but it doesn't matter - unless we prevent
-	 *     exceptions from aborting the function, which
-	 *     is exactly what we're doing here!
+	 * block at any time, most events are useless!
+	 * All we care about is the case where both
+	 * blocks definitely end the same way.
 	 */
 	eel_e_merge(es->context, EEL_EYES);
-
+	eel_initializations(es->context);
 	return TK(STATEMENT);
 }
 
@@ -3974,8 +4198,7 @@ static int trystat(EEL_state *es)
 */
 static int untrystat(EEL_state *es)
 {
-	int tf;
-	EEL_mlist *fl;
+	int start, end, clean;
 	EEL_coder *cdr = es->context->coder;
 	if(TK_KW_UNTRY != es->token)
 		return TK(WRONG);
@@ -3983,16 +4206,16 @@ static int untrystat(EEL_state *es)
 	DBGH(printf("## untrystat\n");)
 	eel_lex(es, 0);
 
-	fl = eel_ml_open(cdr);
-	xblock(es, "__untry", fl, 0);
-	tf = eel_m_prepare_constant(eel_ml_get(fl, 0));
-
-	eel_codeAx(cdr, EEL_OUNTRY_Ax, tf);
-
-	eel_ml_close(fl);
+	/* A region without a handler stops the search for one */
+	clean = eel_initializations(es->context);
+	start = eel_code_target(cdr);
+	xblock(es, "__untry", ECTX_TRY, start, -1);
+	eel_context_pop(es);
+	end = eel_code_target(cdr);
+	if(end > start)
+		eel_coder_add_xregion(cdr, start, end, -1, clean, -1);
 
 	eel_e_merge(es->context, EEL_EYES);
-
 	return TK(STATEMENT);
 }
 
@@ -4030,6 +4253,7 @@ TODO:		| KW_ALWAYS ':'
 		| importstat
 		| throwstat
 		| retrystat
+		| yieldstat
 		| ifstat
 		| switchstat
 		| whilestat
@@ -4161,18 +4385,61 @@ static int statement2(EEL_state *es)
 			eel_r_free(cdr, r, 1);
 		}
 		eel_ml_close(al);
-		eel_e_return(es); /* Remember, 'try' blocks are functions! */
-		eel_e_result(es); /* Not quite true, but equivalent. */
+		eel_e_return(es); /* Not quite true, but equivalent. */
+		eel_e_result(es);
 		expect(es, ';', NULL);
 		return TK(STATEMENT);
 	  }
 
 	  /* retrystat */
 	  case TK_KW_RETRY:
+	  {
+		EEL_context *xctx = find_local_context_flags(es, ECTX_CATCHER);
+		if(!xctx)
+			eel_cerror(es, "'retry' used outside 'except' block!");
 		eel_lex(es, 0);
-		eel_code0(es->context->coder, EEL_ORETRY_0);
+		code_repeat(es, xctx);
 		expect(es, ';', NULL);
 		return TK(STATEMENT);
+	  }
+
+	  /* yieldstat */
+	  case TK_KW_YIELD:
+	  {
+		int r;
+		EEL_coder *cdr = es->context->coder;
+		EEL_mlist *al = eel_ml_open(cdr);
+		eel_lex(es, 0);
+		if(es->token == ';')
+		{
+			/* Plain 'yield;' yields nil */
+			r = eel_r_alloc(cdr, 1, EEL_RUTEMPORARY);
+			eel_codeA(cdr, EEL_OLDNIL_A, r);
+			eel_codeA(cdr, EEL_OYIELD_A, r);
+			eel_r_free(cdr, r, 1);
+		}
+		else
+		{
+			EEL_manipulator *m;
+			if(TK_WRONG == expression(es, al, 1) ||
+					(al->length != 1))
+				eel_cerror(es, "Expected a value to yield!");
+			m = eel_ml_get(al, 0);
+			r = eel_m_direct_read(m);
+			if(r >= 0)
+				eel_codeA(cdr, EEL_OYIELD_A, r);
+			else
+			{
+				r = eel_r_alloc(cdr, 1, EEL_RUTEMPORARY);
+				eel_m_read(m, r);
+				eel_codeA(cdr, EEL_OYIELD_A, r);
+				eel_r_free(cdr, r, 1);
+			}
+		}
+		eel_ml_close(al);
+		expect(es, ';', NULL);
+		return TK(STATEMENT);
+	  }
 	}
 
 	if((importstat(es) != TK_WRONG) ||
@@ -4305,8 +4572,7 @@ static void init_exports(EEL_state *es, EEL_object *mo)
 	eel_finder_init(es, &ef, es->context->symtab, ESTF_TYPES);
 	ef.types = EEL_SMFUNCTION;
 	DBGX2(printf(".-------------------------------------------------------------\n");)
-	xv.classid = EEL_COBJREF;
-	xv.objref.v = es->context->coder->f;
+	eel_o2v(&xv, es->context->coder->f);
 	add_export(mo, &xv, "__init_module");
 	DBGX2(printf("| Added root function to module '%s' exports.\n",
 			eel_module_modname(mo));)
@@ -4317,7 +4583,7 @@ static void init_exports(EEL_state *es, EEL_object *mo)
 			continue;	/* Only exported functions! */
 		if(f->common.module != mo)
 			continue;	/* Don't let imports leak through! */
-		xv.objref.v = s->v.object;
+		eel_o2v(&xv, s->v.object);
 		add_export(mo, &xv, eel_o2s(s->name));
 	}
 	DBGX2(printf("'-------------------------------------------------------------\n");)
@@ -4491,12 +4757,12 @@ void eel_compile(EEL_state *es, EEL_object *mo, EEL_sflags sflags)
 			eel_cerror(es, "Circular module import detected!\n"
 					"Tried to compile module \"%s\", "
 					"which is already being compiled.",
-					eel_o2s(filename.objref.v));
-		v.classid = EEL_CNIL;
+					eel_o2s(eel_v2o(&filename)));
+		eel_nil2v(&v);
 		eel_table_set(es->modnames, &filename, &v);
 	}
 	else
-		filename.classid = EEL_CNIL;
+		eel_nil2v(&filename);
 
 	es->include_depth = 0;
 /* FIXME: 'x' might be clobbered by setjmp()/longjmp()... */
@@ -4507,7 +4773,7 @@ void eel_compile(EEL_state *es, EEL_object *mo, EEL_sflags sflags)
 		x = 1;
 
 	es->include_depth = include_depth_save;
-	if(filename.classid != EEL_CNIL)
+	if(EEL_VCLASS(&filename) != EEL_CNIL)
 		eel_table_delete(es->modnames, &filename);
 
 	/* Turn warnings into errors */
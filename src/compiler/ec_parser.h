@@ -130,11 +130,11 @@ typedef enum
  */
 #define	ECTX_ROOT		0x00000200
 
-/* Context is an exception catcher function; ie an 'except' block. */
+/* Context is an exception catcher; ie an 'except' block. */
 #define	ECTX_CATCHER		0x00000400
 
-/* No explicit code is to be parsed in this context. */
-#define	ECTX_DUMMY		0x00000800
+/* Context is a 'try' or 'untry' block. */
+#define	ECTX_TRY		0x00000800
 
 /* Context is wrapped in {} or equivalent; ie is a 'body'. */
 #define	ECTX_WRAPPED		0x00001000
@@ -182,6 +182,9 @@ struct EEL_context
 	EEL_codemark	*endjumps, *lastej;	/* Jumps to end of context */
 	EEL_codemark	*contjumps, *lastcj;	/* Jumps to loop test */
 
+	/* 'except' blocks: startpos is the start of the 'try' block */
+	int		xreg;			/* Register of 'exception' */
+
 	/* Misc. */
 	EEL_ctxtypes	type;
 	unsigned	flags;
@@ -259,7 +259,7 @@ static int get_export(EEL_symbol *st, EEL_object *n, EEL_value *v,
 			return -1;
 		s->name = n;
 		eel_o_own(s->name);
-		s->v.object = v->objref.v;
+		s->v.object = eel_v2o(v);
 		eel_o_own(s->v.object);
 		break;
 	  case EEL_CCLASS:
@@ -268,7 +268,7 @@ static int get_export(EEL_symbol *st, EEL_object *n, EEL_value *v,
 			return -1;
 		s->name = n;
 		eel_o_own(s->name);
-		s->v.object = v->objref.v;
+		s->v.object = eel_v2o(v);
 		eel_o_own(s->v.object);
 		break;
 	  default:
@@ -322,12 +322,12 @@ int eel_s_get_exports(EEL_symbol *st, EEL_object *m)
 		}
 
 		/* Don't import anything named "__module_init"! */
-		if(k->objref.v == im)
+		if(eel_v2o(k) == im)
 			continue;
 
 		/* Name must not exist in current scope! */
 		eel_finder_init(es, &ef, st, ESTF_NAME | ESTF_TYPES);
-		ef.name = k->objref.v;
+		ef.name = eel_v2o(k);
 		ef.types = EEL_SMFUNCTION;
 		s = eel_finder_go(&ef);
 		if(s)
@@ -341,7 +341,7 @@ int eel_s_get_exports(EEL_symbol *st, EEL_object *m)
 					eel_module_filename(m));
 		}
 
-		if(get_export(st, k->objref.v, v, m) < 0)
+		if(get_export(st, eel_v2o(k), v, m) < 0)
 		{
 			eel_o_disown_nz(im);
 			return -1;
@@ -53,8 +53,8 @@ static inline int a_setsize(EEL_object *eo, int newsize)
 		int i;
 		int min = a->length < n ? a->length : n;
 		for(i = 0; i < min; ++i)
-			if(nv[i].classid == EEL_CWEAKREF)
-				eel_weakref_relocate(&nv[i]);
+			if(EEL_VCLASS(&nv[i]) == EEL_CWEAKREF)
+				eel_weakref_relocate(&nv[i], a->values + i);
 		a->values = nv;
 	}
 	a->maxlength = n;
@@ -103,9 +103,8 @@ static EEL_xno a_destruct(EEL_object *eo)
 {
 	EEL_array *a = o2EEL_array(eo);
 	int i;
-/*
-FIXME: If there are "many" items, any objects should be sent off to incremental cleanup!
-*/
+	if(eel_defer(eo->vm, EEL_CARRAY, a->values, a->length))
+		return 0;
 	for(i = 0; i < a->length; ++i)
 		eel_v_disown_nz(&a->values[i]);
 	eel_free(eo->vm, a->values);
@@ -119,15 +118,15 @@ static EEL_xno a_getindex(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	int i;
 
 	/* Cast index to int */
-	switch(op1->classid)
+	switch(EEL_VCLASS(op1))
 	{
 	  case EEL_CBOOLEAN:
 	  case EEL_CINTEGER:
 	  case EEL_CCLASSID:
-		i = op1->integer.v;
+		i = EEL_VINT(op1);
 		break;
 	  case EEL_CREAL:
-		i = floor(op1->real.v);
+		i = floor(EEL_VREAL(op1));
 		break;
 	  default:
 		return EEL_XWRONGTYPE;
@@ -173,15 +172,15 @@ static inline EEL_xno a_set_index(EEL_object *eo, int i, EEL_value *op2)
 static EEL_xno a_setindex(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
 	int i;
-	switch(op1->classid)
+	switch(EEL_VCLASS(op1))
 	{
 	  case EEL_CBOOLEAN:
 	  case EEL_CINTEGER:
 	  case EEL_CCLASSID:
-		i = op1->integer.v;
+		i = EEL_VINT(op1);
 		break;
 	  case EEL_CREAL:
-		i = floor(op1->real.v);
+		i = floor(EEL_VREAL(op1));
 		break;
 	  default:
 		return EEL_XWRONGTYPE;
@@ -196,15 +195,15 @@ static EEL_xno a_insert(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
 	EEL_array *a = o2EEL_array(eo);
 	int i, mv;
-	switch(op1->classid)
+	switch(EEL_VCLASS(op1))
 	{
 	  case EEL_CBOOLEAN:
 	  case EEL_CINTEGER:
 	  case EEL_CCLASSID:
-		i = op1->integer.v;
+		i = EEL_VINT(op1);
 		break;
 	  case EEL_CREAL:
-		i = floor(op1->real.v);
+		i = floor(EEL_VREAL(op1));
 		break;
 	  default:
 		return EEL_XWRONGTYPE;
@@ -231,11 +230,11 @@ static EEL_xno a_delete(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
 	EEL_array *a = o2EEL_array(eo);
 	int i0, i1, i;
-	if(op1 && EEL_IS_OBJREF(op1->classid))
+	if(op1 && EEL_IS_OBJREF(EEL_VCLASS(op1)))
 	{
 		i0 = -1;
 		for(i = 0; i < a->length; ++i)
-			if(a->values[i].objref.v == op1->objref.v)
+			if(eel_v2o(&a->values[i]) == eel_v2o(op1))
 			{
 				i0 = i1 = i;
 				break;
@@ -286,7 +285,7 @@ static inline EEL_object *a__clone(EEL_object *orig)
 static EEL_xno a_clone(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 {
-	EEL_object *no = a__clone(src->objref.v);
+	EEL_object *no = a__clone(eel_v2o(src));
 	if(!no)
 		return EEL_XMEMORY;
 	eel_o2v(dst, no);
@@ -43,6 +43,8 @@
 #include "e_state.h"
 #include "e_builtin.h"
 #include "e_function.h"
+#include "e_jit.h"
+#include "e_channel.h"
 #include "e_table.h"
 
 #ifndef WEXITSTATUS
@@ -57,29 +59,30 @@ typedef struct
 #else
 	struct timeval start;
 #endif
+	int		gen_cid;	/* Class ID of 'generator' */
+	int		chan_cid;	/* Class ID of 'channel' */
 } BI_moduledata;
 
 
 static EEL_xno bi__version(EEL_vm *vm)
 {
 	EEL_value *arg = vm->heap + vm->argv;
-	if(arg->classid != EEL_CINTEGER)
+	if(EEL_VCLASS(arg) != EEL_CINTEGER)
 		return EEL_XNEEDINTEGER;
 
-	vm->heap[vm->resv].classid = EEL_CINTEGER;
-	switch(arg->integer.v)
+	switch(EEL_VINT(arg))
 	{
 	  case 0:
-	  	vm->heap[vm->resv].integer.v = EEL_MAJOR_VERSION;
+	  	eel_l2v(&vm->heap[vm->resv], EEL_MAJOR_VERSION);
 		break;
 	  case 1:
-	  	vm->heap[vm->resv].integer.v = EEL_MINOR_VERSION;
+	  	eel_l2v(&vm->heap[vm->resv], EEL_MINOR_VERSION);
 		break;
 	  case 2:
-	  	vm->heap[vm->resv].integer.v = EEL_MICRO_VERSION;
+	  	eel_l2v(&vm->heap[vm->resv], EEL_MICRO_VERSION);
 		break;
 	  case 3:
-	  	vm->heap[vm->resv].integer.v = EEL_SNAPSHOT;
+	  	eel_l2v(&vm->heap[vm->resv], EEL_SNAPSHOT);
 		break;
 	  default:
 		return EEL_XWRONGINDEX;
@@ -94,19 +97,18 @@ static EEL_xno bi__xname(EEL_vm *vm)
 	EEL_object *s;
 	const char *n;
 
-	if(arg->classid != EEL_CINTEGER)
+	if(EEL_VCLASS(arg) != EEL_CINTEGER)
 		return EEL_XNEEDINTEGER;
-	if(arg->integer.v >= EEL__XCOUNT)
+	if(EEL_VINT(arg) >= EEL__XCOUNT)
 		return EEL_XHIGHINDEX;
-	if(arg->integer.v < 0)
+	if(EEL_VINT(arg) < 0)
 		return EEL_XLOWINDEX;
 
-	n = eel_x_name(vm, arg->integer.v);
+	n = eel_x_name(vm, EEL_VINT(arg));
 	s = eel_ps_new(vm, n);
 	if(!s)
 		return EEL_XCONSTRUCTOR;
-	vm->heap[vm->resv].classid = EEL_COBJREF;
-	vm->heap[vm->resv].objref.v = s;
+	eel_o2v(&vm->heap[vm->resv], s);
 	return 0;
 }
 
@@ -117,19 +119,18 @@ static EEL_xno bi__xdesc(EEL_vm *vm)
 	EEL_object *s;
 	const char *n;
 
-	if(arg->classid != EEL_CINTEGER)
+	if(EEL_VCLASS(arg) != EEL_CINTEGER)
 		return EEL_XNEEDINTEGER;
-	if(arg->integer.v >= EEL__XCOUNT)
+	if(EEL_VINT(arg) >= EEL__XCOUNT)
 		return EEL_XHIGHINDEX;
-	if(arg->integer.v < 0)
+	if(EEL_VINT(arg) < 0)
 		return EEL_XLOWINDEX;
 
-	n = eel_x_description(vm, arg->integer.v);
+	n = eel_x_description(vm, EEL_VINT(arg));
 	s = eel_ps_new(vm, n);
 	if(!s)
 		return EEL_XCONSTRUCTOR;
-	vm->heap[vm->resv].classid = EEL_COBJREF;
-	vm->heap[vm->resv].objref.v = s;
+	eel_o2v(&vm->heap[vm->resv], s);
 	return 0;
 }
 
@@ -178,32 +179,32 @@ static EEL_xno bi_print(EEL_vm *vm)
 	for(i = 0; i < vm->argc; ++i)
 	{
 		EEL_value *v = &vm->heap[vm->argv + i];
-		switch(v->classid)
+		switch(EEL_VCLASS(v))
 		{
 		  case EEL_CNIL:
 			count += printf("<nil>");
 			break;
 		  case EEL_CREAL:
-			count += printf(EEL_REAL_FMT, v->real.v);
+			count += printf(EEL_REAL_FMT, EEL_VREAL(v));
 			break;
 		  case EEL_CINTEGER:
-			count += printf("%d", v->integer.v);
+			count += printf("%d", EEL_VINT(v));
 			break;
 		  case EEL_CBOOLEAN:
-			count += printf(v->integer.v ? "true" : "false");
+			count += printf(EEL_VINT(v) ? "true" : "false");
 			break;
 		  case EEL_CCLASSID:
 			count += printf("<typeid %s>",
 					eel_o2s(o2EEL_classdef(VMP->state->classes[
-					v->integer.v])->name));
+					EEL_VINT(v)])->name));
 			break;
 		  case EEL_COBJREF:
 		  case EEL_CWEAKREF:
-			count += print_object(vm, v->objref.v);
+			count += print_object(vm, eel_v2o(v));
 			break;
 		  default:
 			count += printf("<illegal value; classid %d>",
-					v->classid);
+					EEL_VCLASS(v));
 			break;
 		}
 	}
@@ -218,7 +219,7 @@ static EEL_xno bi__compile(EEL_vm *vm)
 	if(EEL_CLASS(args + 0) != EEL_CMODULE)
 		return EEL_XNEEDMODULE;
 	eel_try(VMP->state)
-		eel_compile(VMP->state, args[0].objref.v, flags);
+		eel_compile(VMP->state, eel_v2o(&args[0]), flags);
 	eel_except
 		return EEL_XCOMPILE;
 	return 0;
@@ -234,7 +235,7 @@ static EEL_xno bi__exports(EEL_vm *vm)
 		EEL_function *f;
 		if(EEL_CLASS(arg) != EEL_CFUNCTION)
 			return EEL_XWRONGTYPE;
-		f = o2EEL_function(arg->objref.v);
+		f = o2EEL_function(eel_v2o(arg));
 		m = f->common.module;
 	}
 	else
@@ -246,9 +247,8 @@ static EEL_xno bi__exports(EEL_vm *vm)
 		if(!m)
 			return EEL_XBADCONTEXT;
 	}
-	vm->heap[vm->resv].classid = EEL_COBJREF;
-	vm->heap[vm->resv].objref.v = o2EEL_module(m)->exports;
-	eel_o_own(vm->heap[vm->resv].objref.v);
+	eel_o2v(&vm->heap[vm->resv], o2EEL_module(m)->exports);
+	eel_o_own(eel_v2o(&vm->heap[vm->resv]));
 	return 0;
 }
 
@@ -274,8 +274,7 @@ static unsigned long get_ticks(BI_moduledata *md)
 static EEL_xno bi_getms(EEL_vm *vm)
 {
 	BI_moduledata *md = (BI_moduledata *)eel_get_current_moduledata(vm);
-	vm->heap[vm->resv].classid = EEL_CINTEGER;
-	vm->heap[vm->resv].integer.v = get_ticks(md);
+	eel_l2v(&vm->heap[vm->resv], get_ticks(md));
 	return 0;
 }
 
@@ -297,8 +296,7 @@ static EEL_xno bi_getus(EEL_vm *vm)
 	ticks = (now.tv_sec - md->start.tv_sec) * 1000000.0f +
 			(now.tv_usec - md->start.tv_usec);
 #endif
-	vm->heap[vm->resv].classid = EEL_CREAL;
-	vm->heap[vm->resv].real.v = ticks;
+	eel_d2v(&vm->heap[vm->resv], ticks);
 	return 0;
 }
 
@@ -308,7 +306,7 @@ static EEL_xno bi_sleep(EEL_vm *vm)
 #ifdef _WIN32
 	DWORD t1 = timeGetTime();
 	Sleep(eel_v2l(vm->heap + vm->argv));
-	vm->heap[vm->resv].integer.v = timeGetTime() - t1;
+	eel_l2v(&vm->heap[vm->resv], timeGetTime() - t1);
 #else
 	BI_moduledata *md = (BI_moduledata *)eel_get_current_moduledata(vm);
 	unsigned long ms = eel_v2l(vm->heap + vm->argv);
@@ -333,25 +331,169 @@ static EEL_xno bi_sleep(EEL_vm *vm)
 			tv.tv_usec = (ms % 1000) * 1000;
 			select(0, NULL, NULL, NULL, &tv);
 		}
-	vm->heap[vm->resv].integer.v = now - t1;
+	eel_l2v(&vm->heap[vm->resv], now - t1);
 #endif
-	vm->heap[vm->resv].classid = EEL_CINTEGER;
 	return 0;
 }
 
 
 static EEL_xno bi_getis(EEL_vm *vm)
 {
-	vm->heap[vm->resv].classid = EEL_CINTEGER;
 #if DBG6B(1)+0 == 1
-	vm->heap[vm->resv].integer.v = VMP->instructions;
+	eel_l2v(&vm->heap[vm->resv], VMP->instructions);
+#elif defined(EEL_VM_PROFILING)
+	/* Use the profiler's dispatch counts */
+	int i;
+	long long count = 0;
+	for(i = 0; i <= EEL_O_LAST; ++i)
+		count += VMP->vmprof[i].count;
+	eel_l2v(&vm->heap[vm->resv], count);
 #else
-	vm->heap[vm->resv].integer.v = 0;
+	eel_l2v(&vm->heap[vm->resv], 0);
 #endif
 	return 0;
 }
 
 
+/* Set 'key' of table 't' to 'n'; a real if it's too large for an integer */
+static EEL_xno ms_setcount(EEL_object *t, const char *key, long long n)
+{
+	EEL_value v;
+	if((n >= -2147483647LL - 1) && (n <= 2147483647LL))
+		eel_l2v(&v, (EEL_integer)n);
+	else
+		eel_d2v(&v, (EEL_real)n);
+	return eel_table_sets(t, key, &v);
+}
+
+
+static EEL_xno ms_fill(EEL_vm *vm, EEL_object *t)
+{
+	EEL_xno x;
+	EEL_value v;
+	EEL_object *ct;
+	EEL_memstats ms;
+	EEL_classmemstats cms;
+	int i;
+	eel_get_memstats(vm, &ms);
+	if((x = ms_setcount(t, "objects", ms.objects)) ||
+			(x = ms_setcount(t, "bytes", ms.bytes)) ||
+			(x = ms_setcount(t, "allocs", ms.allocs)) ||
+			(x = ms_setcount(t, "frees", ms.frees)) ||
+			(x = ms_setcount(t, "strings", ms.strings)) ||
+			(x = ms_setcount(t, "cachedstrings",
+					ms.cachedstrings)) ||
+			(x = ms_setcount(t, "stringbytes", ms.stringbytes)) ||
+			(x = ms_setcount(t, "heapsize", ms.heapsize)) ||
+			(x = ms_setcount(t, "heappeak", ms.heappeak)) ||
+			(x = ms_setcount(t, "valuesize", ms.valuesize)) ||
+			(x = ms_setcount(t, "cyclecands", ms.cyclecands)) ||
+			(x = ms_setcount(t, "cyclefrees", ms.cyclefrees)) ||
+			(x = ms_setcount(t, "deferreditems",
+					ms.deferreditems)))
+		return x;
+	eel_d2v(&v, ms.allocrate);
+	if((x = eel_table_sets(t, "allocrate", &v)))
+		return x;
+	eel_d2v(&v, ms.freerate);
+	if((x = eel_table_sets(t, "freerate", &v)))
+		return x;
+
+	/* Per class statistics, for classes that have had any objects */
+	if((x = eel_o_construct(vm, EEL_CTABLE, NULL, 0, &v)))
+		return x;
+	ct = eel_v2o(&v);
+	x = eel_table_sets(t, "classes", &v);
+	eel_disown(ct);
+	if(x)
+		return x;
+	for(i = 0; i < VMP->state->nclasses; ++i)
+	{
+		EEL_object *cst;
+		if(eel_get_classmemstats(vm, i, &cms) || !cms.allocs)
+			continue;
+		if((x = eel_o_construct(vm, EEL_CTABLE, NULL, 0, &v)))
+			return x;
+		cst = eel_v2o(&v);
+		x = eel_table_sets(ct, eel_typename(vm, i), &v);
+		eel_disown(cst);
+		if(x || (x = ms_setcount(cst, "objects", cms.objects)) ||
+				(x = ms_setcount(cst, "bytes", cms.bytes)) ||
+				(x = ms_setcount(cst, "allocs", cms.allocs)) ||
+				(x = ms_setcount(cst, "frees", cms.frees)))
+			return x;
+	}
+	return 0;
+}
+
+
+/*
+ * memstats()
+ *	Returns a table with the memory statistics of the VM, as returned by
+ *	eel_get_memstats(). The "classes" field is a table of per class
+ *	statistics, indexed by class name.
+ */
+static EEL_xno bi_memstats(EEL_vm *vm)
+{
+	EEL_xno x;
+	EEL_value v;
+	EEL_object *t;
+	if((x = eel_o_construct(vm, EEL_CTABLE, NULL, 0, &v)))
+		return x;
+	t = eel_v2o(&v);
+	if((x = ms_fill(vm, t)))
+	{
+		eel_disown(t);
+		return x;
+	}
+	eel_o2v(&vm->heap[vm->resv], t);
+	return 0;
+}
+
+
+/*
+ * collect_cycles([budget])
+ *	Run the cycle collector, as eel_collect_cycles(). Returns true if there
+ *	is more work to do.
+ */
+static EEL_xno bi_collect_cycles(EEL_vm *vm)
+{
+	int budget = 0;
+	if(vm->argc >= 1)
+		budget = eel_v2l(vm->heap + vm->argv);
+	eel_b2v(&vm->heap[vm->resv], eel_collect_cycles(vm, budget));
+	return 0;
+}
+
+
+/*
+ * defer_destruction(minitems)
+ *	Defer destruction of tables and arrays with 'minitems' or more items,
+ *	as eel_defer_destruction(). 0 disables. Returns the previous setting.
+ */
+static EEL_xno bi_defer_destruction(EEL_vm *vm)
+{
+	eel_l2v(&vm->heap[vm->resv],
+			eel_defer_destruction(vm, eel_v2l(vm->heap + vm->argv)));
+	return 0;
+}
+
+
+/*
+ * collect([budget])
+ *	Release deferred items, and run the cycle collector, as eel_collect().
+ *	Returns true if there is more work to do.
+ */
+static EEL_xno bi_collect(EEL_vm *vm)
+{
+	int budget = 0;
+	if(vm->argc >= 1)
+		budget = eel_v2l(vm->heap + vm->argv);
+	eel_b2v(&vm->heap[vm->resv], eel_collect(vm, budget));
+	return 0;
+}
+
+
 static EEL_xno bi_caller(EEL_vm *vm)
 {
 	EEL_callframe *cf;
@@ -362,13 +504,431 @@ static EEL_xno bi_caller(EEL_vm *vm)
 		cf = (EEL_callframe *)(vm->heap + cf->r_base - EEL_CFREGS);
 		if(cf->f)
 		{
-			vm->heap[vm->resv].classid = EEL_COBJREF;
-			vm->heap[vm->resv].objref.v = cf->f;
+			eel_o2v(&vm->heap[vm->resv], cf->f);
 			eel_o_own(cf->f);
 			return 0;
 		}
 	}
-	vm->heap[vm->resv].classid = EEL_CNIL;
+	eel_nil2v(&vm->heap[vm->resv]);
+	return 0;
+}
+
+
+/*
+ * jit([enable])
+ *	Enable or disable native code, returning the previous setting, or nil
+ *	if there is no native code support.
+ */
+static EEL_xno bi_jit(EEL_vm *vm)
+{
+#ifdef EEL_VM_JIT
+	int prev = VMP->jit;
+	if(vm->argc >= 1)
+		eel_set_jit(vm, eel_v2l(vm->heap + vm->argv) != 0);
+	eel_b2v(&vm->heap[vm->resv], prev);
+#else
+	eel_nil2v(&vm->heap[vm->resv]);
+#endif
+	return 0;
+}
+
+
+/*
+ * nojit(function)
+ *	Never run 'function' as native code.
+ */
+static EEL_xno bi_nojit(EEL_vm *vm)
+{
+	EEL_value *arg = vm->heap + vm->argv;
+	EEL_function *f;
+	if(EEL_CLASS(arg) != EEL_CFUNCTION)
+		return EEL_XWRONGTYPE;
+	f = o2EEL_function(eel_v2o(arg));
+	f->common.flags |= EEL_FF_NOJIT;
+#ifdef EEL_VM_JIT
+	if(!(f->common.flags & EEL_FF_CFUNC))
+		eel_jit_free(vm, f);
+#endif
+	return 0;
+}
+
+
+/*
+ * spawn(function, ...)
+ *	Start a new microthread that calls 'function' with the remaining
+ *	arguments. Returns the ID of the new thread.
+ */
+static EEL_xno bi_spawn(EEL_vm *vm)
+{
+	EEL_value *args = vm->heap + vm->argv;
+	EEL_xno x;
+	int id;
+	if(EEL_CLASS(args) != EEL_CFUNCTION)
+		return EEL_XNEEDCALLABLE;
+	x = eel__spawn(vm, eel_v2o(args), args + 1, vm->argc - 1, &id);
+	if(x)
+		return x;
+	eel_l2v(&vm->heap[vm->resv], id);
+	return 0;
+}
+
+
+/*
+ * thread_yield()
+ *	Let the other microthreads run for a while.
+ */
+static EEL_xno bi_thread_yield(EEL_vm *vm)
+{
+	return EEL_XYIELD;
+}
+
+
+/*
+ * threads()
+ *	Returns the number of running microthreads, including the main thread.
+ */
+static EEL_xno bi_threads(EEL_vm *vm)
+{
+	eel_l2v(&vm->heap[vm->resv], eel__threads(vm));
+	return 0;
+}
+
+
+/*----------------------------------------------------------
+	generator class
+----------------------------------------------------------*/
+typedef struct
+{
+	EEL_object	*i_next;	/* (string) */
+	EEL_object	*i_done;	/* (string) */
+	EEL_object	*next;		/* (cfunction) */
+	EEL_object	*done;		/* (cfunction) */
+} BI_generator_cd;
+
+
+/*
+ * generator [function, ...]
+ *	Set up a call to 'function' with the remaining arguments, to be run
+ *	one 'yield' statement at a time by the 'next' method.
+ */
+static EEL_xno gen_construct(EEL_vm *vm, EEL_classes cid,
+		EEL_value *initv, int initc, EEL_value *result)
+{
+	EEL_xno x;
+	EEL_object *eo;
+	if(initc < 1)
+		return EEL_XARGUMENTS;
+	if(EEL_CLASS(initv) != EEL_CFUNCTION)
+		return EEL_XNEEDCALLABLE;
+	eo = eel_o_alloc(vm, sizeof(EEL_generator), cid);
+	if(!eo)
+		return EEL_XMEMORY;
+	x = eel__gen_init(vm, o2EEL_generator(eo), eel_v2o(initv),
+			initv + 1, initc - 1);
+	if(x)
+	{
+		eel_o_free(eo);
+		return x;
+	}
+	eel_o2v(result, eo);
+	return 0;
+}
+
+
+static EEL_xno gen_destruct(EEL_object *eo)
+{
+	eel__gen_free(eo->vm, o2EEL_generator(eo));
+	return 0;
+}
+
+
+static EEL_xno gen_getindex(EEL_object *eo, EEL_value *op1, EEL_value *op2)
+{
+	BI_generator_cd *cd = (BI_generator_cd *)eel_get_classdata(eo->vm,
+			eo->classid);
+	if(!EEL_IS_OBJREF(EEL_VCLASS(op1)))
+		return EEL_XWRONGINDEX;
+	if(eel_v2o(op1) == cd->i_next)
+	{
+		eel_o_own(cd->next);
+		eel_o2v(op2, cd->next);
+		return 0;
+	}
+	if(eel_v2o(op1) == cd->i_done)
+	{
+		eel_o_own(cd->done);
+		eel_o2v(op2, cd->done);
+		return 0;
+	}
+	return EEL_XWRONGINDEX;
+}
+
+
+/*
+ * generator:next()
+ *	Run the generator until its next 'yield', and return the value yielded.
+ *	Returns nil once the function of the generator has returned.
+ */
+static EEL_xno gen_next(EEL_vm *vm)
+{
+	BI_moduledata *md = (BI_moduledata *)eel_get_current_moduledata(vm);
+	EEL_value *arg = vm->heap + vm->argv;
+	if(EEL_CLASS(arg) != md->gen_cid)
+		return EEL_XWRONGTYPE;
+	return eel__gen_resume(vm, o2EEL_generator(eel_v2o(arg)),
+			vm->heap + vm->resv);
+}
+
+
+/*
+ * generator:done()
+ *	Returns true if the function of the generator has returned, or thrown
+ *	an exception.
+ */
+static EEL_xno gen_done(EEL_vm *vm)
+{
+	BI_moduledata *md = (BI_moduledata *)eel_get_current_moduledata(vm);
+	EEL_value *arg = vm->heap + vm->argv;
+	if(EEL_CLASS(arg) != md->gen_cid)
+		return EEL_XWRONGTYPE;
+	eel_b2v(vm->heap + vm->resv,
+			o2EEL_generator(eel_v2o(arg))->state == EEL_GS_DONE);
+	return 0;
+}
+
+
+static void gen_unregister(EEL_object *classdef, void *classdata)
+{
+	EEL_vm *vm = classdef->vm;
+	BI_generator_cd *cd = (BI_generator_cd *)classdata;
+	eel_o_disown_nz(cd->i_next);
+	eel_o_disown_nz(cd->i_done);
+	eel_free(vm, classdata);
+}
+
+
+/*----------------------------------------------------------
+	channel class
+----------------------------------------------------------*/
+typedef enum
+{
+	BI_CH_SEND = 0,
+	BI_CH_RECEIVE,
+	BI_CH_SEND_SPIN,
+	BI_CH_RECEIVE_SPIN,
+	BI_CH_READY,
+	BI_CH__COUNT
+} BI_chanmethods;
+
+typedef struct
+{
+	EEL_object	*names[BI_CH__COUNT];	/* (string) */
+	EEL_object	*methods[BI_CH__COUNT];	/* (cfunction) */
+} BI_channel_cd;
+
+
+/*
+ * channel [name]
+ * channel [name, size]
+ *	Open an end of the channel 'name', creating it, with FIFOs of 'size'
+ *	bytes, if needed. The other end is opened by constructing a channel
+ *	with the same name, usually in another VM.
+ */
+static EEL_xno chan_construct(EEL_vm *vm, EEL_classes cid,
+		EEL_value *initv, int initc, EEL_value *result)
+{
+	EEL_xno x;
+	EEL_object *eo;
+	const char *name;
+	int size = EEL_CHANNEL_SIZE;
+	if(initc < 1 || initc > 2)
+		return EEL_XARGUMENTS;
+	if(!(name = eel_v2s(initv)))
+		return EEL_XNEEDSTRING;
+	if(initc >= 2)
+		size = eel_v2l(initv + 1);
+	eo = eel_o_alloc(vm, sizeof(EEL_channel), cid);
+	if(!eo)
+		return EEL_XMEMORY;
+	if((x = eel__chan_open(vm, o2EEL_channel(eo), name, size)))
+	{
+		eel_o_free(eo);
+		return x;
+	}
+	eel_o2v(result, eo);
+	return 0;
+}
+
+
+static EEL_xno chan_destruct(EEL_object *eo)
+{
+	eel__chan_close(eo->vm, o2EEL_channel(eo));
+	return 0;
+}
+
+
+static EEL_xno chan_getindex(EEL_object *eo, EEL_value *op1, EEL_value *op2)
+{
+	BI_channel_cd *cd = (BI_channel_cd *)eel_get_classdata(eo->vm,
+			eo->classid);
+	int i;
+	if(!EEL_IS_OBJREF(EEL_VCLASS(op1)))
+		return EEL_XWRONGINDEX;
+	for(i = 0; i < BI_CH__COUNT; ++i)
+		if(eel_v2o(op1) == cd->names[i])
+		{
+			eel_o_own(cd->methods[i]);
+			eel_o2v(op2, cd->methods[i]);
+			return 0;
+		}
+	return EEL_XWRONGINDEX;
+}
+
+
+static EEL_xno chan_do_send(EEL_vm *vm, int spin)
+{
+	BI_moduledata *md = (BI_moduledata *)eel_get_current_moduledata(vm);
+	EEL_value *args = vm->heap + vm->argv;
+	int res;
+	if(EEL_CLASS(args) != md->chan_cid)
+		return EEL_XWRONGTYPE;
+	res = eel__chan_send(vm, o2EEL_channel(eel_v2o(args)), args + 1, spin);
+	if(res < 0)
+		return -res;
+	eel_b2v(vm->heap + vm->resv, res);
+	return 0;
+}
+
+
+static EEL_xno chan_do_receive(EEL_vm *vm, int spin)
+{
+	BI_moduledata *md = (BI_moduledata *)eel_get_current_moduledata(vm);
+	EEL_value *arg = vm->heap + vm->argv;
+	EEL_value *r = vm->heap + vm->resv;
+	int res;
+	if(EEL_CLASS(arg) != md->chan_cid)
+		return EEL_XWRONGTYPE;
+	res = eel__chan_receive(vm, o2EEL_channel(eel_v2o(arg)), r, spin);
+	if(res < 0)
+		return -res;
+	if(!res)
+		eel_nil2v(r);
+	return 0;
+}
+
+
+/*
+ * channel:send(value)
+ *	Send 'value' to the other end, if there is room for it. Returns true if
+ *	the value was sent, or false if the channel is full.
+ */
+static EEL_xno chan_send(EEL_vm *vm)
+{
+	return chan_do_send(vm, 0);
+}
+
+
+/*
+ * channel:receive()
+ *	Returns the next value sent from the other end, or nil if there is
+ *	none. (Use ready() to tell that from a nil being sent.)
+ */
+static EEL_xno chan_receive(EEL_vm *vm)
+{
+	return chan_do_receive(vm, 0);
+}
+
+
+/*
+ * channel:send_spin(value)
+ *	Like send(), but waits, yielding the CPU to other threads, until there
+ *	is room for the value. Always returns true.
+ */
+static EEL_xno chan_send_spin(EEL_vm *vm)
+{
+	return chan_do_send(vm, 1);
+}
+
+
+/*
+ * channel:receive_spin()
+ *	Like receive(), but waits, yielding the CPU to other threads, until a
+ *	value arrives.
+ *
+ *	NOTE: This blocks the whole VM, including any microthreads!
+ */
+static EEL_xno chan_receive_spin(EEL_vm *vm)
+{
+	return chan_do_receive(vm, 1);
+}
+
+
+/*
+ * channel:ready()
+ *	Returns true if there is a value to receive.
+ */
+static EEL_xno chan_ready(EEL_vm *vm)
+{
+	BI_moduledata *md = (BI_moduledata *)eel_get_current_moduledata(vm);
+	EEL_value *arg = vm->heap + vm->argv;
+	if(EEL_CLASS(arg) != md->chan_cid)
+		return EEL_XWRONGTYPE;
+	eel_b2v(vm->heap + vm->resv,
+			eel__chan_ready(o2EEL_channel(eel_v2o(arg))));
+	return 0;
+}
+
+
+static void chan_unregister(EEL_object *classdef, void *classdata)
+{
+	EEL_vm *vm = classdef->vm;
+	BI_channel_cd *cd = (BI_channel_cd *)classdata;
+	int i;
+	for(i = 0; i < BI_CH__COUNT; ++i)
+		eel_o_disown_nz(cd->names[i]);
+	eel_free(vm, classdata);
+}
+
+
+static EEL_xno chan_register(EEL_vm *vm, EEL_object *m, BI_moduledata *md)
+{
+	static const char *names[BI_CH__COUNT] = {
+		"send", "receive", "send_spin", "receive_spin", "ready"
+	};
+	BI_channel_cd *cd;
+	int i;
+	EEL_object *c = eel_export_class(m, "channel", -1, chan_construct,
+			chan_destruct, NULL);
+	if(!c)
+		return EEL_XMODULEINIT;
+	eel_set_metamethod(c, EEL_MM_GETINDEX, chan_getindex);
+	md->chan_cid = eel_class_cid(c);
+	cd = (BI_channel_cd *)eel_malloc(vm, sizeof(BI_channel_cd));
+	if(!cd)
+		return EEL_XMODULEINIT;
+	cd->methods[BI_CH_SEND] = eel_add_cfunction(m, 1, "send", 2, 0, 0,
+			chan_send);
+	cd->methods[BI_CH_RECEIVE] = eel_add_cfunction(m, 1, "receive", 1, 0,
+			0, chan_receive);
+	cd->methods[BI_CH_SEND_SPIN] = eel_add_cfunction(m, 1, "send_spin", 2,
+			0, 0, chan_send_spin);
+	cd->methods[BI_CH_RECEIVE_SPIN] = eel_add_cfunction(m, 1,
+			"receive_spin", 1, 0, 0, chan_receive_spin);
+	cd->methods[BI_CH_READY] = eel_add_cfunction(m, 1, "ready", 1, 0, 0,
+			chan_ready);
+	for(i = 0; i < BI_CH__COUNT; ++i)
+		cd->names[i] = eel_ps_new(vm, names[i]);
+	for(i = 0; i < BI_CH__COUNT; ++i)
+		if(!cd->methods[i] || !cd->names[i])
+		{
+			for(i = 0; i < BI_CH__COUNT; ++i)
+				if(cd->names[i])
+					eel_o_disown_nz(cd->names[i]);
+			eel_free(vm, cd);
+			return EEL_XMODULEINIT;
+		}
+	eel_set_unregister(c, chan_unregister);
+	eel_set_classdata(vm, md->chan_cid, cd);
 	return 0;
 }
 
@@ -376,27 +936,27 @@ static EEL_xno bi_caller(EEL_vm *vm)
 static EEL_xno bi_insert(EEL_vm *vm)
 {
 	EEL_value *args = vm->heap + vm->argv;
-	if(!EEL_IS_OBJREF(args->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(args)))
 		return EEL_XNEEDOBJECT;
-	return eel_insert(args->objref.v, args + 1, args + 2);
+	return eel_insert(eel_v2o(args), args + 1, args + 2);
 }
 
 
 static EEL_xno bi_delete(EEL_vm *vm)
 {
 	EEL_value *args = vm->heap + vm->argv;
-	if(!EEL_IS_OBJREF(args->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(args)))
 		return EEL_XNEEDOBJECT;
 	switch(vm->argc)
 	{
 	  case 3:
-		return eel_o__metamethod(args->objref.v, EEL_MM_DELETE,
+		return eel_o__metamethod(eel_v2o(args), EEL_MM_DELETE,
 				args + 1, args + 2);
 	  case 2:
-		return eel_o__metamethod(args->objref.v, EEL_MM_DELETE,
+		return eel_o__metamethod(eel_v2o(args), EEL_MM_DELETE,
 				args + 1, NULL);
 	  case 1:
-		return eel_o__metamethod(args->objref.v, EEL_MM_DELETE,
+		return eel_o__metamethod(eel_v2o(args), EEL_MM_DELETE,
 				NULL, NULL);
 	}
 	return EEL_XINTERNAL;	/* Should never get here! */
@@ -410,9 +970,9 @@ static EEL_xno bi_copy(EEL_vm *vm)
 	EEL_value start;
 	EEL_value len;
 	EEL_value *args = vm->heap + vm->argv;
-	if(!EEL_IS_OBJREF(args->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(args)))
 		return EEL_XNEEDOBJECT;
-	o = args->objref.v;
+	o = eel_v2o(args);
 	eel_l2v(&start, vm->argc >= 2 ? eel_v2l(args + 1) : 0);
 	if(vm->argc >= 3)
 		eel_l2v(&len, eel_v2l(args + 2));
@@ -421,7 +981,7 @@ static EEL_xno bi_copy(EEL_vm *vm)
 		x = eel_o__metamethod(o, EEL_MM_LENGTH, NULL, &len);
 		if(x)
 			return x;
-		len.integer.v -= start.integer.v;
+		eel_l2v(&len, EEL_VINT(&len) - EEL_VINT(&start));
 	}
 	x = eel_o__metamethod(o, EEL_MM_COPY, &start, &len);
 	if(x)
@@ -435,7 +995,7 @@ static EEL_xno bi_index(EEL_vm *vm)
 {
 	EEL_value *args = vm->heap + vm->argv;
 	EEL_value *res = vm->heap + vm->resv;
-	if(!EEL_IS_OBJREF(args->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(args)))
 		return EEL_XNEEDOBJECT;
 	switch(EEL_CLASS(args))
 	{
@@ -445,14 +1005,14 @@ static EEL_xno bi_index(EEL_vm *vm)
 		int i = eel_v2l(args + 1);
 		if(i < 0)
 			return EEL_XLOWINDEX;
-		ti = eel_table_get_item(args->objref.v, i);
+		ti = eel_table_get_item(eel_v2o(args), i);
 		if(!ti)
 			return EEL_XHIGHINDEX;
 		eel_v_copy(res, eel_table_get_value(ti));
 		return 0;
 	  }
 	  default:
-		return eel_o__metamethod(args->objref.v, EEL_MM_GETINDEX,
+		return eel_o__metamethod(eel_v2o(args), EEL_MM_GETINDEX,
 			args + 1, res);
 	}
 }
@@ -464,14 +1024,14 @@ static EEL_xno bi_key(EEL_vm *vm)
 	EEL_value *res = vm->heap + vm->resv;
 	EEL_tableitem *ti;
 	int i;
-	if(!EEL_IS_OBJREF(args->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(args)))
 		return EEL_XNEEDOBJECT;
 	if(EEL_CLASS(args) != EEL_CTABLE)
 		return EEL_XNEEDTABLE;
 	i = eel_v2l(args + 1);
 	if(i < 0)
 		return EEL_XLOWINDEX;
-	ti = eel_table_get_item(args->objref.v, i);
+	ti = eel_table_get_item(eel_v2o(args), i);
 	if(!ti)
 		return EEL_XHIGHINDEX;
 	eel_v_copy(res, eel_table_get_key(ti));
@@ -483,9 +1043,9 @@ static EEL_xno bi_tryindex(EEL_vm *vm)
 {
 	EEL_value *args = vm->heap + vm->argv;
 	EEL_value *res = vm->heap + vm->resv;
-	if(!EEL_IS_OBJREF(args->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(args)))
 		return EEL_XNEEDOBJECT;
-	if(eel_o__metamethod(args->objref.v, EEL_MM_GETINDEX, args + 1, res))
+	if(eel_o__metamethod(eel_v2o(args), EEL_MM_GETINDEX, args + 1, res))
 	{
 		if(vm->argc >= 3)
 			eel_v_copy(res, args + 2);
@@ -496,28 +1056,6 @@ static EEL_xno bi_tryindex(EEL_vm *vm)
 }
 
 
-static EEL_xno bi_vacall(EEL_vm *vm)
-{
-/*	EEL_value *args = vm->heap + vm->argv;
-	EEL_value *res = vm->heap + vm->resv;
-	EEL_tableitem *ti;
-	int i;
-	if(!EEL_IS_OBJREF(args->classid))
-		return EEL_XNEEDOBJECT;
-	if(EEL_CLASS(args) != EEL_CTABLE)
-		return EEL_XNEEDTABLE;
-	i = eel_v2l(args + 1);
-	if(i < 0)
-		return EEL_XLOWINDEX;
-	ti = eel_table_get_item(args->objref.v, i);
-	if(!ti)
-		return EEL_XHIGHINDEX;
-	eel_v_copy(res, eel_table_get_key(ti));
-	return 0;*/
-	return EEL_XNOTIMPLEMENTED;
-}
-
-
 /*----------------------------------------------------------
 	Unloading
 ----------------------------------------------------------*/
@@ -568,7 +1106,8 @@ static const EEL_lconstexp bi_constants[] =
 
 EEL_xno eel_builtin_init(EEL_vm *vm)
 {
-	EEL_object *m;
+	EEL_object *m, *c;
+	BI_generator_cd *gcd;
 #ifdef	EEL_USE_EELBIL
 	EEL_state *es = VMP->state;
 #endif
@@ -602,7 +1141,56 @@ EEL_xno eel_builtin_init(EEL_vm *vm)
 	eel_export_cfunction(m, 1, "getus", 0, 0, 0, bi_getus);
 	eel_export_cfunction(m, 1, "sleep", 1, 0, 0, bi_sleep);
 	eel_export_cfunction(m, 1, "get_instruction_count", 0, 0, 0, bi_getis);
+	eel_export_cfunction(m, 1, "memstats", 0, 0, 0, bi_memstats);
+	eel_export_cfunction(m, 1, "collect_cycles", 0, 1, 0,
+			bi_collect_cycles);
+	eel_export_cfunction(m, 1, "defer_destruction", 1, 0, 0,
+			bi_defer_destruction);
+	eel_export_cfunction(m, 1, "collect", 0, 1, 0, bi_collect);
 	eel_export_cfunction(m, 1, "__caller", 0, 0, 0, bi_caller);
+	eel_export_cfunction(m, 1, "jit", 0, 1, 0, bi_jit);
+	eel_export_cfunction(m, 0, "nojit", 1, 0, 0, bi_nojit);
+
+	/* Microthreads */
+	eel_export_cfunction(m, 1, "spawn", 1, 0, 1, bi_spawn);
+	eel_export_cfunction(m, 0, "thread_yield", 0, 0, 0, bi_thread_yield);
+	eel_export_cfunction(m, 1, "threads", 0, 0, 0, bi_threads);
+
+	/* Generators */
+	c = eel_export_class(m, "generator", -1, gen_construct, gen_destruct,
+			NULL);
+	if(!c)
+	{
+		eel_o_disown_nz(m);
+		return EEL_XMODULEINIT;
+	}
+	eel_set_metamethod(c, EEL_MM_GETINDEX, gen_getindex);
+	md->gen_cid = eel_class_cid(c);
+	gcd = (BI_generator_cd *)eel_malloc(vm, sizeof(BI_generator_cd));
+	if(!gcd)
+	{
+		eel_o_disown_nz(m);
+		return EEL_XMODULEINIT;
+	}
+	gcd->next = eel_add_cfunction(m, 1, "next", 1, 0, 0, gen_next);
+	gcd->done = eel_add_cfunction(m, 1, "done", 1, 0, 0, gen_done);
+	gcd->i_next = eel_ps_new(vm, "next");
+	gcd->i_done = eel_ps_new(vm, "done");
+	if(!(gcd->next && gcd->done && gcd->i_next && gcd->i_done))
+	{
+		eel_free(vm, gcd);
+		eel_o_disown_nz(m);
+		return EEL_XMODULEINIT;
+	}
+	eel_set_unregister(c, gen_unregister);
+	eel_set_classdata(vm, md->gen_cid, gcd);
+
+	/* Inter-VM channels */
+	if(chan_register(vm, m, md))
+	{
+		eel_o_disown_nz(m);
+		return EEL_XMODULEINIT;
+	}
 
 	/* Operations on indexable objects */
 	eel_export_cfunction(m, 0, "insert", 3, 0, 0, bi_insert);
@@ -616,9 +1204,6 @@ EEL_xno eel_builtin_init(EEL_vm *vm)
 	eel_export_cfunction(m, 0, "__compile", 2, 0, 0, bi__compile);
 	eel_export_cfunction(m, 1, "__exports", 0, 1, 0, bi__exports);
 
-	/* Utilities for variadics */
-	eel_export_cfunction(m, 1, "vacall", 2, 2, 0, bi_vacall);
-
 	/* Constants and enums */
 	eel_export_lconstants(m, bi_constants);
 
@@ -41,8 +41,8 @@ static EEL_xno generic_indexable_cast(EEL_vm *vm,
 {
 	EEL_xno x;
 	EEL_value iv;
-	int maxi;
-	EEL_object *o1 = op1->objref.v;
+	int i, maxi;
+	EEL_object *o1 = eel_v2o(op1);
 	EEL_object *o2;
 	x = eel_o__metamethod(o1, EEL_MM_LENGTH, NULL, &iv);
 	if(x)
@@ -50,11 +50,12 @@ static EEL_xno generic_indexable_cast(EEL_vm *vm,
 	x = eel_o__construct(vm, cid, NULL, 0, op2);
 	if(x)
 		return x;
-	o2 = op2->objref.v;
-	maxi = iv.integer.v;
-	for(iv.integer.v = 0; iv.integer.v < maxi; ++iv.integer.v)
+	o2 = eel_v2o(op2);
+	maxi = EEL_VINT(&iv);
+	for(i = 0; i < maxi; ++i)
 	{
 		EEL_value tmp;
+		eel_l2v(&iv, i);
 		x = eel_o__metamethod(o1, EEL_MM_GETINDEX, &iv, &tmp);
 		if(x)
 		{
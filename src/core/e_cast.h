@@ -45,15 +45,18 @@ static inline EEL_xno eel_cast(EEL_vm *vm,
 			cid);
 	if(x && (cid == EEL_CSTRING || cid == EEL_CDSTRING))
 	{
+		EEL_object *o;
 		const char *s = eel_v_stringrep(vm, src);
 		if(!s)
 			return EEL_XWRONGTYPE;	/* Giving up! */
 		if(cid == EEL_CSTRING)
-			dst->objref.v = eel_ps_new(vm, s);
+			o = eel_ps_new(vm, s);
 		else/* if(cid == EEL_CDSTRING)*/
-			dst->objref.v = eel_ds_new(vm, s);
-		dst->classid = EEL_COBJREF;
-		return dst->objref.v ? 0 : EEL_XMEMORY;
+			o = eel_ds_new(vm, s);
+		if(!o)
+			return EEL_XMEMORY;
+		eel_o2v(dst, o);
+		return 0;
 	}
 	else
 		return x;
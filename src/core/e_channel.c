@@ -0,0 +1,569 @@
+/*
+---------------------------------------------------------------------------
+	e_channel.c - EEL inter-VM message channels
+---------------------------------------------------------------------------
+ * Copyright 2026 The EEL contributors
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the
+ * use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "e_channel.h"
+#include "e_object.h"
+#include "e_string.h"
+#include "e_dstring.h"
+#include "e_array.h"
+#include "e_table.h"
+#include "e_vector.h"
+
+
+/*----------------------------------------------------------
+	FIFO
+----------------------------------------------------------*/
+/*
+ * Like sfifo, one byte of the buffer is never used, so that 'full' can be
+ * told from 'empty'. Messages are written and read as a whole; a 32 bit
+ * length followed by the encoded value.
+ *
+ * The writer writes the data before moving 'writepos', and the reader reads
+ * the data before moving 'readpos', with barriers in between, so the other
+ * side never sees a position before the data it refers to.
+ */
+
+static int fifo_init(EEL_fifo *f, int size)
+{
+	f->size = 1;
+	while(f->size <= size)
+		f->size <<= 1;
+	f->readpos = f->writepos = 0;
+	f->buffer = (char *)malloc(f->size);
+	return f->buffer ? 0 : -1;
+}
+
+
+static inline int fifo_used(EEL_fifo *f, int rp, int wp)
+{
+	return (wp - rp) & (f->size - 1);
+}
+
+
+/* Copy 'len' bytes from 'data' into the buffer, starting at 'pos' */
+static inline void fifo_put(EEL_fifo *f, int pos, const char *data, int len)
+{
+	int n = f->size - pos;
+	if(n >= len)
+		memcpy(f->buffer + pos, data, len);
+	else
+	{
+		memcpy(f->buffer + pos, data, n);
+		memcpy(f->buffer, data + n, len - n);
+	}
+}
+
+
+/* Copy 'len' bytes from the buffer, starting at 'pos', into 'data' */
+static inline void fifo_get(EEL_fifo *f, int pos, char *data, int len)
+{
+	int n = f->size - pos;
+	if(n >= len)
+		memcpy(data, f->buffer + pos, len);
+	else
+	{
+		memcpy(data, f->buffer + pos, n);
+		memcpy(data + n, f->buffer, len - n);
+	}
+}
+
+
+/* Write message 'msg' of 'len' bytes, or return 0 if there's no room. */
+static int fifo_write(EEL_fifo *f, const char *msg, int len)
+{
+	int rp = f->readpos;
+	int wp = f->writepos;
+	eel_barrier();
+	if(f->size - 1 - fifo_used(f, rp, wp) < len)
+		return 0;
+	fifo_put(f, wp, msg, len);
+	eel_barrier();
+	f->writepos = (wp + len) & (f->size - 1);
+	return 1;
+}
+
+
+/*----------------------------------------------------------
+	Registry
+----------------------------------------------------------*/
+
+static EEL_atomic e_chan_lock = 0;
+static EEL_chanbuf *e_channels = NULL;
+
+
+static void chanbuf_free(EEL_chanbuf *cb)
+{
+	free(cb->fifo[0].buffer);
+	free(cb->fifo[1].buffer);
+	free(cb->name);
+	free(cb);
+}
+
+
+static EEL_chanbuf *chanbuf_new(const char *name, int size)
+{
+	EEL_chanbuf *cb = (EEL_chanbuf *)calloc(1, sizeof(EEL_chanbuf));
+	if(!cb)
+		return NULL;
+	if(!(cb->name = strdup(name)) || fifo_init(&cb->fifo[0], size) ||
+			fifo_init(&cb->fifo[1], size))
+	{
+		chanbuf_free(cb);
+		return NULL;
+	}
+	return cb;
+}
+
+
+EEL_xno eel__chan_open(EEL_vm *vm, EEL_channel *c, const char *name,
+		int size)
+{
+	EEL_chanbuf *cb;
+	if(size < 1)
+		return EEL_XLOWVALUE;
+	if(size > (1 << 29))
+		return EEL_XHIGHVALUE;
+	c->buf = NULL;
+	c->bufsize = 0;
+	eel_spin_lock(&e_chan_lock);
+	for(cb = e_channels; cb; cb = cb->next)
+		if(!strcmp(cb->name, name))
+			break;
+	if(!cb)
+	{
+		if(!(cb = chanbuf_new(name, size)))
+		{
+			eel_spin_unlock(&e_chan_lock);
+			return EEL_XMEMORY;
+		}
+		cb->next = e_channels;
+		e_channels = cb;
+	}
+	else if(cb->sides >= 2)
+	{
+		eel_spin_unlock(&e_chan_lock);
+		return EEL_XSHARINGVIOLATION;
+	}
+	c->cb = cb;
+	c->side = cb->sides++;
+	++cb->nopen;
+	eel_spin_unlock(&e_chan_lock);
+	return 0;
+}
+
+
+void eel__chan_close(EEL_vm *vm, EEL_channel *c)
+{
+	EEL_chanbuf *cb = c->cb;
+	eel_spin_lock(&e_chan_lock);
+	eel_atomic_add(&cb->closed[c->side], 1);
+	if(!--cb->nopen)
+	{
+		EEL_chanbuf **cbp = &e_channels;
+		while(*cbp != cb)
+			cbp = &(*cbp)->next;
+		*cbp = cb->next;
+		chanbuf_free(cb);
+	}
+	eel_spin_unlock(&e_chan_lock);
+	c->cb = NULL;
+	eel_free(vm, c->buf);
+	c->buf = NULL;
+}
+
+
+static inline int peer_closed(EEL_channel *c)
+{
+	return eel_atomic_add(&c->cb->closed[1 - c->side], 0);
+}
+
+
+/*----------------------------------------------------------
+	Encoding
+----------------------------------------------------------*/
+/*
+ * Each value is a one byte class ID, followed by the data, if any, in native
+ * byte order:
+ *	EEL_CNIL				-
+ *	EEL_CREAL				EEL_real
+ *	EEL_CINTEGER, EEL_CBOOLEAN, EEL_CCLASSID	EEL_integer
+ *	EEL_CSTRING, EEL_CDSTRING		EEL_int32 length; chars
+ *	EEL_CARRAY				EEL_int32 count; values
+ *	EEL_CTABLE				EEL_int32 count; key/value pairs
+ *	EEL_CVECTOR_*				EEL_int32 length; items
+ */
+
+/* Make sure the message buffer of 'c' can hold at least 'size' bytes */
+static EEL_xno buf_reserve(EEL_vm *vm, EEL_channel *c, int size)
+{
+	int ns = c->bufsize ? c->bufsize : 256;
+	char *nb;
+	if(size <= c->bufsize)
+		return 0;
+	while(ns < size)
+		ns <<= 1;
+	if(!(nb = (char *)eel_realloc(vm, c->buf, ns)))
+		return EEL_XMEMORY;
+	c->buf = nb;
+	c->bufsize = ns;
+	return 0;
+}
+
+
+static EEL_xno enc_put(EEL_vm *vm, EEL_channel *c, int *pos, const void *data,
+		int len)
+{
+	EEL_xno x;
+	if((x = buf_reserve(vm, c, *pos + len)))
+		return x;
+	memcpy(c->buf + *pos, data, len);
+	*pos += len;
+	return 0;
+}
+
+
+static EEL_xno enc_header(EEL_vm *vm, EEL_channel *c, int *pos,
+		EEL_classes cid, int length)
+{
+	EEL_xno x;
+	unsigned char tag = cid;
+	EEL_int32 l = length;
+	if((x = enc_put(vm, c, pos, &tag, 1)))
+		return x;
+	return enc_put(vm, c, pos, &l, sizeof(l));
+}
+
+
+static EEL_xno enc_value(EEL_vm *vm, EEL_channel *c, int *pos, EEL_value *v,
+		int depth)
+{
+	EEL_xno x;
+	EEL_object *o;
+	unsigned char tag = EEL_VCLASS(v);
+	int i;
+	EEL_integer iv;
+	EEL_real rv;
+	if(depth > EEL_CHANNEL_MAXDEPTH)
+		return EEL_XOVERFLOW;
+	switch(EEL_VCLASS(v))
+	{
+	  case EEL_CNIL:
+		return enc_put(vm, c, pos, &tag, 1);
+	  case EEL_CREAL:
+		if((x = enc_put(vm, c, pos, &tag, 1)))
+			return x;
+		rv = EEL_VREAL(v);
+		return enc_put(vm, c, pos, &rv, sizeof(EEL_real));
+	  case EEL_CCLASSID:
+		/* User class IDs mean nothing to another VM! */
+		if(EEL_VINT(v) >= EEL__CUSER)
+			return EEL_XWRONGTYPE;
+		/* Fall through */
+	  case EEL_CINTEGER:
+	  case EEL_CBOOLEAN:
+		if((x = enc_put(vm, c, pos, &tag, 1)))
+			return x;
+		iv = EEL_VINT(v);
+		return enc_put(vm, c, pos, &iv, sizeof(EEL_integer));
+	  case EEL_COBJREF:
+	  case EEL_CWEAKREF:
+		break;
+	  default:
+		return EEL_XWRONGTYPE;
+	}
+	o = eel_v2o(v);
+	switch((EEL_classes)o->classid)
+	{
+	  case EEL_CSTRING:
+	  {
+		EEL_string *s = o2EEL_string(o);
+		if((x = enc_header(vm, c, pos, o->classid, s->length)))
+			return x;
+		return enc_put(vm, c, pos, s->buffer, s->length);
+	  }
+	  case EEL_CDSTRING:
+	  {
+		EEL_dstring *ds = o2EEL_dstring(o);
+		if((x = enc_header(vm, c, pos, o->classid, ds->length)))
+			return x;
+		return enc_put(vm, c, pos, ds->buffer, ds->length);
+	  }
+	  case EEL_CARRAY:
+	  {
+		EEL_array *a = o2EEL_array(o);
+		if((x = enc_header(vm, c, pos, o->classid, a->length)))
+			return x;
+		for(i = 0; i < a->length; ++i)
+			if((x = enc_value(vm, c, pos, &a->values[i],
+					depth + 1)))
+				return x;
+		return 0;
+	  }
+	  case EEL_CTABLE:
+	  {
+		EEL_table *t = o2EEL_table(o);
+		if((x = enc_header(vm, c, pos, o->classid, t->length)))
+			return x;
+		for(i = 0; i < t->length; ++i)
+		{
+			if((x = enc_value(vm, c, pos, &t->items[i].key,
+					depth + 1)))
+				return x;
+			if((x = enc_value(vm, c, pos, &t->items[i].value,
+					depth + 1)))
+				return x;
+		}
+		return 0;
+	  }
+	  case EEL_CVECTOR_U8:
+	  case EEL_CVECTOR_S8:
+	  case EEL_CVECTOR_U16:
+	  case EEL_CVECTOR_S16:
+	  case EEL_CVECTOR_U32:
+	  case EEL_CVECTOR_S32:
+	  case EEL_CVECTOR_F:
+	  case EEL_CVECTOR_D:
+	  {
+		EEL_vector *vec = o2EEL_vector(o);
+		if((x = enc_header(vm, c, pos, o->classid, vec->length)))
+			return x;
+		return enc_put(vm, c, pos, vec->buffer.u8,
+				vec->length * vec->isize);
+	  }
+	  default:
+		return EEL_XWRONGTYPE;
+	}
+}
+
+
+/*----------------------------------------------------------
+	Decoding
+----------------------------------------------------------*/
+
+typedef struct
+{
+	const char	*p;
+	const char	*end;
+} CH_reader;
+
+
+static inline EEL_xno dec_get(CH_reader *r, void *data, int len)
+{
+	if(r->end - r->p < len)
+		return EEL_XWRONGFORMAT;
+	memcpy(data, r->p, len);
+	r->p += len;
+	return 0;
+}
+
+
+static EEL_xno dec_value(EEL_vm *vm, CH_reader *r, EEL_value *v, int depth);
+
+/* Decode 'count' values, and construct an object of class 'cid' from them */
+static EEL_xno dec_construct(EEL_vm *vm, CH_reader *r, EEL_classes cid,
+		int count, EEL_value *v, int depth)
+{
+	EEL_xno x = 0;
+	EEL_value *initv = NULL;
+	int i;
+	if(count < 0 || count > r->end - r->p)
+		return EEL_XWRONGFORMAT;
+	if(count && !(initv = (EEL_value *)eel_malloc(vm,
+			count * sizeof(EEL_value))))
+		return EEL_XMEMORY;
+	for(i = 0; i < count; ++i)
+		if((x = dec_value(vm, r, initv + i, depth + 1)))
+			break;
+	if(!x)
+		x = eel_o_construct(vm, cid, initv, count, v);
+	while(i--)
+		eel_v_disown_nz(initv + i);
+	eel_free(vm, initv);
+	return x;
+}
+
+
+static EEL_xno dec_value(EEL_vm *vm, CH_reader *r, EEL_value *v, int depth)
+{
+	EEL_xno x;
+	EEL_object *o;
+	EEL_int32 len;
+	EEL_integer iv;
+	EEL_real rv;
+	unsigned char tag;
+	if(depth > EEL_CHANNEL_MAXDEPTH)
+		return EEL_XWRONGFORMAT;
+	if((x = dec_get(r, &tag, 1)))
+		return x;
+	switch((EEL_classes)tag)
+	{
+	  case EEL_CNIL:
+		eel_nil2v(v);
+		return 0;
+	  case EEL_CREAL:
+		if((x = dec_get(r, &rv, sizeof(EEL_real))))
+			return x;
+		eel_d2v(v, rv);
+		return 0;
+	  case EEL_CINTEGER:
+	  case EEL_CBOOLEAN:
+	  case EEL_CCLASSID:
+		if((x = dec_get(r, &iv, sizeof(EEL_integer))))
+			return x;
+		eel_i2v(v, tag, iv);
+		return 0;
+	  default:
+		break;
+	}
+	if((x = dec_get(r, &len, sizeof(len))))
+		return x;
+	switch((EEL_classes)tag)
+	{
+	  case EEL_CSTRING:
+	  case EEL_CDSTRING:
+		if(len < 0 || len > r->end - r->p)
+			return EEL_XWRONGFORMAT;
+		if(tag == EEL_CSTRING)
+			o = eel_ps_nnew(vm, r->p, len);
+		else
+			o = eel_ds_nnew(vm, r->p, len);
+		if(!o)
+			return EEL_XMEMORY;
+		r->p += len;
+		eel_o2v(v, o);
+		return 0;
+	  case EEL_CARRAY:
+		return dec_construct(vm, r, EEL_CARRAY, len, v, depth);
+	  case EEL_CTABLE:
+		if(len > (r->end - r->p) / 2)
+			return EEL_XWRONGFORMAT;
+		return dec_construct(vm, r, EEL_CTABLE, len * 2, v, depth);
+	  case EEL_CVECTOR_U8:
+	  case EEL_CVECTOR_S8:
+	  case EEL_CVECTOR_U16:
+	  case EEL_CVECTOR_S16:
+	  case EEL_CVECTOR_U32:
+	  case EEL_CVECTOR_S32:
+	  case EEL_CVECTOR_F:
+	  case EEL_CVECTOR_D:
+	  {
+		EEL_vector *vec;
+		if(len < 0 || len > r->end - r->p)
+			return EEL_XWRONGFORMAT;
+		if(!(o = eel_new_indexable(vm, tag, len)))
+			return EEL_XMEMORY;
+		vec = o2EEL_vector(o);
+		if((x = dec_get(r, vec->buffer.u8, len * vec->isize)))
+		{
+			eel_o_disown_nz(o);
+			return x;
+		}
+		eel_o2v(v, o);
+		return 0;
+	  }
+	  default:
+		return EEL_XWRONGFORMAT;
+	}
+}
+
+
+/*----------------------------------------------------------
+	Sending and receiving
+----------------------------------------------------------*/
+
+int eel__chan_send(EEL_vm *vm, EEL_channel *c, EEL_value *v, int spin)
+{
+	EEL_xno x;
+	EEL_fifo *f = &c->cb->fifo[c->side];
+	EEL_int32 len = 0;
+	int pos = 0;
+
+	/* Encode, leaving room for the length */
+	if((x = enc_put(vm, c, &pos, &len, sizeof(len))))
+		return -x;
+	if((x = enc_value(vm, c, &pos, v, 0)))
+		return -x;
+	if(pos > f->size - 1)
+		return -EEL_XBUFOVERFLOW;
+	len = pos - sizeof(len);
+	memcpy(c->buf, &len, sizeof(len));
+
+	while(1)
+	{
+		if(peer_closed(c))
+			return -EEL_XDEVICECLOSED;
+		if(fifo_write(f, c->buf, pos))
+			return 1;
+		if(!spin)
+			return 0;
+		eel_yield();
+	}
+}
+
+
+int eel__chan_ready(EEL_channel *c)
+{
+	EEL_fifo *f = &c->cb->fifo[1 - c->side];
+	return fifo_used(f, f->readpos, f->writepos) != 0;
+}
+
+
+int eel__chan_receive(EEL_vm *vm, EEL_channel *c, EEL_value *v, int spin)
+{
+	EEL_xno x;
+	EEL_fifo *f = &c->cb->fifo[1 - c->side];
+	EEL_int32 len;
+	CH_reader r;
+	int rp, wp;
+	while(1)
+	{
+		int closed = peer_closed(c);
+		rp = f->readpos;
+		wp = f->writepos;
+		eel_barrier();
+		if(fifo_used(f, rp, wp))
+			break;
+		if(closed)
+			return -EEL_XDEVICECLOSED;
+		if(!spin)
+			return 0;
+		eel_yield();
+	}
+
+	/* Grab the message, and release the FIFO space right away */
+	fifo_get(f, rp, (char *)&len, sizeof(len));
+	if((x = buf_reserve(vm, c, len)))
+		return -x;
+	rp = (rp + sizeof(len)) & (f->size - 1);
+	fifo_get(f, rp, c->buf, len);
+	eel_barrier();
+	f->readpos = (rp + len) & (f->size - 1);
+
+	r.p = c->buf;
+	r.end = c->buf + len;
+	if((x = dec_value(vm, &r, v, 0)))
+		return -x;
+	return 1;
+}
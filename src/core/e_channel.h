@@ -0,0 +1,121 @@
+/*
+---------------------------------------------------------------------------
+	e_channel.h - EEL inter-VM message channels
+---------------------------------------------------------------------------
+ * Copyright 2026 The EEL contributors
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the
+ * use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef	EEL_E_CHANNEL_H
+#define	EEL_E_CHANNEL_H
+
+#include "EEL.h"
+#include "e_platform.h"
+
+/*
+ * A channel connects two VMs, that may run in different OS threads. It is
+ * found by name in a process-wide registry; the first VM to open a name gets
+ * one end, and the next VM to open the same name gets the other end.
+ *
+ * Each end has a FIFO of its own for sending, so there is only ever one
+ * reader and one writer of each FIFO, and no locking is needed. (This is the
+ * design of sfifo, from Eelium, with memory barriers for SMP systems.)
+ *
+ * Values are sent as messages in a compact binary format. Value types,
+ * strings, dstrings, arrays, tables and vectors can be sent. Arrays and tables
+ * are copied deeply, so shared references end up as separate copies, and
+ * cyclic structures can't be sent.
+ */
+
+/* Default FIFO size (bytes) for each direction */
+#define	EEL_CHANNEL_SIZE	65536
+
+/* Maximum nesting depth of arrays and tables in a message */
+#define	EEL_CHANNEL_MAXDEPTH	64
+
+/* Single reader, single writer FIFO */
+typedef struct EEL_fifo
+{
+	char		*buffer;
+	int		size;		/* Buffer size; power of two */
+	char		pad0[64];	/* (Keep positions in separate lines) */
+	volatile int	readpos;	/* Only changed by the reader */
+	char		pad1[64];
+	volatile int	writepos;	/* Only changed by the writer */
+	char		pad2[64];
+} EEL_fifo;
+
+/* The shared part of a channel */
+typedef struct EEL_chanbuf EEL_chanbuf;
+struct EEL_chanbuf
+{
+	EEL_chanbuf	*next;		/* Registry list */
+	char		*name;
+	int		sides;		/* Ends taken so far (0..2) */
+	int		nopen;		/* Ends currently open */
+	EEL_atomic	closed[2];	/* Set when an end is closed */
+	EEL_fifo	fifo[2];	/* fifo[n] is written by end n */
+};
+
+/* One end of a channel (instance data of class 'channel') */
+typedef struct
+{
+	EEL_chanbuf	*cb;
+	int		side;		/* 0 or 1 */
+	char		*buf;		/* Message encoding buffer */
+	int		bufsize;
+} EEL_channel;
+EEL_MAKE_CAST(EEL_channel)
+
+/*
+ * Open an end of channel 'name', creating the channel, with 'size' bytes of
+ * buffer in each direction, if it doesn't exist. Returns 0 on success, or
+ * EEL_XSHARINGVIOLATION if both ends of the channel are already taken.
+ */
+EEL_xno eel__chan_open(EEL_vm *vm, EEL_channel *c, const char *name,
+		int size);
+
+/*
+ * Close the end 'c', and free the channel if the other end is closed too.
+ * Any messages still in the channel are lost when the channel is freed.
+ */
+void eel__chan_close(EEL_vm *vm, EEL_channel *c);
+
+/*
+ * Send value 'v' through 'c'. If 'spin' is set, busy wait (yielding the CPU)
+ * until there is room for the message.
+ *
+ * Returns 1 if the message was sent, 0 if there was no room, or a negated
+ * exception code. EEL_XDEVICECLOSED means the other end has been closed.
+ */
+int eel__chan_send(EEL_vm *vm, EEL_channel *c, EEL_value *v, int spin);
+
+/*
+ * Receive a value from 'c' into 'v'. If 'spin' is set, busy wait (yielding
+ * the CPU) until there is a message.
+ *
+ * Returns 1 if a value was received, 0 if there was nothing to receive, or a
+ * negated exception code. EEL_XDEVICECLOSED means the other end has been
+ * closed, and there are no more messages.
+ */
+int eel__chan_receive(EEL_vm *vm, EEL_channel *c, EEL_value *v, int spin);
+
+/* Returns 1 if there is at least one message to receive from 'c'. */
+int eel__chan_ready(EEL_channel *c);
+
+#endif	/* EEL_E_CHANNEL_H */
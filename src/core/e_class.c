@@ -128,5 +128,5 @@ EEL_object *eel_cclass_construct(EEL_vm *vm)
 	x = c_construct(vm, EEL_CCLASS, NULL, 0, &v);
 	if(x)
 		return NULL;
-	return v.objref.v;
+	return eel_v2o(&v);
 }
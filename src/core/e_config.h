@@ -26,6 +26,7 @@
 
 /* Pull in the platform check results */
 #include "config.h"
+#include "EEL_platform.h"
 
 /*
  * Assumed tab size for error column calculation. (Of course, tabs ARE 8
@@ -71,6 +72,25 @@ FIXME: and of suitable types!
 #define	EEL_ARRAY_SIZEBASE	8
 #define	EEL_VECTOR_SIZEBASE	8
 
+/*
+ * Objects of up to EEL_SLAB_MAXSIZE bytes, including the object header and an
+ * 8 byte block header, are allocated from per-VM slabs, with size classes in
+ * steps of 16 bytes. Slab memory is grabbed from the memory manager
+ * in chunks of EEL_SLAB_CHUNK bytes, and is not returned until the VM is
+ * closed. Undefine EEL_SLAB_MAXSIZE to have eel_malloc() called for every
+ * object. (Useful when using Valgrind or similar tools.)
+ */
+#define	EEL_SLAB_MAXSIZE	256
+#define	EEL_SLAB_CHUNK		16384
+
+/*
+ * Remember tables and arrays that may be part of garbage reference cycles, so
+ * that eel_collect_cycles() can find and free such cycles. Undefine to remove
+ * the tracking from the refcounting code. (eel_collect_cycles() will then do
+ * nothing.)
+ */
+#define	EEL_CYCLE_COLLECTOR
+
 /*
  * Define to have the '/' operator always generate real type results, Pascal
  * style.
@@ -135,6 +155,50 @@ FIXME: and of suitable types!
 #define EEL_VM_THREADED
 #endif
 
+/*
+ * Pre-decode EEL functions into a table of label addresses with unpacked
+ * operands before running them, so that the threaded dispatcher doesn't have
+ * to look opcodes up in the label table, or reassemble operands from the byte
+ * code for every instruction. (The byte code is kept for the disassembler,
+ * exception handling and debug info, and the PC remains a byte code offset.)
+ *
+ * Costs sizeof(EEL_dinstruction) bytes per byte of code, for functions that
+ * have been called at least once.
+ *
+ * NOTE:
+ *	Requires EEL_VM_THREADED!
+ */
+#ifdef EEL_VM_THREADED
+#  define	EEL_VM_PREDECODE
+#endif
+
+/*
+ * Quicken arithmetic instructions at run time. When ADD, SUB, MUL, DIV or
+ * one of the BOP instructions finds two integer or two real operands, its
+ * pre-decoded entry is switched to a variant that only checks the operand
+ * types before doing the operation inline. If the types don't match, the
+ * variant switches the entry back to the generic instruction and retries.
+ *
+ * NOTE:
+ *	Requires EEL_VM_PREDECODE!
+ */
+#ifdef EEL_VM_PREDECODE
+#  define	EEL_VM_QUICKEN
+#endif
+
+/*
+ * Inline caches for table member access. INDGETC, INDSETC and ARGINDGETC
+ * remember, in their pre-decoded entries, where in the table they last found
+ * their constant string key. If the key is still in that slot the next time,
+ * the hash lookup is skipped.
+ *
+ * NOTE:
+ *	Requires EEL_VM_PREDECODE!
+ */
+#ifdef EEL_VM_PREDECODE
+#  define	EEL_VM_INLINE_CACHE
+#endif
+
 /*
  * Enable call profiling. This causes the VM to build statistics on all C and
  * EEL function calls, including average and maximum time spent in each
@@ -149,6 +213,83 @@ FIXME: and of suitable types!
  */
 #undef	EEL_VM_PROFILING
 
+/*
+ * Compile hot EEL functions into native code. (x86-64 only.) A function is
+ * compiled when the sum of its calls and backward jumps reaches
+ * EEL_JIT_THRESHOLD. Instructions that have no native template, and native
+ * templates that run into operands they don't handle, fall back to the
+ * interpreter, one instruction at a time.
+ *
+ * The native code is switched on and off at run time with eel_set_jit(), and
+ * individual functions can be excluded with the nojit() builtin.
+ *
+ * NOTE:
+ *	Compiling allocates memory and mmap()s executable pages, in the middle
+ *	of whatever call or loop crossed the threshold. Undefine this, or
+ *	disable the JIT with eel_set_jit(), for hard real time applications!
+ *
+ * NOTE:
+ *	Requires EEL_VM_PREDECODE, and doesn't work with EEL_VM_PROFILING or
+ *	EEL_NANBOX.
+ */
+#if defined(EEL_VM_PREDECODE) && !defined(EEL_VM_PROFILING) && \
+		!defined(EEL_NANBOX) && defined(__x86_64__) && defined(__linux__)
+#  define	EEL_VM_JIT
+#endif
+#define	EEL_JIT_THRESHOLD	1000
+
+/*
+ * Keep the VM heap (register frames and argument stacks) in a range of
+ * address space reserved up front, committing EEL_HEAPSEGMENT values at a
+ * time as the stack grows. Frames stay where they are, so growing the heap is
+ * a cheap mprotect() instead of a realloc() and a relocation pass over the
+ * call stack. Only if the reservation of EEL_HEAPRESERVE values runs out, the
+ * heap is moved to a new reservation, twice the size.
+ *
+ * Hard real time applications can use eel_reserve_heap() to commit and touch
+ * heap space before going real time, so that calls never allocate memory.
+ *
+ * VMs opened with eel_open_pool() don't use this, but keep their heaps in the
+ * memory pool, to avoid the system calls.
+ */
+#if defined(__linux__)
+#  define	EEL_VM_SEGHEAP
+#endif
+#define	EEL_HEAPSEGMENT		4096
+#define	EEL_HEAPRESERVE		(1 << 20)
+
+/*
+ * Microthreads and generators have heaps of their own. As there may be many
+ * of them, they start out with a reservation of EEL_THREADHEAPRESERVE values,
+ * committing EEL_THREADHEAPSEGMENT values at a time (a whole number of pages),
+ * and move to bigger reservations as needed, until they are as big as the
+ * main heap.
+ */
+#define	EEL_THREADHEAPSEGMENT	512
+#define	EEL_THREADHEAPRESERVE	(1 << 14)
+
+/*
+ * Number of ticks (backward jumps and function calls) between checks of the
+ * eel_run_slice() deadline. Lower values give better deadline accuracy, but
+ * read the clock more often.
+ */
+#define	EEL_SLICE_POLL		256
+
+/*
+ * Number of ticks a microthread (spawn()) runs before the VM switches to the
+ * next thread, unless the thread yields first. (When running inside
+ * eel_run_slice(), EEL_SLICE_POLL is used instead, if it's smaller.)
+ */
+#define	EEL_THREAD_QUANTUM	1000
+
+/*
+ * Number of upvalue levels kept in the display of each call frame. Upvalues
+ * up to this many levels out are found with a single lookup; deeper levels
+ * walk the remaining frames. (Minimum 1. Every call copies EEL_UV_DISPLAY - 1
+ * entries from the frame below, so don't go overboard.)
+ */
+#define	EEL_UV_DISPLAY		4
+
 /* Keep global count of objects and refcounts. */
 #ifdef DEBUG
 #  define	EEL_OBJECT_ACCOUNTING
@@ -173,6 +314,24 @@ FIXME: and of suitable types!
 /* Substitute recognized instruction sequences with faster equivalents */
 #define	EEL_PEEPHOLE_OPTIMIZER
 
+/*
+ * Compile 'switch' statements where all case values are integers, or all are
+ * type IDs, into SWITCHD instructions, that index a flat jump table instead of
+ * doing a table lookup, if the range of the case values is no larger than
+ * EEL_SWITCH_DENSITY times the number of case values, or EEL_SWITCH_DENSE_MIN.
+ * (Undefine EEL_SWITCH_DENSITY to use table lookups for all switches.)
+ */
+#define	EEL_SWITCH_DENSITY	4
+#define	EEL_SWITCH_DENSE_MIN	64
+
+/*
+ * Pass the arguments of member calls, indirect calls and calls to C functions
+ * as a window of registers (CALLRW and CCALLRW instructions) instead of pushing
+ * them on the argument stack, if there are no more than EEL_CALLRW_MAXARGS of
+ * them. (Undefine to always use the argument stack.)
+ */
+#define	EEL_CALLRW_MAXARGS	8
+
 
 /*---------------------------------------------------------
 	Debug output and checking options
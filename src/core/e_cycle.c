@@ -0,0 +1,603 @@
+/*
+---------------------------------------------------------------------------
+	e_cycle.c - EEL reference cycle collector
+---------------------------------------------------------------------------
+ * Copyright 2026 The EEL contributors
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the
+ * use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include <limits.h>
+#include <string.h>
+#include "e_object.h"
+#include "e_array.h"
+#include "e_table.h"
+#include "e_vm.h"
+
+#ifdef EEL_CYCLE_COLLECTOR
+
+/* Initial size of the candidate buffer */
+#define	CC_MINROOTS	64
+
+
+/*----------------------------------------------------------
+	Candidate buffers
+----------------------------------------------------------*/
+
+/* Free the memory of 'o', which was destroyed while in a candidate buffer */
+static inline void cc_free_dead(EEL_vm *vm, EEL_object *o)
+{
+	eel_slab_free(vm, eel_o2mem(o));
+}
+
+
+/* Take the first 'n' objects of 'list' out of the candidate buffers */
+static void cc_unbuffer(EEL_vm *vm, EEL_object **list, int n)
+{
+	int i;
+	for(i = 0; i < n; ++i)
+	{
+		EEL_slabblock *b = eel_o2block(list[i]);
+		b->a.flags &= ~EEL_CCF_BUFFERED;
+		if(b->a.flags & EEL_CCF_DEAD)
+			cc_free_dead(vm, list[i]);
+	}
+}
+
+
+/*
+ * Make room in the candidate buffer; first by dropping objects that have been
+ * destroyed, and if that doesn't free up at least a quarter of the buffer, by
+ * growing it.
+ */
+static void cc_grow_roots(EEL_vm *vm)
+{
+	EEL_cycles *cc = &VMP->cc;
+	EEL_object **r;
+	int i, j, n;
+	for(i = j = 0; i < cc->nroots; ++i)
+	{
+		EEL_object *o = cc->roots[i];
+		if(eel_o2block(o)->a.flags & EEL_CCF_DEAD)
+			cc_free_dead(vm, o);
+		else
+			cc->roots[j++] = o;
+	}
+	cc->nroots = j;
+	if(cc->nroots < cc->maxroots - cc->maxroots / 4)
+		return;
+	n = cc->maxroots ? cc->maxroots * 2 : CC_MINROOTS;
+	r = (EEL_object **)eel_realloc(vm, cc->roots,
+			n * sizeof(EEL_object *));
+	if(!r)
+		return;
+	cc->roots = r;
+	cc->maxroots = n;
+}
+
+
+void eel_cc_candidate(EEL_object *o)
+{
+	EEL_vm *vm = o->vm;
+	EEL_cycles *cc = &VMP->cc;
+	if(cc->closed)
+		return;
+	if(cc->nroots >= cc->maxroots)
+	{
+		cc_grow_roots(vm);
+		if(cc->nroots >= cc->maxroots)
+			return;	/* Out of memory. We'll just miss this one. */
+	}
+	cc->roots[cc->nroots++] = o;
+	eel_o2block(o)->a.flags |= EEL_CCF_BUFFERED;
+}
+
+
+/*----------------------------------------------------------
+	Nodes
+----------------------------------------------------------*/
+
+/* Number of values held by table or array 'o' */
+static inline int cc_count(EEL_object *o)
+{
+	if(o->classid == EEL_CTABLE)
+		return o2EEL_table(o)->length * 2;
+	return o2EEL_array(o)->length;
+}
+
+
+/* Value 'i' of table or array 'o'. (Tables are key, value, key, ...) */
+static inline EEL_value *cc_value(EEL_object *o, int i)
+{
+	if(o->classid == EEL_CTABLE)
+	{
+		EEL_tableitem *ti = o2EEL_table(o)->items + (i >> 1);
+		return (i & 1) ? &ti->value : &ti->key;
+	}
+	return o2EEL_array(o)->values + i;
+}
+
+
+/* If 'v' is a (strong) reference to a node, return its index, otherwise -1 */
+static inline int cc_nodeof(EEL_value *v)
+{
+	EEL_slabblock *b;
+	if(EEL_VCLASS(v) != EEL_COBJREF)
+		return -1;
+	b = eel_o2block(eel_v2o(v));
+	if(!(b->a.flags & EEL_CCF_NODE))
+		return -1;
+	return b->a.size;
+}
+
+
+/*
+ * Returns non-zero if node 'n' is referenced by anything but other nodes, and
+ * the reference held by the node itself.
+ */
+static inline int cc_external(EEL_ccnode *n)
+{
+	return (n->o->refcount - 1 > n->internal) || eel_in_limbo(n->o);
+}
+
+
+/* Make 'o' a node, holding a reference to it */
+static int cc_add(EEL_vm *vm, EEL_object *o)
+{
+	EEL_cycles *cc = &VMP->cc;
+	EEL_slabblock *b = eel_o2block(o);
+	EEL_ccnode *n;
+	if(cc->nnodes >= cc->maxnodes)
+	{
+		int nmax = cc->maxnodes ? cc->maxnodes * 2 : CC_MINROOTS;
+		n = (EEL_ccnode *)eel_realloc(vm, cc->nodes,
+				nmax * sizeof(EEL_ccnode));
+		if(!n)
+			return -1;
+		cc->nodes = n;
+		cc->maxnodes = nmax;
+	}
+	n = cc->nodes + cc->nnodes;
+	n->o = o;
+	n->size = b->a.size;
+	n->internal = 0;
+	n->live = 0;
+	b->a.size = cc->nnodes++;
+	b->a.flags |= EEL_CCF_NODE;
+	eel_o_own(o);
+	return 0;
+}
+
+
+/*
+ * Turn node 'n' back into a plain object, and release the node reference.
+ * Unlike eel_o_disown(), this does not make the object a candidate.
+ */
+static void cc_release(EEL_vm *vm, EEL_ccnode *n)
+{
+	EEL_object *o = n->o;
+	EEL_slabblock *b = eel_o2block(o);
+	b->a.size = n->size;
+	b->a.flags &= ~EEL_CCF_NODE;
+	DBGM(++VMP->disowns;)
+	if(!--o->refcount)
+		eel_o__dispose(o);
+}
+
+
+/*
+ * Drop everything held by table or array 'o'. Returns the number of items
+ * released, which is 0 if they were handed over to the deferred queue.
+ */
+static int cc_clear(EEL_object *o)
+{
+	int i, n;
+	if(o->classid == EEL_CTABLE)
+	{
+		EEL_table *t = o2EEL_table(o);
+		n = t->length;
+		t->length = 0;
+		if(eel_defer(o->vm, EEL_CTABLE, t->items, n))
+		{
+			t->items = NULL;
+			t->asize = 0;
+			return 0;
+		}
+		for(i = 0; i < n; ++i)
+		{
+			eel_v_disown_nz(&t->items[i].key);
+			eel_v_disown_nz(&t->items[i].value);
+		}
+	}
+	else
+	{
+		EEL_array *a = o2EEL_array(o);
+		n = a->length;
+		a->length = 0;
+		if(eel_defer(o->vm, EEL_CARRAY, a->values, n))
+		{
+			a->values = NULL;
+			a->maxlength = 0;
+			return 0;
+		}
+		for(i = 0; i < n; ++i)
+			eel_v_disown_nz(&a->values[i]);
+	}
+	return n;
+}
+
+
+/* Stop any collection in progress, and let go of all nodes */
+static void cc_abort(EEL_vm *vm)
+{
+	EEL_cycles *cc = &VMP->cc;
+	int i = (cc->phase == EEL_CCP_FREE) ? cc->pos : 0;
+	cc_unbuffer(vm, cc->taken, cc->ntaken);
+	cc->ntaken = 0;
+	for( ; i < cc->nnodes; ++i)
+		cc_release(vm, cc->nodes + i);
+	cc->nnodes = 0;
+	cc->nstack = 0;
+	cc->ncands = 0;
+	cc->phase = EEL_CCP_IDLE;
+}
+
+
+/*----------------------------------------------------------
+	Collection phases
+----------------------------------------------------------*/
+
+static int cc_roots(EEL_vm *vm, int budget)
+{
+	EEL_cycles *cc = &VMP->cc;
+	int work = 0;
+	while(cc->ntaken)
+	{
+		EEL_object *o;
+		EEL_slabblock *b;
+		if(work >= budget)
+			return work;
+		o = cc->taken[--cc->ntaken];
+		b = eel_o2block(o);
+		b->a.flags &= ~EEL_CCF_BUFFERED;
+		++work;
+		if(b->a.flags & EEL_CCF_DEAD)
+			cc_free_dead(vm, o);
+		else if(!(b->a.flags & EEL_CCF_NODE) && !eel_in_limbo(o) &&
+				(cc_add(vm, o) < 0))
+		{
+			cc_abort(vm);
+			return work;
+		}
+	}
+	cc->phase = EEL_CCP_SCAN;
+	cc->pos = cc->item = 0;
+	return work;
+}
+
+
+static int cc_scan(EEL_vm *vm, int budget)
+{
+	EEL_cycles *cc = &VMP->cc;
+	int work = 0;
+	while(cc->pos < cc->nnodes)
+	{
+		EEL_object *o = cc->nodes[cc->pos].o;
+		int n = cc_count(o);
+		while(cc->item < n)
+		{
+			EEL_value *v;
+			EEL_object *c;
+			EEL_slabblock *b;
+			if(work >= budget)
+				return work;
+			v = cc_value(o, cc->item++);
+			++work;
+			if(EEL_VCLASS(v) != EEL_COBJREF)
+				continue;
+			c = eel_v2o(v);
+			if((c->classid != EEL_CTABLE) &&
+					(c->classid != EEL_CARRAY))
+				continue;
+			b = eel_o2block(c);
+			if(!(b->a.flags & EEL_CCF_NODE) && (cc_add(vm, c) < 0))
+			{
+				cc_abort(vm);
+				return work;
+			}
+			++cc->nodes[b->a.size].internal;
+		}
+		++cc->pos;
+		cc->item = 0;
+		++work;
+	}
+
+	/* Each node goes on the stack and in the candidate list at most once */
+	if(cc->maxstack < cc->nnodes)
+	{
+		int *s = (int *)eel_realloc(vm, cc->stack,
+				cc->nnodes * 2 * sizeof(int));
+		if(!s)
+		{
+			cc_abort(vm);
+			return work;
+		}
+		cc->stack = s;
+		cc->cands = s + cc->nnodes;
+		cc->maxstack = cc->nnodes;
+	}
+	cc->phase = EEL_CCP_LIVE;
+	cc->pos = 0;
+	return work;
+}
+
+
+static int cc_live(EEL_vm *vm, int budget)
+{
+	EEL_cycles *cc = &VMP->cc;
+	int work = 0;
+	while(cc->pos < cc->nnodes)
+	{
+		EEL_ccnode *n = cc->nodes + cc->pos;
+		if(work >= budget)
+			return work;
+		if(!n->live && cc_external(n))
+		{
+			n->live = 1;
+			cc->stack[cc->nstack++] = cc->pos;
+		}
+		++cc->pos;
+		++work;
+	}
+	cc->phase = EEL_CCP_PROPAGATE;
+	cc->pos = -1;
+	return work;
+}
+
+
+/*
+ * Mark everything reachable from the nodes on the stack as live. Done when
+ * the stack is empty, and 'pos' is -1.
+ */
+static int cc_propagate(EEL_vm *vm, int budget)
+{
+	EEL_cycles *cc = &VMP->cc;
+	int work = 0;
+	while(1)
+	{
+		EEL_object *o;
+		int n;
+		if(cc->pos < 0)
+		{
+			if(!cc->nstack)
+				return work;
+			cc->pos = cc->stack[--cc->nstack];
+			cc->item = 0;
+		}
+		o = cc->nodes[cc->pos].o;
+		n = cc_count(o);
+		while(cc->item < n)
+		{
+			int i;
+			if(work >= budget)
+				return work;
+			i = cc_nodeof(cc_value(o, cc->item++));
+			++work;
+			if((i >= 0) && !cc->nodes[i].live)
+			{
+				cc->nodes[i].live = 1;
+				cc->stack[cc->nstack++] = i;
+			}
+		}
+		cc->pos = -1;
+		++work;
+	}
+}
+
+
+/* List the nodes that still look like garbage */
+static int cc_gather(EEL_vm *vm, int budget)
+{
+	EEL_cycles *cc = &VMP->cc;
+	int work = 0;
+	while(cc->pos < cc->nnodes)
+	{
+		if(work >= budget)
+			return work;
+		if(!cc->nodes[cc->pos].live)
+			cc->cands[cc->ncands++] = cc->pos;
+		++cc->pos;
+		++work;
+	}
+	cc->phase = EEL_CCP_VERIFY;
+	return work;
+}
+
+
+/*
+ * Count the references between the candidates again, as things are now, and
+ * check them against the current refcounts. This is done in one go, as the
+ * result is only valid until the VM runs again. Whatever is left is garbage,
+ * and as nothing can reach it anymore, it can be freed in steps.
+ */
+static int cc_verify(EEL_vm *vm)
+{
+	EEL_cycles *cc = &VMP->cc;
+	int i, j, work = 0;
+	for(i = 0; i < cc->ncands; ++i)
+		cc->nodes[cc->cands[i]].internal = 0;
+	for(i = 0; i < cc->ncands; ++i)
+	{
+		EEL_object *o = cc->nodes[cc->cands[i]].o;
+		int n = cc_count(o);
+		for(j = 0; j < n; ++j)
+		{
+			int k = cc_nodeof(cc_value(o, j));
+			if((k >= 0) && !cc->nodes[k].live)
+				++cc->nodes[k].internal;
+		}
+		work += n + 1;
+	}
+	for(i = 0; i < cc->ncands; ++i)
+	{
+		EEL_ccnode *n = cc->nodes + cc->cands[i];
+		if(cc_external(n))
+		{
+			n->live = 1;
+			cc->stack[cc->nstack++] = cc->cands[i];
+		}
+	}
+	cc->pos = -1;
+	work += cc_propagate(vm, INT_MAX);
+
+	/* Weakrefs are the only way left to get at the garbage. Kill them! */
+	for(i = 0; i < cc->ncands; ++i)
+	{
+		EEL_ccnode *n = cc->nodes + cc->cands[i];
+		if(n->live)
+			continue;
+		eel_kill_weakrefs(n->o);
+		++cc->frees;
+	}
+	cc->ncands = 0;
+	cc->phase = EEL_CCP_FREE;
+	cc->pos = 0;
+	return work;
+}
+
+
+static int cc_free(EEL_vm *vm, int budget)
+{
+	EEL_cycles *cc = &VMP->cc;
+	int work = 0;
+	while(cc->pos < cc->nnodes)
+	{
+		EEL_ccnode *n;
+		if(work >= budget)
+			return work;
+		n = cc->nodes + cc->pos++;
+		if(!n->live)
+			work += cc_clear(n->o);
+		cc_release(vm, n);
+		++work;
+	}
+	cc->nnodes = 0;
+	cc->phase = EEL_CCP_IDLE;
+	return work;
+}
+
+
+/*----------------------------------------------------------
+	Setup and shutdown
+----------------------------------------------------------*/
+
+void eel_cc_shutdown(EEL_vm *vm)
+{
+	EEL_cycles *cc = &VMP->cc;
+	cc->closed = 1;
+	cc_abort(vm);
+	cc_unbuffer(vm, cc->roots, cc->nroots);
+	cc->nroots = 0;
+}
+
+
+void eel_cc_close(EEL_vm *vm)
+{
+	EEL_cycles *cc = &VMP->cc;
+	cc_unbuffer(vm, cc->roots, cc->nroots);
+	cc_unbuffer(vm, cc->taken, cc->ntaken);
+	eel_free(vm, cc->roots);
+	eel_free(vm, cc->taken);
+	eel_free(vm, cc->nodes);
+	eel_free(vm, cc->stack);
+	memset(cc, 0, sizeof(EEL_cycles));
+}
+
+#endif /* EEL_CYCLE_COLLECTOR */
+
+
+int eel_collect_cycles(EEL_vm *vm, int budget)
+{
+#ifdef EEL_CYCLE_COLLECTOR
+	EEL_cycles *cc = &VMP->cc;
+	int started = 0;
+	int work = 0;
+	if(cc->closed)
+		return 0;
+	if(cc->busy)
+		return 1;	/* Called from a destructor or something */
+	cc->busy = 1;
+	if(budget <= 0)
+		budget = INT_MAX;
+	while(work < budget)
+	{
+		EEL_object **r;
+		int n;
+		switch(cc->phase)
+		{
+		  case EEL_CCP_IDLE:
+			/* Start at most one new collection per call */
+			if(started || !cc->nroots)
+			{
+				budget = 0;
+				break;
+			}
+			started = 1;
+			r = cc->taken;
+			cc->taken = cc->roots;
+			cc->roots = r;
+			n = cc->maxtaken;
+			cc->maxtaken = cc->maxroots;
+			cc->maxroots = n;
+			cc->ntaken = cc->nroots;
+			cc->nroots = 0;
+			cc->phase = EEL_CCP_ROOTS;
+			break;
+		  case EEL_CCP_ROOTS:
+			work += cc_roots(vm, budget - work);
+			break;
+		  case EEL_CCP_SCAN:
+			work += cc_scan(vm, budget - work);
+			break;
+		  case EEL_CCP_LIVE:
+			work += cc_live(vm, budget - work);
+			break;
+		  case EEL_CCP_PROPAGATE:
+			work += cc_propagate(vm, budget - work);
+			if((cc->pos < 0) && !cc->nstack)
+			{
+				cc->phase = EEL_CCP_GATHER;
+				cc->pos = 0;
+			}
+			break;
+		  case EEL_CCP_GATHER:
+			work += cc_gather(vm, budget - work);
+			break;
+		  case EEL_CCP_VERIFY:
+			work += cc_verify(vm);
+			break;
+		  case EEL_CCP_FREE:
+			work += cc_free(vm, budget - work);
+			break;
+		}
+	}
+	cc->busy = 0;
+	return (cc->phase != EEL_CCP_IDLE) || (cc->nroots > 0);
+#else
+	return 0;
+#endif
+}
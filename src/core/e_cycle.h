@@ -0,0 +1,138 @@
+/*
+---------------------------------------------------------------------------
+	e_cycle.h - EEL reference cycle collector
+---------------------------------------------------------------------------
+ * Copyright 2026 The EEL contributors
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the
+ * use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef	EEL_E_CYCLE_H
+#define	EEL_E_CYCLE_H
+
+#include "e_eel.h"
+
+/*
+ * Trial deletion cycle collector for tables and arrays.
+ *
+ * Whenever the refcount of a table or array is decremented to a non-zero
+ * value, the object may have just become part of a garbage cycle, so it is
+ * put in the candidate root buffer. eel_collect_cycles() then works through
+ * a few phases, a budgeted slice at a time:
+ *
+ *	ROOTS		Candidates are taken from the buffer and turned into
+ *			"nodes". Each node holds a reference to its object,
+ *			so that nodes can't be destroyed under our feet
+ *			between steps.
+ *	SCAN		All tables and arrays reachable from the nodes are
+ *			added as nodes as well, and references between nodes
+ *			are counted.
+ *	LIVE		Nodes with more references than the ones from other
+ *			nodes (and ours) are referenced from elsewhere, and
+ *			thus live...
+ *	PROPAGATE	...as is everything they reference.
+ *	GATHER		The nodes that are not live are listed.
+ *	VERIFY		As the VM may have been running between the steps, the
+ *			listed nodes are checked again, in one go, against
+ *			the current contents and refcounts. What is still not
+ *			live after this is garbage.
+ *	FREE		The garbage nodes are emptied, and all node references
+ *			are released, which has the garbage destroyed.
+ *
+ * Unlike the textbook version of the algorithm, the real refcounts are never
+ * touched, which is what allows the VM to run between steps.
+ *
+ * The node flag and index are kept in the object block header (see e_slab.h),
+ * so that finding the node of an object is O(1). While an object is a node,
+ * the header 'size' field holds the node index, and the real value is kept in
+ * the node.
+ *
+ * An object that is destroyed while in a candidate buffer is marked DEAD, and
+ * its memory is kept until the collector (or buffer compaction) gets to it.
+ */
+
+/* Object block header flags */
+#define	EEL_CCF_BUFFERED	0x0001	/* In a candidate buffer */
+#define	EEL_CCF_DEAD		0x0002	/* Destroyed while buffered */
+#define	EEL_CCF_NODE		0x0004	/* Node of the current collection */
+
+#ifdef EEL_CYCLE_COLLECTOR
+
+typedef enum
+{
+	EEL_CCP_IDLE = 0,
+	EEL_CCP_ROOTS,
+	EEL_CCP_SCAN,
+	EEL_CCP_LIVE,
+	EEL_CCP_PROPAGATE,
+	EEL_CCP_GATHER,
+	EEL_CCP_VERIFY,
+	EEL_CCP_FREE
+} EEL_ccphases;
+
+typedef struct
+{
+	EEL_object	*o;
+	int		size;		/* Real header 'size' of 'o' */
+	int		internal;	/* References from other nodes */
+	int		live;		/* Referenced from outside the nodes */
+} EEL_ccnode;
+
+typedef struct
+{
+	/* Candidate roots */
+	EEL_object	**roots;	/* Candidate buffer */
+	int		nroots;
+	int		maxroots;
+	EEL_object	**taken;	/* Candidates of the current collection */
+	int		ntaken;
+	int		maxtaken;
+
+	/* Collection in progress */
+	EEL_ccphases	phase;
+	EEL_ccnode	*nodes;
+	int		nnodes;
+	int		maxnodes;
+	int		*stack;		/* Live nodes to propagate from */
+	int		nstack;
+	int		*cands;		/* Garbage candidates (after 'stack') */
+	int		ncands;
+	int		maxstack;	/* Size of 'stack' and 'cands' */
+	int		pos;		/* Current node */
+	int		item;		/* Current item of the current node */
+	int		busy;		/* In eel_collect_cycles() */
+	int		closed;		/* eel_cc_shutdown() has been called */
+
+	/* Statistics */
+	long long	frees;		/* Objects freed by the collector */
+} EEL_cycles;
+
+/* Add table or array 'o' to the candidate root buffer. */
+void eel_cc_candidate(EEL_object *o);
+
+/*
+ * Abort any collection in progress, and forget all candidates. Candidates are
+ * no longer tracked after this. Used by eel_close().
+ */
+void eel_cc_shutdown(EEL_vm *vm);
+
+/* Free all collector memory. Used by eel_vm_close(). */
+void eel_cc_close(EEL_vm *vm);
+
+#endif /* EEL_CYCLE_COLLECTOR */
+
+#endif /* EEL_E_CYCLE_H */
@@ -0,0 +1,151 @@
+/*
+---------------------------------------------------------------------------
+	e_defer.c - EEL deferred destruction of large containers
+---------------------------------------------------------------------------
+ * Copyright 2026 The EEL contributors
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the
+ * use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include <limits.h>
+#include <string.h>
+#include "e_object.h"
+#include "e_table.h"
+#include "e_vm.h"
+
+/* Initial size of the queue */
+#define	DQ_MINSIZE	16
+
+
+int eel_defer_queue(EEL_vm *vm, EEL_classes cid, void *items, int count)
+{
+	EEL_deferqueue *dq = &VMP->dq;
+	EEL_deferred *d;
+	if(dq->n >= dq->max)
+	{
+		int max = dq->max ? dq->max * 2 : DQ_MINSIZE;
+		EEL_deferred *q = eel_realloc(vm, dq->q,
+				max * sizeof(EEL_deferred));
+		if(!q)
+			return 0;	/* Out of memory. Destroy right away. */
+		dq->q = q;
+		dq->max = max;
+	}
+	d = dq->q + dq->n++;
+	d->cid = cid;
+	d->items = items;
+	d->count = count;
+	d->pos = 0;
+	dq->pending += count;
+	return 1;
+}
+
+
+/*
+ * Release up to 'budget' queued items. Returns the number of items released.
+ *
+ * NOTE:
+ *	Releasing an item may destroy another large container, which pushes a
+ *	new entry, and may move the queue, so we never hold on to entries!
+ */
+static int dq_drain(EEL_vm *vm, int budget)
+{
+	EEL_deferqueue *dq = &VMP->dq;
+	int work = 0;
+	while(dq->n && (work < budget))
+	{
+		EEL_deferred *d = dq->q + dq->n - 1;
+		if(d->pos >= d->count)
+		{
+			eel_free(vm, d->items);
+			--dq->n;
+			continue;
+		}
+		--dq->pending;
+		++work;
+		if(d->cid == EEL_CTABLE)
+		{
+			EEL_tableitem *ti = (EEL_tableitem *)d->items + d->pos++;
+			eel_v_disown_nz(&ti->key);
+			eel_v_disown_nz(&ti->value);
+		}
+		else
+			eel_v_disown_nz((EEL_value *)d->items + d->pos++);
+	}
+	/* Don't leave finished entries around until the next call */
+	while(dq->n && (dq->q[dq->n - 1].pos >= dq->q[dq->n - 1].count))
+		eel_free(vm, dq->q[--dq->n].items);
+	return work;
+}
+
+
+int eel_defer_destruction(EEL_vm *vm, int minitems)
+{
+	EEL_deferqueue *dq = &VMP->dq;
+	int prev = dq->min;
+	if(VMP->is_closing)
+		return prev;
+	dq->min = minitems > 0 ? minitems : 0;
+	return prev;
+}
+
+
+/* Does the cycle collector have anything to do? */
+static inline int cc_pending(EEL_vm *vm)
+{
+#ifdef EEL_CYCLE_COLLECTOR
+	return !VMP->cc.closed &&
+			((VMP->cc.phase != EEL_CCP_IDLE) || VMP->cc.nroots);
+#else
+	return 0;
+#endif
+}
+
+
+int eel_collect(EEL_vm *vm, int budget)
+{
+	int work;
+	if(budget <= 0)
+	{
+		/* The cycle collector may queue more containers... */
+		dq_drain(vm, INT_MAX);
+		eel_collect_cycles(vm, 0);
+		dq_drain(vm, INT_MAX);
+	}
+	else
+	{
+		work = dq_drain(vm, budget);
+		if(work < budget)
+			eel_collect_cycles(vm, budget - work);
+	}
+	return (VMP->dq.n > 0) || cc_pending(vm);
+}
+
+
+void eel_defer_shutdown(EEL_vm *vm)
+{
+	VMP->dq.min = 0;
+	dq_drain(vm, INT_MAX);
+}
+
+
+void eel_defer_close(EEL_vm *vm)
+{
+	EEL_deferqueue *dq = &VMP->dq;
+	eel_free(vm, dq->q);
+	memset(dq, 0, sizeof(EEL_deferqueue));
+}
@@ -0,0 +1,74 @@
+/*
+---------------------------------------------------------------------------
+	e_defer.h - EEL deferred destruction of large containers
+---------------------------------------------------------------------------
+ * Copyright 2026 The EEL contributors
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the
+ * use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef	EEL_E_DEFER_H
+#define	EEL_E_DEFER_H
+
+#include "e_eel.h"
+
+/*
+ * When enabled (eel_defer_destruction()), tables and arrays with many items
+ * don't release their items when destroyed. Instead, the item storage is
+ * handed over to a per-VM queue, and the container itself goes away as usual.
+ * eel_collect() then releases the queued items a few at a time, and frees the
+ * storage when done.
+ *
+ * The queue is a stack, as releasing items may destroy more large containers,
+ * and it's better to finish those before moving on.
+ */
+
+typedef struct
+{
+	EEL_classes	cid;		/* EEL_CTABLE or EEL_CARRAY */
+	void		*items;		/* EEL_tableitem or EEL_value array */
+	int		count;		/* Number of items */
+	int		pos;		/* Next item to release */
+} EEL_deferred;
+
+typedef struct
+{
+	EEL_deferred	*q;
+	int		n;
+	int		max;
+	int		min;		/* Smallest container to defer, or 0 */
+	long long	pending;	/* Items in the queue */
+} EEL_deferqueue;
+
+/*
+ * Add 'count' items at 'items' of a table or array of class 'cid' to the
+ * queue. Returns 1 on success, or 0 if the queue could not be grown.
+ *
+ * NOTE: Use eel_defer() (e_vm.h), which checks if deferring is enabled first!
+ */
+int eel_defer_queue(EEL_vm *vm, EEL_classes cid, void *items, int count);
+
+/*
+ * Release everything in the queue, and stop deferring destruction. Used by
+ * eel_close().
+ */
+void eel_defer_shutdown(EEL_vm *vm);
+
+/* Free the queue. Used by eel_vm_close(). */
+void eel_defer_close(EEL_vm *vm);
+
+#endif /* EEL_E_DEFER_H */
@@ -185,15 +185,15 @@ static EEL_xno ds_getindex(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	int i;
 
 	/* Cast index to int */
-	switch(op1->classid)
+	switch(EEL_VCLASS(op1))
 	{
 	  case EEL_CBOOLEAN:
 	  case EEL_CINTEGER:
 	  case EEL_CCLASSID:
-		i = op1->integer.v;
+		i = EEL_VINT(op1);
 		break;
 	  case EEL_CREAL:
-		i = floor(op1->real.v);
+		i = floor(EEL_VREAL(op1));
 		break;
 	  default:
 		return EEL_XWRONGTYPE;
@@ -206,8 +206,7 @@ static EEL_xno ds_getindex(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 		return EEL_XHIGHINDEX;
 
 	/* Read value */
-	op2->classid = EEL_CINTEGER;
-	op2->integer.v = ds->buffer[i] & 0xff;	/* Treat as unsigned! */
+	eel_l2v(op2, ds->buffer[i] & 0xff);	/* Treat as unsigned! */
 	return 0;
 }
 
@@ -220,28 +219,27 @@ static EEL_xno ds_in(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	  case EEL_CBOOLEAN:
 	  case EEL_CINTEGER:
 	  case EEL_CCLASSID:
-		return eel_s_char_in(ds->buffer, ds->length, op1->integer.v,
+		return eel_s_char_in(ds->buffer, ds->length, EEL_VINT(op1),
 				op2);
 	  case EEL_CREAL:
 		return eel_s_char_in(ds->buffer, ds->length,
-				floor(op1->real.v), op2);
+				floor(EEL_VREAL(op1)), op2);
 	  case EEL_CSTRING:
 	  {
-		EEL_string *s2 = o2EEL_string(op1->objref.v);
+		EEL_string *s2 = o2EEL_string(eel_v2o(op1));
 		return eel_s_str_in(ds->buffer, ds->length,
 				s2->buffer, s2->length, op2);
 	  }
 	  case EEL_CDSTRING:
 	  {
 		EEL_dstring *s2;
-		if(op1->objref.v == eo)
+		if(eel_v2o(op1) == eo)
 		{
 			/* Same instance! */
-			op2->classid = EEL_CINTEGER;
-			op2->integer.v = 0;
+			eel_l2v(op2, 0);
 			return 0;
 		}
-		s2 = o2EEL_dstring(op1->objref.v);
+		s2 = o2EEL_dstring(eel_v2o(op1));
 		return eel_s_str_in(ds->buffer, ds->length,
 				s2->buffer, s2->length, op2);
 	  }
@@ -274,15 +272,15 @@ static inline EEL_xno ds_set_index(EEL_object *eo, int i, EEL_value *op2)
 static EEL_xno ds_setindex(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
 	int i;
-	switch(op1->classid)
+	switch(EEL_VCLASS(op1))
 	{
 	  case EEL_CBOOLEAN:
 	  case EEL_CINTEGER:
 	  case EEL_CCLASSID:
-		i = op1->integer.v;
+		i = EEL_VINT(op1);
 		break;
 	  case EEL_CREAL:
-		i = floor(op1->real.v);
+		i = floor(EEL_VREAL(op1));
 		break;
 	  default:
 		return EEL_XWRONGTYPE;
@@ -321,15 +319,15 @@ static EEL_xno ds_insert(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	char cb[1];
 
 	/* Index */
-	switch(op1->classid)
+	switch(EEL_VCLASS(op1))
 	{
 	  case EEL_CBOOLEAN:
 	  case EEL_CINTEGER:
 	  case EEL_CCLASSID:
-		i = op1->integer.v;
+		i = EEL_VINT(op1);
 		break;
 	  case EEL_CREAL:
-		i = floor(op1->real.v);
+		i = floor(EEL_VREAL(op1));
 		break;
 	  default:
 		return EEL_XWRONGTYPE;
@@ -342,14 +340,14 @@ static EEL_xno ds_insert(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	{
 	  case EEL_CSTRING:
 	  {
-		EEL_string *s2 = o2EEL_string(op2->objref.v);
+		EEL_string *s2 = o2EEL_string(eel_v2o(op2));
 		s2buf = s2->buffer;
 		s2len = s2->length;
 		break;
 	  }
 	  case EEL_CDSTRING:
 	  {
-		EEL_dstring *ds2 = o2EEL_dstring(op2->objref.v);
+		EEL_dstring *ds2 = o2EEL_dstring(eel_v2o(op2));
 		s2buf = ds2->buffer;
 		s2len = ds2->length;
 		break;
@@ -396,6 +394,7 @@ static EEL_xno ds_delete(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 
 static EEL_xno ds_copy(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
+	EEL_object *o;
 	EEL_dstring *s = o2EEL_dstring(eo);
 	int start = eel_v2l(op1);
 	int length = eel_v2l(op2);
@@ -407,18 +406,17 @@ static EEL_xno ds_copy(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 		return EEL_XWRONGINDEX;
 	else if(start + length > s->length)
 		return EEL_XHIGHINDEX;
-	op2->objref.v = ds_nnew(eo->vm, s->buffer + start, length);
-	if(!op2->objref.v)
+	o = ds_nnew(eo->vm, s->buffer + start, length);
+	if(!o)
 		return EEL_XCONSTRUCTOR;
-	op2->classid = EEL_COBJREF;
+	eel_o2v(op2, o);
 	return 0;
 }
 
 
 static EEL_xno ds_length(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
-	op2->classid = EEL_CINTEGER;
-	op2->integer.v = o2EEL_dstring(eo)->length;
+	eel_l2v(op2, o2EEL_dstring(eo)->length);
 	return 0;
 }
 
@@ -428,15 +426,14 @@ static EEL_xno ds_compare(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	EEL_dstring *ds;
 	const char *s2buf;
 	int s2len;
-	if(!EEL_IS_OBJREF(op1->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(op1)))
 		return EEL_XWRONGTYPE;
-	op2->classid = EEL_CINTEGER;
 
-	switch(op1->objref.v->classid)
+	switch(eel_v2o(op1)->classid)
 	{
 	  case EEL_CSTRING:
 	  {
-		EEL_string *s2 = o2EEL_string(op1->objref.v);
+		EEL_string *s2 = o2EEL_string(eel_v2o(op1));
 		s2buf = s2->buffer;
 		s2len = s2->length;
 		break;
@@ -444,13 +441,13 @@ static EEL_xno ds_compare(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	  case EEL_CDSTRING:
 	  {
 		EEL_dstring *s2;
-		if(op1->objref.v == eo)
+		if(eel_v2o(op1) == eo)
 		{
 			/* Same instance! */
-			op2->integer.v = 0;
+			eel_l2v(op2, 0);
 			return 0;
 		}
-		s2 = o2EEL_dstring(op1->objref.v);
+		s2 = o2EEL_dstring(eel_v2o(op1));
 		s2buf = s2->buffer;
 		s2len = s2->length;
 		break;
@@ -462,53 +459,49 @@ static EEL_xno ds_compare(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	ds = o2EEL_dstring(eo);
 	if(ds->length > s2len)
 	{
-		op2->integer.v = 1;
+		eel_l2v(op2, 1);
 		return 0;
 	}
 	else if(ds->length < s2len)
 	{
-		op2->integer.v = -1;
+		eel_l2v(op2, -1);
 		return 0;
 	}
-	op2->integer.v = eel_s_cmp((unsigned char *)ds->buffer,
-			(unsigned const char *)s2buf, s2len);
+	eel_l2v(op2, eel_s_cmp((unsigned char *)ds->buffer,
+			(unsigned const char *)s2buf, s2len));
 	return 0;
 }
 
 
 static EEL_xno ds_eq(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
-	switch(op1->classid)
+	switch(EEL_VCLASS(op1))
 	{
 	  case EEL_CNIL:
 	  case EEL_CREAL:
 	  case EEL_CINTEGER:
 	  case EEL_CBOOLEAN:
 	  case EEL_CCLASSID:
-		op2->classid = EEL_CBOOLEAN;
-		op2->integer.v = 0;
+		eel_b2v(op2, 0);
 		return 0;
 	  case EEL_COBJREF:
 	  case EEL_CWEAKREF:
 	  {
-		EEL_object *o = op1->objref.v;
+		EEL_object *o = eel_v2o(op1);
 		if(o->classid == EEL_CDSTRING)
 		{
-			op2->classid = EEL_CBOOLEAN;
-			op2->integer.v = (eo == o);
+			eel_b2v(op2, (eo == o));
 			return 0;
 		}
 		else if(o->classid == EEL_CSTRING)
 		{
 			ds_compare(eo, op1, op2);
-			op2->classid = EEL_CBOOLEAN;
-			op2->integer.v = (op2->integer.v == 0);
+			eel_b2v(op2, (EEL_VINT(op2) == 0));
 			return 0;
 		}
 		else
 		{
-			op2->classid = EEL_CBOOLEAN;
-			op2->integer.v = 0;
+			eel_b2v(op2, 0);
 			return 0;
 		}
 	  }
@@ -521,7 +514,7 @@ static EEL_xno ds_eq(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 static EEL_xno ds_cast_to_real(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 {
-	EEL_dstring *ds = o2EEL_dstring(src->objref.v);
+	EEL_dstring *ds = o2EEL_dstring(eel_v2o(src));
 	eel_d2v(dst, atof(ds->buffer));
 	return 0;
 }
@@ -530,7 +523,7 @@ static EEL_xno ds_cast_to_real(EEL_vm *vm,
 static EEL_xno ds_cast_to_integer(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 {
-	EEL_dstring *ds = o2EEL_dstring(src->objref.v);
+	EEL_dstring *ds = o2EEL_dstring(eel_v2o(src));
 	eel_l2v(dst, atol(ds->buffer));
 	return 0;
 }
@@ -539,15 +532,14 @@ static EEL_xno ds_cast_to_integer(EEL_vm *vm,
 static EEL_xno ds_cast_to_boolean(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 {
-	EEL_string *ds = o2EEL_string(src->objref.v);
-	dst->classid = EEL_CBOOLEAN;
+	EEL_string *ds = o2EEL_string(eel_v2o(src));
 	if(!strncmp("true", ds->buffer, 4) ||
 			!strncmp("yes", ds->buffer, 3) ||
 			!strncmp("1", ds->buffer, 1) ||
 			!strncmp("on", ds->buffer, 2))
-		dst->integer.v = 1;
+		eel_b2v(dst, 1);
 	else
-		dst->integer.v = 0;
+		eel_b2v(dst, 0);
 	return 0;
 }
 
@@ -555,11 +547,12 @@ static EEL_xno ds_cast_to_boolean(EEL_vm *vm,
 static EEL_xno s_cast_to_string(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 {
-	EEL_dstring *s = o2EEL_dstring(src->objref.v);
-	dst->objref.v = eel_ps_nnew(vm, s->buffer, s->length);
-	if(!dst->objref.v)
+	EEL_object *o;
+	EEL_dstring *s = o2EEL_dstring(eel_v2o(src));
+	o = eel_ps_nnew(vm, s->buffer, s->length);
+	if(!o)
 		return EEL_XMEMORY;
-	dst->classid = EEL_COBJREF;
+	eel_o2v(dst, o);
 	return 0;
 }
 
@@ -568,7 +561,7 @@ static EEL_xno ds_clone(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 
 {
-	EEL_dstring *ds = o2EEL_dstring(src->objref.v);
+	EEL_dstring *ds = o2EEL_dstring(eel_v2o(src));
 	EEL_object *no = ds_nnew(vm, ds->buffer, ds->length);
 	if(!no)
 		return EEL_XCONSTRUCTOR;
@@ -593,7 +586,7 @@ static EEL_xno ds_cast_from_integer(EEL_vm *vm,
 {
 	EEL_object *no;
 	char buf[24];
-	int len = snprintf(buf, sizeof(buf) - 1, "%d", src->integer.v);
+	int len = snprintf(buf, sizeof(buf) - 1, "%d", EEL_VINT(src));
 	if(len >= sizeof(buf))
 		return EEL_XOVERFLOW;
 	buf[sizeof(buf) - 1] = 0;
@@ -610,7 +603,7 @@ static EEL_xno ds_cast_from_real(EEL_vm *vm,
 {
 	EEL_object *no;
 	char buf[64];
-	int len = snprintf(buf, sizeof(buf) - 1, EEL_REAL_FMT, src->real.v);
+	int len = snprintf(buf, sizeof(buf) - 1, EEL_REAL_FMT, EEL_VREAL(src));
 	if(len >= sizeof(buf))
 		return EEL_XOVERFLOW;
 	buf[sizeof(buf) - 1] = 0;
@@ -626,7 +619,7 @@ static EEL_xno ds_cast_from_boolean(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 {
 	EEL_object *no;
-  	if(src->integer.v)
+  	if(EEL_VINT(src))
 		no = ds_nnew(vm, "true", 4);
 	else
 		no = ds_nnew(vm, "false", 5);
@@ -640,7 +633,7 @@ static EEL_xno ds_cast_from_boolean(EEL_vm *vm,
 static EEL_xno ds_cast_from_typeid(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 {
-	EEL_object *no = eel_ds_new(vm, eel_typename(vm, src->integer.v));
+	EEL_object *no = eel_ds_new(vm, eel_typename(vm, EEL_VINT(src)));
 	if(!no)
 		return EEL_XCONSTRUCTOR;
 	eel_o2v(dst, no);
@@ -650,6 +643,7 @@ static EEL_xno ds_cast_from_typeid(EEL_vm *vm,
 
 static EEL_xno ds_add(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
+	EEL_object *o;
 	EEL_dstring *ds1 = o2EEL_dstring(eo);
 	const char *s2buf;
 	int s2len;
@@ -661,14 +655,14 @@ static EEL_xno ds_add(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	{
 	  case EEL_CSTRING:
 	  {
-		EEL_string *s2 = o2EEL_string(op1->objref.v);
+		EEL_string *s2 = o2EEL_string(eel_v2o(op1));
 		s2buf = s2->buffer;
 		s2len = s2->length;
 		break;
 	  }
 	  case EEL_CDSTRING:
 	  {
-		EEL_dstring *ds2 = o2EEL_dstring(op1->objref.v);
+		EEL_dstring *ds2 = o2EEL_dstring(eel_v2o(op1));
 		s2buf = ds2->buffer;
 		s2len = ds2->length;
 		break;
@@ -689,13 +683,13 @@ static EEL_xno ds_add(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	memcpy(buf, ds1->buffer, ds1->length);
 	memcpy(buf + ds1->length, s2buf, s2len);
 	buf[ds1->length + s2len] = 0;
-	op2->objref.v = ds_nnew_grab(eo->vm, buf, ds1->length + s2len);
-	if(!op2->objref.v)
+	o = ds_nnew_grab(eo->vm, buf, ds1->length + s2len);
+	if(!o)
 	{
 		eel_free(eo->vm, buf);
 		return EEL_XCONSTRUCTOR;
 	}
-	op2->classid = EEL_COBJREF;
+	eel_o2v(op2, o);
 	return 0;
 }
 
@@ -711,14 +705,14 @@ static EEL_xno ds_ipadd(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	{
 	  case EEL_CSTRING:
 	  {
-		EEL_string *s2 = o2EEL_string(op1->objref.v);
+		EEL_string *s2 = o2EEL_string(eel_v2o(op1));
 		s2buf = s2->buffer;
 		s2len = s2->length;
 		break;
 	  }
 	  case EEL_CDSTRING:
 	  {
-		EEL_dstring *ds2 = o2EEL_dstring(op1->objref.v);
+		EEL_dstring *ds2 = o2EEL_dstring(eel_v2o(op1));
 		s2buf = ds2->buffer;
 		s2len = ds2->length;
 		break;
@@ -346,7 +346,7 @@ static void vm_msg(EEL_vm *vm, EEL_emtype t,
 		{
 		  case EEL_CINTEGER:
 			eel_msg(es, -1, "Unhandled exception '%s'\n",
-					eel_x_name(vm, VMP->exception.integer.v));
+					eel_x_name(vm, EEL_VINT(&VMP->exception)));
 			break;
 		  case EEL_CSTRING:
 			eel_msg(es, -1, "Unhandled exception \"%s\"\n",
@@ -420,8 +420,8 @@ static void vm_msg(EEL_vm *vm, EEL_emtype t,
 		else
 			eel_msg(es, t, "In some place not a function:\n");
 		eel_msg(es, -1, "Unhandled exception '%s'\n",
-				(VMP->exception.classid == EEL_CINTEGER) ?
-				eel_x_name(vm, VMP->exception.integer.v) :
+				(EEL_VCLASS(&VMP->exception) == EEL_CINTEGER) ?
+				eel_x_name(vm, EEL_VINT(&VMP->exception)) :
 				"<object>");
 		eel_vmsg(es, -1, format, args);
 		if(!statedump)
@@ -29,6 +29,12 @@
 #include "e_platform.h"
 
 
+/*
+ * The registry is shared by all VMs of the process, so that modules can keep
+ * their exception code base in a static variable. Blocks are never removed
+ * while the registry is open, so the strings returned by eel_x_name() and
+ * eel_x_description() remain valid after the lock is released.
+ */
 static EEL_mutex eel_x_mutex;
 
 
@@ -59,7 +65,10 @@ EEL_xno eel_x_open_registry(void)
 	e_x_registry = (EEL_xblock **)calloc(EEL_EXCEPTION_BLOCKS,
 			sizeof(EEL_xblock *));
 	if(!e_x_registry)
+	{
+		eel_mutex_close(&eel_x_mutex);
 		return EEL_XMEMORY;
+	}
 	e_x_registry[0] = (EEL_xblock *)&e_core_xblock;
 	return EEL_XOK;
 }
@@ -75,6 +84,7 @@ static void destroy_xblock(EEL_xblock *xb)
 		if(xb->entries[i].description)
 			free((void *)xb->entries[i].description);
 	}
+	free((void *)xb->entries);
 	free(xb);
 }
 
@@ -102,7 +112,10 @@ static inline const EEL_xentry *get_xentry(EEL_vm *vm, EEL_xno x,
 		*err = "<exception code out of range>";
 		return NULL;
 	}
-	if(!(xb = e_x_registry[block]))
+	eel_mutex_lock(&eel_x_mutex);
+	xb = e_x_registry[block];
+	eel_mutex_unlock(&eel_x_mutex);
+	if(!xb)
 	{
 		*err = "<undefined exception range>";
 		return NULL;
@@ -236,8 +249,14 @@ int eel_x_register(EEL_vm *vm, const EEL_xdef *exceptions)
 	}
 
 	/* If an identical block is already registered, just return that! */
+	eel_mutex_lock(&eel_x_mutex);
 	if((i = already_registered(exceptions, min, max, count)))
-		return e_x_registry[i]->base;
+	{
+		int base = e_x_registry[i]->base;
+		eel_mutex_unlock(&eel_x_mutex);
+		return base;
+	}
+	eel_mutex_unlock(&eel_x_mutex);
 
 	/* Create and fill in exception block! */
 	xb = (EEL_xblock *)calloc(1, sizeof(EEL_xblock));
@@ -274,8 +293,18 @@ int eel_x_register(EEL_vm *vm, const EEL_xdef *exceptions)
 		}
 	}
 
-	/* Install exception block! */
+	/*
+	 * Install exception block! Another thread may have installed the same
+	 * block while we were building ours, so we have to check again.
+	 */
 	eel_mutex_lock(&eel_x_mutex);
+	if((i = already_registered(exceptions, min, max, count)))
+	{
+		int base = e_x_registry[i]->base;
+		eel_mutex_unlock(&eel_x_mutex);
+		destroy_xblock(xb);
+		return base;
+	}
 	for(i = 1; i < EEL_EXCEPTION_BLOCKS; ++i)
 	{
 		if(e_x_registry[i])
@@ -27,6 +27,7 @@
 #include "e_object.h"
 #include "e_string.h"
 #include "e_register.h"
+#include "e_jit.h"
 #if DBGN(1)+0 == 1
 # include <stdio.h>
 #endif
@@ -56,9 +57,17 @@ static EEL_xno f_destruct(EEL_object *eo)
 	if(!(f->common.flags & EEL_FF_CFUNC))
 	{
 		int i;
+#ifdef EEL_VM_JIT
+		/* Needs 'code' and 'dcode' to restore the predecoded code! */
+		eel_jit_free(vm, f);
+#endif
 		eel_free(vm, f->e.lines);
 		eel_free(vm, f->e.code);
+#ifdef EEL_VM_PREDECODE
+		eel_free(vm, f->e.dcode);
+#endif
 		eel_free(vm, f->e.argdefaults);
+		eel_free(vm, f->e.xregions);
 		DBGN(printf("--- Freeing constants of '%s' ---\n",
 				eel_o2s(f->common.name));)
 		for(i = 0; i < f->e.nconstants; ++i)
@@ -76,36 +85,36 @@ static EEL_xno f_getindex(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
 	EEL_function_cd *cd = (EEL_function_cd *)eel_get_classdata(eo->vm,
 			eo->classid);
-	if(!EEL_IS_OBJREF(op1->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(op1)))
 		return EEL_XWRONGINDEX;
-	if(op1->objref.v == cd->i_name)
+	if(eel_v2o(op1) == cd->i_name)
 	{
 		eel_o2v(op2, o2EEL_function(eo)->common.name);
-		eel_o_own(op2->objref.v);
+		eel_o_own(eel_v2o(op2));
 		return 0;
 	}
-	else if(op1->objref.v == cd->i_module)
+	else if(eel_v2o(op1) == cd->i_module)
 	{
 		eel_o2v(op2, o2EEL_function(eo)->common.module);
-		eel_o_own(op2->objref.v);
+		eel_o_own(eel_v2o(op2));
 		return 0;
 	}
-	else if(op1->objref.v == cd->i_results)
+	else if(eel_v2o(op1) == cd->i_results)
 	{
 		eel_l2v(op2, o2EEL_function(eo)->common.results);
 		return 0;
 	}
-	else if(op1->objref.v == cd->i_reqargs)
+	else if(eel_v2o(op1) == cd->i_reqargs)
 	{
 		eel_l2v(op2, o2EEL_function(eo)->common.reqargs);
 		return 0;
 	}
-	else if(op1->objref.v == cd->i_optargs)
+	else if(eel_v2o(op1) == cd->i_optargs)
 	{
 		eel_l2v(op2, o2EEL_function(eo)->common.optargs);
 		return 0;
 	}
-	else if(op1->objref.v == cd->i_tupargs)
+	else if(eel_v2o(op1) == cd->i_tupargs)
 	{
 		eel_l2v(op2, o2EEL_function(eo)->common.tupargs);
 		return 0;
@@ -204,12 +213,12 @@ void eel_function_detach(EEL_function *f)
 	for(i = 0; i < f->e.nconstants; ++i)
 	{
 		EEL_object *o;
-		if(!EEL_IS_OBJREF(f->e.constants[i].classid))
+		if(!EEL_IS_OBJREF(EEL_VCLASS(&f->e.constants[i])))
 			continue;
-		o = f->e.constants[i].objref.v;
+		o = eel_v2o(&f->e.constants[i]);
 		if((o->classid == EEL_CFUNCTION) &&
 				(o2EEL_function(o)->common.module ==
 						f->common.module))
-			f->e.constants[i].classid = EEL_CNIL;
+			eel_nil2v(&f->e.constants[i]);
 	}
 }
@@ -51,7 +51,8 @@ typedef enum
 	EEL_FF_ROOT =		0x0040,
 	EEL_FF_EXPORT =		0x0080,
 	EEL_FF_UPVALUES =	0x0100,
-	EEL_FF_XBLOCK =		0x0200
+	EEL_FF_LEAF =		0x0200,	/* Leaf C function; call c.leaf */
+	EEL_FF_NOJIT =		0x0400	/* Never compile to native code */
 } EEL_funcflags;
 
 /* Common fields */
@@ -64,6 +65,25 @@ typedef enum
 	unsigned char	optargs;	/* # of optional args */	\
 	unsigned char	tupargs;	/* # of args in tuple */
 
+/*
+ * Exception handling region of an EEL function. An exception thrown by the
+ * code in [start, end), or by anything called from there, is handled by
+ * cleaning variables down to 'clean', moving the exception value into
+ * R[xreg] (or dropping it, if 'xreg' is -1), and continuing at 'handler', in
+ * the same call frame. 'untry' regions have a 'handler' of -1, and stop the
+ * search for a handler instead.
+ *
+ * Regions are listed innermost first, so the first region found that covers
+ * a PC is the one that handles exceptions thrown there.
+ */
+typedef struct
+{
+	int	start, end;	/* Code range */
+	int	handler;	/* Handler PC, or -1 for 'untry' */
+	int	clean;		/* Cleaning table level for the handler */
+	int	xreg;		/* Register for 'exception', or -1 */
+} EEL_xregion;
+
 #ifdef	EEL_PROFILING
 #define	EEL_FUNC_DEBUG							\
 	long long	rtime;	/* Time spent in this function */	\
@@ -98,6 +118,17 @@ typedef union
 /* FIXME: Use an EEL_dstring or EEL_vector! */
 		int		codesize;	/* # of bytes */
 		unsigned char	*code;		/* Code */
+#ifdef EEL_VM_PREDECODE
+		EEL_dinstruction *dcode;	/* Pre-decoded code, or NULL */
+#endif
+#ifdef EEL_VM_JIT
+		int		jithot;		/* Calls + backward jumps */
+		EEL_jitcode	*jit;		/* Native code, or NULL */
+#endif
+
+		/* Exception handling */
+		int		nxregions;
+		EEL_xregion	*xregions;	/* try/untry regions */
 
 		/* Debug info */
 		int		nlines;
@@ -108,6 +139,7 @@ typedef union
 		EEL_FUNC_COMMON
 		EEL_FUNC_DEBUG
 		EEL_cfunc_cb	cb;
+		EEL_cleaf_cb	leaf;		/* If EEL_FF_LEAF is set */
 	} c;
 } EEL_function;
 
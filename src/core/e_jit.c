@@ -0,0 +1,1473 @@
+/*
+---------------------------------------------------------------------------
+	e_jit.c - EEL baseline native code compiler (x86-64)
+---------------------------------------------------------------------------
+ * Copyright 2026 The EEL contributors
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the
+ * use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "e_jit.h"
+
+#ifdef EEL_VM_JIT
+
+#include <string.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include "ec_coder.h"
+#include "e_operate.h"
+
+/*
+ * Register usage in native code:
+ *	r8	Register frame (EEL_jitstate.r)
+ *	r9	EEL_jitstate
+ *	rdx	Static variables or arguments, within an instruction
+ *	rax, rcx, rsi, rdi, xmm0..xmm3
+ *		Scratch
+ *
+ * Only caller saved registers are used, and the native code never calls
+ * anything, so there is no stack frame. Entry is through a small prologue
+ * that loads r8 and r9 and jumps to the native code of the instruction to
+ * start at. Exits are "mov eax, <pc>; ret".
+ */
+#define	J_RAX	0
+#define	J_RCX	1
+#define	J_RDX	2
+#define	J_RSI	6
+#define	J_RDI	7
+#define	J_R8	8
+#define	J_R9	9
+
+#define	J_REGS	J_R8
+#define	J_STATE	J_R9
+
+/* Condition codes */
+typedef enum
+{
+	J_CB =	0x2,
+	J_CAE =	0x3,
+	J_CE =	0x4,
+	J_CNE =	0x5,
+	J_CBE =	0x6,
+	J_CA =	0x7,
+	J_CS =	0x8,
+	J_CP =	0xa,
+	J_CNP =	0xb,
+	J_CL =	0xc,
+	J_CGE =	0xd,
+	J_CLE =	0xe,
+	J_CG =	0xf
+} EEL_jitcc;
+
+/* Field offsets in EEL_value */
+#define	J_CID	((int)offsetof(EEL_value, classid))
+#define	J_INT	((int)offsetof(EEL_value, integer.v))
+#define	J_REAL	((int)offsetof(EEL_value, real.v))
+
+/* Offset of register 'r' in the register frame */
+#define	J_R(r)	((int)((r) * sizeof(EEL_value)))
+
+/* Offset of EEL_jitstate field 'x' */
+#define	J_JS(x)	((int)offsetof(EEL_jitstate, x))
+
+typedef enum
+{
+	EEL_JF_PC,	/* Jump to native code of VM instruction */
+	EEL_JF_EXIT	/* Jump to exit stub for VM instruction */
+} EEL_jitfixkind;
+
+typedef struct
+{
+	EEL_jitfixkind	kind;
+	int		pos;	/* Position of rel32 field */
+	int		pc;	/* Target VM instruction */
+} EEL_jitfixup;
+
+typedef struct
+{
+	EEL_vm		*vm;
+	EEL_function	*f;
+	int		pc;		/* Instruction being compiled */
+	unsigned char	*buf;		/* Code buffer */
+	int		pos;		/* Current position in 'buf' */
+	int		size;		/* Size of 'buf' */
+	int		failed;		/* Out of memory! */
+	int		*pcpos;		/* pc ==> native code offset */
+	int		*exitpos;	/* pc ==> exit stub offset, or -1 */
+	EEL_jitfixup	*fixups;
+	int		nfixups;
+	int		maxfixups;
+} EEL_jitasm;
+
+/* Operand of an arithmetic or comparison template */
+typedef enum
+{
+	EEL_JO_MEM,	/* EEL_value at [base + disp] */
+	EEL_JO_INT,	/* Integer constant */
+	EEL_JO_REAL	/* Real constant */
+} EEL_jitoprkind;
+
+typedef struct
+{
+	EEL_jitoprkind	kind;
+	int		base;
+	int		disp;
+	EEL_integer	i;
+	EEL_real	r;
+} EEL_jitopr;
+
+
+/*----------------------------------------------------------
+	Code buffer and x86-64 encoding
+----------------------------------------------------------*/
+
+static void a_byte(EEL_jitasm *a, int b)
+{
+	if(a->failed)
+	{
+		++a->pos;
+		return;
+	}
+	if(a->pos >= a->size)
+	{
+		int ns = a->size * 2;
+		unsigned char *nb = (unsigned char *)eel_realloc(a->vm,
+				a->buf, ns);
+		if(!nb)
+		{
+			a->failed = 1;
+			++a->pos;
+			return;
+		}
+		a->buf = nb;
+		a->size = ns;
+	}
+	a->buf[a->pos++] = b;
+}
+
+static void a_dword(EEL_jitasm *a, EEL_uint32 v)
+{
+	a_byte(a, v & 0xff);
+	a_byte(a, (v >> 8) & 0xff);
+	a_byte(a, (v >> 16) & 0xff);
+	a_byte(a, (v >> 24) & 0xff);
+}
+
+static void a_patch(EEL_jitasm *a, int pos, int target)
+{
+	EEL_uint32 rel = (EEL_uint32)(target - (pos + 4));
+	if(a->failed)
+		return;
+	a->buf[pos] = rel & 0xff;
+	a->buf[pos + 1] = (rel >> 8) & 0xff;
+	a->buf[pos + 2] = (rel >> 16) & 0xff;
+	a->buf[pos + 3] = (rel >> 24) & 0xff;
+}
+
+/* Optional legacy prefix, REX prefix as needed, and 1..3 opcode bytes */
+static void a_op(EEL_jitasm *a, int prefix, int w, int op, int reg, int rm)
+{
+	int rex = 0x40 | (w ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0);
+	if(prefix)
+		a_byte(a, prefix);
+	if(rex != 0x40)
+		a_byte(a, rex);
+	if(op > 0xffff)
+		a_byte(a, op >> 16);
+	if(op > 0xff)
+		a_byte(a, (op >> 8) & 0xff);
+	a_byte(a, op & 0xff);
+}
+
+/* <op> reg, [base + disp] (Never used with rsp or r12 as the base.) */
+static void a_opm(EEL_jitasm *a, int prefix, int w, int op, int reg,
+		int base, int disp)
+{
+	a_op(a, prefix, w, op, reg, base);
+	if((disp >= -128) && (disp <= 127))
+	{
+		a_byte(a, 0x40 | ((reg & 7) << 3) | (base & 7));
+		a_byte(a, disp & 0xff);
+	}
+	else
+	{
+		a_byte(a, 0x80 | ((reg & 7) << 3) | (base & 7));
+		a_dword(a, (EEL_uint32)disp);
+	}
+}
+
+/* <op> reg, rm */
+static void a_opr(EEL_jitasm *a, int prefix, int w, int op, int reg, int rm)
+{
+	a_op(a, prefix, w, op, reg, rm);
+	a_byte(a, 0xc0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+/* Integer instructions */
+static void a_load(EEL_jitasm *a, int r, int base, int disp)
+{
+	a_opm(a, 0, 0, 0x8b, r, base, disp);		/* mov r32, [m] */
+}
+
+static void a_loadp(EEL_jitasm *a, int r, int base, int disp)
+{
+	a_opm(a, 0, 1, 0x8b, r, base, disp);		/* mov r64, [m] */
+}
+
+static void a_store(EEL_jitasm *a, int r, int base, int disp)
+{
+	a_opm(a, 0, 0, 0x89, r, base, disp);		/* mov [m], r32 */
+}
+
+static void a_storei(EEL_jitasm *a, EEL_uint32 v, int base, int disp)
+{
+	a_opm(a, 0, 0, 0xc7, 0, base, disp);		/* mov dword [m], imm */
+	a_dword(a, v);
+}
+
+static void a_movi(EEL_jitasm *a, int r, EEL_uint32 v)
+{
+	a_op(a, 0, 0, 0xb8 + (r & 7), 0, r);		/* mov r32, imm */
+	a_dword(a, v);
+}
+
+static void a_movi64(EEL_jitasm *a, int r, EEL_uint32 lo, EEL_uint32 hi)
+{
+	a_op(a, 0, 1, 0xb8 + (r & 7), 0, r);		/* mov r64, imm */
+	a_dword(a, lo);
+	a_dword(a, hi);
+}
+
+static void a_cmpmi(EEL_jitasm *a, int base, int disp, EEL_uint32 v)
+{
+	a_opm(a, 0, 0, 0x81, 7, base, disp);		/* cmp dword [m], imm */
+	a_dword(a, v);
+}
+
+static void a_cmpri(EEL_jitasm *a, int r, EEL_uint32 v)
+{
+	a_opr(a, 0, 0, 0x81, 7, r);			/* cmp r32, imm */
+	a_dword(a, v);
+}
+
+static void a_cmprr(EEL_jitasm *a, int r1, int r2)
+{
+	a_opr(a, 0, 0, 0x3b, r1, r2);			/* cmp r1, r2 */
+}
+
+static void a_setcc(EEL_jitasm *a, EEL_jitcc cc, int r)
+{
+	a_opr(a, 0, 0, 0x0f90 + cc, 0, r);		/* setcc r8 */
+}
+
+static void a_movzxb(EEL_jitasm *a, int r, int r8)
+{
+	a_opr(a, 0, 0, 0x0fb6, r, r8);			/* movzx r32, r8 */
+}
+
+/* SSE2 instructions */
+static void a_movsdm(EEL_jitasm *a, int x, int base, int disp)
+{
+	a_opm(a, 0xf2, 0, 0x0f10, x, base, disp);	/* movsd xmm, [m] */
+}
+
+static void a_movsdst(EEL_jitasm *a, int x, int base, int disp)
+{
+	a_opm(a, 0xf2, 0, 0x0f11, x, base, disp);	/* movsd [m], xmm */
+}
+
+static void a_cvtim(EEL_jitasm *a, int x, int base, int disp)
+{
+	a_opm(a, 0xf2, 0, 0x0f2a, x, base, disp);	/* cvtsi2sd xmm, [m] */
+}
+
+static void a_cvtir(EEL_jitasm *a, int x, int r)
+{
+	a_opr(a, 0xf2, 0, 0x0f2a, x, r);		/* cvtsi2sd xmm, r32 */
+}
+
+static void a_sse(EEL_jitasm *a, int op, int x1, int x2)
+{
+	a_opr(a, 0xf2, 0, 0x0f00 + op, x1, x2);		/* <op>sd x1, x2 */
+}
+#define	J_ADDSD	0x58
+#define	J_MULSD	0x59
+#define	J_SUBSD	0x5c
+#define	J_DIVSD	0x5e
+
+static void a_ucomisd(EEL_jitasm *a, int x1, int x2)
+{
+	a_opr(a, 0x66, 0, 0x0f2e, x1, x2);
+}
+
+static void a_xorpd(EEL_jitasm *a, int x1, int x2)
+{
+	a_opr(a, 0x66, 0, 0x0f57, x1, x2);
+}
+
+/* Copy a whole EEL_value, using xmm0 */
+static void a_copyv(EEL_jitasm *a, int dbase, int ddisp, int sbase, int sdisp)
+{
+	a_opm(a, 0xf3, 0, 0x0f6f, 0, sbase, sdisp);	/* movdqu xmm0, [s] */
+	a_opm(a, 0xf3, 0, 0x0f7f, 0, dbase, ddisp);	/* movdqu [d], xmm0 */
+}
+
+
+/*----------------------------------------------------------
+	Branches, labels and exits
+----------------------------------------------------------*/
+
+static void a_fixup(EEL_jitasm *a, EEL_jitfixkind kind, int pc)
+{
+	if(a->nfixups >= a->maxfixups)
+	{
+		int nm = a->maxfixups * 2;
+		EEL_jitfixup *nf = (EEL_jitfixup *)eel_realloc(a->vm,
+				a->fixups, nm * sizeof(EEL_jitfixup));
+		if(!nf)
+		{
+			a->failed = 1;
+			return;
+		}
+		a->fixups = nf;
+		a->maxfixups = nm;
+	}
+	a->fixups[a->nfixups].kind = kind;
+	a->fixups[a->nfixups].pos = a->pos;
+	a->fixups[a->nfixups].pc = pc;
+	++a->nfixups;
+}
+
+/* Forward jumps within a template. Returns the position to a_label(). */
+static int a_jcc(EEL_jitasm *a, EEL_jitcc cc)
+{
+	a_byte(a, 0x0f);
+	a_byte(a, 0x80 + cc);
+	a_dword(a, 0);
+	return a->pos - 4;
+}
+
+static int a_jmp(EEL_jitasm *a)
+{
+	a_byte(a, 0xe9);
+	a_dword(a, 0);
+	return a->pos - 4;
+}
+
+static void a_label(EEL_jitasm *a, int pos)
+{
+	a_patch(a, pos, a->pos);
+}
+
+/* Jump to the native code of VM instruction 'pc' */
+static void a_jcc_pc(EEL_jitasm *a, EEL_jitcc cc, int pc)
+{
+	a_byte(a, 0x0f);
+	a_byte(a, 0x80 + cc);
+	a_fixup(a, EEL_JF_PC, pc);
+	a_dword(a, 0);
+}
+
+static void a_jmp_pc(EEL_jitasm *a, int pc)
+{
+	a_byte(a, 0xe9);
+	a_fixup(a, EEL_JF_PC, pc);
+	a_dword(a, 0);
+}
+
+/*
+ * Leave the native code, having the interpreter run the current instruction.
+ * (Templates must not change anything before bailing out!)
+ */
+static void a_bail(EEL_jitasm *a, EEL_jitcc cc)
+{
+	a_byte(a, 0x0f);
+	a_byte(a, 0x80 + cc);
+	a_fixup(a, EEL_JF_EXIT, a->pc);
+	a_dword(a, 0);
+}
+
+/* Return to the interpreter at 'pc' */
+static void a_exit(EEL_jitasm *a, int pc)
+{
+	a_movi(a, J_RAX, pc);
+	a_byte(a, 0xc3);				/* ret */
+}
+
+
+/*----------------------------------------------------------
+	Operands
+----------------------------------------------------------*/
+
+static void opr_reg(EEL_jitopr *o, int r)
+{
+	o->kind = EEL_JO_MEM;
+	o->base = J_REGS;
+	o->disp = J_R(r);
+}
+
+static void opr_int(EEL_jitopr *o, EEL_integer i)
+{
+	o->kind = EEL_JO_INT;
+	o->i = i;
+}
+
+/* Constant 'v', if it's an integer or a real. Returns 0 otherwise. */
+static int opr_const(EEL_jitopr *o, EEL_value *v)
+{
+	switch(v->classid)
+	{
+	  case EEL_CINTEGER:
+		opr_int(o, EEL_VINT(v));
+		return 1;
+	  case EEL_CREAL:
+		o->kind = EEL_JO_REAL;
+		o->r = EEL_VREAL(v);
+		return 1;
+	  default:
+		return 0;
+	}
+}
+
+/* Load class ID of 'o' into 'r', if it's not a constant */
+static void opr_cid(EEL_jitasm *a, EEL_jitopr *o, int r)
+{
+	if(o->kind == EEL_JO_MEM)
+		a_load(a, r, o->base, o->disp + J_CID);
+}
+
+/*
+ * Load 'o' into 'x' as a real, bailing out if it's not an integer or a real.
+ * 'cid' is the register holding the class ID of 'o', and 'tmp' is a scratch
+ * register.
+ */
+static void opr_loadreal(EEL_jitasm *a, EEL_jitopr *o, int x, int cid,
+		int tmp)
+{
+	int notreal, done;
+	switch(o->kind)
+	{
+	  case EEL_JO_MEM:
+		a_cmpri(a, cid, EEL_CREAL);
+		notreal = a_jcc(a, J_CNE);
+		a_movsdm(a, x, o->base, o->disp + J_REAL);
+		done = a_jmp(a);
+		a_label(a, notreal);
+		a_cmpri(a, cid, EEL_CINTEGER);
+		a_bail(a, J_CNE);
+		a_cvtim(a, x, o->base, o->disp + J_INT);
+		a_label(a, done);
+		break;
+	  case EEL_JO_INT:
+		a_movi(a, tmp, (EEL_uint32)o->i);
+		a_cvtir(a, x, tmp);
+		break;
+	  case EEL_JO_REAL:
+	  {
+		EEL_uint32 w[2];
+		memcpy(w, &o->r, sizeof(w));
+		a_movi64(a, tmp, w[0], w[1]);
+		a_opr(a, 0x66, 1, 0x0f6e, x, tmp);	/* movq xmm, r64 */
+		break;
+	  }
+	}
+}
+
+/* <op> r, o (integer) */
+static void opr_intop(EEL_jitasm *a, int op, int opi, int r, EEL_jitopr *o)
+{
+	if(o->kind == EEL_JO_MEM)
+		a_opm(a, 0, 0, op, r, o->base, o->disp + J_INT);
+	else if(op == 0x0faf)
+	{
+		a_opr(a, 0, 0, 0x69, r, r);		/* imul r, r, imm */
+		a_dword(a, (EEL_uint32)o->i);
+	}
+	else
+	{
+		a_opr(a, 0, 0, 0x81, opi, r);		/* <op> r, imm */
+		a_dword(a, (EEL_uint32)o->i);
+	}
+}
+
+
+
+/*----------------------------------------------------------
+	Instruction templates
+----------------------------------------------------------*/
+
+/* Operators that have templates */
+static int jit_binop(int op)
+{
+	switch(op)
+	{
+	  case EEL_OP_ADD:
+	  case EEL_OP_SUB:
+	  case EEL_OP_MUL:
+#ifdef EEL_PASCAL_IDIV
+	  case EEL_OP_DIV:
+#endif
+	  case EEL_OP_MOD:
+	  case EEL_OP_EQ:
+	  case EEL_OP_NE:
+	  case EEL_OP_GT:
+	  case EEL_OP_GE:
+	  case EEL_OP_LT:
+	  case EEL_OP_LE:
+		return 1;
+	  default:
+		return 0;
+	}
+}
+
+/* Store the result in esi (integer, boolean) or xmm0 (real) in R['dst'] */
+static void t_store(EEL_jitasm *a, EEL_classes cid, int dst)
+{
+	if(cid == EEL_CREAL)
+		a_movsdst(a, 0, J_REGS, J_R(dst) + J_REAL);
+	else
+		a_store(a, J_RSI, J_REGS, J_R(dst) + J_INT);
+	a_storei(a, cid, J_REGS, J_R(dst) + J_CID);
+}
+
+/*
+ * Set esi to 1 if the flags from ucomisd say 'op' is true, otherwise 0.
+ *
+ * NOTE: LT and LE are 'not GE' and 'not GT', as eel_op_lt() and eel_op_le(),
+ *	so they are true for unordered (NaN) operands!
+ */
+static void t_realcond(EEL_jitasm *a, int op)
+{
+	switch(op)
+	{
+	  case EEL_OP_EQ:
+		a_setcc(a, J_CE, J_RAX);
+		a_setcc(a, J_CNP, J_RCX);
+		a_opr(a, 0, 0, 0x20, J_RCX, J_RAX);	/* and al, cl */
+		break;
+	  case EEL_OP_NE:
+		a_setcc(a, J_CNE, J_RAX);
+		a_setcc(a, J_CP, J_RCX);
+		a_opr(a, 0, 0, 0x08, J_RCX, J_RAX);	/* or al, cl */
+		break;
+	  case EEL_OP_GT:
+		a_setcc(a, J_CA, J_RAX);
+		break;
+	  case EEL_OP_GE:
+		a_setcc(a, J_CAE, J_RAX);
+		break;
+	  case EEL_OP_LT:
+		a_setcc(a, J_CB, J_RAX);
+		break;
+	  case EEL_OP_LE:
+		a_setcc(a, J_CBE, J_RAX);
+		break;
+	}
+	a_movzxb(a, J_RSI, J_RAX);
+}
+
+/*
+ * R['dst'] = 'l' <op> 'r', for integer and real operands. 'l' must be an
+ * EEL_JO_MEM operand. If 'dst' is -1, the template only calculates the
+ * result of a comparison operator, leaving it in esi.
+ */
+static void t_binop(EEL_jitasm *a, int op, EEL_jitopr *l, EEL_jitopr *r,
+		int dst)
+{
+	int mixed = -1, mixed2 = -1, done = -1;
+	EEL_classes res;
+	opr_cid(a, l, J_RAX);
+	opr_cid(a, r, J_RCX);
+
+	if(op == EEL_OP_MOD)
+	{
+		/* Integers only. (Real modulo is a libm call.) */
+		a_cmpri(a, J_RAX, EEL_CINTEGER);
+		a_bail(a, J_CNE);
+		if(r->kind == EEL_JO_MEM)
+		{
+			a_cmpri(a, J_RCX, EEL_CINTEGER);
+			a_bail(a, J_CNE);
+			a_load(a, J_RCX, r->base, r->disp + J_INT);
+		}
+		else
+			a_movi(a, J_RCX, (EEL_uint32)r->i);
+		/* Leave x % 0 and x % -1 to the interpreter */
+		a_opr(a, 0, 0, 0x85, J_RCX, J_RCX);	/* test ecx, ecx */
+		a_bail(a, J_CE);
+		a_cmpri(a, J_RCX, (EEL_uint32)-1);
+		a_bail(a, J_CE);
+		a_load(a, J_RAX, l->base, l->disp + J_INT);
+		a_byte(a, 0x99);			/* cdq */
+		a_opr(a, 0, 0, 0xf7, 7, J_RCX);		/* idiv ecx */
+		a_opr(a, 0, 0, 0x8b, J_RSI, J_RDX);	/* mov esi, edx */
+		t_store(a, EEL_CINTEGER, dst);
+		return;
+	}
+
+	/* integer <op> integer */
+	if((op != EEL_OP_DIV) && (r->kind != EEL_JO_REAL))
+	{
+		a_cmpri(a, J_RAX, EEL_CINTEGER);
+		mixed = a_jcc(a, J_CNE);
+		if(r->kind == EEL_JO_MEM)
+		{
+			a_cmpri(a, J_RCX, EEL_CINTEGER);
+			mixed2 = a_jcc(a, J_CNE);
+		}
+		a_load(a, J_RSI, l->base, l->disp + J_INT);
+		switch(op)
+		{
+		  case EEL_OP_ADD:
+			opr_intop(a, 0x03, 0, J_RSI, r);
+			res = EEL_CINTEGER;
+			break;
+		  case EEL_OP_SUB:
+			opr_intop(a, 0x2b, 5, J_RSI, r);
+			res = EEL_CINTEGER;
+			break;
+		  case EEL_OP_MUL:
+			opr_intop(a, 0x0faf, 0, J_RSI, r);
+			res = EEL_CINTEGER;
+			break;
+		  default:
+			opr_intop(a, 0x3b, 7, J_RSI, r);	/* cmp */
+			switch(op)
+			{
+			  case EEL_OP_EQ: a_setcc(a, J_CE, J_RAX); break;
+			  case EEL_OP_NE: a_setcc(a, J_CNE, J_RAX); break;
+			  case EEL_OP_GT: a_setcc(a, J_CG, J_RAX); break;
+			  case EEL_OP_GE: a_setcc(a, J_CGE, J_RAX); break;
+			  case EEL_OP_LT: a_setcc(a, J_CL, J_RAX); break;
+			  case EEL_OP_LE: a_setcc(a, J_CLE, J_RAX); break;
+			}
+			a_movzxb(a, J_RSI, J_RAX);
+			res = EEL_CBOOLEAN;
+			break;
+		}
+		if(dst >= 0)
+			t_store(a, res, dst);
+		done = a_jmp(a);
+		a_label(a, mixed);
+		if(mixed2 >= 0)
+			a_label(a, mixed2);
+	}
+
+	/* Real or mixed operands */
+	opr_loadreal(a, l, 0, J_RAX, J_RDI);
+	opr_loadreal(a, r, 1, J_RCX, J_RDI);
+	switch(op)
+	{
+	  case EEL_OP_ADD:
+		a_sse(a, J_ADDSD, 0, 1);
+		res = EEL_CREAL;
+		break;
+	  case EEL_OP_SUB:
+		a_sse(a, J_SUBSD, 0, 1);
+		res = EEL_CREAL;
+		break;
+	  case EEL_OP_MUL:
+		a_sse(a, J_MULSD, 0, 1);
+		res = EEL_CREAL;
+		break;
+	  case EEL_OP_DIV:
+	  {
+		/* Leave division by zero to the interpreter */
+		int nan;
+		a_xorpd(a, 2, 2);
+		a_ucomisd(a, 1, 2);
+		nan = a_jcc(a, J_CP);
+		a_bail(a, J_CE);
+		a_label(a, nan);
+		a_sse(a, J_DIVSD, 0, 1);
+		res = EEL_CREAL;
+		break;
+	  }
+	  default:
+		a_ucomisd(a, 0, 1);
+		t_realcond(a, op);
+		res = EEL_CBOOLEAN;
+		break;
+	}
+	if(dst >= 0)
+		t_store(a, res, dst);
+	if(done >= 0)
+		a_label(a, done);
+}
+
+/* Set esi to the truth value of the EEL_value at [base + disp] */
+static void t_test_nz(EEL_jitasm *a, int base, int disp)
+{
+	int done1, done2, done3, real;
+	a_load(a, J_RAX, base, disp + J_CID);
+	a_movi(a, J_RSI, 0);
+	a_cmpri(a, J_RAX, EEL_CNIL);
+	done1 = a_jcc(a, J_CE);
+	a_movi(a, J_RSI, 1);
+	a_cmpri(a, J_RAX, EEL_CBOOLEAN);
+	done2 = a_jcc(a, J_CA);			/* Class IDs and objects */
+	a_cmpri(a, J_RAX, EEL_CREAL);
+	real = a_jcc(a, J_CE);
+	a_cmpmi(a, base, disp + J_INT, 0);	/* Integer or boolean */
+	a_setcc(a, J_CNE, J_RAX);
+	a_movzxb(a, J_RSI, J_RAX);
+	done3 = a_jmp(a);
+	a_label(a, real);
+	a_movsdm(a, 0, base, disp + J_REAL);
+	a_xorpd(a, 1, 1);
+	a_ucomisd(a, 0, 1);
+	t_realcond(a, EEL_OP_NE);
+	a_label(a, done1);
+	a_label(a, done2);
+	a_label(a, done3);
+}
+
+/* Branch to 'target' if esi is (nz) or isn't (!nz) zero */
+static void t_branch_esi(EEL_jitasm *a, int nz, int target)
+{
+	a_opr(a, 0, 0, 0x85, J_RSI, J_RSI);		/* test esi, esi */
+	a_jcc_pc(a, nz ? J_CNE : J_CE, target);
+}
+
+/* Bail out if the EEL_value at [base + disp] is not a value type */
+static void t_needvalue(EEL_jitasm *a, int base, int disp)
+{
+	a_cmpmi(a, base, disp + J_CID, EEL_COBJREF);
+	a_bail(a, J_CAE);
+}
+
+/* Bail out unless R['r'] is of class 'cid' */
+static void t_needclass(EEL_jitasm *a, int r, EEL_classes cid)
+{
+	a_cmpmi(a, J_REGS, J_R(r) + J_CID, cid);
+	a_bail(a, J_CNE);
+}
+
+/* Load 'rdx' from field 'offs' of the EEL_jitstate */
+static void t_state(EEL_jitasm *a, int offs)
+{
+	a_loadp(a, J_RDX, J_STATE, offs);
+}
+
+/* ADDCLEAN(r) */
+static void t_addclean(EEL_jitasm *a, int r)
+{
+	t_state(a, J_JS(ctab));
+	a_opm(a, 0, 0, 0x0fb6, J_RAX, J_RDX, 0);	/* movzx eax, [rdx] */
+	a_opr(a, 0, 0, 0x81, 0, J_RAX);			/* add eax, 1 */
+	a_dword(a, 1);
+	a_opm(a, 0, 0, 0x88, J_RAX, J_RDX, 0);		/* mov [rdx], al */
+	a_byte(a, 0xc6);				/* mov [rdx + rax], r */
+	a_byte(a, 0x04);
+	a_byte(a, 0x02);
+	a_byte(a, r & 0xff);
+}
+
+/* R['r'] = <value type> */
+static void t_setvalue(EEL_jitasm *a, int r, EEL_classes cid, EEL_integer v)
+{
+	a_storei(a, cid, J_REGS, J_R(r) + J_CID);
+	if(cid != EEL_CNIL)
+		a_storei(a, (EEL_uint32)v, J_REGS, J_R(r) + J_INT);
+}
+
+/* Load the address of constant 'c' into rdx */
+static void t_constant(EEL_jitasm *a, EEL_value *c)
+{
+	size_t p = (size_t)c;
+	a_movi64(a, J_RDX, (EEL_uint32)p, (EEL_uint32)(p >> 32));
+}
+
+/*
+ * Real for loop. Loops (jumps to 'target') or, if 'pre', skips the loop, if
+ * the xmm0/xmm1/xmm2 (counter/step/limit) say so.
+ */
+static void t_realloop(EEL_jitasm *a, int pre, int target)
+{
+	int pos, neg, end;
+	a_xorpd(a, 3, 3);
+	a_ucomisd(a, 1, 3);
+	pos = a_jcc(a, J_CP);
+	neg = a_jcc(a, J_CB);
+	a_label(a, pos);
+	a_ucomisd(a, 0, 2);		/* step >= 0: stop if counter > limit */
+	a_jcc_pc(a, pre ? J_CA : J_CBE, target);
+	end = a_jmp(a);
+	a_label(a, neg);
+	a_ucomisd(a, 2, 0);		/* step < 0: stop if counter < limit */
+	a_jcc_pc(a, pre ? J_CA : J_CBE, target);
+	a_label(a, end);
+}
+
+/* Load the counter, step and limit of a real for loop into xmm0..xmm2 */
+static void t_loadloop(EEL_jitasm *a, int ra, int rb, int rc)
+{
+	a_movsdm(a, 0, J_REGS, J_R(ra) + J_REAL);
+	a_movsdm(a, 1, J_REGS, J_R(rb) + J_REAL);
+	a_movsdm(a, 2, J_REGS, J_R(rc) + J_REAL);
+}
+
+/* ILOOP, integer version. Jumps to 'noint' if R[A] or R[B] is not integer. */
+static void t_iloop(EEL_jitasm *a, int ra, int rb, int rc, int target,
+		int *noint, int *noint2)
+{
+	int neg, end1, end2, end3, end4;
+	a_cmpmi(a, J_REGS, J_R(ra) + J_CID, EEL_CINTEGER);
+	*noint = a_jcc(a, J_CNE);
+	a_cmpmi(a, J_REGS, J_R(rb) + J_CID, EEL_CINTEGER);
+	*noint2 = a_jcc(a, J_CNE);
+	a_load(a, J_RAX, J_REGS, J_R(ra) + J_INT);	/* i */
+	a_load(a, J_RCX, J_REGS, J_R(rb) + J_INT);	/* step */
+	a_load(a, J_RDX, J_REGS, J_R(rc) + J_INT);	/* limit */
+	a_opr(a, 0, 0, 0x8b, J_RSI, J_RAX);		/* mov esi, eax */
+	a_opr(a, 0, 0, 0x03, J_RSI, J_RCX);		/* add esi, ecx */
+	a_store(a, J_RSI, J_REGS, J_R(ra) + J_INT);
+	a_opr(a, 0, 0, 0x85, J_RCX, J_RCX);		/* test ecx, ecx */
+	neg = a_jcc(a, J_CS);
+	a_cmprr(a, J_RAX, J_RDX);			/* i > limit? */
+	end1 = a_jcc(a, J_CG);
+	a_opr(a, 0, 0, 0x8b, J_RSI, J_RDX);		/* limit - i < step? */
+	a_opr(a, 0, 0, 0x2b, J_RSI, J_RAX);
+	a_cmprr(a, J_RSI, J_RCX);
+	end2 = a_jcc(a, J_CB);
+	a_jmp_pc(a, target);
+	a_label(a, neg);
+	a_cmprr(a, J_RAX, J_RDX);			/* i < limit? */
+	end3 = a_jcc(a, J_CL);
+	a_opr(a, 0, 0, 0x8b, J_RSI, J_RAX);		/* i - limit < -step? */
+	a_opr(a, 0, 0, 0x2b, J_RSI, J_RDX);
+	a_opr(a, 0, 0, 0xf7, 3, J_RCX);			/* neg ecx */
+	a_cmprr(a, J_RSI, J_RCX);
+	end4 = a_jcc(a, J_CB);
+	a_jmp_pc(a, target);
+	a_label(a, end1);
+	a_label(a, end2);
+	a_label(a, end3);
+	a_label(a, end4);
+}
+
+/* Operator of a conditional jump instruction */
+static int jump_op(EEL_opcodes op)
+{
+	switch(op)
+	{
+	  case EEL_OJUMPEQ_ABsCx:	return EEL_OP_EQ;
+	  case EEL_OJUMPNE_ABsCx:	return EEL_OP_NE;
+	  case EEL_OJUMPGE_ABsCx:	return EEL_OP_GE;
+	  case EEL_OJUMPLE_ABsCx:	return EEL_OP_LE;
+	  case EEL_OJUMPGT_ABsCx:	return EEL_OP_GT;
+	  case EEL_OJUMPLT_ABsCx:	return EEL_OP_LT;
+	  default:			return -1;
+	}
+}
+
+/*
+ * Generate native code for the instruction at 'a->pc'.
+ *
+ * Returns 0 without generating any code if the instruction has no template.
+ */
+static int jit_instruction(EEL_jitasm *a)
+{
+	EEL_function *f = a->f;
+	unsigned char *ins = f->e.code + a->pc;
+	int next = a->pc + eel_i_size(ins[0]);
+	EEL_jitopr l, r;
+	switch((EEL_opcodes)ins[0])
+	{
+	  case EEL_ONOP_0:
+		return 1;
+
+	  /* Local flow control */
+	  case EEL_OJUMP_sAx:
+	  {
+		EEL_OPR_sAx(ins)
+		if(!(next + A - a->pc))
+			return 0;	/* Leave infinite loops to the VM */
+		a_jmp_pc(a, next + A);
+		return 1;
+	  }
+	  case EEL_OJUMPZ_AsBx:
+	  case EEL_OJUMPNZ_AsBx:
+	  {
+		EEL_OPR_AsBx(ins)
+		if(!(next + B - a->pc))
+			return 0;
+		t_test_nz(a, J_REGS, J_R(A));
+		t_branch_esi(a, ins[0] == EEL_OJUMPNZ_AsBx, next + B);
+		return 1;
+	  }
+	  case EEL_OJUMPEQ_ABsCx:
+	  case EEL_OJUMPNE_ABsCx:
+	  case EEL_OJUMPGE_ABsCx:
+	  case EEL_OJUMPLE_ABsCx:
+	  case EEL_OJUMPGT_ABsCx:
+	  case EEL_OJUMPLT_ABsCx:
+	  {
+		EEL_OPR_ABsCx(ins)
+		if(!(next + C - a->pc))
+			return 0;
+		opr_reg(&l, A);
+		opr_reg(&r, B);
+		t_binop(a, jump_op((EEL_opcodes)ins[0]), &l, &r, -1);
+		t_branch_esi(a, 1, next + C);
+		return 1;
+	  }
+	  case EEL_OJUMPZARGI_AsBx:
+	  case EEL_OJUMPNZARGI_AsBx:
+	  {
+		EEL_OPR_AsBx(ins)
+		if(!(next + B - a->pc))
+			return 0;
+		/* Leave default arguments to the VM */
+		a_cmpmi(a, J_STATE, J_JS(argc), A);
+		a_bail(a, J_CBE);
+		t_state(a, J_JS(args));
+		t_test_nz(a, J_RDX, J_R(A));
+		t_branch_esi(a, ins[0] == EEL_OJUMPNZARGI_AsBx, next + B);
+		return 1;
+	  }
+	  case EEL_OPRELOOP_ABCsDx:
+	  {
+		EEL_OPR_ABCsDx(ins)
+		t_needclass(a, A, EEL_CREAL);
+		t_needclass(a, B, EEL_CREAL);
+		t_needclass(a, C, EEL_CREAL);
+		t_loadloop(a, A, B, C);
+		t_realloop(a, 1, next + D);
+		return 1;
+	  }
+	  case EEL_OLOOP_ABCsDx:
+	  {
+		EEL_OPR_ABCsDx(ins)
+		/* PRELOOP has made sure that the step and limit are real */
+		t_needclass(a, A, EEL_CREAL);
+		t_loadloop(a, A, B, C);
+		a_sse(a, J_ADDSD, 0, 1);
+		a_movsdst(a, 0, J_REGS, J_R(A) + J_REAL);
+		t_realloop(a, 0, next + D);
+		return 1;
+	  }
+	  case EEL_OIPRELOOP_ABCsDx:
+	  {
+		int neg, end;
+		EEL_OPR_ABCsDx(ins)
+		t_needclass(a, A, EEL_CINTEGER);
+		t_needclass(a, B, EEL_CINTEGER);
+		t_needclass(a, C, EEL_CINTEGER);
+		a_load(a, J_RAX, J_REGS, J_R(A) + J_INT);
+		a_cmpmi(a, J_REGS, J_R(B) + J_INT, 0);
+		neg = a_jcc(a, J_CL);
+		a_opm(a, 0, 0, 0x3b, J_RAX, J_REGS, J_R(C) + J_INT);
+		a_jcc_pc(a, J_CG, next + D);
+		end = a_jmp(a);
+		a_label(a, neg);
+		a_opm(a, 0, 0, 0x3b, J_RAX, J_REGS, J_R(C) + J_INT);
+		a_jcc_pc(a, J_CL, next + D);
+		a_label(a, end);
+		return 1;
+	  }
+	  case EEL_OILOOP_ABCsDx:
+	  {
+		int noint, noint2, end;
+		EEL_OPR_ABCsDx(ins)
+		t_iloop(a, A, B, C, next + D, &noint, &noint2);
+		end = a_jmp(a);
+		a_label(a, noint);
+		a_label(a, noint2);
+		/* Real loop, as set up by IPRELOOP */
+		t_needclass(a, A, EEL_CREAL);
+		t_needclass(a, B, EEL_CREAL);
+		t_needclass(a, C, EEL_CREAL);
+		t_loadloop(a, A, B, C);
+		a_sse(a, J_ADDSD, 0, 1);
+		a_movsdst(a, 0, J_REGS, J_R(A) + J_REAL);
+		t_realloop(a, 0, next + D);
+		a_label(a, end);
+		return 1;
+	  }
+
+	  /* Immediate values, constants etc */
+	  case EEL_OLDI_AsBx:
+	  {
+		EEL_OPR_AsBx(ins)
+		t_setvalue(a, A, EEL_CINTEGER, B);
+		return 1;
+	  }
+	  case EEL_OLDTRUE_A:
+	  case EEL_OLDFALSE_A:
+	  {
+		EEL_OPR_A(ins)
+		t_setvalue(a, A, EEL_CBOOLEAN, ins[0] == EEL_OLDTRUE_A);
+		return 1;
+	  }
+	  case EEL_OLDNIL_A:
+	  {
+		EEL_OPR_A(ins)
+		t_setvalue(a, A, EEL_CNIL, 0);
+		return 1;
+	  }
+	  case EEL_OLDC_ABx:
+	  {
+		EEL_OPR_ABx(ins)
+		if(f->e.constants[B].classid == EEL_CWEAKREF)
+			return 0;
+		t_constant(a, &f->e.constants[B]);
+		a_copyv(a, J_REGS, J_R(A), J_RDX, 0);
+		return 1;
+	  }
+
+	  /* Register access */
+	  case EEL_OMOVE_AB:
+	  {
+		EEL_OPR_AB(ins)
+		a_cmpmi(a, J_REGS, J_R(B) + J_CID, EEL_CWEAKREF);
+		a_bail(a, J_CE);
+		a_copyv(a, J_REGS, J_R(A), J_REGS, J_R(B));
+		return 1;
+	  }
+
+	  /* Register variables */
+	  case EEL_OINIT_AB:
+	  case EEL_OASSIGN_AB:
+	  {
+		EEL_OPR_AB(ins)
+		if(ins[0] == EEL_OASSIGN_AB)
+			t_needvalue(a, J_REGS, J_R(A));
+		t_needvalue(a, J_REGS, J_R(B));
+		a_copyv(a, J_REGS, J_R(A), J_REGS, J_R(B));
+		if(ins[0] == EEL_OINIT_AB)
+			t_addclean(a, A);
+		return 1;
+	  }
+	  case EEL_OINITI_AsBx:
+	  case EEL_OASSIGNI_AsBx:
+	  {
+		EEL_OPR_AsBx(ins)
+		if(ins[0] == EEL_OASSIGNI_AsBx)
+			t_needvalue(a, J_REGS, J_R(A));
+		t_setvalue(a, A, EEL_CINTEGER, B);
+		if(ins[0] == EEL_OINITI_AsBx)
+			t_addclean(a, A);
+		return 1;
+	  }
+	  case EEL_OINITNIL_A:
+	  case EEL_OASNNIL_A:
+	  {
+		EEL_OPR_A(ins)
+		if(ins[0] == EEL_OASNNIL_A)
+			t_needvalue(a, J_REGS, J_R(A));
+		t_setvalue(a, A, EEL_CNIL, 0);
+		if(ins[0] == EEL_OINITNIL_A)
+			t_addclean(a, A);
+		return 1;
+	  }
+	  case EEL_OINITC_ABx:
+	  case EEL_OASSIGNC_ABx:
+	  {
+		EEL_OPR_ABx(ins)
+		if(EEL_IS_OBJREF(f->e.constants[B].classid))
+			return 0;
+		if(ins[0] == EEL_OASSIGNC_ABx)
+			t_needvalue(a, J_REGS, J_R(A));
+		t_constant(a, &f->e.constants[B]);
+		a_copyv(a, J_REGS, J_R(A), J_RDX, 0);
+		if(ins[0] == EEL_OINITC_ABx)
+			t_addclean(a, A);
+		return 1;
+	  }
+
+	  /* Static variables */
+	  case EEL_OGETVAR_ABx:
+	  {
+		EEL_OPR_ABx(ins)
+		t_state(a, J_JS(sv));
+		t_needvalue(a, J_RDX, J_R(B));
+		a_copyv(a, J_REGS, J_R(A), J_RDX, J_R(B));
+		return 1;
+	  }
+	  case EEL_OSETVAR_ABx:
+	  {
+		EEL_OPR_ABx(ins)
+		t_state(a, J_JS(sv));
+		t_needvalue(a, J_RDX, J_R(B));
+		t_needvalue(a, J_REGS, J_R(A));
+		a_copyv(a, J_RDX, J_R(B), J_REGS, J_R(A));
+		return 1;
+	  }
+
+	  /* Argument access */
+	  case EEL_OGETARGI_AB:
+	  {
+		EEL_OPR_AB(ins)
+		a_cmpmi(a, J_STATE, J_JS(argc), B);
+		a_bail(a, J_CBE);
+		t_state(a, J_JS(args));
+		t_needvalue(a, J_RDX, J_R(B));
+		a_copyv(a, J_REGS, J_R(A), J_RDX, J_R(B));
+		return 1;
+	  }
+
+	  /* Operators */
+	  case EEL_OBOP_ABCD:
+	  {
+		EEL_OPR_ABCD(ins)
+		if(!jit_binop(C))
+			return 0;
+		opr_reg(&l, B);
+		opr_reg(&r, D);
+		t_binop(a, C, &l, &r, A);
+		return 1;
+	  }
+	  case EEL_OBOPS_ABCsDx:
+	  {
+		EEL_OPR_ABCsDx(ins)
+		if(!jit_binop(C))
+			return 0;
+		t_state(a, J_JS(sv));
+		opr_reg(&l, B);
+		r.kind = EEL_JO_MEM;
+		r.base = J_RDX;
+		r.disp = J_R(D);
+		t_binop(a, C, &l, &r, A);
+		return 1;
+	  }
+	  case EEL_OBOPI_ABCsDx:
+	  {
+		EEL_OPR_ABCsDx(ins)
+		if(!jit_binop(C))
+			return 0;
+		opr_reg(&l, B);
+		opr_int(&r, D);
+		t_binop(a, C, &l, &r, A);
+		return 1;
+	  }
+	  case EEL_OBOPC_ABCDx:
+	  {
+		EEL_OPR_ABCDx(ins)
+		if(!jit_binop(C) || !opr_const(&r, &f->e.constants[D]))
+			return 0;
+		if((C == EEL_OP_MOD) && (r.kind != EEL_JO_INT))
+			return 0;
+		opr_reg(&l, B);
+		t_binop(a, C, &l, &r, A);
+		return 1;
+	  }
+	  case EEL_OADD_ABC:
+	  case EEL_OSUB_ABC:
+	  case EEL_OMUL_ABC:
+#ifdef EEL_PASCAL_IDIV
+	  case EEL_ODIV_ABC:
+#endif
+	  case EEL_OMOD_ABC:
+	  {
+		int op;
+		EEL_OPR_ABC(ins)
+		switch(ins[0])
+		{
+		  case EEL_OADD_ABC:	op = EEL_OP_ADD; break;
+		  case EEL_OSUB_ABC:	op = EEL_OP_SUB; break;
+		  case EEL_OMUL_ABC:	op = EEL_OP_MUL; break;
+		  case EEL_ODIV_ABC:	op = EEL_OP_DIV; break;
+		  default:		op = EEL_OP_MOD; break;
+		}
+		opr_reg(&l, B);
+		opr_reg(&r, C);
+		t_binop(a, op, &l, &r, A);
+		return 1;
+	  }
+	  case EEL_ONEG_AB:
+	  {
+		int isint, real, done;
+		EEL_OPR_AB(ins)
+		a_load(a, J_RAX, J_REGS, J_R(B) + J_CID);
+		a_cmpri(a, J_RAX, EEL_CREAL);
+		real = a_jcc(a, J_CE);
+		a_cmpri(a, J_RAX, EEL_CINTEGER);
+		isint = a_jcc(a, J_CE);
+		a_cmpri(a, J_RAX, EEL_CBOOLEAN);
+		a_bail(a, J_CNE);
+		a_label(a, isint);
+		a_load(a, J_RSI, J_REGS, J_R(B) + J_INT);
+		a_opr(a, 0, 0, 0xf7, 3, J_RSI);		/* neg esi */
+		t_store(a, EEL_CINTEGER, A);
+		done = a_jmp(a);
+		a_label(a, real);
+		a_movi64(a, J_RAX, 0, 0x80000000);	/* Flip the sign bit */
+		a_opr(a, 0x66, 1, 0x0f6e, 1, J_RAX);	/* movq xmm1, rax */
+		a_movsdm(a, 0, J_REGS, J_R(B) + J_REAL);
+		a_xorpd(a, 0, 1);
+		t_store(a, EEL_CREAL, A);
+		a_label(a, done);
+		return 1;
+	  }
+	  case EEL_OCASTR_AB:
+	  {
+		int real, done;
+		EEL_OPR_AB(ins)
+		a_load(a, J_RAX, J_REGS, J_R(B) + J_CID);
+		a_cmpri(a, J_RAX, EEL_CREAL);
+		real = a_jcc(a, J_CE);
+		a_cmpri(a, J_RAX, EEL_CINTEGER);
+		a_bail(a, J_CNE);
+		a_cvtim(a, 0, J_REGS, J_R(B) + J_INT);
+		done = a_jmp(a);
+		a_label(a, real);
+		a_movsdm(a, 0, J_REGS, J_R(B) + J_REAL);
+		a_label(a, done);
+		t_store(a, EEL_CREAL, A);
+		return 1;
+	  }
+	  case EEL_OCASTI_AB:
+	  {
+		int real, done, nofix;
+		EEL_OPR_AB(ins)
+		a_load(a, J_RAX, J_REGS, J_R(B) + J_CID);
+		a_cmpri(a, J_RAX, EEL_CREAL);
+		real = a_jcc(a, J_CE);
+		a_cmpri(a, J_RAX, EEL_CINTEGER);
+		a_bail(a, J_CNE);
+		a_load(a, J_RSI, J_REGS, J_R(B) + J_INT);
+		done = a_jmp(a);
+		a_label(a, real);
+		/* Truncate, then adjust to floor() for negative values */
+		a_movsdm(a, 0, J_REGS, J_R(B) + J_REAL);
+		a_opr(a, 0xf2, 0, 0x0f2c, J_RSI, 0);	/* cvttsd2si esi, xmm0 */
+		a_cmpri(a, J_RSI, 0x80000000);		/* Out of range or NaN */
+		a_bail(a, J_CE);
+		a_cvtir(a, 1, J_RSI);
+		a_ucomisd(a, 1, 0);
+		nofix = a_jcc(a, J_CBE);
+		a_opr(a, 0, 0, 0x81, 5, J_RSI);		/* sub esi, 1 */
+		a_dword(a, 1);
+		a_label(a, nofix);
+		a_label(a, done);
+		t_store(a, EEL_CINTEGER, A);
+		return 1;
+	  }
+
+	  default:
+		return 0;
+	}
+}
+
+
+/*----------------------------------------------------------
+	Compiler
+----------------------------------------------------------*/
+
+static void jit_cleanup(EEL_jitasm *a)
+{
+	eel_free(a->vm, a->buf);
+	eel_free(a->vm, a->pcpos);
+	eel_free(a->vm, a->exitpos);
+	eel_free(a->vm, a->fixups);
+}
+
+/* Get the exit stub for 'pc', generating one if needed */
+static int jit_exitstub(EEL_jitasm *a, int pc)
+{
+	if(a->exitpos[pc] < 0)
+	{
+		a->exitpos[pc] = a->pos;
+		a_exit(a, pc);
+	}
+	return a->exitpos[pc];
+}
+
+/*
+ * Generate a backward branch to 'pc' that counts a time slice tick, leaving
+ * through the exit stub of 'pc' when the slice needs attention.
+ */
+static int jit_tickstub(EEL_jitasm *a, int pc)
+{
+	int start = a->pos;
+	int out, loop;
+	a_loadp(a, J_RAX, J_STATE, J_JS(slice));
+	a_opm(a, 0, 0, 0x83, 5, J_RAX, 0);		/* sub dword [rax], 1 */
+	a_byte(a, 1);
+	out = a_jcc(a, J_CLE);
+	loop = a_jmp(a);
+	a_patch(a, loop, a->pcpos[pc]);
+	a_patch(a, out, jit_exitstub(a, pc));
+	return start;
+}
+
+EEL_xno eel_jit_compile(EEL_vm *vm, EEL_function *f)
+{
+	EEL_jitasm a;
+	EEL_jitcode *jc;
+	int pc, i, n;
+	int codesize = f->e.codesize;
+	void *code;
+	size_t mapsize;
+
+	memset(&a, 0, sizeof(a));
+	a.vm = vm;
+	a.f = f;
+	a.size = 256 + codesize * 16;
+	a.maxfixups = 16 + codesize / 2;
+	a.buf = (unsigned char *)eel_malloc(vm, a.size);
+	a.pcpos = (int *)eel_malloc(vm, (codesize + 1) * sizeof(int));
+	a.exitpos = (int *)eel_malloc(vm, (codesize + 1) * sizeof(int));
+	a.fixups = (EEL_jitfixup *)eel_malloc(vm,
+			a.maxfixups * sizeof(EEL_jitfixup));
+	if(!a.buf || !a.pcpos || !a.exitpos || !a.fixups)
+	{
+		jit_cleanup(&a);
+		return EEL_XMEMORY;
+	}
+	for(pc = 0; pc <= codesize; ++pc)
+		a.pcpos[pc] = a.exitpos[pc] = -1;
+
+	/* Entry: r8 = js->r; r9 = js; jump to 'entry' */
+	a_loadp(&a, J_REGS, J_RDI, J_JS(r));
+	a_opr(&a, 0, 1, 0x8b, J_STATE, J_RDI);		/* mov r9, rdi */
+	a_opr(&a, 0, 0, 0xff, 4, J_RSI);		/* jmp rsi */
+
+	/* Instructions */
+	n = 0;
+	pc = 0;
+	while(pc < codesize)
+	{
+		a.pc = pc;
+		a.pcpos[pc] = a.pos;
+		if(jit_instruction(&a))
+			++n;
+		else
+		{
+			/* No template! Have the interpreter deal with it. */
+			a.exitpos[pc] = a.pos;
+			a_exit(&a, pc);
+		}
+		pc += eel_i_size(f->e.code[pc]);
+	}
+	a.pcpos[codesize] = a.pos;
+	a_exit(&a, codesize);
+	if(!n)
+	{
+		/* Nothing to gain. Don't try again. */
+		jit_cleanup(&a);
+		return 0;
+	}
+
+	/* Bail-out exits, and branches */
+	for(i = 0; i < a.nfixups; ++i)
+	{
+		EEL_jitfixup *fx = &a.fixups[i];
+		int target;
+		if((fx->pc < 0) || (fx->pc > codesize))
+		{
+			/* Can't happen, unless the compiler is broken */
+			jit_cleanup(&a);
+			return EEL_XINTERNAL;
+		}
+		if((fx->kind == EEL_JF_PC) && (a.pcpos[fx->pc] >= 0))
+		{
+			target = a.pcpos[fx->pc];
+			if(target < fx->pos)
+				target = jit_tickstub(&a, fx->pc);
+		}
+		else
+			target = jit_exitstub(&a, fx->pc);
+		a_patch(&a, fx->pos, target);
+	}
+	if(a.failed)
+	{
+		jit_cleanup(&a);
+		return EEL_XMEMORY;
+	}
+
+	/* Install */
+	mapsize = a.pos;
+	code = mmap(NULL, mapsize, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(code == MAP_FAILED)
+	{
+		jit_cleanup(&a);
+		return EEL_XMEMORY;
+	}
+	memcpy(code, a.buf, a.pos);
+	if(mprotect(code, mapsize, PROT_READ | PROT_EXEC) < 0)
+	{
+		munmap(code, mapsize);
+		jit_cleanup(&a);
+		return EEL_XMEMORY;
+	}
+	jc = (EEL_jitcode *)eel_malloc(vm, sizeof(EEL_jitcode));
+	if(!jc)
+	{
+		munmap(code, mapsize);
+		jit_cleanup(&a);
+		return EEL_XMEMORY;
+	}
+	jc->vm = vm;
+	jc->f = f;
+	jc->code = (unsigned char *)code;
+	jc->size = mapsize;
+	jc->entry = a.pcpos;
+	a.pcpos = NULL;
+	for(pc = 0; pc <= codesize; ++pc)
+		if(a.exitpos[pc] == jc->entry[pc])
+			jc->entry[pc] = -1;	/* Exits right away */
+	jit_cleanup(&a);
+
+	jc->prev = NULL;
+	jc->next = VMP->jitcodes;
+	if(jc->next)
+		jc->next->prev = jc;
+	VMP->jitcodes = jc;
+	f->e.jit = jc;
+
+	for(pc = 0; pc < codesize; ++pc)
+		if(jc->entry[pc] >= 0)
+			f->e.dcode[pc].op = VMP->jitop;
+	return 0;
+}
+
+
+void eel_jit_free(EEL_vm *vm, EEL_function *f)
+{
+	EEL_jitcode *jc = f->e.jit;
+	int pc;
+	f->e.jithot = 0;
+	if(!jc)
+		return;
+	vm = jc->vm;
+	if(f->e.dcode)
+		for(pc = 0; pc < f->e.codesize; ++pc)
+			if(f->e.dcode[pc].op == VMP->jitop)
+				f->e.dcode[pc].op = VMP->itab[f->e.code[pc]];
+	if(jc->prev)
+		jc->prev->next = jc->next;
+	else
+		VMP->jitcodes = jc->next;
+	if(jc->next)
+		jc->next->prev = jc->prev;
+	munmap(jc->code, jc->size);
+	eel_free(vm, jc->entry);
+	eel_free(vm, jc);
+	f->e.jit = NULL;
+}
+
+
+void eel_jit_free_all(EEL_vm *vm)
+{
+	while(VMP->jitcodes)
+		eel_jit_free(vm, VMP->jitcodes->f);
+}
+
+#endif /* EEL_VM_JIT */
@@ -0,0 +1,102 @@
+/*
+---------------------------------------------------------------------------
+	e_jit.h - EEL baseline native code compiler (x86-64)
+---------------------------------------------------------------------------
+ * Copyright 2026 The EEL contributors
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the
+ * use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef	EEL_E_JIT_H
+#define	EEL_E_JIT_H
+
+#include "e_config.h"
+
+#ifdef EEL_VM_JIT
+
+#include "e_vm.h"
+#include "e_function.h"
+
+/*
+ * Native code is generated one instruction template at a time, straight from
+ * the byte code of a function, and works directly on the VM register frame,
+ * so the VM state is valid at every instruction boundary. Instructions that
+ * have no template, and templates that find operands they can't deal with
+ * (objects, division by zero etc), return to the interpreter, which then
+ * runs that one instruction and continues from there.
+ *
+ * Backward branches count time slice ticks, like the interpreter does, and
+ * return to the interpreter when the slice needs attention.
+ *
+ * The interpreter enters the native code through the pre-decoded code;
+ * eel_jit_compile() points the entries of all instructions that have native
+ * code at a special entry handler in eel_run(), which calls eel_jit_run().
+ */
+
+/* Context passed to native code */
+typedef struct
+{
+	EEL_value	*r;	/* Register frame */
+	EEL_value	*args;	/* Arguments */
+	EEL_value	*sv;	/* Static variables of the module */
+	unsigned char	*ctab;	/* Register variable cleanup table */
+	int		*slice;	/* Time slice tick counter */
+	EEL_uint32	argc;	/* Argument count */
+} EEL_jitstate;
+
+/* Native code for one EEL function */
+struct EEL_jitcode
+{
+	EEL_jitcode	*next, *prev;	/* List of all native code of 'vm' */
+	EEL_vm		*vm;		/* VM that compiled this */
+	EEL_function	*f;		/* Function this was compiled from */
+	unsigned char	*code;		/* Native code (mmap()ed) */
+	int		size;		/* Size of 'code' */
+	int		*entry;		/* pc ==> code offset, or -1 */
+};
+
+/*
+ * Compile EEL function 'f' into native code, and have the interpreter use
+ * it. 'f' must have been pre-decoded.
+ *
+ * Returns 0 on success, or an exception code if there was an error, in which
+ * case 'f' is left as it was.
+ */
+EEL_xno eel_jit_compile(EEL_vm *vm, EEL_function *f);
+
+/*
+ * Throw away the native code of 'f', if any, and restore the pre-decoded
+ * code. 'f' may be compiled again later.
+ */
+void eel_jit_free(EEL_vm *vm, EEL_function *f);
+
+/* Throw away all native code of 'vm'. */
+void eel_jit_free_all(EEL_vm *vm);
+
+/*
+ * Run the native code of 'jc' from 'pc', which must be a valid entry point.
+ * Returns the PC of the first instruction to be handled by the interpreter.
+ */
+typedef int (*EEL_jitfunc)(EEL_jitstate *js, const void *entry);
+static inline int eel_jit_run(EEL_jitcode *jc, EEL_jitstate *js, int pc)
+{
+	return ((EEL_jitfunc)jc->code)(js, jc->code + jc->entry[pc]);
+}
+
+#endif /* EEL_VM_JIT */
+
+#endif /* EEL_E_JIT_H */
@@ -61,7 +61,7 @@ static void load_buffer(EEL_vm *vm, EEL_module *m,
 		eel_cerror(es, "Script name went missing in action!");
 
 	m->len = len;
-	m->source = (unsigned char *)malloc(m->len + 1);
+	m->source = (unsigned char *)eel_malloc(vm, m->len + 1);
 	if(!m->source)
 		eel_serror(es, "Could not allocate space for source!");
 
@@ -80,7 +80,7 @@ static EEL_object *eel_load_buffer_nc(EEL_vm *vm,
 	EEL_xno x = eel_o_construct(es->vm, EEL_CMODULE, NULL, 0, &v);
 	if(x)
 		return NULL;
-	m = v.objref.v;
+	m = eel_v2o(&v);
 	eel_try(es)
 		load_buffer(vm, o2EEL_module(m), source, len);
 	eel_except
@@ -132,9 +132,9 @@ EEL_object *eel_get_loaded_module(EEL_vm *vm, const char *modname)
 		return NULL;
 	if(eel_table_gets(es->modules, modname, &v))
 		return NULL;
-	if(!EEL_IS_OBJREF(v.classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(&v)))
 		return NULL;
-	m = v.objref.v;
+	m = eel_v2o(&v);
 	if(!m->refcount)
 		eel_limbo_unlink(m);	/* es->deadmods! */
 	eel_o_own(m);
@@ -154,9 +154,9 @@ EEL_object *eel_load(EEL_vm *vm, const char *modname, EEL_sflags flags)
 		return eel_get_loaded_module(vm, modname); /* Bootstrap! */
 	if(eel_callnf(vm, es->loader, "load", "Rsi", &res, modname, flags))
 		return NULL;
-	if(!EEL_IS_OBJREF(vm->heap[res].classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(&vm->heap[res])))
 		return NULL;
-	return vm->heap[res].objref.v;
+	return eel_v2o(&vm->heap[res]);
 }
 
 
@@ -187,7 +187,7 @@ static EEL_xno m_construct(EEL_vm *vm, EEL_classes cid,
 		eel_o_free(eo);
 		return x;
 	}
-	m->exports = v.objref.v;
+	m->exports = eel_v2o(&v);
 	eel_o2v(result,  eo);
 	return 0;
 }
@@ -265,7 +265,7 @@ static EEL_xno m_real_destruct(EEL_object *eo)
 				m->variables[m->nvariables].type));)
 		DBG1(if(EEL_IS_OBJREF(m->variables[m->nvariables].type))
 			printf(", %s", eel_typename(vm,
-				m->variables[m->nvariables].objref.v->type));)
+				eel_v2o(&m->variables[m->nvariables])->type));)
 		DBG1(printf(">\n");)
 		eel_v_disown(&m->variables[m->nvariables]);
 	}
@@ -356,7 +356,7 @@ FIXME: Should probably just use exports.__source, but if it's a dstring, it may
 		if(!(s = eel_v2s(op2)))
 			return EEL_XNEEDSTRING;
 		m->len = eel_length(eel_v2o(op2));
-		m->source = (unsigned char *)malloc(m->len + 1);
+		m->source = (unsigned char *)eel_malloc(eo->vm, m->len + 1);
 		if(!m->source)
 			return EEL_XMEMORY;
 		memcpy(m->source, s, m->len);
@@ -461,7 +461,7 @@ int eel_clean_modules(EEL_vm *vm)
 		EEL_value *v;
 		ti = eel_table_get_item(es->modules, i);
 		v = eel_table_get_value(ti);
-		if(v->classid == EEL_CNIL)
+		if(EEL_VCLASS(v) == EEL_CNIL)
 			eel_table_delete(es->modules, eel_table_get_key(ti));
 		else
 			++i;
@@ -67,16 +67,43 @@ static inline void eeld_o_unlink(EEL_vm *vm, EEL_object *o)
 #endif
 
 
+/* Make room for the memory statistics of class 'cid' */
+static int grow_cstats(EEL_vm *vm, EEL_classes cid)
+{
+	EEL_classmemstats *cs;
+	int n = VMP->ncstats ? VMP->ncstats : 32;
+	while(n <= cid)
+		n <<= 1;
+	cs = (EEL_classmemstats *)eel_realloc(vm, VMP->cstats,
+			n * sizeof(EEL_classmemstats));
+	if(!cs)
+		return -1;
+	memset(cs + VMP->ncstats, 0,
+			(n - VMP->ncstats) * sizeof(EEL_classmemstats));
+	VMP->cstats = cs;
+	VMP->ncstats = n;
+	return 0;
+}
+
+
 EEL_object *eel_o_alloc(EEL_vm *vm, int size, EEL_classes cid)
 {
+	EEL_object *o;
+	EEL_classmemstats *cs;
+	if((cid >= VMP->ncstats) && (grow_cstats(vm, cid) < 0))
+		return NULL;
 #if DBGM(1) + 0 == 1
-	EEL_object *o = (EEL_object *)eel_malloc(vm,
+	o = (EEL_object *)eel_slab_alloc(vm,
 			sizeof(EEL_object_dbg) + sizeof(EEL_object) + size);
 #else
-	EEL_object *o = (EEL_object *)eel_malloc(vm, sizeof(EEL_object) + size);
+	o = (EEL_object *)eel_slab_alloc(vm, sizeof(EEL_object) + size);
 #endif
 	if(!o)
 		return NULL;
+	cs = VMP->cstats + cid;
+	++cs->objects;
+	++cs->allocs;
+	cs->bytes += eel_slab_size(o);
 #if DBGM(1) + 0 == 1
 	o = (EEL_object *)(((EEL_object_dbg *)o) + 1);
 #endif
@@ -104,8 +131,25 @@ EEL_object *eel_o_alloc(EEL_vm *vm, int size, EEL_classes cid)
 }
 
 
+EEL_xno eel_reserve_objects(EEL_vm *vm, int size, int count)
+{
+	/* Statistics for all classes, so eel_o_alloc() won't need to grow it */
+	int nclasses = VMP->state->nclasses;
+	if((nclasses > VMP->ncstats) && (grow_cstats(vm, nclasses - 1) < 0))
+		return EEL_XMEMORY;
+#if DBGM(1) + 0 == 1
+	size += sizeof(EEL_object_dbg);
+#endif
+	return eel_slab_reserve(vm, sizeof(EEL_object) + size, count);
+}
+
+
 static inline void o__dealloc(EEL_object *o)
 {
+	EEL_classmemstats *cs = eel_vm2p(o->vm)->cstats + o->classid;
+	cs->bytes -= eel_slab_size(eel_o2mem(o));
+	--cs->objects;
+	++cs->frees;
 #ifdef EEL_VM_CHECKING
 	if(o->lprev || o->lnext)
 	{
@@ -117,13 +161,17 @@ static inline void o__dealloc(EEL_object *o)
 #if DBGM(1) + 0 == 1
 	++eel_vm2p(o->vm)->destroyed;
 	eeld_o_unlink(o->vm, o);
-# if DBGK(1) + 0 == 0
-	eel_free(o->vm, o2dbg(o));
-# endif
-#else
-# if DBGK(1) + 0 == 0
-	eel_free(o->vm, o);
+#endif
+#if DBGK(1) + 0 == 0
+# ifdef EEL_CYCLE_COLLECTOR
+	/* If the cycle collector has a pointer to it, let it free the block */
+	if(eel_o2block(o)->a.flags & EEL_CCF_BUFFERED)
+	{
+		eel_o2block(o)->a.flags |= EEL_CCF_DEAD;
+		return;
+	}
 # endif
+	eel_slab_free(o->vm, eel_o2mem(o));
 #endif
 }
 
@@ -196,8 +244,7 @@ EEL_xno eel_o_construct(EEL_vm *vm, EEL_classes cid,
 	x = (cd->construct)(vm, cid, inits, initc, result);
 	if(x)
 	{
-		result->classid = EEL_CILLEGAL;
-		result->integer.v = 1001;
+		eel_i2v(result, EEL_CILLEGAL, 1001);
 		return x;
 	}
 	if(cid == EEL_CVECTOR)	/* Does this all the time... */
@@ -261,17 +308,17 @@ void eel_disown(EEL_object *o)
 
 void eel_v_disown(EEL_value *v)
 {
-	switch(v->classid)
+	switch(EEL_VCLASS(v))
 	{
 	  case EEL_COBJREF:
-		eel_disown(v->objref.v);
+		eel_disown(eel_v2o(v));
 #ifdef DEBUG
-		v->objref.v = NULL;
+		eel_o2v(v, NULL);
 #endif
 		break;
 	  case EEL_CWEAKREF:
 #ifdef EEL_VM_CHECKING
-		if(v->objref.index == EEL_WEAKREF_UNWIRED)
+		if(EEL_VUNWIRED(v))
 		{
 			fprintf(stderr, "ERROR: eel_v_disown() called on a "
 					"weakref that was not attached!\n");
@@ -279,9 +326,6 @@ void eel_v_disown(EEL_value *v)
 		}
 #endif
 		eel__weakref_detach(v);
-#ifdef DEBUG
-		v->objref.v = NULL;
-#endif
 		break;
 	  default:
 		break;
@@ -305,7 +349,7 @@ long eel_length(EEL_object *io)
 	EEL_xno x = eel_o__metamethod(io, EEL_MM_LENGTH, NULL, &len);
 	if(x)
 		return -1;
-	return len.integer.v;
+	return EEL_VINT(&len);
 }
 
 
@@ -329,7 +373,7 @@ EEL_xno eel_getsindex(EEL_object *io, const char *key, EEL_value *value)
 	EEL_xno x;
 	EEL_value keyv;
 	eel_o2v(&keyv, eel_ps_new(vm, key));
-	if(!keyv.objref.v)
+	if(!eel_v2o(&keyv))
 		return EEL_XCONSTRUCTOR;
 	x = eel_o__metamethod(io, EEL_MM_GETINDEX, &keyv, value);
 	eel_v_disown(&keyv);
@@ -357,7 +401,7 @@ EEL_xno eel_setsindex(EEL_object *io, const char *key, EEL_value *value)
 	EEL_xno x;
 	EEL_value keyv;
 	eel_o2v(&keyv, eel_ps_new(vm, key));
-	if(!keyv.objref.v)
+	if(!eel_v2o(&keyv))
 		return EEL_XCONSTRUCTOR;
 	x = eel_o__metamethod(io, EEL_MM_SETINDEX, &keyv, value);
 	eel_v_disown(&keyv);
@@ -386,7 +430,7 @@ EEL_xno eel_sdelete(EEL_object *io, const char *key)
 	EEL_xno x;
 	EEL_value keyv;
 	eel_o2v(&keyv, eel_ps_new(vm, key));
-	if(!keyv.objref.v)
+	if(!eel_v2o(&keyv))
 		return EEL_XCONSTRUCTOR;
 	x = eel_o__metamethod(io, EEL_MM_DELETE, &keyv, NULL);
 	eel_v_disown(&keyv);
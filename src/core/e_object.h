@@ -62,6 +62,8 @@
 #include "e_module.h"
 #include "e_error.h"
 #include "e_config.h"
+#include "e_slab.h"
+#include "e_cycle.h"
 
 #if (DBGK(1)+0 == 1) || (DBGL(1)+0 == 1) || (DBGK3(1)+0 == 1) ||	\
 		(DBGK4(1)+0 == 1) || (DBG7(1)+0 == 1) ||		\
@@ -85,6 +87,22 @@ static inline EEL_object_dbg *o2dbg(EEL_object *o)
 }
 #endif
 
+/* Start of the memory block of 'o', as returned by eel_slab_alloc() */
+static inline void *eel_o2mem(EEL_object *o)
+{
+#if DBGM(1) + 0 == 1
+	return o2dbg(o);
+#else
+	return o;
+#endif
+}
+
+/* Object block header of 'o' */
+static inline EEL_slabblock *eel_o2block(EEL_object *o)
+{
+	return (EEL_slabblock *)eel_o2mem(o) - 1;
+}
+
 #if DBGM2(1)+0 == 1
 #  define SETNAME(o, x)	o2dbg(o)->dname = strdup(x)
 #  define GETNAME(o)	(o2dbg(o)->dname)
@@ -117,13 +135,32 @@ typedef struct
 #define	EEL_WR_MINSIZE	4
 
 
+/*
+ * Find the index of weakref 'v' in the weakref vector of its target. With
+ * EEL_NANBOX, there's no room for the index in the value, so we search the
+ * vector for the address of the value.
+ */
+static inline int eel__weakref_index(EEL_weakrefs *wr, const EEL_value *v)
+{
+#ifdef EEL_NANBOX
+	int i;
+	for(i = wr->nrefs - 1; i > 0; --i)
+		if(wr->refs[i] == v)
+			break;
+	return i;
+#else
+	return v->objref.index;
+#endif
+}
+
+
 static inline void eel_weakref_attach(EEL_value *v)
 {
-	EEL_weakrefs *wr = v->objref.v->weakrefs;
-	EEL_vm *vm = v->objref.v->vm;
+	EEL_weakrefs *wr = eel_v2o(v)->weakrefs;
+	EEL_vm *vm = eel_v2o(v)->vm;
 	int nrefs, size;
 #ifdef EEL_VM_CHECKING
-	switch(v->classid)
+	switch(EEL_VCLASS(v))
 	{
 	  case EEL_COBJREF:
 		eel_vmdump(vm, "INTERNAL ERROR: Tried to attach an objref "
@@ -160,20 +197,24 @@ static inline void eel_weakref_attach(EEL_value *v)
 		wr = (EEL_weakrefs *)vm->realloc(vm, wr, ms);
 		if(!wr)
 		{
-			eel_own(v->objref.v);
+			eel_own(eel_v2o(v));
 			eel_vmdump(vm, "INTERNAL ERROR: Out of memory while "
 					"adding weak reference! Refcount "
 					"increased.\n");
 			eel_perror(vm, 1);
 			return;
 		}
-		v->objref.v->weakrefs = wr;
+		eel_v2o(v)->weakrefs = wr;
 		wr->nrefs = nrefs;
 		wr->size = newsize;
 	}
 	DBG7W(fprintf(stderr, "attach(%p): index = %d\n", v, wr->nrefs);)
 	wr->refs[wr->nrefs] = v;
+#ifdef EEL_NANBOX
+	v->bits &= ~(EEL_uint64)1;	/* Wired! */
+#else
 	v->objref.index = wr->nrefs;
+#endif
 	++wr->nrefs;
 }
 
@@ -181,10 +222,11 @@ static inline void eel_weakref_attach(EEL_value *v)
 static inline void eel__weakref_detach(EEL_value *v)
 {
 	EEL_vm *vm;
-	EEL_weakrefs *wr = v->objref.v->weakrefs;
+	EEL_weakrefs *wr = eel_v2o(v)->weakrefs;
+	int i;
 	DBG7W(fprintf(stderr, "eel__weakref_detach(%p)\n", v);)
 #ifdef EEL_VM_CHECKING
-	switch(v->classid)
+	switch(EEL_VCLASS(v))
 	{
 	  case EEL_COBJREF:
 		fprintf(stderr, "INTERNAL ERROR: Tried to detach non-weakref "
@@ -198,7 +240,7 @@ static inline void eel__weakref_detach(EEL_value *v)
 		return;
 	}
 #endif
-	vm = v->objref.v->vm;
+	vm = eel_v2o(v)->vm;
 #ifdef EEL_VM_CHECKING
 	if(!wr)
 	{
@@ -210,12 +252,15 @@ static inline void eel__weakref_detach(EEL_value *v)
 	if(EEL_IN_HEAP(vm, v))
 		VMP->weakrefs--;
 #endif
-	if(wr->nrefs > v->objref.index)
+	i = eel__weakref_index(wr, v);
+	if(wr->nrefs > i)
 	{
 		// Replace this ref with the last in the vector
-		wr->refs[v->objref.index] = wr->refs[wr->nrefs - 1];
+		wr->refs[i] = wr->refs[wr->nrefs - 1];
+#ifndef EEL_NANBOX
 		// Update the index field of the moved weakref
-		wr->refs[v->objref.index]->objref.index = v->objref.index;
+		wr->refs[i]->objref.index = i;
+#endif
 	}
 	--wr->nrefs;
 
@@ -229,37 +274,41 @@ static inline void eel__weakref_detach(EEL_value *v)
 		if(wr)
 		{
 			wr->size = newsize;
-			v->objref.v->weakrefs = wr;
+			eel_v2o(v)->weakrefs = wr;
 		}
 	}
 	else if(!wr->nrefs)
 	{
 		vm->free(vm, wr);
-		v->objref.v->weakrefs = NULL;
+		eel_v2o(v)->weakrefs = NULL;
 	}
 
 	// Clear the ref
-	v->classid = EEL_CNIL;
+	eel_nil2v(v);
 }
 
 
-static inline void eel_weakref_relocate(EEL_value *to)
+/*
+ * Update the weakref vector of the target of weakref 'to', which has been
+ * moved there from 'from'. ('from' is only used for finding the weakref; it
+ * need not be valid memory anymore.)
+ */
+static inline void eel_weakref_relocate(EEL_value *to, const EEL_value *from)
 {
 	EEL_weakrefs *wr;
 #ifdef EEL_VM_CHECKING
 	EEL_vm *vm;
-	if(to->classid != EEL_CWEAKREF)
+	if(EEL_VCLASS(to) != EEL_CWEAKREF)
 	{
 		fprintf(stderr, "INTERNAL ERROR: Tried to relocate non-weakref "
 				"value!\n");
 		return;
 	}
 #endif
-	wr = to->objref.v->weakrefs;
-	DBG7W(fprintf(stderr, "Relocated weakref %p to %p!\n",
-			wr->refs[to->objref.index], to);)
+	wr = eel_v2o(to)->weakrefs;
+	DBG7W(fprintf(stderr, "Relocated weakref %p to %p!\n", from, to);)
 #ifdef EEL_VM_CHECKING
-	vm = to->objref.v->vm;
+	vm = eel_v2o(to)->vm;
 	if(!wr)
 	{
 		eel_vmdump(vm, "INTERNAL ERROR: Tried to relocate weakref, but "
@@ -267,7 +316,7 @@ static inline void eel_weakref_relocate(EEL_value *to)
 		eel_perror(vm, 1);
 		return;
 	}
-	if(to->objref.index == EEL_WEAKREF_UNWIRED)
+	if(EEL_VUNWIRED(to))
 	{
 		eel_vmdump(vm, "INTERNAL ERROR: Tried to relocate an unwired "
 				"weakref!\n");
@@ -275,7 +324,11 @@ static inline void eel_weakref_relocate(EEL_value *to)
 		return;
 	}
 #endif
+#ifdef EEL_NANBOX
+	wr->refs[eel__weakref_index(wr, from)] = to;
+#else
 	wr->refs[to->objref.index] = to;
+#endif
 }
 
 
@@ -298,7 +351,7 @@ static inline void eel_kill_weakrefs(EEL_object *o)
 	}
 #endif
 	for(i = 0; i < wr->nrefs; i++)
-		wr->refs[i]->classid = EEL_CNIL;
+		eel_nil2v(wr->refs[i]);
 	o->vm->free(o->vm, wr);
 	o->weakrefs = NULL;
 	DBG7W(fprintf(stderr, "    Done\n");)
@@ -348,6 +401,32 @@ static inline void eel_o__dispose(EEL_object *object)
 }
 
 
+/* returns a non-zero value if 'o' is in limbo. */
+static inline int eel_in_limbo(EEL_object *object)
+{
+	return (object->lprev != NULL);
+}
+
+
+#ifdef EEL_CYCLE_COLLECTOR
+/*
+ * The refcount of 'o' was just decremented to a non-zero value. If 'o' is a
+ * table or an array, that may have left it in a garbage cycle, so make it a
+ * cycle collector candidate, unless it is one already.
+ *
+ * Objects in limbo are alive, and as they're disowned when taken out of limbo,
+ * they will get another chance then.
+ */
+static inline void eel_o__possible_root(EEL_object *o)
+{
+	if(((o->classid == EEL_CTABLE) || (o->classid == EEL_CARRAY)) &&
+			!eel_in_limbo(o) &&
+			!(eel_o2block(o)->a.flags & EEL_CCF_BUFFERED))
+		eel_cc_candidate(o);
+}
+#endif
+
+
 /*
  * Add reference ownership to object.
  */
@@ -406,6 +485,10 @@ static inline void eel_o_disown(EEL_object **po)
 		*po = NULL;
 		eel_o__dispose(o);
  	}
+#ifdef EEL_CYCLE_COLLECTOR
+	else
+		eel_o__possible_root(o);
+#endif
 }
 
 
@@ -439,6 +522,10 @@ static inline void eel_o_disown_nz(EEL_object *o)
 	)
 	if(!o->refcount)
 		eel_o__dispose(o);
+#ifdef EEL_CYCLE_COLLECTOR
+	else
+		eel_o__possible_root(o);
+#endif
 }
 
 
@@ -451,28 +538,21 @@ static inline void eel_o_disown_nz(EEL_object *o)
  */
 static inline void eel_v_disown_nz(EEL_value *value)
 {
-	if(value->classid == EEL_COBJREF)
-		eel_o_disown_nz(value->objref.v);
-	else if(value->classid == EEL_CWEAKREF)
+	if(EEL_VCLASS(value) == EEL_COBJREF)
+		eel_o_disown_nz(eel_v2o(value));
+	else if(EEL_VCLASS(value) == EEL_CWEAKREF)
 		eel__weakref_detach(value);
 #ifdef EEL_VM_CHECKING
-	else if(value->classid == EEL_CILLEGAL)
+	else if(EEL_VCLASS(value) == EEL_CILLEGAL)
 	{
 		fprintf(stderr, "INTERNAL ERROR: eel_v_disown_nz(): ILLEGAL "
-				"value! (Source: %d)\n", value->integer.v);
+				"value! (Source: %d)\n", EEL_VINT(value));
 		DBGZ2(abort();)
 	}
 #endif
 }
 
 
-/* returns a non-zero value if 'o' is in limbo. */
-static inline int eel_in_limbo(EEL_object *object)
-{
-	return (object->lprev != NULL);
-}
-
-
 /*
  * Add object 'o' to the current function's limbo list.
  * This will ensure that newly created objects are not
@@ -504,13 +584,13 @@ static inline void eel_o_limbo(EEL_object *o)
  */
 static inline void eel_v_limbo(EEL_value *v)
 {
-	if(EEL_IS_OBJREF(v->classid))
+	if(EEL_IS_OBJREF(EEL_VCLASS(v)))
 	{
-		EEL_vm *vm = v->objref.v->vm;
+		EEL_vm *vm = eel_v2o(v)->vm;
 		EEL_callframe *cf = (EEL_callframe *)
 				(vm->heap + vm->base - EEL_CFREGS);
 #ifdef EEL_VM_CHECKING
-		if(eel_in_limbo(v->objref.v))
+		if(eel_in_limbo(eel_v2o(v)))
 		{
 			eel_vmdump(vm, "INTERNAL ERROR: Tried to add object"
 					" to limbo list more than"
@@ -520,13 +600,13 @@ static inline void eel_v_limbo(EEL_value *v)
 			return;
 		}
 #endif
-		eel_limbo_push(&cf->limbo, v->objref.v);
+		eel_limbo_push(&cf->limbo, eel_v2o(v));
 	}
 #ifdef EEL_VM_CHECKING
-	if(v->classid == EEL_CILLEGAL)
+	if(EEL_VCLASS(v) == EEL_CILLEGAL)
 	{
 		fprintf(stderr, "INTERNAL ERROR: eel_v_limbo(): ILLEGAL value!"
-				" (Source: %d)\n", v->integer.v);
+				" (Source: %d)\n", EEL_VINT(v));
 		DBGZ2(abort();)
 	}
 #endif
@@ -550,9 +630,9 @@ static inline void eel_v_limbo(EEL_value *v)
  */
 static inline void eel_v_receive(EEL_value *v)
 {
-	if(EEL_IS_OBJREF(v->classid))
+	if(EEL_IS_OBJREF(EEL_VCLASS(v)))
 	{
-		EEL_object *o = v->objref.v;
+		EEL_object *o = eel_v2o(v);
 #if DBGK4(1) + DBGM(1) + 0 >= 1
 		EEL_vm *vm = o->vm;
 #endif
@@ -589,9 +669,9 @@ static inline void eel_v_receive(EEL_value *v)
 		DBGK4(eel_sfree(es, s);)
 	}
 #ifdef EEL_VM_CHECKING
-	if(v->classid == EEL_CILLEGAL)
+	if(EEL_VCLASS(v) == EEL_CILLEGAL)
 	{
-		fprintf(stderr, "INTERNAL ERROR: eel_v_receive(): ILLEGAL value! (Source: %d)\n", v->integer.v);
+		fprintf(stderr, "INTERNAL ERROR: eel_v_receive(): ILLEGAL value! (Source: %d)\n", EEL_VINT(v));
 		DBGZ2(abort();)
 	}
 #endif
@@ -610,17 +690,17 @@ static inline void eel_v_receive(EEL_value *v)
  */
 static inline void eel_v_grab(EEL_value *v)
 {
-	if(EEL_IS_OBJREF(v->classid))
-		if(!eel_in_limbo(v->objref.v))
+	if(EEL_IS_OBJREF(EEL_VCLASS(v)))
+		if(!eel_in_limbo(eel_v2o(v)))
 		{
-			eel_o_own(v->objref.v);
-			eel_o_limbo(v->objref.v);
+			eel_o_own(eel_v2o(v));
+			eel_o_limbo(eel_v2o(v));
 		}
 #ifdef EEL_VM_CHECKING
-	if(v->classid == EEL_CILLEGAL)
+	if(EEL_VCLASS(v) == EEL_CILLEGAL)
 	{
 		fprintf(stderr, "INTERNAL ERROR: eel_v_grab(): ILLEGAL value! "
-				"(Source: %d)\n", v->integer.v);
+				"(Source: %d)\n", EEL_VINT(v));
 		DBGZ2(abort();)
 	}
 #endif
@@ -641,43 +721,43 @@ static inline void eel_v_grab(EEL_value *v)
 static inline void eel_v_clone(EEL_value *value, const EEL_value *from)
 {
 #ifdef EEL_CLEAN_COPY
-	value->classid = from->classid;
-	switch(from->classid)
+	switch(EEL_VCLASS(from))
 	{
 	  case EEL_CNIL:
+		eel_nil2v(value);
 		return;
 	  case EEL_CREAL:
-		value->real.v = from->real.v;
+		eel_d2v(value, EEL_VREAL(from));
 		return;
 	  case EEL_CINTEGER:
 	  case EEL_CBOOLEAN:
 	  case EEL_CCLASSID:
-		value->integer.v = from->integer.v;
+		eel_i2v(value, EEL_VCLASS(from), EEL_VINT(from));
 		return;
 	  case EEL_COBJREF:
-		value->objref.v = from->objref.v;
-		eel_o_own(value->objref.v);
+		eel_o2v(value, eel_v2o(from));
+		eel_o_own(eel_v2o(value));
 		return;
 	  case EEL_CWEAKREF:
 		DBG7W(fprintf(stderr, "eel_v_clone(): WEAKREF %p -> %p!\n",
 				from, value);)
-		value->objref.v = from->objref.v;
-		DBG7W(fprintf(stderr, "      ptr = %p\n", value->objref.v);)
+		eel_o2wr(value, eel_v2o(from));
+		DBG7W(fprintf(stderr, "      ptr = %p\n", eel_v2o(value));)
 		DBG7W(fprintf(stderr, " refcount = %d\n",
-				value->objref.v->refcount);)
+				eel_v2o(value)->refcount);)
 		eel_weakref_attach(value);
 		DBG7W(fprintf(stderr, "eel_v_clone(): Done!\n");)
 		return;
 	}
 	fprintf(stderr, "INTERNAL ERROR: Tried to clone "
 			"a value of illegal class %d!\n",
-			value->classid);
+			EEL_VCLASS(from));
 	DBGZ2(abort();)
 #else
 	*value = *from;
-	if(value->classid == EEL_COBJREF)
-		eel_o_own(value->objref.v);
-	else if(value->classid == EEL_CWEAKREF)
+	if(EEL_VCLASS(value) == EEL_COBJREF)
+		eel_o_own(eel_v2o(value));
+	else if(EEL_VCLASS(value) == EEL_CWEAKREF)
 		eel_weakref_attach(value);
 #endif
 }
@@ -690,62 +770,63 @@ static inline void eel_v_clone(EEL_value *value, const EEL_value *from)
 static inline void eel_v_copy(EEL_value *value, const EEL_value *from)
 {
 #ifdef EEL_CLEAN_COPY
-	value->classid = from->classid;
-	switch(from->classid)
+	switch(EEL_VCLASS(from))
 	{
 	  case EEL_CNIL:
+		eel_nil2v(value);
 		return;
 	  case EEL_CREAL:
-		value->real.v = from->real.v;
+		eel_d2v(value, EEL_VREAL(from));
 		return;
 	  case EEL_CINTEGER:
 	  case EEL_CBOOLEAN:
 	  case EEL_CCLASSID:
-		value->integer.v = from->integer.v;
+		eel_i2v(value, EEL_VCLASS(from), EEL_VINT(from));
 		return;
 	  case EEL_COBJREF:
-		value->objref.v = from->objref.v;
-		eel_o_own(value->objref.v);
+		eel_o2v(value, eel_v2o(from));
+		eel_o_own(eel_v2o(value));
 		return;
 	  case EEL_CWEAKREF:
 		DBG7W(fprintf(stderr, "eel_v_copy(): WEAKREF %p -> %p!\n",
 				from, value);)
-		value->objref.v = from->objref.v;
-		DBG7W(fprintf(stderr, "      ptr = %p\n", value->objref.v);)
+		eel_o2wr(value, eel_v2o(from));
+		DBG7W(fprintf(stderr, "      ptr = %p\n", eel_v2o(value));)
 		DBG7W(fprintf(stderr, " refcount = %d\n",
-				value->objref.v->refcount);)
-		if(from->objref.index == EEL_WEAKREF_UNWIRED)
+				eel_v2o(value)->refcount);)
+		if(EEL_VUNWIRED(from))
 		{
 			DBG7W(fprintf(stderr, "     UNWIRED! Attached!\n");)
 			eel_weakref_attach(value);
 			DBG7W(fprintf(stderr, "    index = %d\n",
-					value->objref.index);)
+					eel__weakref_index(
+					eel_v2o(value)->weakrefs, value));)
 		}
 		else
 		{
 			DBG7W(fprintf(stderr, "     Converted to OBJREF!\n");)
-			value->classid = EEL_COBJREF;
-			eel_o_own(value->objref.v);
+			eel_v_setclass(value, EEL_COBJREF);
+			eel_o_own(eel_v2o(value));
 		}
 		DBG7W(fprintf(stderr, "eel_v_copy(): Done!\n");)
 		return;
 	}
 	fprintf(stderr, "INTERNAL ERROR: Tried to copy "
 			"a value of illegal class %d!\n",
-			value->classid);
+			EEL_VCLASS(from));
 	DBGZ2(abort();)
 #else
 	*value = *from;
-	if(value->classid == EEL_COBJREF)
-		eel_o_own(value->objref.v);
-	else if(value->classid == EEL_CWEAKREF)
+	if(EEL_VCLASS(value) == EEL_COBJREF)
+		eel_o_own(eel_v2o(value));
+	else if(EEL_VCLASS(value) == EEL_CWEAKREF)
 	{
-		if(from->objref.index == EEL_WEAKREF_UNWIRED)
+		if(EEL_VUNWIRED(from))
 			eel_weakref_attach(value);
 		else
 		{
-			value->classid = EEL_COBJREF;
-			eel_o_own(value->objref.v);
+			eel_v_setclass(value, EEL_COBJREF);
+			eel_o_own(eel_v2o(value));
 		}
 	}
 #endif
@@ -760,37 +841,36 @@ static inline void eel_v_copy(EEL_value *value, const EEL_value *from)
 static inline void eel_v_move(EEL_value *value, const EEL_value *from)
 {
 #ifdef EEL_CLEAN_COPY
-	value->classid = from->classid;
-	switch(from->classid)
+	switch(EEL_VCLASS(from))
 	{
 	  case EEL_CNIL:
+		eel_nil2v(value);
 		return;
 	  case EEL_CREAL:
-		value->real.v = from->real.v;
+		eel_d2v(value, EEL_VREAL(from));
 		return;
 	  case EEL_CINTEGER:
 	  case EEL_CBOOLEAN:
 	  case EEL_CCLASSID:
-		value->integer.v = from->integer.v;
+		eel_i2v(value, EEL_VCLASS(from), EEL_VINT(from));
 		return;
 	  case EEL_COBJREF:
-		value->objref.v = from->objref.v;
+		eel_o2v(value, eel_v2o(from));
 		return;
 	  case EEL_CWEAKREF:
 		DBG7W(fprintf(stderr, "eel_v_move(): WEAKREF!\n");)
-		value->objref.v = from->objref.v;
-		value->objref.index = from->objref.index;
-		eel_weakref_relocate(value);
+		*value = *from;
+		eel_weakref_relocate(value, from);
 		return;
 	}
 	fprintf(stderr, "INTERNAL ERROR: Tried to move "
 			"a value of illegal class %d!\n",
-			value->classid);
+			EEL_VCLASS(from));
 	DBGZ2(abort();)
 #else
 	*value = *from;
-	if(value->classid == EEL_CWEAKREF)
-		eel_weakref_relocate(value);
+	if(EEL_VCLASS(value) == EEL_CWEAKREF)
+		eel_weakref_relocate(value, from);
 #endif
 }
 
@@ -804,36 +884,32 @@ static inline void eel_v_move(EEL_value *value, const EEL_value *from)
 static inline void eel_v_qcopy(EEL_value *value, const EEL_value *from)
 {
 #ifdef EEL_CLEAN_COPY
-	value->classid = from->classid;
-	switch(from->classid)
+	switch(EEL_VCLASS(from))
 	{
 	  case EEL_CNIL:
+		eel_nil2v(value);
 		return;
 	  case EEL_CREAL:
-		value->real.v = from->real.v;
+		eel_d2v(value, EEL_VREAL(from));
 		return;
 	  case EEL_CINTEGER:
 	  case EEL_CBOOLEAN:
 	  case EEL_CCLASSID:
-		value->integer.v = from->integer.v;
+		eel_i2v(value, EEL_VCLASS(from), EEL_VINT(from));
 		return;
 	  case EEL_COBJREF:
-		value->objref.v = from->objref.v;
-		return;
 	  case EEL_CWEAKREF:
-		DBG7W(fprintf(stderr, "eel_v_qcopy(): WEAKREF!\n");)
-		value->objref.v = from->objref.v;
-		value->classid = EEL_COBJREF;
+		eel_o2v(value, eel_v2o(from));
 		return;
 	}
 	fprintf(stderr, "INTERNAL ERROR: Tried to qcopy "
 			"a value of illegal class %d!\n",
-			value->classid);
+			EEL_VCLASS(from));
 	DBGZ2(abort();)
 #else
 	*value = *from;
-	if(value->classid == EEL_CWEAKREF)
-		value->classid = EEL_COBJREF;
+	if(EEL_VCLASS(value) == EEL_CWEAKREF)
+		eel_v_setclass(value, EEL_COBJREF);
 #endif
 }
 
@@ -866,30 +942,30 @@ static inline EEL_xno eel_get_delete_range(int *i0, int *i1,
 	if(op1)
 	{
 		/* Get start index */
-		switch(op1->classid)
+		switch(EEL_VCLASS(op1))
 		{
 		  case EEL_CBOOLEAN:
 		  case EEL_CINTEGER:
 		  case EEL_CCLASSID:
-			*i0 = op1->integer.v;
+			*i0 = EEL_VINT(op1);
 			break;
 		  case EEL_CREAL:
-			*i0 = floor(op1->real.v);
+			*i0 = floor(EEL_VREAL(op1));
 			break;
 		  default:
 			return EEL_XWRONGTYPE;
 		}
 		if(op2)
 			/* Get item count */
-			switch(op2->classid)
+			switch(EEL_VCLASS(op2))
 			{
 			  case EEL_CBOOLEAN:
 			  case EEL_CINTEGER:
 			  case EEL_CCLASSID:
-				*i1 = *i0 + op2->integer.v - 1;
+				*i1 = *i0 + EEL_VINT(op2) - 1;
 				break;
 			  case EEL_CREAL:
-				*i1 = *i0 + floor(op2->real.v) - 1;
+				*i1 = *i0 + floor(EEL_VREAL(op2)) - 1;
 				break;
 			  default:
 				return EEL_XWRONGTYPE;
@@ -31,10 +31,9 @@ static inline EEL_xno eel_op_in(EEL_object *o, EEL_value *v, EEL_value *r)
 	EEL_xno x = eel_o__metamethod(o, EEL_MM_IN, v, r);
 	if(x)
 		return x;
-	if(r->classid == EEL_CINTEGER)
+	if(EEL_VCLASS(r) == EEL_CINTEGER)
 	{
-		r->classid = EEL_CBOOLEAN;
-		r->integer.v = 1;
+		eel_b2v(r, 1);
 	}
 	return 0;
 }
@@ -45,7 +44,7 @@ EEL_xno eel_object_op(EEL_value *left, int binop, EEL_value *right,
 {
 	EEL_xno x;
 	EEL_value v;
-	EEL_object *o = left->objref.v;
+	EEL_object *o = eel_v2o(left);
 	switch(binop)
 	{
 	  case EEL_OP_POWER:
@@ -76,49 +75,46 @@ EEL_xno eel_object_op(EEL_value *left, int binop, EEL_value *right,
 
 	  /* Boolean (any object == true) */
 	  case EEL_OP_AND:
-		result->classid = EEL_CBOOLEAN;
-		switch(right->classid)
+		switch(EEL_VCLASS(right))
 		{
 		  case EEL_CNIL:
-			result->integer.v = 0;
+			eel_b2v(result, 0);
 			break;
 		  case EEL_CREAL:
-			result->integer.v = (right->real.v != 0.0f);
+			eel_b2v(result, EEL_VREAL(right) != 0.0f);
 			break;
 		  case EEL_CINTEGER:
 		  case EEL_CBOOLEAN:
-			result->integer.v = (right->integer.v != 0);
+			eel_b2v(result, EEL_VINT(right) != 0);
 			break;
 		  case EEL_CCLASSID:
 		  case EEL_COBJREF:
 		  case EEL_CWEAKREF:
-			result->integer.v = 1;
+			eel_b2v(result, 1);
 			break;
 		  default:
 			return 0;
 		}
 	  case EEL_OP_OR:
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = 1;
+		eel_b2v(result, 1);
 		return 0;
 	  case EEL_OP_XOR:
-		result->classid = EEL_CBOOLEAN;
-		switch(right->classid)
+		switch(EEL_VCLASS(right))
 		{
 		  case EEL_CNIL:
-			result->integer.v = 1;
+			eel_b2v(result, 1);
 			break;
 		  case EEL_CREAL:
-			result->integer.v = (right->real.v == 0.0f);
+			eel_b2v(result, EEL_VREAL(right) == 0.0f);
 			break;
 		  case EEL_CINTEGER:
 		  case EEL_CBOOLEAN:
-			result->integer.v = (right->integer.v == 0);
+			eel_b2v(result, EEL_VINT(right) == 0);
 			break;
 		  case EEL_CCLASSID:
 		  case EEL_COBJREF:
 		  case EEL_CWEAKREF:
-			result->integer.v = 0;
+			eel_b2v(result, 0);
 			break;
 		  default:
 			return 0;
@@ -132,52 +128,47 @@ EEL_xno eel_object_op(EEL_value *left, int binop, EEL_value *right,
 		if(inplace)
 			return EEL_XCANTINPLACE;
 		x = eel_o__metamethod(o, EEL_MM_EQ, right, result);
-		result->integer.v = !result->integer.v;
+		eel_b2v(result, !EEL_VINT(result));
 		return x;
 	  case EEL_OP_GT:
 		if(inplace)
 			return EEL_XCANTINPLACE;
 		x = eel_o__metamethod(o, EEL_MM_COMPARE, right, result);
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = result->integer.v > 0;
+		eel_b2v(result, EEL_VINT(result) > 0);
 		return x;
 	  case EEL_OP_GE:
 		if(inplace)
 			return EEL_XCANTINPLACE;
 		x = eel_o__metamethod(o, EEL_MM_COMPARE, right, result);
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = result->integer.v >= 0;
+		eel_b2v(result, EEL_VINT(result) >= 0);
 		return x;
 	  case EEL_OP_LT:
 		if(inplace)
 			return EEL_XCANTINPLACE;
 		x = eel_o__metamethod(o, EEL_MM_COMPARE, right, result);
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = result->integer.v < 0;
+		eel_b2v(result, EEL_VINT(result) < 0);
 		return x;
 	  case EEL_OP_LE:
 		if(inplace)
 			return EEL_XCANTINPLACE;
 		x = eel_o__metamethod(o, EEL_MM_COMPARE, right, result);
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = result->integer.v <= 0;
+		eel_b2v(result, EEL_VINT(result) <= 0);
 		return x;
 	  case EEL_OP_IN:
 		if(inplace)
 			return EEL_XCANTINPLACE;
-		if(!EEL_IS_OBJREF(right->classid))
+		if(!EEL_IS_OBJREF(EEL_VCLASS(right)))
 		{
 			/* Not an indexable object, so "no"! */
-			result->classid = EEL_CBOOLEAN;
-			result->integer.v = 0;
+			eel_b2v(result, 0);
 			return 0;
 		}
-		return eel_op_in(right->objref.v, left, result);
+		return eel_op_in(eel_v2o(right), left, result);
 	  case EEL_OP_MIN:
 		if(inplace)
 			return EEL_XCANTINPLACE;
 		x = eel_o__metamethod(o, EEL_MM_COMPARE, right, &v);
-		if(v.integer.v <= 0)
+		if(EEL_VINT(&v) <= 0)
 			eel_v_copy(result, left);
 		else
 			eel_v_copy(result, right);
@@ -186,7 +177,7 @@ EEL_xno eel_object_op(EEL_value *left, int binop, EEL_value *right,
 		if(inplace)
 			return EEL_XCANTINPLACE;
 		x = eel_o__metamethod(o, EEL_MM_COMPARE, right, &v);
-		if(v.integer.v >= 0)
+		if(EEL_VINT(&v) >= 0)
 			eel_v_copy(result, left);
 		else
 			eel_v_copy(result, right);
@@ -208,7 +199,7 @@ EEL_xno eel_object_rop(EEL_value *left, int binop, EEL_value *right,
 {
 	EEL_xno x;
 	EEL_value v;
-	EEL_object *o = left->objref.v;
+	EEL_object *o = eel_v2o(left);
 	switch(binop)
 	{
 	  case EEL_OP_POWER:
@@ -239,49 +230,46 @@ EEL_xno eel_object_rop(EEL_value *left, int binop, EEL_value *right,
 
 	  /* Boolean (any object == true) */
 	  case EEL_OP_AND:
-		result->classid = EEL_CBOOLEAN;
-		switch(right->classid)
+		switch(EEL_VCLASS(right))
 		{
 		  case EEL_CNIL:
-			result->integer.v = 0;
+			eel_b2v(result, 0);
 			break;
 		  case EEL_CREAL:
-			result->integer.v = (right->real.v != 0.0f);
+			eel_b2v(result, EEL_VREAL(right) != 0.0f);
 			break;
 		  case EEL_CINTEGER:
 		  case EEL_CBOOLEAN:
-			result->integer.v = (right->integer.v != 0);
+			eel_b2v(result, EEL_VINT(right) != 0);
 			break;
 		  case EEL_CCLASSID:
 		  case EEL_COBJREF:
 		  case EEL_CWEAKREF:
-			result->integer.v = 1;
+			eel_b2v(result, 1);
 			break;
 		  default:
 			return 0;
 		}
 	  case EEL_OP_OR:
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = 1;
+		eel_b2v(result, 1);
 		return 0;
 	  case EEL_OP_XOR:
-		result->classid = EEL_CBOOLEAN;
-		switch(right->classid)
+		switch(EEL_VCLASS(right))
 		{
 		  case EEL_CNIL:
-			result->integer.v = 1;
+			eel_b2v(result, 1);
 			break;
 		  case EEL_CREAL:
-			result->integer.v = (right->real.v == 0.0f);
+			eel_b2v(result, EEL_VREAL(right) == 0.0f);
 			break;
 		  case EEL_CINTEGER:
 		  case EEL_CBOOLEAN:
-			result->integer.v = (right->integer.v == 0);
+			eel_b2v(result, EEL_VINT(right) == 0);
 			break;
 		  case EEL_CCLASSID:
 		  case EEL_COBJREF:
 		  case EEL_CWEAKREF:
-			result->integer.v = 0;
+			eel_b2v(result, 0);
 			break;
 		  default:
 			return 0;
@@ -296,13 +284,13 @@ EEL_xno eel_object_rop(EEL_value *left, int binop, EEL_value *right,
 		if(inplace)
 			return EEL_XCANTINPLACE;
 		x = eel_o__metamethod(o, EEL_MM_EQ, right, result);
-		result->integer.v = !result->integer.v;
+		eel_b2v(result, !EEL_VINT(result));
 		return x;
 	  case EEL_OP_MIN:
 		if(inplace)
 			return EEL_XCANTINPLACE;
 		x = eel_o__metamethod(o, EEL_MM_COMPARE, right, &v);
-		if(v.integer.v <= 0)
+		if(EEL_VINT(&v) <= 0)
 			eel_v_copy(result, left);
 		else
 			eel_v_copy(result, right);
@@ -311,7 +299,7 @@ EEL_xno eel_object_rop(EEL_value *left, int binop, EEL_value *right,
 		if(inplace)
 			return EEL_XCANTINPLACE;
 		x = eel_o__metamethod(o, EEL_MM_COMPARE, right, &v);
-		if(v.integer.v >= 0)
+		if(EEL_VINT(&v) >= 0)
 			eel_v_copy(result, left);
 		else
 			eel_v_copy(result, right);
@@ -322,29 +310,25 @@ EEL_xno eel_object_rop(EEL_value *left, int binop, EEL_value *right,
 		if(inplace)
 			return EEL_XCANTINPLACE;
 		x = eel_o__metamethod(o, EEL_MM_COMPARE, right, &v);
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = v.integer.v < 0;
+		eel_b2v(result, EEL_VINT(&v) < 0);
 		break;
 	  case EEL_OP_GE:
 		if(inplace)
 			return EEL_XCANTINPLACE;
 		x = eel_o__metamethod(o, EEL_MM_COMPARE, right, &v);
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = v.integer.v <= 0;
+		eel_b2v(result, EEL_VINT(&v) <= 0);
 		break;
 	  case EEL_OP_LT:
 		if(inplace)
 			return EEL_XCANTINPLACE;
 		x = eel_o__metamethod(o, EEL_MM_COMPARE, right, &v);
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = v.integer.v > 0;
+		eel_b2v(result, EEL_VINT(&v) > 0);
 		break;
 	  case EEL_OP_LE:
 		if(inplace)
 			return EEL_XCANTINPLACE;
 		x = eel_o__metamethod(o, EEL_MM_COMPARE, right, &v);
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = v.integer.v >= 0;
+		eel_b2v(result, EEL_VINT(&v) >= 0);
 		break;
 
 	  /* <non-object> in <object> */
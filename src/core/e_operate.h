@@ -134,7 +134,7 @@ static inline EEL_xno eel_o__metamethod(EEL_object *object,
 	c = VMP->state->classes[object->classid];
 	cd = o2EEL_classdef(c);
 	x = cd->mmethods[mm](object, op1, op2);
-	DBGM(if(!x && (mm != EEL_MM_DELETE) && (op2->classid == EEL_COBJREF) &&
+	DBGM(if(!x && (mm != EEL_MM_DELETE) && (EEL_VCLASS(op2) == EEL_COBJREF) &&
 			(old_owns == VMP->owns))
 		eel_ierror(VMP->state, "Metamethod %s::%s received or "
 				"returned an object, but no one inc'ed any "
@@ -159,14 +159,14 @@ static inline EEL_xno eel_o__metamethod(EEL_object *object,
  */
 static inline int eel_get_indexval(EEL_vm *vm, EEL_value *v)
 {
-	switch(v->classid)
+	switch(EEL_VCLASS(v))
 	{
 	  case EEL_CREAL:
-		return floor(v->real.v);
+		return floor(EEL_VREAL(v));
 	  case EEL_CINTEGER:
 	  case EEL_CBOOLEAN:
 	  case EEL_CCLASSID:
-		return v->integer.v;
+		return EEL_VINT(v);
 	  default:
 		return -1;
 	}
@@ -179,18 +179,18 @@ static inline int eel_get_indexval(EEL_vm *vm, EEL_value *v)
  */
 static inline double eel_get_realval(EEL_vm *vm, EEL_value *v, double *dv)
 {
-	switch(v->classid)
+	switch(EEL_VCLASS(v))
 	{
 	  case EEL_CNIL:
 		*dv = 0.0;
 		return 0;
 	  case EEL_CREAL:
-		*dv = v->real.v;
+		*dv = EEL_VREAL(v);
 		return 0;
 	  case EEL_CINTEGER:
 	  case EEL_CBOOLEAN:
 	  case EEL_CCLASSID:
-		*dv = v->integer.v;
+		*dv = EEL_VINT(v);
 		return 0;
 	  case EEL_COBJREF:
 	  case EEL_CWEAKREF:
@@ -200,7 +200,7 @@ static inline double eel_get_realval(EEL_vm *vm, EEL_value *v, double *dv)
 		x = eel_cast(vm, v, &result, EEL_CREAL);
 		if(x)
 			return x;
-		*dv = result.integer.v;
+		*dv = EEL_VINT(&result);
 		return 0;
 	  }
 	  default:
@@ -216,9 +216,9 @@ static inline double eel_get_realval(EEL_vm *vm, EEL_value *v, double *dv)
 static inline EEL_xno eel__op_fallback(EEL_value *left, int binop, EEL_value *right,
 		EEL_value *result)
 {
-	if(EEL_IS_OBJREF(left->classid))
+	if(EEL_IS_OBJREF(EEL_VCLASS(left)))
 		return eel_object_op(left, binop, right, result, 0);
-	else if(EEL_IS_OBJREF(right->classid))
+	else if(EEL_IS_OBJREF(EEL_VCLASS(right)))
 		return eel_object_rop(right, binop, left, result, 0);
 	else
 		return EEL_XNOTIMPLEMENTED;
@@ -232,22 +232,22 @@ static inline EEL_xno eel__op_fallback(EEL_value *left, int binop, EEL_value *ri
 static inline int eel_test_nz(EEL_vm *vm, EEL_value *opr)
 {
 	DBG6(printf("test_nz heap[%ld] ", opr - vm->heap);)
-	switch(opr->classid)
+	switch(EEL_VCLASS(opr))
 	{
 	  case EEL_CNIL:
 		DBG6(printf(" NIL\n");)
 		return 0;
 	  case EEL_CREAL:
-		DBG6(printf(" REAL %g\n", opr->real.v);)
-		return opr->real.v != 0.0;
+		DBG6(printf(" REAL %g\n", EEL_VREAL(opr));)
+		return EEL_VREAL(opr) != 0.0;
 	  case EEL_CINTEGER:
-		DBG6(printf(" INTEGER %d\n", opr->integer.v);)
-		return opr->integer.v != 0;
+		DBG6(printf(" INTEGER %d\n", EEL_VINT(opr));)
+		return EEL_VINT(opr) != 0;
 	  case EEL_CBOOLEAN:
-		DBG6(printf(" BOOLEAN %s\n", opr->integer.v ? "true" : "false");)
-		return opr->integer.v;
+		DBG6(printf(" BOOLEAN %s\n", EEL_VINT(opr) ? "true" : "false");)
+		return EEL_VINT(opr);
 	  case EEL_CCLASSID:
-		DBG6(printf(" TYPEID %s\n", eel_typename(vm, opr->integer.v));)
+		DBG6(printf(" TYPEID %s\n", eel_typename(vm, EEL_VINT(opr)));)
 		return 1;
 	  case EEL_COBJREF:	/* An object is "something". (nil is nothing.) */
 		DBG6(printf(" OBJREF %s\n", eel_v_stringrep(vm, opr));)
@@ -264,7 +264,7 @@ static inline int eel_test_nz(EEL_vm *vm, EEL_value *opr)
 static inline EEL_xno eel_op_and(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CREAL):
@@ -275,24 +275,20 @@ static inline EEL_xno eel_op_and(EEL_value *left, EEL_value *right,
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CNIL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = 0;
+		eel_b2v(result, 0);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CREAL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->real.v && right->real.v;
+		eel_b2v(result, EEL_VREAL(left) && EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CCLASSID):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->real.v && right->integer.v;
+		eel_b2v(result, EEL_VREAL(left) && EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CREAL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->integer.v && right->real.v;
+		eel_b2v(result, EEL_VINT(left) && EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
@@ -303,8 +299,7 @@ static inline EEL_xno eel_op_and(EEL_value *left, EEL_value *right,
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CCLASSID):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->integer.v && right->integer.v;
+		eel_b2v(result, EEL_VINT(left) && EEL_VINT(right));
 		return 0;
 	  default:
 		return eel__op_fallback(left, EEL_OP_AND, right, result);
@@ -314,47 +309,39 @@ static inline EEL_xno eel_op_and(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_or(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CNIL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = 0;
+		eel_b2v(result, 0);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CREAL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = right->real.v != 0.0;
+		eel_b2v(result, EEL_VREAL(right) != 0.0);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CCLASSID):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = right->integer.v != 0.0;
+		eel_b2v(result, EEL_VINT(right) != 0.0);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CNIL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->real.v != 0.0;
+		eel_b2v(result, EEL_VREAL(left) != 0.0);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CNIL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->integer.v != 0.0;
+		eel_b2v(result, EEL_VINT(left) != 0.0);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CREAL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->real.v || right->real.v;
+		eel_b2v(result, EEL_VREAL(left) || EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CCLASSID):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->real.v || right->integer.v;
+		eel_b2v(result, EEL_VREAL(left) || EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CREAL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->integer.v || right->real.v;
+		eel_b2v(result, EEL_VINT(left) || EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
@@ -365,8 +352,7 @@ static inline EEL_xno eel_op_or(EEL_value *left, EEL_value *right,
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CCLASSID):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->integer.v || right->integer.v;
+		eel_b2v(result, EEL_VINT(left) || EEL_VINT(right));
 		return 0;
 	  default:
 		return eel__op_fallback(left, EEL_OP_OR, right, result);
@@ -376,47 +362,39 @@ static inline EEL_xno eel_op_or(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_xor(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CNIL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = 0;
+		eel_b2v(result, 0);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CREAL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = right->real.v != 0.0;
+		eel_b2v(result, EEL_VREAL(right) != 0.0);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CCLASSID):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = right->integer.v != 0.0;
+		eel_b2v(result, EEL_VINT(right) != 0.0);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CNIL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->real.v != 0.0;
+		eel_b2v(result, EEL_VREAL(left) != 0.0);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CNIL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->integer.v != 0.0;
+		eel_b2v(result, EEL_VINT(left) != 0.0);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CREAL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = (left->real.v != 0.0) ^ (right->real.v != 0.0);
+		eel_b2v(result, (EEL_VREAL(left) != 0.0) ^ (EEL_VREAL(right) != 0.0));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CCLASSID):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = (left->real.v != 0.0) ^ (right->integer.v != 0);
+		eel_b2v(result, (EEL_VREAL(left) != 0.0) ^ (EEL_VINT(right) != 0));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CREAL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = (left->integer.v != 0) ^ (right->real.v != 0.0);
+		eel_b2v(result, (EEL_VINT(left) != 0) ^ (EEL_VREAL(right) != 0.0));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
@@ -427,8 +405,7 @@ static inline EEL_xno eel_op_xor(EEL_value *left, EEL_value *right,
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CCLASSID):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = (left->integer.v != 0) ^ (right->integer.v != 0);
+		eel_b2v(result, (EEL_VINT(left) != 0) ^ (EEL_VINT(right) != 0));
 		return 0;
 	  default:
 		return eel__op_fallback(left, EEL_OP_XOR, right, result);
@@ -438,11 +415,10 @@ static inline EEL_xno eel_op_xor(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_eq(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CNIL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = 1;
+		eel_b2v(result, 1);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CINTEGER):
@@ -462,26 +438,21 @@ static inline EEL_xno eel_op_eq(EEL_value *left, EEL_value *right,
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CCLASSID):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CINTEGER):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = 0;
+		eel_b2v(result, 0);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CREAL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->real.v == right->real.v;
+		eel_b2v(result, EEL_VREAL(left) == EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CINTEGER):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->real.v == (EEL_real)right->integer.v;
+		eel_b2v(result, EEL_VREAL(left) == (EEL_real)EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CREAL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = (EEL_real)left->integer.v == right->real.v;
+		eel_b2v(result, (EEL_real)EEL_VINT(left) == EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CCLASSID):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->integer.v == right->integer.v;
+		eel_b2v(result, EEL_VINT(left) == EEL_VINT(right));
 		return 0;
 	  default:
 		return eel__op_fallback(left, EEL_OP_EQ, right, result);
@@ -494,45 +465,40 @@ static inline EEL_xno eel_op_ne(EEL_value *left, EEL_value *right,
 	EEL_xno res = eel_op_eq(left, right, result);
 	if(res)
 		return res;
-	result->integer.v = !result->integer.v;
+	eel_b2v(result, !EEL_VINT(result));
 	return 0;
 }
 
 static inline EEL_xno eel_op_gt(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CCLASSID):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = 0;
+		eel_b2v(result, 0);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CNIL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = 1;
+		eel_b2v(result, 1);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CREAL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->real.v > right->real.v;
+		eel_b2v(result, EEL_VREAL(left) > EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CCLASSID):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->real.v > (EEL_real)right->integer.v;
+		eel_b2v(result, EEL_VREAL(left) > (EEL_real)EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CREAL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = (EEL_real)left->integer.v > right->real.v;
+		eel_b2v(result, (EEL_real)EEL_VINT(left) > EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
@@ -543,8 +509,7 @@ static inline EEL_xno eel_op_gt(EEL_value *left, EEL_value *right,
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CCLASSID):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->integer.v > right->integer.v;
+		eel_b2v(result, EEL_VINT(left) > EEL_VINT(right));
 		return 0;
 	  default:
 		return eel__op_fallback(left, EEL_OP_GT, right, result);
@@ -554,38 +519,33 @@ static inline EEL_xno eel_op_gt(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_ge(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CNIL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = 1;
+		eel_b2v(result, 1);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CCLASSID):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = 0;
+		eel_b2v(result, 0);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CREAL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->real.v >= right->real.v;
+		eel_b2v(result, EEL_VREAL(left) >= EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CCLASSID):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->real.v >= (EEL_real)right->integer.v;
+		eel_b2v(result, EEL_VREAL(left) >= (EEL_real)EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CREAL):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = (EEL_real)left->integer.v >= right->real.v;
+		eel_b2v(result, (EEL_real)EEL_VINT(left) >= EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
@@ -596,8 +556,7 @@ static inline EEL_xno eel_op_ge(EEL_value *left, EEL_value *right,
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CCLASSID):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->integer.v >= right->integer.v;
+		eel_b2v(result, EEL_VINT(left) >= EEL_VINT(right));
 		return 0;
 	  default:
 		return eel__op_fallback(left, EEL_OP_GE, right, result);
@@ -610,7 +569,7 @@ static inline EEL_xno eel_op_lt(EEL_value *left, EEL_value *right,
 	EEL_xno res = eel_op_ge(left, right, result);
 	if(res)
 		return res;
-	result->integer.v = !result->integer.v;
+	eel_b2v(result, !EEL_VINT(result));
 	return 0;
 }
 
@@ -620,7 +579,7 @@ static inline EEL_xno eel_op_le(EEL_value *left, EEL_value *right,
 	EEL_xno res = eel_op_gt(left, right, result);
 	if(res)
 		return res;
-	result->integer.v = !result->integer.v;
+	eel_b2v(result, !EEL_VINT(result));
 	return 0;
 }
 
@@ -632,37 +591,33 @@ static inline EEL_xno eel_op_le(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_power(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CCLASSID):
-		result->classid = EEL_CNIL;
+		eel_nil2v(result);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CNIL):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = 1;
+		eel_l2v(result, 1);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CREAL):
-		result->classid = EEL_CREAL;
-		result->real.v = pow(left->real.v, right->real.v);
+		eel_d2v(result, pow(EEL_VREAL(left), EEL_VREAL(right)));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CCLASSID):
-		result->classid = EEL_CREAL;
-		result->real.v = pow(left->real.v, right->integer.v);
+		eel_d2v(result, pow(EEL_VREAL(left), EEL_VINT(right)));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CREAL):
-		result->classid = EEL_CREAL;
-		result->real.v = pow(left->integer.v, right->real.v);
+		eel_d2v(result, pow(EEL_VINT(left), EEL_VREAL(right)));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
@@ -673,9 +628,8 @@ static inline EEL_xno eel_op_power(EEL_value *left, EEL_value *right,
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CCLASSID):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = floor(pow(left->integer.v,
-				right->integer.v));
+		eel_l2v(result, floor(pow(EEL_VINT(left),
+				EEL_VINT(right))));
 		return 0;
 	  default:
 		return eel__op_fallback(left, EEL_OP_POWER, right, result);
@@ -685,7 +639,7 @@ static inline EEL_xno eel_op_power(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_mod(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CNIL):
@@ -694,43 +648,40 @@ static inline EEL_xno eel_op_mod(EEL_value *left, EEL_value *right,
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CNIL):
 		return EEL_XDIVBYZERO;
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CREAL):
-		if(!right->real.v)
+		if(!EEL_VREAL(right))
 			return EEL_XDIVBYZERO;
 		else
-			result->classid = EEL_CNIL;
+			eel_nil2v(result);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CCLASSID):
-		if(!right->integer.v)
+		if(!EEL_VINT(right))
 			return EEL_XDIVBYZERO;
 		else
-			result->classid = EEL_CNIL;
+			eel_nil2v(result);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CREAL):
-		result->classid = EEL_CREAL;
-		if(!right->real.v)
+		if(!EEL_VREAL(right))
 			return EEL_XDIVBYZERO;
 		else
-			result->real.v = fmod(left->real.v, right->real.v);
+			eel_d2v(result, fmod(EEL_VREAL(left), EEL_VREAL(right)));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CCLASSID):
-		result->classid = EEL_CREAL;
-		if(!right->integer.v)
+		if(!EEL_VINT(right))
 			return EEL_XDIVBYZERO;
 		else
-			result->real.v = fmod(left->real.v, right->integer.v);
+			eel_d2v(result, fmod(EEL_VREAL(left), EEL_VINT(right)));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CREAL):
-		result->classid = EEL_CREAL;
-		if(!right->real.v)
+		if(!EEL_VREAL(right))
 			return EEL_XDIVBYZERO;
 		else
-			result->real.v = fmod(left->integer.v, right->real.v);
+			eel_d2v(result, fmod(EEL_VINT(left), EEL_VREAL(right)));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
@@ -741,11 +692,10 @@ static inline EEL_xno eel_op_mod(EEL_value *left, EEL_value *right,
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CCLASSID):
-		result->classid = EEL_CINTEGER;
-		if(!right->integer.v)
+		if(!EEL_VINT(right))
 			return EEL_XDIVBYZERO;
 		else
-			result->integer.v = left->integer.v % right->integer.v;
+			eel_l2v(result, EEL_VINT(left) % EEL_VINT(right));
 		return 0;
 	  default:
 		return eel__op_fallback(left, EEL_OP_MOD, right, result);
@@ -755,7 +705,7 @@ static inline EEL_xno eel_op_mod(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_div(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CNIL):
@@ -764,43 +714,40 @@ static inline EEL_xno eel_op_div(EEL_value *left, EEL_value *right,
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CNIL):
 		return EEL_XDIVBYZERO;
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CREAL):
-		if(!right->real.v)
+		if(!EEL_VREAL(right))
 			return EEL_XDIVBYZERO;
 		else
-			result->classid = EEL_CNIL;
+			eel_nil2v(result);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CCLASSID):
-		if(!right->integer.v)
+		if(!EEL_VINT(right))
 			return EEL_XDIVBYZERO;
 		else
-			result->classid = EEL_CNIL;
+			eel_nil2v(result);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CREAL):
-		result->classid = EEL_CREAL;
-		if(!right->real.v)
+		if(!EEL_VREAL(right))
 			return EEL_XDIVBYZERO;
 		else
-			result->real.v = left->real.v / right->real.v;
+			eel_d2v(result, EEL_VREAL(left) / EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CCLASSID):
-		result->classid = EEL_CREAL;
-		if(!right->integer.v)
+		if(!EEL_VINT(right))
 			return EEL_XDIVBYZERO;
 		else
-			result->real.v = left->real.v / right->integer.v;
+			eel_d2v(result, EEL_VREAL(left) / EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CREAL):
-		result->classid = EEL_CREAL;
-		if(!right->real.v)
+		if(!EEL_VREAL(right))
 			return EEL_XDIVBYZERO;
 		else
-			result->real.v = left->integer.v / right->real.v;
+			eel_d2v(result, EEL_VINT(left) / EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CCLASSID):
@@ -809,22 +756,20 @@ static inline EEL_xno eel_op_div(EEL_value *left, EEL_value *right,
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CCLASSID):
 #ifdef EEL_PASCAL_IDIV
-		result->classid = EEL_CREAL;
-		if(!right->integer.v)
+		if(!EEL_VINT(right))
 			return EEL_XDIVBYZERO;
 		else
-			result->real.v = (EEL_real)left->integer.v /
-					right->integer.v;
+			eel_d2v(result, (EEL_real)EEL_VINT(left) /
+					EEL_VINT(right));
 		return 0;
 #endif
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CBOOLEAN):
-		result->classid = EEL_CINTEGER;
-		if(!right->integer.v)
+		if(!EEL_VINT(right))
 			return EEL_XDIVBYZERO;
 		else
-			result->integer.v = left->integer.v / right->integer.v;
+			eel_l2v(result, EEL_VINT(left) / EEL_VINT(right));
 		return 0;
 	  default:
 		return eel__op_fallback(left, EEL_OP_DIV, right, result);
@@ -834,7 +779,7 @@ static inline EEL_xno eel_op_div(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_mul(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CREAL):
@@ -845,23 +790,20 @@ static inline EEL_xno eel_op_mul(EEL_value *left, EEL_value *right,
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CNIL):
-		result->classid = EEL_CNIL;
+		eel_nil2v(result);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CREAL):
-		result->classid = EEL_CREAL;
-		result->real.v = left->real.v * right->real.v;
+		eel_d2v(result, EEL_VREAL(left) * EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CCLASSID):
-		result->classid = EEL_CREAL;
-		result->real.v = left->real.v * right->integer.v;
+		eel_d2v(result, EEL_VREAL(left) * EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CREAL):
-		result->classid = EEL_CREAL;
-		result->real.v = left->integer.v * right->real.v;
+		eel_d2v(result, EEL_VINT(left) * EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
@@ -872,8 +814,7 @@ static inline EEL_xno eel_op_mul(EEL_value *left, EEL_value *right,
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CCLASSID):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = left->integer.v * right->integer.v;
+		eel_l2v(result, EEL_VINT(left) * EEL_VINT(right));
 		return 0;
 	  default:
 		return eel__op_fallback(left, EEL_OP_MUL, right, result);
@@ -883,46 +824,39 @@ static inline EEL_xno eel_op_mul(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_sub(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CNIL):
-		result->classid = EEL_CNIL;
+		eel_nil2v(result);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CREAL):
-		result->classid = EEL_CREAL;
-		result->real.v = - right->real.v;
+		eel_d2v(result, - EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CCLASSID):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = - right->integer.v;
+		eel_l2v(result, - EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CNIL):
-		result->classid = EEL_CREAL;
-		result->real.v = left->real.v;
+		eel_d2v(result, EEL_VREAL(left));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CNIL):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = left->integer.v;
+		eel_l2v(result, EEL_VINT(left));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CREAL):
-		result->classid = EEL_CREAL;
-		result->real.v = left->real.v - right->real.v;
+		eel_d2v(result, EEL_VREAL(left) - EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CCLASSID):
-		result->classid = EEL_CREAL;
-		result->real.v = left->real.v - right->integer.v;
+		eel_d2v(result, EEL_VREAL(left) - EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CREAL):
-		result->classid = EEL_CREAL;
-		result->real.v = left->integer.v - right->real.v;
+		eel_d2v(result, EEL_VINT(left) - EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
@@ -933,8 +867,7 @@ static inline EEL_xno eel_op_sub(EEL_value *left, EEL_value *right,
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CCLASSID):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = left->integer.v - right->integer.v;
+		eel_l2v(result, EEL_VINT(left) - EEL_VINT(right));
 		return 0;
 	  default:
 		return eel__op_fallback(left, EEL_OP_SUB, right, result);
@@ -944,46 +877,39 @@ static inline EEL_xno eel_op_sub(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_add(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CNIL):
-		result->classid = EEL_CNIL;
+		eel_nil2v(result);
 		return 0;
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CREAL):
-		result->classid = EEL_CREAL;
-		result->real.v = right->real.v;
+		eel_d2v(result, EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CNIL, EEL_CCLASSID):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = - right->integer.v;
+		eel_l2v(result, - EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CNIL):
-		result->classid = EEL_CREAL;
-		result->real.v = left->real.v;
+		eel_d2v(result, EEL_VREAL(left));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CNIL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CNIL):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = left->integer.v;
+		eel_l2v(result, EEL_VINT(left));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CREAL):
-		result->classid = EEL_CREAL;
-		result->real.v = left->real.v + right->real.v;
+		eel_d2v(result, EEL_VREAL(left) + EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CCLASSID):
-		result->classid = EEL_CREAL;
-		result->real.v = left->real.v + right->integer.v;
+		eel_d2v(result, EEL_VREAL(left) + EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CREAL):
-		result->classid = EEL_CREAL;
-		result->real.v = left->integer.v + right->real.v;
+		eel_d2v(result, EEL_VINT(left) + EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
@@ -994,8 +920,7 @@ static inline EEL_xno eel_op_add(EEL_value *left, EEL_value *right,
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CCLASSID, EEL_CCLASSID):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = left->integer.v + right->integer.v;
+		eel_l2v(result, EEL_VINT(left) + EEL_VINT(right));
 		return 0;
 	  default:
 		return eel__op_fallback(left, EEL_OP_ADD, right, result);
@@ -1010,23 +935,19 @@ static inline EEL_xno eel_op_add(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_band(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = left->integer.v & right->integer.v;
+		eel_l2v(result, EEL_VINT(left) & EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = left->integer.v & -right->integer.v;
+		eel_l2v(result, EEL_VINT(left) & -EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CINTEGER):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = -left->integer.v & right->integer.v;
+		eel_l2v(result, -EEL_VINT(left) & EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CBOOLEAN):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->integer.v && right->integer.v;
+		eel_b2v(result, EEL_VINT(left) && EEL_VINT(right));
 		return 0;
 	  default:
 		return eel__op_fallback(left, EEL_OP_BAND, right, result);
@@ -1036,23 +957,19 @@ static inline EEL_xno eel_op_band(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_bor(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = left->integer.v | right->integer.v;
+		eel_l2v(result, EEL_VINT(left) | EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = left->integer.v | -right->integer.v;
+		eel_l2v(result, EEL_VINT(left) | -EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CINTEGER):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = -left->integer.v | right->integer.v;
+		eel_l2v(result, -EEL_VINT(left) | EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CBOOLEAN):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->integer.v || right->integer.v;
+		eel_b2v(result, EEL_VINT(left) || EEL_VINT(right));
 		return 0;
 	  default:
 		return eel__op_fallback(left, EEL_OP_BOR, right, result);
@@ -1062,23 +979,19 @@ static inline EEL_xno eel_op_bor(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_bxor(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = left->integer.v ^ right->integer.v;
+		eel_l2v(result, EEL_VINT(left) ^ EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = left->integer.v ^ -right->integer.v;
+		eel_l2v(result, EEL_VINT(left) ^ -EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CINTEGER):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = -left->integer.v ^ right->integer.v;
+		eel_l2v(result, -EEL_VINT(left) ^ EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CBOOLEAN):
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = left->integer.v ^ right->integer.v;
+		eel_b2v(result, EEL_VINT(left) ^ EEL_VINT(right));
 		return 0;
 	  default:
 		return eel__op_fallback(left, EEL_OP_BXOR, right, result);
@@ -1088,26 +1001,23 @@ static inline EEL_xno eel_op_bxor(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_shl(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CBOOLEAN):
-		result->integer.v = (int)left->real.v << right->integer.v;
+		eel_l2v(result, (int)EEL_VREAL(left) << EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CREAL):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = left->integer.v << (int)right->real.v;
+		eel_l2v(result, EEL_VINT(left) << (int)EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CREAL):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = (int)left->real.v << (int)right->real.v;
+		eel_l2v(result, (int)EEL_VREAL(left) << (int)EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CINTEGER):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = left->integer.v << right->integer.v;
+		eel_l2v(result, EEL_VINT(left) << EEL_VINT(right));
 		return 0;
 	  default:
 		return eel__op_fallback(left, EEL_OP_SHL, right, result);
@@ -1117,26 +1027,23 @@ static inline EEL_xno eel_op_shl(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_shr(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CBOOLEAN):
-		result->integer.v = (int)left->real.v >> right->integer.v;
+		eel_l2v(result, (int)EEL_VREAL(left) >> EEL_VINT(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CREAL):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CREAL):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = left->integer.v >> (int)right->real.v;
+		eel_l2v(result, EEL_VINT(left) >> (int)EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CREAL, EEL_CREAL):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = (int)left->real.v >> (int)right->real.v;
+		eel_l2v(result, (int)EEL_VREAL(left) >> (int)EEL_VREAL(right));
 		return 0;
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CINTEGER):
-		result->classid = EEL_CINTEGER;
-		result->integer.v = left->integer.v >> right->integer.v;
+		eel_l2v(result, EEL_VINT(left) >> EEL_VINT(right));
 		return 0;
 	  default:
 		return eel__op_fallback(left, EEL_OP_SHR, right, result);
@@ -1146,16 +1053,15 @@ static inline EEL_xno eel_op_shr(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_rol(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CINTEGER):
 	  {
-		int sh = right->integer.v & 31;
-		unsigned int v = left->integer.v;
-		result->classid = EEL_CINTEGER;
-		result->integer.v = (v << sh) | (v >> (32 - sh));
+		int sh = EEL_VINT(right) & 31;
+		unsigned int v = EEL_VINT(left);
+		eel_l2v(result, (v << sh) | (v >> (32 - sh)));
 		return 0;
 	  }
 	  default:
@@ -1166,16 +1072,15 @@ static inline EEL_xno eel_op_rol(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_ror(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CBOOLEAN):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CINTEGER):
 	  {
-	  	int sh = right->integer.v & 31;
-		unsigned int v = left->integer.v;
-		result->classid = EEL_CINTEGER;
-		result->integer.v = (v >> sh) | (v << (32 - sh));
+	  	int sh = EEL_VINT(right) & 31;
+		unsigned int v = EEL_VINT(left);
+		eel_l2v(result, (v >> sh) | (v << (32 - sh)));
 		return 0;
 	  }
 	  default:
@@ -1186,26 +1091,25 @@ static inline EEL_xno eel_op_ror(EEL_value *left, EEL_value *right,
 static inline EEL_xno eel_op_brev(EEL_value *left, EEL_value *right,
 		EEL_value *result)
 {
-	switch(EEL_MK2TYPES(left->classid, right->classid))
+	switch(EEL_MK2TYPES(EEL_VCLASS(left), EEL_VCLASS(right)))
 	{
 	  case EEL_MK2TYPES(EEL_CINTEGER, EEL_CINTEGER):
 	  case EEL_MK2TYPES(EEL_CBOOLEAN, EEL_CINTEGER):
 	  {
 /*FIXME: Add support for non-32-bit EEL_integer! */
 		EEL_uint32 tmp;
-		if(right->integer.v > 32)
+		if(EEL_VINT(right) > 32)
 			return EEL_XHIGHVALUE;
-		else if(right->integer.v < 0)
+		else if(EEL_VINT(right) < 0)
 			return EEL_XLOWVALUE;
-		tmp = left->integer.v;
+		tmp = EEL_VINT(left);
 		tmp = (tmp << 16) | (tmp >> 16);
 		tmp = ((tmp & 0x00ff00ff) << 8) | ((tmp & 0xff00ff00) >> 8);
 		tmp = ((tmp & 0x0f0f0f0f) << 4) | ((tmp & 0xf0f0f0f0) >> 4);
 		tmp = ((tmp & 0x33333333) << 2) | ((tmp & 0xcccccccc) >> 2);
 		tmp = ((tmp & 0x55555555) << 1) | ((tmp & 0xaaaaaaaa) >> 1);
-		tmp >>= 32 - right->integer.v;
-		result->classid = EEL_CINTEGER;
-		result->integer.v = tmp;
+		tmp >>= 32 - EEL_VINT(right);
+		eel_l2v(result, tmp);
 		return 0;
 	  }
 	  default:
@@ -1225,7 +1129,7 @@ static inline EEL_xno eel_op_max(EEL_value *left, EEL_value *right,
 	EEL_xno res = eel_op_ge(left, right, &r);
 	if(res)
 		return res;
-	if(r.integer.v)
+	if(EEL_VINT(&r))
 		eel_v_copy(result, left);
 	else
 		eel_v_copy(result, right);
@@ -1239,7 +1143,7 @@ static inline EEL_xno eel_op_min(EEL_value *left, EEL_value *right,
 	EEL_xno res = eel_op_ge(left, right, &r);
 	if(res)
 		return res;
-	if(r.integer.v)
+	if(EEL_VINT(&r))
 		eel_v_copy(result, right);
 	else
 		eel_v_copy(result, left);
@@ -1253,16 +1157,14 @@ static inline EEL_xno eel_op_min(EEL_value *left, EEL_value *right,
 
 static inline EEL_xno eel_op_neg(EEL_value *right, EEL_value *result)
 {
-	switch(right->classid)
+	switch(EEL_VCLASS(right))
 	{
 	  case EEL_CREAL:
-		result->classid = EEL_CREAL;
-		result->real.v = -right->real.v;
+		eel_d2v(result, -EEL_VREAL(right));
 		return 0;
 	  case EEL_CINTEGER:
 	  case EEL_CBOOLEAN:
-		result->classid = EEL_CINTEGER;
-		result->integer.v = -right->integer.v;
+		eel_l2v(result, -EEL_VINT(right));
 		return 0;
 	  case EEL_COBJREF:
 	  case EEL_CWEAKREF:
@@ -1274,28 +1176,24 @@ static inline EEL_xno eel_op_neg(EEL_value *right, EEL_value *result)
 
 static inline EEL_xno eel_op_castr(EEL_value *right, EEL_value *result)
 {
-	switch(right->classid)
+	switch(EEL_VCLASS(right))
 	{
 	  case EEL_CNIL:
-		result->classid = EEL_CREAL;
-		result->real.v = 0.0;
+		eel_d2v(result, 0.0);
 		return 0;
 	  case EEL_CREAL:
-		result->classid = EEL_CREAL;
-		result->real.v = right->real.v;
+		eel_d2v(result, EEL_VREAL(right));
 		return 0;
 	  case EEL_CINTEGER:
 	  case EEL_CCLASSID:
-		result->classid = EEL_CREAL;
-		result->real.v = right->integer.v;
+		eel_d2v(result, EEL_VINT(right));
 		return 0;
 	  case EEL_CBOOLEAN:
-		result->classid = EEL_CREAL;
-		result->real.v = right->integer.v ? 1.0 : 0.0;
+		eel_d2v(result, EEL_VINT(right) ? 1.0 : 0.0);
 		return 0;
 	  case EEL_COBJREF:
 	  case EEL_CWEAKREF:
-		return eel_cast(right->objref.v->vm, right, result, EEL_CREAL);
+		return eel_cast(eel_v2o(right)->vm, right, result, EEL_CREAL);
 	  default:
 		return EEL_XWRONGTYPE;
 	}
@@ -1303,25 +1201,22 @@ static inline EEL_xno eel_op_castr(EEL_value *right, EEL_value *result)
 
 static inline EEL_xno eel_op_casti(EEL_value *right, EEL_value *result)
 {
-	switch(right->classid)
+	switch(EEL_VCLASS(right))
 	{
 	  case EEL_CNIL:
-		result->classid = EEL_CINTEGER;
-		result->integer.v = 0;
+		eel_l2v(result, 0);
 		return 0;
 	  case EEL_CREAL:
-		result->classid = EEL_CINTEGER;
-		result->integer.v = floor(right->real.v);
+		eel_l2v(result, floor(EEL_VREAL(right)));
 		return 0;
 	  case EEL_CINTEGER:
 	  case EEL_CBOOLEAN:
 	  case EEL_CCLASSID:
-		result->classid = EEL_CINTEGER;
-		result->integer.v = right->integer.v;
+		eel_l2v(result, EEL_VINT(right));
 		return 0;
 	  case EEL_COBJREF:
 	  case EEL_CWEAKREF:
-		return eel_cast(right->objref.v->vm,
+		return eel_cast(eel_v2o(right)->vm,
 				right, result, EEL_CINTEGER);
 	  default:
 		return EEL_XWRONGTYPE;
@@ -1330,28 +1225,24 @@ static inline EEL_xno eel_op_casti(EEL_value *right, EEL_value *result)
 
 static inline EEL_xno eel_op_castb(EEL_value *right, EEL_value *result)
 {
-	switch(right->classid)
+	switch(EEL_VCLASS(right))
 	{
 	  case EEL_CNIL:
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = 0;
+		eel_b2v(result, 0);
 		return 0;
 	  case EEL_CREAL:
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = 0.0 != right->real.v;
+		eel_b2v(result, 0.0 != EEL_VREAL(right));
 		return 0;
 	  case EEL_CINTEGER:
 	  case EEL_CCLASSID:
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = 0 != right->integer.v;
+		eel_b2v(result, 0 != EEL_VINT(right));
 		return 0;
 	  case EEL_CBOOLEAN:
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = right->integer.v;
+		eel_b2v(result, EEL_VINT(right));
 		return 0;
 	  case EEL_COBJREF:
 	  case EEL_CWEAKREF:
-		return eel_cast(right->objref.v->vm,
+		return eel_cast(eel_v2o(right)->vm,
 				right, result, EEL_CBOOLEAN);
 	  default:
 		return EEL_XWRONGTYPE;
@@ -1360,22 +1251,20 @@ static inline EEL_xno eel_op_castb(EEL_value *right, EEL_value *result)
 
 static inline EEL_xno eel_op_typeof(EEL_value *right, EEL_value *result)
 {
-	switch(right->classid)
+	switch(EEL_VCLASS(right))
 	{
 	  case EEL_CNIL:
-		result->classid = EEL_CNIL;
+		eel_nil2v(result);
 		return 0;
 	  case EEL_CREAL:
 	  case EEL_CINTEGER:
 	  case EEL_CBOOLEAN:
 	  case EEL_CCLASSID:
-		result->integer.v = right->classid;
-		result->classid = EEL_CCLASSID;
+		eel_i2v(result, EEL_CCLASSID, EEL_VCLASS(right));
 		return 0;
 	  case EEL_COBJREF:
 	  case EEL_CWEAKREF:
-		result->integer.v = right->objref.v->classid;
-		result->classid = EEL_CCLASSID;
+		eel_i2v(result, EEL_CCLASSID, eel_v2o(right)->classid);
 		return 0;
 	  default:
 		return EEL_XWRONGTYPE;
@@ -1384,19 +1273,18 @@ static inline EEL_xno eel_op_typeof(EEL_value *right, EEL_value *result)
 
 static inline EEL_xno eel_op_sizeof(EEL_value *right, EEL_value *result)
 {
-	switch(right->classid)
+	switch(EEL_VCLASS(right))
 	{
 	  case EEL_CNIL:
 	  case EEL_CREAL:
 	  case EEL_CINTEGER:
 	  case EEL_CBOOLEAN:
 	  case EEL_CCLASSID:
-		result->classid = EEL_CINTEGER;
-		result->integer.v = 1;
+		eel_l2v(result, 1);
 		return 0;
 	  case EEL_COBJREF:
 	  case EEL_CWEAKREF:
-		return eel_o__metamethod(right->objref.v,
+		return eel_o__metamethod(eel_v2o(right),
 				EEL_MM_LENGTH, NULL, result);
 	  default:
 		return EEL_XWRONGTYPE;
@@ -1405,7 +1293,7 @@ static inline EEL_xno eel_op_sizeof(EEL_value *right, EEL_value *result)
 
 static inline EEL_xno eel_op_clone(EEL_value *right, EEL_value *result)
 {
-	switch(right->classid)
+	switch(EEL_VCLASS(right))
 	{
 	  case EEL_CNIL:
 	  case EEL_CREAL:
@@ -1416,7 +1304,7 @@ static inline EEL_xno eel_op_clone(EEL_value *right, EEL_value *result)
 		return 0;
 	  case EEL_COBJREF:
 	  case EEL_CWEAKREF:
-		return eel_cast(right->objref.v->vm,
+		return eel_cast(eel_v2o(right)->vm,
 				right, result, EEL_CLASS(right));
 	  default:
 		return EEL_XWRONGTYPE;
@@ -1425,29 +1313,24 @@ static inline EEL_xno eel_op_clone(EEL_value *right, EEL_value *result)
 
 static inline EEL_xno eel_op_not(EEL_value *right, EEL_value *result)
 {
-	switch(right->classid)
+	switch(EEL_VCLASS(right))
 	{
 	  case EEL_CNIL:
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = 1;
+		eel_b2v(result, 1);
 		return 0;
 	  case EEL_CREAL:
-		result->classid = EEL_CREAL;
-		result->real.v = 0 == right->real.v;
+		eel_d2v(result, 0 == EEL_VREAL(right));
 		return 0;
 	  case EEL_CINTEGER:
-		result->classid = EEL_CINTEGER;
-		result->integer.v = !right->integer.v;
+		eel_l2v(result, !EEL_VINT(right));
 		return 0;
 	  case EEL_CBOOLEAN:
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = !right->integer.v;
+		eel_b2v(result, !EEL_VINT(right));
 		return 0;
 	  case EEL_COBJREF:
 	  case EEL_CWEAKREF:
 	  case EEL_CCLASSID:
-		result->classid = EEL_CBOOLEAN;
-		result->integer.v = 0;
+		eel_b2v(result, 0);
 		return 0;
 	  default:
 		return EEL_XWRONGTYPE;
@@ -1456,10 +1339,9 @@ static inline EEL_xno eel_op_not(EEL_value *right, EEL_value *result)
 
 static inline EEL_xno eel_op_bnot(EEL_value *right, EEL_value *result)
 {
-	if(right->classid != EEL_CINTEGER)
+	if(EEL_VCLASS(right) != EEL_CINTEGER)
 		return EEL_XWRONGTYPE;
-	result->classid = EEL_CINTEGER;
-	result->integer.v = ~right->integer.v;
+	eel_l2v(result, ~EEL_VINT(right));
 	return 0;
 }
 
@@ -1540,10 +1422,10 @@ static inline EEL_xno eel__operate(EEL_value *left, int binop,
 static inline EEL_xno eel__ipoperate(EEL_value *left, int binop,
 		EEL_value *right, EEL_value *result)
 {
-	if(EEL_IS_OBJREF(left->classid))
+	if(EEL_IS_OBJREF(EEL_VCLASS(left)))
 		return eel_object_op(left, binop, right, result, 1);
-	if((left->classid > EEL_CLASTVALUE) ||
-			(right->classid > EEL_CLASTVALUE))
+	if((EEL_VCLASS(left) > EEL_CLASTVALUE) ||
+			(EEL_VCLASS(right) > EEL_CLASTVALUE))
 		return EEL_XNOTIMPLEMENTED;
 	return EEL_XCANTINPLACE;
 }
@@ -1554,12 +1436,11 @@ static inline EEL_xno eel_operate(EEL_value *left, int binop, EEL_value *right,
 {
 		EEL_xno x;
 		EEL_value rv;
-		rv.classid = EEL_CILLEGAL;
-		EEL_VMCHECK(rv.integer.v = 1004;)
+		eel_i2v(&rv, EEL_CILLEGAL, 1004);
 		x = eel__operate(left, binop, right, &rv);
 		if(x)
 			return x;
-		if(rv.classid == EEL_CILLEGAL)
+		if(EEL_VCLASS(&rv) == EEL_CILLEGAL)
 		{
 			eel_vmdump(NULL, "Operator generated no result! "
 					"Metamethod bug?");
@@ -1573,12 +1454,11 @@ static inline EEL_xno eel_ipoperate(EEL_value *left, int binop,
 {
 		EEL_xno x;
 		EEL_value rv;
-		rv.classid = EEL_CILLEGAL;
-		EEL_VMCHECK(rv.integer.v = 1005;)
+		eel_i2v(&rv, EEL_CILLEGAL, 1005);
 		x = eel__ipoperate(left, binop, right, &rv);
 		if(x)
 			return x;
-		if(rv.classid == EEL_CILLEGAL)
+		if(EEL_VCLASS(&rv) == EEL_CILLEGAL)
 		{
 			eel_vmdump(NULL, "Operator generated no result! "
 					"Metamethod bug?");
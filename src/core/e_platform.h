@@ -82,6 +82,19 @@ static inline int eel_atomic_add(EEL_atomic *a, int v)
 }
 
 
+/* Full memory barrier */
+static inline void eel_barrier(void)
+{
+#ifdef _WIN32
+	MemoryBarrier();
+#elif defined(__MACOSX__)
+	OSMemoryBarrier();
+#else
+	__sync_synchronize();
+#endif
+}
+
+
 /*---------------------------------------------------------
 	Mutex
 ---------------------------------------------------------*/
@@ -183,4 +196,23 @@ static inline void eel_yield(void)
 #endif
 }
 
+
+/*---------------------------------------------------------
+	Spinlock
+---------------------------------------------------------*/
+/*
+ * For rarely taken locks on process-wide state. Unlike EEL_mutex, an
+ * EEL_atomic initialized to 0 is a valid, unlocked spinlock.
+ */
+static inline void eel_spin_lock(EEL_atomic *lock)
+{
+	while(!eel_atomic_cas(lock, 0, 1))
+		eel_yield();
+}
+
+static inline void eel_spin_unlock(EEL_atomic *lock)
+{
+	eel_atomic_cas(lock, 1, 0);
+}
+
 #endif /* EEL_E_PLATFORM_H */
@@ -199,10 +199,10 @@ static EEL_object *eel__register_cfunction(EEL_vm *vm,
 				optargs);
 	if((x = eel_o_construct(vm, EEL_CFUNCTION, NULL, 0, &fv)))
 		eel_serror(es, "Could not create FUNCTION object!");
-	f = o2EEL_function(fv.objref.v);
+	f = o2EEL_function(eel_v2o(&fv));
 	if(!(f->common.name = eel_ps_new(vm, name)))
 	{
-		eel_o_disown_nz(fv.objref.v);
+		eel_o_disown_nz(eel_v2o(&fv));
 		eel_serror(es, "Could not duplicate function name!");
 	}
 	f->common.flags = EEL_FF_CFUNC;
@@ -216,7 +216,7 @@ static EEL_object *eel__register_cfunction(EEL_vm *vm,
 		f->common.flags |= EEL_FF_ARGS;
 	f->c.cb = func;
 	eel_clear_info(es);
-	return fv.objref.v;
+	return eel_v2o(&fv);
 }
 
 
@@ -491,13 +491,13 @@ EEL_object *eel_create_module(EEL_vm *vm, const char *name,
 	x = eel_o_construct(vm, EEL_CMODULE, NULL, 0, &v);
 	if(x)
 		return NULL;
-	m = o2EEL_module(v.objref.v);
+	m = o2EEL_module(eel_v2o(&v));
 	eel_table_setss(m->exports, "__modname", name);
 	eel_table_setss(m->exports, "__filename", name);
 	m->unload = unload;
 	m->moduledata = moduledata;
-	eel_share_module(v.objref.v);
-	return v.objref.v;
+	eel_share_module(eel_v2o(&v));
+	return eel_v2o(&v);
 }
 
 
@@ -612,6 +612,21 @@ EEL_object *eel_export_cfunction(EEL_object *module,
 }
 
 
+EEL_object *eel_export_cleaf(EEL_object *module,
+		const char *name, int args, EEL_cleaf_cb func)
+{
+	EEL_function *f;
+	EEL_object *fo = eel_export_cfunction(module, 1, name, args, 0, 0,
+			NULL);
+	if(!fo)
+		return NULL;
+	f = o2EEL_function(fo);
+	f->common.flags |= EEL_FF_LEAF;
+	f->c.leaf = func;
+	return fo;
+}
+
+
 EEL_xno eel_export_constant(EEL_object *module,
 		const char *name, EEL_value *value)
 {
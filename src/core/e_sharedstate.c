@@ -27,67 +27,45 @@
 #include "e_exceptions.h"
 
 
-static EEL_atomic eel_api_users = 0;
-static EEL_atomic eel_api_up = 0;
-static EEL_xno eel_api_error = EEL_XOK;
+/*
+ * All process-wide state is behind 'eel_api_lock'. It is only touched by
+ * eel_open() and eel_close(), so a spinlock is good enough, and unlike a
+ * mutex, it needs no initialization.
+ */
+static EEL_atomic eel_api_lock = 0;
+static int eel_api_users = 0;
 
 
 int eel_add_api_user(void)
 {
-	if(eel_atomic_add(&eel_api_users, 1) == 0)
+	eel_spin_lock(&eel_api_lock);
+	if(!eel_api_users)
 	{
-		EEL_xno x;
-		/* We could arrive here right when the API is being closed! */
-		while(eel_atomic_add(&eel_api_up, 0))
-			eel_yield();
-		eel_api_error = EEL_XOK;
-		if((x = eel_x_open_registry()))
+		EEL_xno x = eel_x_open_registry();
+		if(x)
 		{
-			eel_api_error = x;
-			eel_atomic_add(&eel_api_users, -1);
+			eel_spin_unlock(&eel_api_lock);
 			return x;
 		}
-		eel_atomic_add(&eel_api_up, 1);
-	}
-	else
-	{
-		/* Someone beat us to it. Wait until the API is actually up! */
-		while(!eel_atomic_add(&eel_api_up, 0))
-		{
-			if(eel_api_error)
-			{
-				/*
-				 * Oh... The thread opening the API failed.
-				 * We're not likely going to succeed either,
-				 * so we return the same error code.
-				 */
-				eel_atomic_add(&eel_api_users, -1);
-				return eel_api_error;
-			}
-			eel_yield();
-		}
 	}
+	++eel_api_users;
+	eel_spin_unlock(&eel_api_lock);
 	return EEL_XOK;
 }
 
 
 void eel_remove_api_user(void)
 {
-	int users = eel_atomic_add(&eel_api_users, -1);
-	if(users == 1)
+	eel_spin_lock(&eel_api_lock);
+	if(!eel_api_users)
 	{
-		/*
-		 * If someone tries to reopen now, eel_add_api_user() will wait
-		 * until we're done closing, before opening again.
-		 */
-		eel_x_close_registry();
-		eel_atomic_add(&eel_api_up, -1);
-	}
-	else if(!users)
-	{
-		eel_atomic_add(&eel_api_users, 1);
+		eel_spin_unlock(&eel_api_lock);
 		fprintf(stderr, "EEL INTERNAL ERROR: "
 				"eel_remove_api_user() called while "
 				"eel_api_users == 0!\n");
+		return;
 	}
+	if(!--eel_api_users)
+		eel_x_close_registry();
+	eel_spin_unlock(&eel_api_lock);
 }
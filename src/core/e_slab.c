@@ -0,0 +1,174 @@
+/*
+---------------------------------------------------------------------------
+	e_slab.c - EEL object slab allocator
+---------------------------------------------------------------------------
+ * Copyright 2026 The EEL contributors
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the
+ * use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "e_slab.h"
+#include "e_vm.h"
+
+#ifdef EEL_SLAB_MAXSIZE
+
+/* Size class for blocks holding 'size' bytes, or 0 if too large */
+static inline int slab_class(int size)
+{
+	size += sizeof(EEL_slabblock);
+	if(size > EEL_SLAB_MAXSIZE)
+		return 0;
+	return (size + EEL_SLAB_GRAIN - 1) / EEL_SLAB_GRAIN;
+}
+
+
+/* Carve a new chunk into blocks of size class 'sc' */
+static EEL_xno slab_refill(EEL_vm *vm, int sc)
+{
+	EEL_slab *s = &VMP->slab;
+	EEL_slabclass *c = &s->classes[sc];
+	int bs = eel_slab_blocksize(sc);
+	int n = (EEL_SLAB_CHUNK - sizeof(EEL_slabchunk)) / bs;
+	char *b;
+	EEL_slabchunk *ch = (EEL_slabchunk *)eel_malloc(vm, EEL_SLAB_CHUNK);
+	if(!ch)
+		return EEL_XMEMORY;
+	ch->next = s->chunks;
+	s->chunks = ch;
+	++s->nchunks;
+	++c->chunks;
+
+	/* Push back to front, so blocks are handed out in address order */
+	b = (char *)(ch + 1) + (n - 1) * bs;
+	while(n--)
+	{
+		EEL_slabblock *blk = (EEL_slabblock *)b;
+		blk->next = c->free;
+		c->free = blk;
+		++c->nfree;
+		b -= bs;
+	}
+	return 0;
+}
+
+#endif /* EEL_SLAB_MAXSIZE */
+
+
+void *eel_slab_alloc(EEL_vm *vm, int size)
+{
+	EEL_slabblock *blk;
+#ifdef EEL_SLAB_MAXSIZE
+	EEL_slab *s = &VMP->slab;
+	int sc = slab_class(size);
+	if(sc)
+	{
+		EEL_slabclass *c = &s->classes[sc];
+		if(!c->free && slab_refill(vm, sc))
+			return NULL;
+		blk = c->free;
+		c->free = blk->next;
+		--c->nfree;
+		if(++c->inuse > c->peak)
+			c->peak = c->inuse;
+		++c->allocs;
+		blk->a.sclass = sc;
+		blk->a.flags = 0;
+		blk->a.size = size;
+		return blk + 1;
+	}
+#endif
+	blk = (EEL_slabblock *)eel_malloc(vm, sizeof(EEL_slabblock) + size);
+	if(!blk)
+		return NULL;
+#ifdef EEL_SLAB_MAXSIZE
+	++s->large;
+	++s->largeallocs;
+#endif
+	blk->a.sclass = 0;
+	blk->a.flags = 0;
+	blk->a.size = size;
+	return blk + 1;
+}
+
+
+void eel_slab_free(EEL_vm *vm, void *block)
+{
+	EEL_slabblock *blk = (EEL_slabblock *)block - 1;
+#ifdef EEL_SLAB_MAXSIZE
+	EEL_slab *s = &VMP->slab;
+	EEL_slabclass *c;
+	if(blk->a.sclass)
+	{
+		c = &s->classes[blk->a.sclass];
+		blk->next = c->free;
+		c->free = blk;
+		++c->nfree;
+		--c->inuse;
+		return;
+	}
+	--s->large;
+#endif
+	eel_free(vm, blk);
+}
+
+
+EEL_xno eel_slab_reserve(EEL_vm *vm, int size, int count)
+{
+#ifdef EEL_SLAB_MAXSIZE
+	EEL_xno x;
+	int sc = slab_class(size);
+	if(!sc)
+		return EEL_XHIGHVALUE;
+	while(VMP->slab.classes[sc].nfree < count)
+		if((x = slab_refill(vm, sc)))
+			return x;
+	return 0;
+#else
+	return EEL_XNOTIMPLEMENTED;
+#endif
+}
+
+
+void eel_slab_close(EEL_vm *vm)
+{
+#ifdef EEL_SLAB_MAXSIZE
+	EEL_slab *s = &VMP->slab;
+# if DBGM(1) + 0 == 1
+	int sc;
+	printf("Object slabs: %d chunks of %d bytes, %lu large allocations\n",
+			s->nchunks, EEL_SLAB_CHUNK, s->largeallocs);
+	for(sc = 1; sc <= EEL_SLAB_CLASSES; ++sc)
+	{
+		EEL_slabclass *c = &s->classes[sc];
+		if(!c->chunks)
+			continue;
+		printf("  %3d bytes: %d chunks, %lu allocs, peak %d, in use %d\n",
+				eel_slab_blocksize(sc), c->chunks, c->allocs,
+				c->peak, c->inuse);
+	}
+# endif
+	while(s->chunks)
+	{
+		EEL_slabchunk *ch = s->chunks;
+		s->chunks = ch->next;
+		eel_free(vm, ch);
+	}
+	memset(s, 0, sizeof(EEL_slab));
+#endif
+}
@@ -0,0 +1,122 @@
+/*
+---------------------------------------------------------------------------
+	e_slab.h - EEL object slab allocator
+---------------------------------------------------------------------------
+ * Copyright 2026 The EEL contributors
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the
+ * use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef	EEL_E_SLAB_H
+#define	EEL_E_SLAB_H
+
+#include "e_eel.h"
+
+/*
+ * Object memory is handed out from per-VM slabs, with one free list per size
+ * class. Every block starts with a header that tells which class it belongs
+ * to, so that eel_slab_free() can find the right free list without the object
+ * knowing its own size. Blocks that are too large for the slabs (or all
+ * blocks, if EEL_SLAB_MAXSIZE is not defined) are marked as class 0, and go
+ * straight to eel_malloc()/eel_free().
+ *
+ * The header also has a few flag bits for the cycle collector. (See e_cycle.h.)
+ *
+ * Chunks are never returned to the memory manager before eel_slab_close(), as
+ * blocks of all classes are carved from them, and a chunk can't be released
+ * until all of its blocks are free.
+ */
+
+/* Header of object blocks; also the free list node of free blocks */
+typedef union EEL_slabblock EEL_slabblock;
+union EEL_slabblock
+{
+	EEL_slabblock	*next;		/* Next free block (free blocks) */
+	struct
+	{
+		short	sclass;		/* Size class, or 0 if not in a slab */
+		unsigned short flags;	/* Cycle collector flags (EEL_CCF_*) */
+		int	size;		/* Size asked for (allocated blocks) */
+	} a;
+	double		align;
+};
+
+/* Size that block 'block' was allocated with */
+static inline int eel_slab_size(void *block)
+{
+	return ((EEL_slabblock *)block - 1)->a.size;
+}
+
+#ifdef EEL_SLAB_MAXSIZE
+
+#define	EEL_SLAB_GRAIN		16
+#define	EEL_SLAB_CLASSES	(EEL_SLAB_MAXSIZE / EEL_SLAB_GRAIN)
+
+/* Header of slab chunks */
+typedef union EEL_slabchunk EEL_slabchunk;
+union EEL_slabchunk
+{
+	EEL_slabchunk	*next;		/* Next chunk of the same VM */
+	char		pad[EEL_SLAB_GRAIN];
+};
+
+typedef struct
+{
+	EEL_slabblock	*free;		/* Free list */
+	int		nfree;		/* # of blocks in 'free' */
+	int		inuse;		/* # of blocks allocated */
+	int		peak;		/* Highest 'inuse' seen */
+	int		chunks;		/* # of chunks carved for this class */
+	unsigned long	allocs;		/* Total # of allocations */
+} EEL_slabclass;
+
+typedef struct
+{
+	EEL_slabclass	classes[EEL_SLAB_CLASSES + 1];	/* [0] is unused */
+	EEL_slabchunk	*chunks;	/* All chunks of the VM */
+	int		nchunks;	/* # of chunks in 'chunks' */
+	int		large;		/* # of large blocks allocated */
+	unsigned long	largeallocs;	/* Total # of large allocations */
+} EEL_slab;
+
+/* Block size of size class 'sc', including the block header */
+static inline int eel_slab_blocksize(int sc)
+{
+	return sc * EEL_SLAB_GRAIN;
+}
+
+#endif /* EEL_SLAB_MAXSIZE */
+
+/*
+ * Allocate 'size' bytes of object memory. Returns NULL if the memory manager
+ * fails.
+ */
+void *eel_slab_alloc(EEL_vm *vm, int size);
+
+/* Free a block allocated with eel_slab_alloc(). */
+void eel_slab_free(EEL_vm *vm, void *block);
+
+/*
+ * Make sure there are at least 'count' free blocks that can hold 'size'
+ * bytes each.
+ */
+EEL_xno eel_slab_reserve(EEL_vm *vm, int size, int count);
+
+/* Release all slab memory of 'vm'. */
+void eel_slab_close(EEL_vm *vm);
+
+#endif /* EEL_E_SLAB_H */
@@ -52,7 +52,7 @@ static EEL_xno array_sadd(EEL_object *a, const char *s)
 	EEL_xno x;
 	EEL_value v;
 	eel_s2v(a->vm, &v, s);
-	if(v.classid == EEL_CNIL)
+	if(EEL_VCLASS(&v) == EEL_CNIL)
 		return EEL_XMEMORY;
 	x = eel_setlindex(a, eel_length(a), &v);
 	if(x)
@@ -71,22 +71,22 @@ static EEL_xno init_env_table(EEL_state *es)
 				" 'environment' table!\n");
 		return x;
 	}
-	es->environment = v.objref.v;
+	es->environment = eel_v2o(&v);
 	SETNAME(es->environment, "'environment' Table");
 
 	/* Module paths */
 	XCHECK(eel_o_construct(es->vm, EEL_CARRAY, NULL, 0, &a));
-	XCHECK(array_sadd(a.objref.v, "."));
-	XCHECK(array_sadd(a.objref.v, "./modules"));
-	XCHECK(array_sadd(a.objref.v, EEL_MODULE_DIR));
-	XCHECK(array_sadd(a.objref.v, ""));
+	XCHECK(array_sadd(eel_v2o(&a), "."));
+	XCHECK(array_sadd(eel_v2o(&a), "./modules"));
+	XCHECK(array_sadd(eel_v2o(&a), EEL_MODULE_DIR));
+	XCHECK(array_sadd(eel_v2o(&a), ""));
 	XCHECK(eel_setsindex(es->environment, "path_modules", &a));
-	eel_disown(a.objref.v);
+	eel_disown(eel_v2o(&a));
 	return 0;
 }
 
 
-EEL_vm *eel_open(int argc, const char *argv[])
+static EEL_vm *es_open(int argc, const char *argv[], void *pool, int size)
 {
 #ifdef DEBUG
 	int i;
@@ -98,6 +98,12 @@ EEL_vm *eel_open(int argc, const char *argv[])
 	if(!es)
 		return NULL;
 
+	if(pool && !(es->pool = eel_tlsf_open(pool, size)))
+	{
+		free(es);
+		return NULL;
+	}
+
 	if(eel_add_api_user() != EEL_XOK)
 		return NULL;
 
@@ -217,7 +223,7 @@ EEL_vm *eel_open(int argc, const char *argv[])
 		es_close(es);
 		return NULL;
 	}
-	es->modnames = v.objref.v;
+	es->modnames = eel_v2o(&v);
 	SETNAME(es->modnames, "Module Name Table");
 
 	/* Module table */
@@ -228,7 +234,7 @@ EEL_vm *eel_open(int argc, const char *argv[])
 		es_close(es);
 		return NULL;
 	}
-	es->modules = v.objref.v;
+	es->modules = eel_v2o(&v);
 	SETNAME(es->modules, "Shared Module Table");
 
 	/* 'environment' table */
@@ -259,6 +265,7 @@ EEL_vm *eel_open(int argc, const char *argv[])
 	eel_register_keyword(vm, "break", TK_KW_BREAK);
 	eel_register_keyword(vm, "continue", TK_KW_CONTINUE);
 	eel_register_keyword(vm, "repeat", TK_KW_REPEAT);
+	eel_register_keyword(vm, "yield", TK_KW_YIELD);
 
 	eel_register_keyword(vm, "try", TK_KW_TRY);
 	eel_register_keyword(vm, "untry", TK_KW_UNTRY);
@@ -389,6 +396,20 @@ EEL_vm *eel_open(int argc, const char *argv[])
 }
 
 
+EEL_vm *eel_open(int argc, const char *argv[])
+{
+	return es_open(argc, argv, NULL, 0);
+}
+
+
+EEL_vm *eel_open_pool(int argc, const char *argv[], void *pool, int size)
+{
+	if(!pool)
+		return NULL;
+	return es_open(argc, argv, pool, size);
+}
+
+
 void eel_close(EEL_vm *vm)
 {
 	EEL_state *es;
@@ -516,6 +537,10 @@ static void es_close(EEL_state *es)
 	if(!vm)
 		return;
 	VMP->is_closing = 1;
+	eel_defer_shutdown(vm);
+#ifdef EEL_CYCLE_COLLECTOR
+	eel_cc_shutdown(vm);
+#endif
 	DBGK2(printf("eel_close(): Running $.cleanup and deleting environment.\n");)
 	if(es->eellib)
 		eel_callnf(vm, es->eellib, "__cleanup", NULL);
@@ -58,6 +58,7 @@
 #endif	/* BROKEN__LONGJMP */
 
 #include "ec_parser.h"
+#include "e_tlsf.h"
 
 
 /*----------------------------------------------------------
@@ -113,6 +114,7 @@ struct EEL_state
 	/* Compiler */
 	EEL_context	*context;	/* Linked LIFO stack */
 	EEL_vm		*vm;		/* Master/state VM */
+	EEL_tlsf	*pool;		/* Memory pool, or NULL for libc */
 
 	/* Compiler error/warning handling */
 	unsigned	last_module_id;
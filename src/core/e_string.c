@@ -174,6 +174,8 @@ EEL_object *eel_ps_nnew_grab(EEL_vm *vm, char *s, int len)
 	ps->length = len;
 	ps->hash = hash;
 	ps_push(HASH2BUCKET(VMP, hash), pso);
+	++VMP->nstrings;
+	VMP->stringbytes += len + 1;
 	PSDBG2(printf("CREATED STRING %s\n", eel_o_stringrep(pso));)
 	print_cache(vm);
 	return pso;
@@ -212,6 +214,8 @@ EEL_object *eel_ps_nnew(EEL_vm *vm, const char *s, int len)
 	ps->length = len;
 	ps->hash = hash;
 	ps_push(HASH2BUCKET(VMP, hash), pso);
+	++VMP->nstrings;
+	VMP->stringbytes += len + 1;
 	PSDBG2(printf("CREATED STRING %s\n", eel_o_stringrep(pso));)
 	print_cache(vm);
 	return pso;
@@ -230,6 +234,8 @@ static inline void really_destruct(EEL_vm *vm, EEL_object *eo)
 	PSDBG2(printf("DESTROYING STRING %s\n", eel_o_stringrep(eo));)
 	if(VMP->strings)
 		ps_unlink(HASH2BUCKET(VMP, ps->hash), eo);
+	--VMP->nstrings;
+	VMP->stringbytes -= ps->length + 1;
 	eel_free(vm, (void *)(ps->buffer));
 	PSDBG2(printf("   STRING DESTROYED.\n");)
 }
@@ -404,15 +410,15 @@ static EEL_xno s_getindex(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	int i;
 
 	/* Cast index to int */
-	switch(op1->classid)
+	switch(EEL_VCLASS(op1))
 	{
 	  case EEL_CBOOLEAN:
 	  case EEL_CINTEGER:
 	  case EEL_CCLASSID:
-		i = op1->integer.v;
+		i = EEL_VINT(op1);
 		break;
 	  case EEL_CREAL:
-		i = floor(op1->real.v);
+		i = floor(EEL_VREAL(op1));
 		break;
 	  default:
 		return EEL_XWRONGTYPE;
@@ -425,8 +431,7 @@ static EEL_xno s_getindex(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 		return EEL_XHIGHINDEX;
 
 	/* Read value */
-	op2->classid = EEL_CINTEGER;
-	op2->integer.v = s->buffer[i] & 0xff;	/* Treat as unsigned! */
+	eel_l2v(op2, s->buffer[i] & 0xff);	/* Treat as unsigned! */
 	return 0;
 }
 
@@ -439,28 +444,27 @@ static EEL_xno s_in(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	  case EEL_CBOOLEAN:
 	  case EEL_CINTEGER:
 	  case EEL_CCLASSID:
-		return eel_s_char_in(s->buffer, s->length, op1->integer.v,
+		return eel_s_char_in(s->buffer, s->length, EEL_VINT(op1),
 				op2);
 	  case EEL_CREAL:
-		return eel_s_char_in(s->buffer, s->length, floor(op1->real.v),
+		return eel_s_char_in(s->buffer, s->length, floor(EEL_VREAL(op1)),
 				op2);
 	  case EEL_CSTRING:
 	  {
 		EEL_string *s2;
-		if(op1->objref.v == eo)
+		if(eel_v2o(op1) == eo)
 		{
 			/* Same instance! */
-			op2->classid = EEL_CINTEGER;
-			op2->integer.v = 0;
+			eel_l2v(op2, 0);
 			return 0;
 		}
-		s2 = o2EEL_string(op1->objref.v);
+		s2 = o2EEL_string(eel_v2o(op1));
 		return eel_s_str_in(s->buffer, s->length,
 				s2->buffer, s2->length, op2);
 	  }
 	  case EEL_CDSTRING:
 	  {
-		EEL_dstring *s2 = o2EEL_dstring(op1->objref.v);
+		EEL_dstring *s2 = o2EEL_dstring(eel_v2o(op1));
 		return eel_s_str_in(s->buffer, s->length,
 				s2->buffer, s2->length, op2);
 	  }
@@ -472,6 +476,7 @@ static EEL_xno s_in(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 
 static EEL_xno s_copy(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
+	EEL_object *o;
 	EEL_string *s = o2EEL_string(eo);
 	int start = eel_v2l(op1);
 	int length = eel_v2l(op2);
@@ -483,18 +488,17 @@ static EEL_xno s_copy(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 		return EEL_XWRONGINDEX;
 	else if(start + length > s->length)
 		return EEL_XHIGHINDEX;
-	op2->objref.v = eel_ps_nnew(eo->vm, s->buffer + start, length);
-	if(!op2->objref.v)
+	o = eel_ps_nnew(eo->vm, s->buffer + start, length);
+	if(!o)
 		return EEL_XCONSTRUCTOR;
-	op2->classid = EEL_COBJREF;
+	eel_o2v(op2, o);
 	return 0;
 }
 
 
 static EEL_xno s_length(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
-	op2->classid = EEL_CINTEGER;
-	op2->integer.v = o2EEL_string(eo)->length;
+	eel_l2v(op2, o2EEL_string(eo)->length);
 	return 0;
 }
 
@@ -504,29 +508,28 @@ static EEL_xno s_compare(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	EEL_string *s;
 	const char *s2buf;
 	int s2len;
-	if(!EEL_IS_OBJREF(op1->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(op1)))
 		return EEL_XWRONGTYPE;
-	op2->classid = EEL_CINTEGER;
 
-	switch(op1->objref.v->classid)
+	switch(eel_v2o(op1)->classid)
 	{
 	  case EEL_CSTRING:
 	  {
 		EEL_string *s2;
-		if(op1->objref.v == eo)
+		if(eel_v2o(op1) == eo)
 		{
 			/* Same instance! */
-			op2->integer.v = 0;
+			eel_l2v(op2, 0);
 			return 0;
 		}
-		s2 = o2EEL_string(op1->objref.v);
+		s2 = o2EEL_string(eel_v2o(op1));
 		s2buf = s2->buffer;
 		s2len = s2->length;
 		break;
 	  }
 	  case EEL_CDSTRING:
 	  {
-		EEL_dstring *s2 = o2EEL_dstring(op1->objref.v);
+		EEL_dstring *s2 = o2EEL_dstring(eel_v2o(op1));
 		s2buf = s2->buffer;
 		s2len = s2->length;
 		break;
@@ -538,53 +541,49 @@ static EEL_xno s_compare(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	s = o2EEL_string(eo);
 	if(s->length > s2len)
 	{
-		op2->integer.v = 1;
+		eel_l2v(op2, 1);
 		return 0;
 	}
 	else if(s->length < s2len)
 	{
-		op2->integer.v = -1;
+		eel_l2v(op2, -1);
 		return 0;
 	}
-	op2->integer.v = eel_s_cmp((unsigned char *)s->buffer,
-			(unsigned const char *)s2buf, s2len);
+	eel_l2v(op2, eel_s_cmp((unsigned char *)s->buffer,
+			(unsigned const char *)s2buf, s2len));
 	return 0;
 }
 
 
 static EEL_xno s_eq(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
-	switch(op1->classid)
+	switch(EEL_VCLASS(op1))
 	{
 	  case EEL_CNIL:
 	  case EEL_CREAL:
 	  case EEL_CINTEGER:
 	  case EEL_CBOOLEAN:
 	  case EEL_CCLASSID:
-		op2->classid = EEL_CBOOLEAN;
-		op2->integer.v = 0;
+		eel_b2v(op2, 0);
 		return 0;
 	  case EEL_COBJREF:
 	  case EEL_CWEAKREF:
 	  {
-		EEL_object *o = op1->objref.v;
+		EEL_object *o = eel_v2o(op1);
 		if(o->classid == EEL_CSTRING)
 		{
-			op2->classid = EEL_CBOOLEAN;
-			op2->integer.v = (eo == o);
+			eel_b2v(op2, (eo == o));
 			return 0;
 		}
 		else if(o->classid == EEL_CDSTRING)
 		{
 			s_compare(eo, op1, op2);
-			op2->classid = EEL_CBOOLEAN;
-			op2->integer.v = (op2->integer.v == 0);
+			eel_b2v(op2, (EEL_VINT(op2) == 0));
 			return 0;
 		}
 		else
 		{
-			op2->classid = EEL_CBOOLEAN;
-			op2->integer.v = 0;
+			eel_b2v(op2, 0);
 			return 0;
 		}
 	  }
@@ -597,7 +596,7 @@ static EEL_xno s_eq(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 static EEL_xno s_cast_to_real(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 {
-	EEL_string *s = o2EEL_string(src->objref.v);
+	EEL_string *s = o2EEL_string(eel_v2o(src));
 	eel_d2v(dst, atof(s->buffer));
 	return 0;
 }
@@ -606,7 +605,7 @@ static EEL_xno s_cast_to_real(EEL_vm *vm,
 static EEL_xno s_cast_to_integer(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 {
-	EEL_string *s = o2EEL_string(src->objref.v);
+	EEL_string *s = o2EEL_string(eel_v2o(src));
 	eel_l2v(dst, atol(s->buffer));
 	return 0;
 }
@@ -615,15 +614,14 @@ static EEL_xno s_cast_to_integer(EEL_vm *vm,
 static EEL_xno s_cast_to_boolean(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 {
-	EEL_string *s = o2EEL_string(src->objref.v);
-	dst->classid = EEL_CBOOLEAN;
+	EEL_string *s = o2EEL_string(eel_v2o(src));
 	if(!strncmp("true", s->buffer, 4) ||
 			!strncmp("yes", s->buffer, 3) ||
 			!strncmp("1", s->buffer, 1) ||
 			!strncmp("on", s->buffer, 2))
-		dst->integer.v = 1;
+		eel_b2v(dst, 1);
 	else
-		dst->integer.v = 0;
+		eel_b2v(dst, 0);
 	return 0;
 }
 
@@ -631,11 +629,12 @@ static EEL_xno s_cast_to_boolean(EEL_vm *vm,
 static EEL_xno s_cast_to_dstring(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 {
-	EEL_string *s = o2EEL_string(src->objref.v);
-	dst->objref.v = eel_ds_nnew(vm, s->buffer, s->length);
-	if(!dst->objref.v)
+	EEL_object *o;
+	EEL_string *s = o2EEL_string(eel_v2o(src));
+	o = eel_ds_nnew(vm, s->buffer, s->length);
+	if(!o)
 		return EEL_XMEMORY;
-	dst->classid = EEL_COBJREF;
+	eel_o2v(dst, o);
 	return 0;
 }
 
@@ -644,8 +643,8 @@ static EEL_xno s_clone(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 {
 	/* NOP, more or less - strings are immutable! */
-	eel_o2v(dst, src->objref.v);
-	eel_o_own(dst->objref.v);
+	eel_o2v(dst, eel_v2o(src));
+	eel_o_own(eel_v2o(dst));
 	return 0;
 }
 
@@ -666,7 +665,7 @@ static EEL_xno s_cast_from_integer(EEL_vm *vm,
 {
 	EEL_object *no;
 	char buf[24];
-	int len = snprintf(buf, sizeof(buf) - 1, "%d", src->integer.v);
+	int len = snprintf(buf, sizeof(buf) - 1, "%d", EEL_VINT(src));
 	if(len >= sizeof(buf))
 		return EEL_XOVERFLOW;
 	buf[sizeof(buf) - 1] = 0;
@@ -683,7 +682,7 @@ static EEL_xno s_cast_from_real(EEL_vm *vm,
 {
 	EEL_object *no;
 	char buf[64];
-	int len = snprintf(buf, sizeof(buf) - 1, EEL_REAL_FMT, src->real.v);
+	int len = snprintf(buf, sizeof(buf) - 1, EEL_REAL_FMT, EEL_VREAL(src));
 	if(len >= sizeof(buf))
 		return EEL_XOVERFLOW;
 	buf[sizeof(buf) - 1] = 0;
@@ -699,7 +698,7 @@ static EEL_xno s_cast_from_boolean(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 {
 	EEL_object *no;
-	if(src->integer.v)
+	if(EEL_VINT(src))
 		no = eel_ps_nnew(vm, "true", 4);
 	else
 		no = eel_ps_nnew(vm, "false", 5);
@@ -713,7 +712,7 @@ static EEL_xno s_cast_from_boolean(EEL_vm *vm,
 static EEL_xno s_cast_from_typeid(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 {
-	EEL_object *no = eel_ps_new(vm, eel_typename(vm, src->integer.v));
+	EEL_object *no = eel_ps_new(vm, eel_typename(vm, EEL_VINT(src)));
 	if(!no)
 		return EEL_XCONSTRUCTOR;
 	eel_o2v(dst, no);
@@ -723,6 +722,7 @@ static EEL_xno s_cast_from_typeid(EEL_vm *vm,
 
 static EEL_xno s_add(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
+	EEL_object *o;
 	EEL_string *s1 = o2EEL_string(eo);
 	const char *s2buf;
 	int s2len;
@@ -737,18 +737,18 @@ static EEL_xno s_add(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 		if(!s1->length)
 		{
 			/* (self == "") ==> return op1 */
-			eel_o2v(op2, op1->objref.v);
-			eel_o_own(op1->objref.v);
+			eel_o2v(op2, eel_v2o(op1));
+			eel_o_own(eel_v2o(op1));
 			return 0;
 		}
-		s2 = o2EEL_string(op1->objref.v);
+		s2 = o2EEL_string(eel_v2o(op1));
 		s2buf = s2->buffer;
 		s2len = s2->length;
 		break;
 	  }
 	  case EEL_CDSTRING:
 	  {
-		EEL_dstring *ds2 = o2EEL_dstring(op1->objref.v);
+		EEL_dstring *ds2 = o2EEL_dstring(eel_v2o(op1));
 		s2buf = ds2->buffer;
 		s2len = ds2->length;
 		break;
@@ -772,13 +772,13 @@ static EEL_xno s_add(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	memcpy(buf, s1->buffer, s1->length);
 	memcpy(buf + s1->length, s2buf, s2len);
 	buf[s1->length + s2len] = 0;
-	op2->objref.v = eel_ps_nnew_grab(eo->vm, buf, s1->length + s2len);
-	if(!op2->objref.v)
+	o = eel_ps_nnew_grab(eo->vm, buf, s1->length + s2len);
+	if(!o)
 	{
 		eel_free(eo->vm, buf);
 		return EEL_XCONSTRUCTOR;
 	}
-	op2->classid = EEL_COBJREF;
+	eel_o2v(op2, o);
 	return 0;
 }
 
@@ -83,13 +83,11 @@ static inline EEL_xno eel_s_char_in(char *str, unsigned len, int c,
 	char *f = memchr(str, c, len);
 	if(f)
 	{
-		op2->classid = EEL_CINTEGER;
-		op2->integer.v = f - str;
+		eel_l2v(op2, f - str);
 	}
 	else
 	{
-		op2->classid = EEL_CBOOLEAN;
-		op2->integer.v = 0;
+		eel_b2v(op2, 0);
 	}
 	return 0;
 }
@@ -109,14 +107,12 @@ static inline EEL_xno eel_s_str_in(char *str, unsigned len,
 					break;
 			if(j == len2)
 			{
-				op2->classid = EEL_CINTEGER;
-				op2->integer.v = i;
+				eel_l2v(op2, i);
 				return 0;
 			}
 		}
 	}
-	op2->classid = EEL_CBOOLEAN;
-	op2->integer.v = 0;
+	eel_b2v(op2, 0);
 	return 0;
 }
 
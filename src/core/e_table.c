@@ -31,14 +31,6 @@
 #include "e_register.h"
 
 
-struct EEL_tableitem
-{
-	EEL_hash	hash;
-	EEL_value	key;
-	EEL_value	value;
-};
-
-
 static inline int t_setsize(EEL_object *eo, int newlength)
 {
 	EEL_table *t = o2EEL_table(eo);
@@ -65,10 +57,11 @@ static inline int t_setsize(EEL_object *eo, int newlength)
 		int min = t->length < newlength ? t->length : newlength;
 		for(i = 0; i < min; ++i)
 		{
-			if(ni[i].key.classid == EEL_CWEAKREF)
-				eel_weakref_relocate(&ni[i].key);
-			if(ni[i].value.classid == EEL_CWEAKREF)
-				eel_weakref_relocate(&ni[i].value);
+			if(EEL_VCLASS(&ni[i].key) == EEL_CWEAKREF)
+				eel_weakref_relocate(&ni[i].key, &t->items[i].key);
+			if(EEL_VCLASS(&ni[i].value) == EEL_CWEAKREF)
+				eel_weakref_relocate(&ni[i].value,
+						&t->items[i].value);
 		}
 		t->items = ni;
 	}
@@ -204,51 +197,51 @@ static inline int t__find(EEL_object *eo, EEL_value *key, EEL_hash h)
 	}
 	
 	/* Fast-path for string lookups */
-	if(EEL_IS_OBJREF(key->classid) &&
-			(key->objref.v->classid == EEL_CSTRING))
+	if(EEL_IS_OBJREF(EEL_VCLASS(key)) &&
+			(eel_v2o(key)->classid == EEL_CSTRING))
 	{
 		for(i = first; (i < t->length) && (ti[i].hash == h); ++i)
 			/* NOTE: Nasty backwards testing here...! */
-			if(ti[i].key.objref.v == key->objref.v)
-				if(EEL_IS_OBJREF(ti[i].key.classid))
+			if(eel_v2o(&ti[i].key) == eel_v2o(key))
+				if(EEL_IS_OBJREF(EEL_VCLASS(&ti[i].key)))
 					return i;	/* Found! */
 		return ~first;	/* Not found! */
 	}
 
 	/* Generic linear scan - NO shortcuts for strings! */
 	for(i = first; (i < t->length) && (ti[i].hash == h); ++i)
-		switch(key->classid)
+		switch(EEL_VCLASS(key))
 		{
 		  case EEL_CNIL:
-			if(ti[i].key.classid == EEL_CNIL)
+			if(EEL_VCLASS(&ti[i].key) == EEL_CNIL)
 				return i;
 			continue;
 		  case EEL_CREAL:
-			if(ti[i].key.classid != EEL_CREAL)
+			if(EEL_VCLASS(&ti[i].key) != EEL_CREAL)
 				continue;
-			if(ti[i].key.real.v == key->real.v)
+			if(EEL_VREAL(&ti[i].key) == EEL_VREAL(key))
 				return i;
 			continue;
 		  case EEL_CINTEGER:
 		  case EEL_CBOOLEAN:
 		  case EEL_CCLASSID:
-			if(ti[i].key.classid != key->classid)
+			if(EEL_VCLASS(&ti[i].key) != EEL_VCLASS(key))
 				continue;
-			if(ti[i].key.integer.v == key->integer.v)
+			if(EEL_VINT(&ti[i].key) == EEL_VINT(key))
 				return i;
 			continue;
 		  case EEL_COBJREF:
 		  case EEL_CWEAKREF:
 		  {
 			EEL_value v;
-			if(!EEL_IS_OBJREF(ti[i].key.classid))
+			if(!EEL_IS_OBJREF(EEL_VCLASS(&ti[i].key)))
 				continue;
-			if(ti[i].key.objref.v == key->objref.v)
+			if(eel_v2o(&ti[i].key) == eel_v2o(key))
 				return i;	/* Same instance! ==> */
-			if(eel_o__metamethod(ti[i].key.objref.v,
+			if(eel_o__metamethod(eel_v2o(&ti[i].key),
 					EEL_MM_COMPARE, key, &v))
 				continue;	/* Cannot even compare! */
-			if(v.integer.v)
+			if(EEL_VINT(&v))
 				continue;	/* Not equal! */
 			return i;
 		  }
@@ -262,6 +255,24 @@ static inline int t__find(EEL_object *eo, EEL_value *key, EEL_hash h)
 }
 
 
+#ifdef EEL_VM_INLINE_CACHE
+EEL_value *eel_table_cache_find(EEL_object *to, EEL_value *key,
+		EEL_uint16 *slot)
+{
+	int pos;
+	if(!EEL_IS_OBJREF(EEL_VCLASS(key)) ||
+			(eel_v2o(key)->classid != EEL_CSTRING))
+		return NULL;
+	pos = t__find(to, key, eel_v2hash(key));
+	if(pos < 0)
+		return NULL;
+	if(pos < 0xffff)
+		*slot = pos + 1;
+	return &o2EEL_table(to)->items[pos].value;
+}
+#endif
+
+
 static inline EEL_xno t__setindex(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
 	int pos;
@@ -289,6 +300,8 @@ static EEL_xno t_destruct(EEL_object *eo)
 {
 	EEL_table *t = o2EEL_table(eo);
 	int i;
+	if(eel_defer(eo->vm, EEL_CTABLE, t->items, t->length))
+		return 0;
 	for(i = 0; i < t->length; ++i)
 	{
 		EEL_tableitem *ti = t->items + i;
@@ -385,7 +398,7 @@ static inline EEL_object *t__clone(EEL_object *orig)
 static EEL_xno t_clone(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 {
-	EEL_object *no = t__clone(src->objref.v);
+	EEL_object *no = t__clone(eel_v2o(src));
 	if(!no)
 		return EEL_XMEMORY;
 	eel_o2v(dst, no);
@@ -420,13 +433,11 @@ static EEL_xno t_in(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	int pos = t__find(eo, op1, eel_v2hash(op1));
 	if(pos >= 0)
 	{
-		op2->classid = EEL_CINTEGER;
-		op2->integer.v = pos;
+		eel_l2v(op2, pos);
 	}
 	else
 	{
-		op2->classid = EEL_CBOOLEAN;
-		op2->integer.v = 0;
+		eel_b2v(op2, 0);
 	}
 	return 0;
 }
@@ -503,7 +514,7 @@ static EEL_xno t_add(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	eo = t__clone(eo);
 	if(!eo)
 		return EEL_XMEMORY;
-	x = insert_items(eo, op1->objref.v);
+	x = insert_items(eo, eel_v2o(op1));
 	if(x)
 	{
 		eel_o_free(eo);
@@ -519,7 +530,7 @@ static EEL_xno t_ipadd(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	EEL_xno x;
 	if(EEL_CLASS(op1) != EEL_CTABLE)
 		return EEL_XWRONGTYPE;
-	x = insert_items(eo, op1->objref.v);
+	x = insert_items(eo, eel_v2o(op1));
 	if(x)
 		return x;
 	eel_o_own(eo);
@@ -587,7 +598,7 @@ EEL_xno eel_table_gets(EEL_object *to, const char *key, EEL_value *value)
 	EEL_xno x;
 	EEL_value keyv;
 	eel_o2v(&keyv, eel_ps_new(vm, key));
-	if(!keyv.objref.v)
+	if(!eel_v2o(&keyv))
 		eel_serror(VMP->state, "Could not create string \"%s\"!", key);
 	x = eel_table_get(to, &keyv, value);
 	eel_v_disown_nz(&keyv);
@@ -625,7 +636,7 @@ EEL_xno eel_table_sets(EEL_object *to, const char *key, EEL_value *value)
 	EEL_xno x;
 	EEL_value keyv;
 	eel_o2v(&keyv, eel_ps_new(to->vm, key));
-	if(!keyv.objref.v)
+	if(!eel_v2o(&keyv))
 		eel_serror(VMP->state, "Could not create key string \"%s\"!", key);
 	x = eel_table_set(to, &keyv, value);
 	eel_v_disown_nz(&keyv);
@@ -639,7 +650,7 @@ EEL_xno eel_table_setss(EEL_object *to, const char *key, const char *value)
 	EEL_xno x;
 	EEL_value vv;
 	eel_o2v(&vv, eel_ps_new(to->vm, value));
-	if(!vv.objref.v)
+	if(!eel_v2o(&vv))
 		eel_serror(VMP->state, "Could not create value string \"%s\"!", value);
 	x = eel_table_sets(to, key, &vv);
 	eel_v_disown_nz(&vv);
@@ -678,7 +689,7 @@ EEL_xno eel_table_deletes(EEL_object *to, const char *key)
 	EEL_xno x;
 	EEL_value keyv;
 	eel_o2v(&keyv, eel_ps_new(to->vm, key));
-	if(!keyv.objref.v)
+	if(!eel_v2o(&keyv))
 		eel_serror(VMP->state, "Could not create key string \"%s\"!", key);
 	x = eel_table_delete(to, &keyv);
 	eel_v_disown_nz(&keyv);
@@ -695,7 +706,7 @@ EEL_xno eel_insert_lconstants(EEL_object *to, const EEL_lconstexp *data)
 		EEL_value keyv, v;
 		eel_l2v(&v, data->value);
 		eel_o2v(&keyv, eel_ps_new(vm, data->name));
-		if(!keyv.objref.v)
+		if(!eel_v2o(&keyv))
 			eel_serror(VMP->state, "Could not create key "
 					"string \"%s\"!", data->name);
 		x = eel_table_set(to, &keyv, &v);
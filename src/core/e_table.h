@@ -28,7 +28,12 @@
 #include "EEL_types.h"
 #include "e_config.h"
 
-typedef struct EEL_tableitem EEL_tableitem;
+typedef struct EEL_tableitem
+{
+	EEL_hash	hash;
+	EEL_value	key;
+	EEL_value	value;
+} EEL_tableitem;
 
 typedef struct
 {
@@ -58,4 +63,37 @@ EEL_value *eel_table_get_value(EEL_tableitem *ti);
 
 /* (Remaining tools moved to EEL_object.h)*/
 
+#ifdef EEL_VM_INLINE_CACHE
+/*
+ * Inline cache lookup for the VM. Returns a pointer to the value of item
+ * 'key' in table 'to', or NULL if there is no such item, or 'key' is not a
+ * string. '*slot' is 0 (no information), or 1 + the index where 'key' was
+ * last found, and is updated as needed.
+ *
+ * NOTE:
+ *	The returned pointer is only valid until the table is modified!
+ */
+EEL_value *eel_table_cache_find(EEL_object *to, EEL_value *key,
+		EEL_uint16 *slot);
+
+static inline EEL_value *eel_table_cache_get(EEL_object *to, EEL_value *key,
+		EEL_uint16 *slot)
+{
+	EEL_table *t = o2EEL_table(to);
+	int i = *slot;
+	if(i && (i <= t->length))
+	{
+		/*
+		 * Keys are unique within a table, and strings are pooled, so
+		 * if the same string object is still in the slot, this is it.
+		 */
+		EEL_tableitem *ti = t->items + i - 1;
+		if(EEL_IS_OBJREF(EEL_VCLASS(&ti->key)) &&
+				(eel_v2o(&ti->key) == eel_v2o(key)))
+			return &ti->value;
+	}
+	return eel_table_cache_find(to, key, slot);
+}
+#endif
+
 #endif	/* EEL_E_TABLE_H */
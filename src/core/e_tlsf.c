@@ -0,0 +1,420 @@
+/*
+---------------------------------------------------------------------------
+	e_tlsf.c - EEL TLSF memory pool allocator
+---------------------------------------------------------------------------
+ * Copyright 2026 The EEL contributors
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the
+ * use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "e_tlsf.h"
+
+/* Block data alignment and granularity */
+#define	TLSF_ALIGN_LOG2	3
+#define	TLSF_ALIGN	(1 << TLSF_ALIGN_LOG2)
+
+/* Second level lists per first level size range */
+#define	TLSF_SL_LOG2	5
+#define	TLSF_SL_COUNT	(1 << TLSF_SL_LOG2)
+
+/*
+ * Blocks smaller than TLSF_SMALL all go in first level 0, in linear steps of
+ * TLSF_ALIGN. First level 1 and up cover one power of two each, up to the
+ * largest 'int' size.
+ */
+#define	TLSF_FL_SHIFT	(TLSF_SL_LOG2 + TLSF_ALIGN_LOG2)
+#define	TLSF_FL_MAX	31
+#define	TLSF_FL_COUNT	(TLSF_FL_MAX - TLSF_FL_SHIFT + 1)
+#define	TLSF_SMALL	(1 << TLSF_FL_SHIFT)
+
+/* Flag in TLSF_block.size */
+#define	TLSF_FREE	1
+
+/*
+ * Block header. 'next' and 'prev' are only used while the block is free; they
+ * are the first bytes of the data area of allocated blocks.
+ */
+typedef struct TLSF_block TLSF_block;
+struct TLSF_block
+{
+	TLSF_block	*prevphys;	/* Previous block in memory, or NULL */
+	size_t		size;		/* Size of data area | TLSF_FREE */
+	TLSF_block	*next, *prev;	/* Free list links */
+};
+
+/* Size of the part of the header that's always there */
+#define	TLSF_HEADER	offsetof(TLSF_block, next)
+
+/* Smallest data area; must hold the free list links */
+#define	TLSF_MINDATA	(sizeof(TLSF_block) - TLSF_HEADER)
+
+struct EEL_tlsf
+{
+	unsigned	flmap;			/* Non-empty first levels */
+	unsigned	slmap[TLSF_FL_COUNT];	/* Non-empty lists per level */
+	TLSF_block	*lists[TLSF_FL_COUNT][TLSF_SL_COUNT];
+
+	/* Statistics */
+	size_t		size;		/* Size of the whole pool */
+	size_t		used;		/* Allocated, including headers */
+	size_t		peak;		/* Highest 'used' seen */
+	int		fails;		/* Failed allocations */
+};
+
+
+/*----------------------------------------------------------
+	Bit tools
+----------------------------------------------------------*/
+
+/* Index of the highest set bit of 'x', which must not be 0 */
+static inline int tlsf_fls(size_t x)
+{
+#ifdef __GNUC__
+	return (int)(sizeof(unsigned long) * 8) - 1 -
+			__builtin_clzl((unsigned long)x);
+#else
+	int n = 0;
+	while(x >>= 1)
+		++n;
+	return n;
+#endif
+}
+
+/* Index of the lowest set bit of 'x', which must not be 0 */
+static inline int tlsf_ffs(unsigned x)
+{
+#ifdef __GNUC__
+	return __builtin_ctz(x);
+#else
+	int n = 0;
+	while(!(x & 1))
+	{
+		x >>= 1;
+		++n;
+	}
+	return n;
+#endif
+}
+
+
+/*----------------------------------------------------------
+	Blocks and free lists
+----------------------------------------------------------*/
+
+static inline size_t b_size(TLSF_block *b)
+{
+	return b->size & ~(size_t)TLSF_FREE;
+}
+
+static inline int b_isfree(TLSF_block *b)
+{
+	return b->size & TLSF_FREE;
+}
+
+static inline void *b2ptr(TLSF_block *b)
+{
+	return (char *)b + TLSF_HEADER;
+}
+
+static inline TLSF_block *ptr2b(void *p)
+{
+	return (TLSF_block *)((char *)p - TLSF_HEADER);
+}
+
+static inline TLSF_block *b_next(TLSF_block *b)
+{
+	return (TLSF_block *)((char *)b2ptr(b) + b_size(b));
+}
+
+/* List that free blocks of 'size' bytes go in */
+static inline void mapping_insert(size_t size, int *fl, int *sl)
+{
+	if(size < TLSF_SMALL)
+	{
+		*fl = 0;
+		*sl = (int)size / (TLSF_SMALL / TLSF_SL_COUNT);
+	}
+	else
+	{
+		int f = tlsf_fls(size);
+		*sl = (int)(size >> (f - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+		*fl = f - (TLSF_FL_SHIFT - 1);
+	}
+}
+
+/*
+ * First list where all blocks are at least 'size' bytes. Returns 0 if 'size'
+ * is too large for any list.
+ */
+static inline int mapping_search(size_t size, int *fl, int *sl)
+{
+	if(size >= TLSF_SMALL)
+		size += ((size_t)1 << (tlsf_fls(size) - TLSF_SL_LOG2)) - 1;
+	mapping_insert(size, fl, sl);
+	return *fl < TLSF_FL_COUNT;
+}
+
+static inline TLSF_block *find_free(EEL_tlsf *t, int fl, int sl)
+{
+	unsigned slmap = t->slmap[fl] & (~0U << sl);
+	if(!slmap)
+	{
+		unsigned flmap = t->flmap & (~0U << (fl + 1));
+		if(!flmap)
+			return NULL;
+		fl = tlsf_ffs(flmap);
+		slmap = t->slmap[fl];
+	}
+	return t->lists[fl][tlsf_ffs(slmap)];
+}
+
+static inline void insert_free(EEL_tlsf *t, TLSF_block *b)
+{
+	int fl, sl;
+	mapping_insert(b_size(b), &fl, &sl);
+	b->size |= TLSF_FREE;
+	b->prev = NULL;
+	b->next = t->lists[fl][sl];
+	if(b->next)
+		b->next->prev = b;
+	t->lists[fl][sl] = b;
+	t->flmap |= 1U << fl;
+	t->slmap[fl] |= 1U << sl;
+}
+
+static inline void remove_free(EEL_tlsf *t, TLSF_block *b)
+{
+	int fl, sl;
+	mapping_insert(b_size(b), &fl, &sl);
+	if(b->next)
+		b->next->prev = b->prev;
+	if(b->prev)
+		b->prev->next = b->next;
+	else
+	{
+		t->lists[fl][sl] = b->next;
+		if(!b->next)
+		{
+			t->slmap[fl] &= ~(1U << sl);
+			if(!t->slmap[fl])
+				t->flmap &= ~(1U << fl);
+		}
+	}
+	b->size &= ~(size_t)TLSF_FREE;
+}
+
+/*
+ * Cut the data area of the allocated block 'b' down to 'size' bytes, if
+ * enough is left over for a free block, and merge that with the following
+ * block if that's free.
+ */
+static inline void trim_used(EEL_tlsf *t, TLSF_block *b, size_t size)
+{
+	TLSF_block *rest, *next;
+	size_t bs = b_size(b);
+	if(bs < size + sizeof(TLSF_block))
+		return;
+	rest = (TLSF_block *)((char *)b2ptr(b) + size);
+	rest->size = bs - size - TLSF_HEADER;
+	rest->prevphys = b;
+	b->size = size;
+	next = b_next(rest);
+	if(b_isfree(next))
+	{
+		remove_free(t, next);
+		rest->size += TLSF_HEADER + b_size(next);
+		next = b_next(rest);
+	}
+	next->prevphys = rest;
+	insert_free(t, rest);
+}
+
+/* Round a request up to a valid data area size */
+static inline size_t adjust_size(int size)
+{
+	size_t s = size > 0 ? (size_t)size : 1;
+	s = (s + TLSF_ALIGN - 1) & ~(size_t)(TLSF_ALIGN - 1);
+	return s < TLSF_MINDATA ? TLSF_MINDATA : s;
+}
+
+static inline void count_used(EEL_tlsf *t, size_t bytes)
+{
+	t->used += bytes;
+	if(t->used > t->peak)
+		t->peak = t->used;
+}
+
+
+/*----------------------------------------------------------
+	Allocator API
+----------------------------------------------------------*/
+
+EEL_tlsf *eel_tlsf_open(void *pool, int size)
+{
+	EEL_tlsf *t;
+	TLSF_block *b, *sentinel;
+	char *start = (char *)pool;
+	char *end = start + size;
+	char *area;
+	if(!pool || size <= 0)
+		return NULL;
+
+	/* Control structure */
+	t = (EEL_tlsf *)(((size_t)start + TLSF_ALIGN - 1) &
+			~(size_t)(TLSF_ALIGN - 1));
+	area = (char *)(t + 1);
+	area = (char *)(((size_t)area + TLSF_ALIGN - 1) &
+			~(size_t)(TLSF_ALIGN - 1));
+	if(end - area < (ptrdiff_t)(sizeof(TLSF_block) + TLSF_HEADER))
+		return NULL;
+	memset(t, 0, sizeof(EEL_tlsf));
+	t->size = size;
+
+	/* One big free block, followed by a zero sized allocated sentinel */
+	b = (TLSF_block *)area;
+	b->prevphys = NULL;
+	b->size = ((size_t)(end - area) - 2 * TLSF_HEADER) &
+			~(size_t)(TLSF_ALIGN - 1);
+	sentinel = b_next(b);
+	sentinel->prevphys = b;
+	sentinel->size = 0;
+	insert_free(t, b);
+	return t;
+}
+
+
+void *eel_tlsf_malloc(EEL_tlsf *t, int size)
+{
+	int fl, sl;
+	TLSF_block *b;
+	size_t s = adjust_size(size);
+	if(!mapping_search(s, &fl, &sl) || !(b = find_free(t, fl, sl)))
+	{
+		++t->fails;
+		return NULL;
+	}
+	remove_free(t, b);
+	trim_used(t, b, s);
+	count_used(t, TLSF_HEADER + b_size(b));
+	return b2ptr(b);
+}
+
+
+void eel_tlsf_free(EEL_tlsf *t, void *block)
+{
+	TLSF_block *b, *next;
+	if(!block)
+		return;
+	b = ptr2b(block);
+	t->used -= TLSF_HEADER + b_size(b);
+	if(b->prevphys && b_isfree(b->prevphys))
+	{
+		TLSF_block *prev = b->prevphys;
+		remove_free(t, prev);
+		prev->size += TLSF_HEADER + b_size(b);
+		b = prev;
+	}
+	next = b_next(b);
+	if(b_isfree(next))
+	{
+		remove_free(t, next);
+		b->size += TLSF_HEADER + b_size(next);
+		next = b_next(b);
+	}
+	next->prevphys = b;
+	insert_free(t, b);
+}
+
+
+void *eel_tlsf_realloc(EEL_tlsf *t, void *block, int size)
+{
+	TLSF_block *b, *next;
+	size_t s, bs;
+	void *nb;
+	if(!block)
+		return eel_tlsf_malloc(t, size);
+	if(!size)
+	{
+		eel_tlsf_free(t, block);
+		return NULL;
+	}
+	b = ptr2b(block);
+	bs = b_size(b);
+	s = adjust_size(size);
+
+	/* Grow in place, if the next block is free and large enough */
+	next = b_next(b);
+	if(s > bs && b_isfree(next) &&
+			bs + TLSF_HEADER + b_size(next) >= s)
+	{
+		remove_free(t, next);
+		b->size += TLSF_HEADER + b_size(next);
+		b_next(b)->prevphys = b;
+		t->used -= TLSF_HEADER + bs;
+		trim_used(t, b, s);
+		count_used(t, TLSF_HEADER + b_size(b));
+		return block;
+	}
+
+	/* Shrink in place */
+	if(s <= bs)
+	{
+		t->used -= TLSF_HEADER + bs;
+		trim_used(t, b, s);
+		count_used(t, TLSF_HEADER + b_size(b));
+		return block;
+	}
+
+	/* Move */
+	if(!(nb = eel_tlsf_malloc(t, size)))
+		return NULL;
+	memcpy(nb, block, bs);
+	eel_tlsf_free(t, block);
+	return nb;
+}
+
+
+/* O(free blocks); see e_tlsf.h */
+void eel_tlsf_stats(EEL_tlsf *t, EEL_poolstats *ps)
+{
+	int fl, sl;
+	size_t total = 0, largest = 0;
+	int blocks = 0;
+	for(fl = 0; fl < TLSF_FL_COUNT; ++fl)
+		for(sl = 0; sl < TLSF_SL_COUNT; ++sl)
+		{
+			TLSF_block *b;
+			for(b = t->lists[fl][sl]; b; b = b->next)
+			{
+				size_t bs = b_size(b);
+				total += bs;
+				if(bs > largest)
+					largest = bs;
+				++blocks;
+			}
+		}
+	ps->size = (int)t->size;
+	ps->used = (int)t->used;
+	ps->peak = (int)t->peak;
+	ps->free = (int)total;
+	ps->largest = (int)largest;
+	ps->freeblocks = blocks;
+	ps->fails = t->fails;
+	ps->fragmentation = total ? 1.0 - (double)largest / total : 0.0;
+}
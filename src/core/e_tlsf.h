@@ -0,0 +1,61 @@
+/*
+---------------------------------------------------------------------------
+	e_tlsf.h - EEL TLSF memory pool allocator
+---------------------------------------------------------------------------
+ * Copyright 2026 The EEL contributors
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the
+ * use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef	EEL_E_TLSF_H
+#define	EEL_E_TLSF_H
+
+#include "e_eel.h"
+
+/*
+ * Two-Level Segregated Fit allocator, managing a fixed memory pool. Free
+ * blocks are kept in lists by size, indexed by the position of the highest
+ * set bit of the size (first level), and the next few bits below that
+ * (second level). A bitmap for each level makes finding a large enough free
+ * block O(1), and physically adjacent free blocks are merged immediately, so
+ * malloc, realloc and free all run in bounded time, without ever calling the
+ * operating system.
+ *
+ * The control structure is placed at the start of the pool, so the pool is
+ * the only memory involved. NOT thread safe!
+ */
+
+typedef struct EEL_tlsf EEL_tlsf;
+
+/*
+ * Set up an allocator managing the 'size' bytes at 'pool'. Returns NULL if
+ * the pool is too small to be useful.
+ */
+EEL_tlsf *eel_tlsf_open(void *pool, int size);
+
+void *eel_tlsf_malloc(EEL_tlsf *t, int size);
+void *eel_tlsf_realloc(EEL_tlsf *t, void *block, int size);
+void eel_tlsf_free(EEL_tlsf *t, void *block);
+
+/*
+ * Fill in 'ps' with statistics. This walks the free lists, so unlike the rest
+ * of the allocator, it does NOT run in constant time, but O(free blocks). Not
+ * for the real time path!
+ */
+void eel_tlsf_stats(EEL_tlsf *t, EEL_poolstats *ps);
+
+#endif /* EEL_E_TLSF_H */
@@ -224,7 +224,7 @@ TODO: Try to cast to EEL_CREAL or something.
 
 const char *eel_v2s(EEL_value *v)
 {
-	switch(v->classid)
+	switch(EEL_VCLASS(v))
 	{
 	  case EEL_CNIL:
 	  case EEL_CBOOLEAN:
@@ -234,12 +234,12 @@ const char *eel_v2s(EEL_value *v)
 		return NULL;
 	  case EEL_COBJREF:
 	  case EEL_CWEAKREF:
-		switch(v->objref.v->classid)
+		switch(eel_v2o(v)->classid)
 		{
 		  case EEL_CSTRING:
-			return eel_o2s(v->objref.v);
+			return eel_o2s(eel_v2o(v));
 		  case EEL_CDSTRING:
-			return o2EEL_dstring(v->objref.v)->buffer;
+			return o2EEL_dstring(eel_v2o(v))->buffer;
 		  default:
 			return NULL;
 		}
@@ -281,7 +281,7 @@ EEL_object *eel_new_indexable(EEL_vm *vm, EEL_classes itype, int length)
 	/* Try to construct empty object */
 	if(eel_o__construct(vm, itype, NULL, 0, &iv))
 		return NULL;
-	o = iv.objref.v;
+	o = eel_v2o(&iv);
 
 	/* Set last index, to reallocate and initialize */
 	eel_l2v(&iv, length - 1);
@@ -504,21 +504,21 @@ const char *eel_o_stringrep(EEL_object *o)
 const char *eel_v_stringrep(EEL_vm *vm, const EEL_value *value)
 {
 	char *buf;
-	switch(value->classid)
+	switch(EEL_VCLASS(value))
 	{
 	  case EEL_CNIL:
 		return "<nil>";
 	  case EEL_CREAL:
 		buf = eel_salloc(VMP->state);
-		snprintf(buf, EEL_SBUFSIZE, "%.10g", value->real.v);
+		snprintf(buf, EEL_SBUFSIZE, "%.10g", EEL_VREAL(value));
 		return buf;
 	  case EEL_CINTEGER:
 		buf = eel_salloc(VMP->state);
 		snprintf(buf, EEL_SBUFSIZE, "%d (0x%x)",
-				value->integer.v, value->integer.v);
+				EEL_VINT(value), EEL_VINT(value));
 		return buf;
 	  case EEL_CBOOLEAN:
-		if(value->integer.v)
+		if(EEL_VINT(value))
 			return "true";
 		else
 			return "false";
@@ -526,11 +526,11 @@ const char *eel_v_stringrep(EEL_vm *vm, const EEL_value *value)
 		buf = eel_salloc(VMP->state);
 		snprintf(buf, EEL_SBUFSIZE, "<classid %s>",
 				eel_o2s(o2EEL_classdef(
-				VMP->state->classes[value->integer.v])->name));
+				VMP->state->classes[EEL_VINT(value)])->name));
 		return buf;
 	  case EEL_COBJREF:
 	  case EEL_CWEAKREF:
-		return eel_o_stringrep(value->objref.v);
+		return eel_o_stringrep(eel_v2o(value));
 	  default:
 		return "<internal error: undef value type>";
 	}
@@ -729,6 +729,17 @@ static void dump_code(EEL_state *es, EEL_object *fo, int indent)
 	}
 	else
 		printf("%s       <no code>\n", inds);
+	for(i = 0; i < f->e.nxregions; ++i)
+	{
+		EEL_xregion *xr = &f->e.xregions[i];
+		if(xr->handler < 0)
+			printf("%s   X%d: %d..%d untry\n", inds, i,
+					xr->start, xr->end);
+		else
+			printf("%s   X%d: %d..%d -> %d, CLEAN %d, R[%d]\n",
+					inds, i, xr->start, xr->end,
+					xr->handler, xr->clean, xr->xreg);
+	}
 	free(inds);
 }
 
@@ -852,10 +863,12 @@ static void st_dump(EEL_state *es, EEL_symbol *st, int code, int indent)
 
 	if((EEL_SFUNCTION == st->type) && code && st->v.object)
 	{
+		EEL_function *f = o2EEL_function(st->v.object);
 		printf("%s---------------------------------------\n", inds);
-		if((o2EEL_function(st->v.object)->common.flags & EEL_FF_CFUNC))
-			printf("%s native code: %p\n", inds,
-					o2EEL_function(st->v.object)->c.cb);
+		if(f->common.flags & EEL_FF_LEAF)
+			printf("%s native leaf code: %p\n", inds, f->c.leaf);
+		else if(f->common.flags & EEL_FF_CFUNC)
+			printf("%s native code: %p\n", inds, f->c.cb);
 		else
 			dump_code(es, st->v.object, indent);
 	}
@@ -280,29 +280,31 @@ static inline EEL_hash eel_hashmem(const void *dat, unsigned len)
 
 static inline EEL_hash eel_v2hash(EEL_value *v)
 {
-	switch(v->classid)
+	switch(EEL_VCLASS(v))
 	{
 	  case EEL_CNIL:
 		return 1315423911;
 	  case EEL_CREAL:
 	  {
-		unsigned *i = (unsigned *)&v->real;
+		EEL_real r = EEL_VREAL(v);
+		unsigned *i = (unsigned *)&r;
 		return 1315423911 ^ (42422421131 + (i[0] ^ i[1]));
 	  }
 	  case EEL_CINTEGER:
 	  case EEL_CBOOLEAN:
 	  case EEL_CCLASSID:
-		return (1315423911 << v->classid) ^ v->integer.v;
+		return (1315423911 << EEL_VCLASS(v)) ^ EEL_VINT(v);
 	  case EEL_COBJREF:
 	  case EEL_CWEAKREF:
-		if(v->objref.v->classid == EEL_CSTRING)
-			return o2EEL_string(v->objref.v)->hash;
+		if(eel_v2o(v)->classid == EEL_CSTRING)
+			return o2EEL_string(eel_v2o(v))->hash;
 		else
 		{
-			unsigned *i = (unsigned *)&v->objref.v;
+			EEL_object *o = eel_v2o(v);
+			unsigned *i = (unsigned *)&o;
 			EEL_hash hash = 1315423911;
 			int j;
-			for(j = 0; j < sizeof(v->objref.v) / sizeof(unsigned); ++j)
+			for(j = 0; j < sizeof(o) / sizeof(unsigned); ++j)
 				hash ^= ((hash << 5) + i[j] + (hash >> 2));
 			return hash;
 	 	}
@@ -50,7 +50,7 @@ static inline EEL_xno v_setsize(EEL_object *eo, int newsize)
 static inline EEL_xno write_index(EEL_object *eo, int i, EEL_value *v)
 {
 	EEL_vector *vec = o2EEL_vector(eo);
-	switch(v->classid)
+	switch(EEL_VCLASS(v))
 	{
 	  case EEL_CNIL:
 		switch(eo->classid)
@@ -94,21 +94,21 @@ static inline EEL_xno write_index(EEL_object *eo, int i, EEL_value *v)
 		   */
 		  case EEL_CVECTOR_U8:
 		  case EEL_CVECTOR_S8:
-			vec->buffer.u8[i] = v->integer.v;
+			vec->buffer.u8[i] = EEL_VINT(v);
 			break;
 		  case EEL_CVECTOR_U16:
 		  case EEL_CVECTOR_S16:
-			vec->buffer.u16[i] = v->integer.v;
+			vec->buffer.u16[i] = EEL_VINT(v);
 			break;
 		  case EEL_CVECTOR_U32:
 		  case EEL_CVECTOR_S32:
-			vec->buffer.u32[i] = v->integer.v;
+			vec->buffer.u32[i] = EEL_VINT(v);
 			break;
 		  case EEL_CVECTOR_F:
-			vec->buffer.f[i] = v->integer.v;
+			vec->buffer.f[i] = EEL_VINT(v);
 			break;
 		  case EEL_CVECTOR_D:
-			vec->buffer.d[i] = v->integer.v;
+			vec->buffer.d[i] = EEL_VINT(v);
 			break;
 		  default:
 			return EEL_XINTERNAL;
@@ -119,21 +119,21 @@ static inline EEL_xno write_index(EEL_object *eo, int i, EEL_value *v)
 		{
 		  case EEL_CVECTOR_U8:
 		  case EEL_CVECTOR_S8:
-			vec->buffer.u8[i] = floor(v->real.v);
+			vec->buffer.u8[i] = floor(EEL_VREAL(v));
 			break;
 		  case EEL_CVECTOR_U16:
 		  case EEL_CVECTOR_S16:
-			vec->buffer.u16[i] = floor(v->real.v);
+			vec->buffer.u16[i] = floor(EEL_VREAL(v));
 			break;
 		  case EEL_CVECTOR_U32:
 		  case EEL_CVECTOR_S32:
-			vec->buffer.u32[i] = floor(v->real.v);
+			vec->buffer.u32[i] = floor(EEL_VREAL(v));
 			break;
 		  case EEL_CVECTOR_F:
-			vec->buffer.f[i] = v->real.v;
+			vec->buffer.f[i] = EEL_VREAL(v);
 			break;
 		  case EEL_CVECTOR_D:
-			vec->buffer.d[i] = v->real.v;
+			vec->buffer.d[i] = EEL_VREAL(v);
 			break;
 		  default:
 			return EEL_XINTERNAL;
@@ -370,15 +370,15 @@ static EEL_xno v_getindex(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	int i;
 
 	/* Cast index to int */
-	switch(op1->classid)
+	switch(EEL_VCLASS(op1))
 	{
 	  case EEL_CBOOLEAN:
 	  case EEL_CINTEGER:
 	  case EEL_CCLASSID:
-		i = op1->integer.v;
+		i = EEL_VINT(op1);
 		break;
 	  case EEL_CREAL:
-		i = floor(op1->real.v);
+		i = floor(EEL_VREAL(op1));
 		break;
 	  default:
 		return EEL_XWRONGTYPE;
@@ -394,36 +394,28 @@ static EEL_xno v_getindex(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	switch(eo->classid)
 	{
 	  case EEL_CVECTOR_U8:
-		op2->classid = EEL_CINTEGER;
-		op2->integer.v = vec->buffer.u8[i];
+		eel_l2v(op2, vec->buffer.u8[i]);
 		break;
 	  case EEL_CVECTOR_S8:
-		op2->classid = EEL_CINTEGER;
-		op2->integer.v = vec->buffer.s8[i];
+		eel_l2v(op2, vec->buffer.s8[i]);
 		break;
 	  case EEL_CVECTOR_U16:
-		op2->classid = EEL_CINTEGER;
-		op2->integer.v = vec->buffer.u16[i];
+		eel_l2v(op2, vec->buffer.u16[i]);
 		break;
 	  case EEL_CVECTOR_S16:
-		op2->classid = EEL_CINTEGER;
-		op2->integer.v = vec->buffer.s16[i];
+		eel_l2v(op2, vec->buffer.s16[i]);
 		break;
 	  case EEL_CVECTOR_U32:
-		op2->classid = EEL_CINTEGER;
-		op2->integer.v = vec->buffer.u32[i];
+		eel_l2v(op2, vec->buffer.u32[i]);
 		break;
 	  case EEL_CVECTOR_S32:
-		op2->classid = EEL_CINTEGER;
-		op2->integer.v = vec->buffer.s32[i];
+		eel_l2v(op2, vec->buffer.s32[i]);
 		break;
 	  case EEL_CVECTOR_F:
-		op2->classid = EEL_CREAL;
-		op2->real.v = vec->buffer.f[i];
+		eel_d2v(op2, vec->buffer.f[i]);
 		break;
 	  case EEL_CVECTOR_D:
-		op2->classid = EEL_CREAL;
-		op2->real.v = vec->buffer.d[i];
+		eel_d2v(op2, vec->buffer.d[i]);
 		break;
 	  default:
 		return EEL_XINTERNAL;
@@ -439,15 +431,15 @@ static EEL_xno v_setindex(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	int i;
 
 	/* Cast index to int */
-	switch(op1->classid)
+	switch(EEL_VCLASS(op1))
 	{
 	  case EEL_CBOOLEAN:
 	  case EEL_CINTEGER:
 	  case EEL_CCLASSID:
-		i = op1->integer.v;
+		i = EEL_VINT(op1);
 		break;
 	  case EEL_CREAL:
-		i = floor(op1->real.v);
+		i = floor(EEL_VREAL(op1));
 		break;
 	  default:
 		return EEL_XWRONGTYPE;
@@ -486,15 +478,15 @@ static EEL_xno v_insert(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
 	int x, i, is;
 	EEL_vector *v = o2EEL_vector(eo);
-	switch(op1->classid)
+	switch(EEL_VCLASS(op1))
 	{
 	  case EEL_CBOOLEAN:
 	  case EEL_CINTEGER:
 	  case EEL_CCLASSID:
-		i = op1->integer.v;
+		i = EEL_VINT(op1);
 		break;
 	  case EEL_CREAL:
-		i = floor(op1->real.v);
+		i = floor(EEL_VREAL(op1));
 		break;
 	  default:
 		return EEL_XWRONGTYPE;
@@ -556,8 +548,7 @@ static EEL_xno v_copy(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 
 static EEL_xno v_length(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
-	op2->classid = EEL_CINTEGER;
-	op2->integer.v = o2EEL_vector(eo)->length;
+	eel_l2v(op2, o2EEL_vector(eo)->length);
 	return 0;
 }
 
@@ -580,29 +571,28 @@ static inline int vcmp_u8_u8(EEL_uint8 *a, EEL_uint8 *b, int length)
 static EEL_xno v_compare(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
 	EEL_vector *v, *ov;
-	if(!EEL_IS_OBJREF(op1->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(op1)))
 		return EEL_XWRONGTYPE;
 
-	if(op1->objref.v->classid != eo->classid)
+	if(eel_v2o(op1)->classid != eo->classid)
 		return EEL_XNOTIMPLEMENTED;
 
 	v = o2EEL_vector(eo);
-	ov = o2EEL_vector(op1->objref.v);
-	op2->classid = EEL_CINTEGER;
+	ov = o2EEL_vector(eel_v2o(op1));
 	if(v->length > ov->length)
 	{
-		op2->integer.v = 1;
+		eel_l2v(op2, 1);
 		return 0;
 	}
 	else if(v->length < ov->length)
 	{
-		op2->integer.v = -1;
+		eel_l2v(op2, -1);
 		return 0;
 	}
 	switch(eo->classid)
 	{
 	  case EEL_CVECTOR_U8:
-		op2->integer.v = vcmp_u8_u8(v->buffer.u8, ov->buffer.u8, v->length);
+		eel_l2v(op2, vcmp_u8_u8(v->buffer.u8, ov->buffer.u8, v->length));
 		return 0;
 	  case EEL_CVECTOR_S8:
 	  case EEL_CVECTOR_U16:
@@ -622,8 +612,9 @@ static EEL_xno v_cast_to_string(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 
 {
+	EEL_object *o;
 	int i;
-	EEL_object *orig = src->objref.v;
+	EEL_object *orig = eel_v2o(src);
 	EEL_vector *vec = o2EEL_vector(orig);
 	char *buf = eel_malloc(vm, vec->length + 1);
 	if(!buf)
@@ -631,13 +622,13 @@ static EEL_xno v_cast_to_string(EEL_vm *vm,
 	for(i = 0; i < vec->length; ++i)
 		buf[i] = get_ivalue(orig, i);
 	buf[i] = 0;
-	dst->objref.v = eel_ps_nnew_grab(vm, buf, vec->length);
-	if(!dst->objref.v)
+	o = eel_ps_nnew_grab(vm, buf, vec->length);
+	if(!o)
 	{
 		eel_free(vm, buf);
 		return EEL_XCONSTRUCTOR;
 	}
-	dst->classid = EEL_COBJREF;
+	eel_o2v(dst, o);
 	return 0;
 }
 
@@ -645,7 +636,7 @@ static EEL_xno v_cast_to_string(EEL_vm *vm,
 static EEL_xno v_clone(EEL_vm *vm,
 		const EEL_value *src, EEL_value *dst, EEL_classes cid)
 {
-	EEL_object *orig = src->objref.v;
+	EEL_object *orig = eel_v2o(src);
 	EEL_object *no = full_clone(orig);
 	if(!no)
 		return EEL_XMEMORY;
@@ -661,7 +652,7 @@ static inline EEL_xno do_vadd(EEL_object *eo, EEL_value *op1, EEL_object *to)
 	EEL_real rv;
 	EEL_vector *source = o2EEL_vector(eo);
 	EEL_vector *target = o2EEL_vector(to);
-	switch(op1->classid)
+	switch(EEL_VCLASS(op1))
 	{
 	  case EEL_CNIL:
 		if(target == source)
@@ -681,27 +672,27 @@ static inline EEL_xno do_vadd(EEL_object *eo, EEL_value *op1, EEL_object *to)
 		  case EEL_CVECTOR_S8:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u8[i] = source->buffer.u8[i] +
-						op1->integer.v;
+						EEL_VINT(op1);
 			return 0;
 		  case EEL_CVECTOR_U16:
 		  case EEL_CVECTOR_S16:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u16[i] = source->buffer.u16[i] +
-						op1->integer.v;
+						EEL_VINT(op1);
 			return 0;
 		  case EEL_CVECTOR_U32:
 		  case EEL_CVECTOR_S32:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u32[i] = source->buffer.u32[i] +
-						op1->integer.v;
+						EEL_VINT(op1);
 			return 0;
 		  case EEL_CVECTOR_F:
-			rv = op1->integer.v;
+			rv = EEL_VINT(op1);
 			for(i = 0; i < source->length; ++i)
 				target->buffer.f[i] = source->buffer.f[i] + rv;
 			return 0;
 		  case EEL_CVECTOR_D:
-			rv = op1->integer.v;
+			rv = EEL_VINT(op1);
 			for(i = 0; i < source->length; ++i)
 				target->buffer.d[i] = source->buffer.d[i] + rv;
 			return 0;
@@ -713,31 +704,31 @@ static inline EEL_xno do_vadd(EEL_object *eo, EEL_value *op1, EEL_object *to)
 		{
 		  case EEL_CVECTOR_U8:
 		  case EEL_CVECTOR_S8:
-			iv = floor(op1->real.v);
+			iv = floor(EEL_VREAL(op1));
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u8[i] = source->buffer.u8[i] + iv;
 			return 0;
 		  case EEL_CVECTOR_U16:
 		  case EEL_CVECTOR_S16:
-			iv = floor(op1->real.v);
+			iv = floor(EEL_VREAL(op1));
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u16[i] = source->buffer.u16[i] + iv;
 			return 0;
 		  case EEL_CVECTOR_U32:
 		  case EEL_CVECTOR_S32:
-			iv = floor(op1->real.v);
+			iv = floor(EEL_VREAL(op1));
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u32[i] = source->buffer.u32[i] + iv;
 			return 0;
 		  case EEL_CVECTOR_F:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.f[i] = source->buffer.f[i] +
-						op1->real.v;
+						EEL_VREAL(op1);
 			return 0;
 		  case EEL_CVECTOR_D:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.d[i] = source->buffer.d[i] +
-						op1->real.v;
+						EEL_VREAL(op1);
 			return 0;
 		  default:
 			return EEL_XINTERNAL;
@@ -751,29 +742,29 @@ static inline EEL_xno do_vadd(EEL_object *eo, EEL_value *op1, EEL_object *to)
 		  case EEL_CVECTOR_S8:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u8[i] = source->buffer.u8[i] +
-						get_ivalue(op1->objref.v, i);
+						get_ivalue(eel_v2o(op1), i);
 			return 0;
 		  case EEL_CVECTOR_U16:
 		  case EEL_CVECTOR_S16:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u16[i] = source->buffer.u16[i] +
-						get_ivalue(op1->objref.v, i);
+						get_ivalue(eel_v2o(op1), i);
 			return 0;
 		  case EEL_CVECTOR_U32:
 		  case EEL_CVECTOR_S32:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u32[i] = source->buffer.u32[i] +
-						get_ivalue(op1->objref.v, i);
+						get_ivalue(eel_v2o(op1), i);
 			return 0;
 		  case EEL_CVECTOR_F:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.f[i] = source->buffer.f[i] +
-						get_rvalue(op1->objref.v, i);
+						get_rvalue(eel_v2o(op1), i);
 			return 0;
 		  case EEL_CVECTOR_D:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.d[i] = source->buffer.d[i] +
-						get_rvalue(op1->objref.v, i);
+						get_rvalue(eel_v2o(op1), i);
 			return 0;
 		  default:
 			return EEL_XWRONGTYPE;
@@ -820,7 +811,7 @@ static inline EEL_xno do_vsub(EEL_object *eo, EEL_value *op1, EEL_object *to)
 	EEL_real rv;
 	EEL_vector *source = o2EEL_vector(eo);
 	EEL_vector *target = o2EEL_vector(to);
-	switch(op1->classid)
+	switch(EEL_VCLASS(op1))
 	{
 	  case EEL_CNIL:
 		if(target == source)
@@ -840,27 +831,27 @@ static inline EEL_xno do_vsub(EEL_object *eo, EEL_value *op1, EEL_object *to)
 		  case EEL_CVECTOR_S8:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u8[i] = source->buffer.u8[i] -
-						op1->integer.v;
+						EEL_VINT(op1);
 			return 0;
 		  case EEL_CVECTOR_U16:
 		  case EEL_CVECTOR_S16:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u16[i] = source->buffer.u16[i] -
-						op1->integer.v;
+						EEL_VINT(op1);
 			return 0;
 		  case EEL_CVECTOR_U32:
 		  case EEL_CVECTOR_S32:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u32[i] = source->buffer.u32[i] -
-						op1->integer.v;
+						EEL_VINT(op1);
 			return 0;
 		  case EEL_CVECTOR_F:
-			rv = op1->integer.v;
+			rv = EEL_VINT(op1);
 			for(i = 0; i < source->length; ++i)
 				target->buffer.f[i] = source->buffer.f[i] - rv;
 			return 0;
 		  case EEL_CVECTOR_D:
-			rv = op1->integer.v;
+			rv = EEL_VINT(op1);
 			for(i = 0; i < source->length; ++i)
 				target->buffer.d[i] = source->buffer.d[i] - rv;
 			return 0;
@@ -872,31 +863,31 @@ static inline EEL_xno do_vsub(EEL_object *eo, EEL_value *op1, EEL_object *to)
 		{
 		  case EEL_CVECTOR_U8:
 		  case EEL_CVECTOR_S8:
-			iv = floor(op1->real.v);
+			iv = floor(EEL_VREAL(op1));
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u8[i] = source->buffer.u8[i] - iv;
 			return 0;
 		  case EEL_CVECTOR_U16:
 		  case EEL_CVECTOR_S16:
-			iv = floor(op1->real.v);
+			iv = floor(EEL_VREAL(op1));
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u16[i] = source->buffer.u16[i] - iv;
 			return 0;
 		  case EEL_CVECTOR_U32:
 		  case EEL_CVECTOR_S32:
-			iv = floor(op1->real.v);
+			iv = floor(EEL_VREAL(op1));
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u32[i] = source->buffer.u32[i] - iv;
 			return 0;
 		  case EEL_CVECTOR_F:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.f[i] = source->buffer.f[i] -
-						op1->real.v;
+						EEL_VREAL(op1);
 			return 0;
 		  case EEL_CVECTOR_D:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.d[i] = source->buffer.d[i] -
-						op1->real.v;
+						EEL_VREAL(op1);
 			return 0;
 		  default:
 			return EEL_XINTERNAL;
@@ -910,29 +901,29 @@ static inline EEL_xno do_vsub(EEL_object *eo, EEL_value *op1, EEL_object *to)
 		  case EEL_CVECTOR_S8:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u8[i] = source->buffer.u8[i] -
-						get_ivalue(op1->objref.v, i);
+						get_ivalue(eel_v2o(op1), i);
 			return 0;
 		  case EEL_CVECTOR_U16:
 		  case EEL_CVECTOR_S16:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u16[i] = source->buffer.u16[i] -
-						get_ivalue(op1->objref.v, i);
+						get_ivalue(eel_v2o(op1), i);
 			return 0;
 		  case EEL_CVECTOR_U32:
 		  case EEL_CVECTOR_S32:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u32[i] = source->buffer.u32[i] -
-						get_ivalue(op1->objref.v, i);
+						get_ivalue(eel_v2o(op1), i);
 			return 0;
 		  case EEL_CVECTOR_F:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.f[i] = source->buffer.f[i] -
-						get_rvalue(op1->objref.v, i);
+						get_rvalue(eel_v2o(op1), i);
 			return 0;
 		  case EEL_CVECTOR_D:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.d[i] = source->buffer.d[i] -
-						get_rvalue(op1->objref.v, i);
+						get_rvalue(eel_v2o(op1), i);
 			return 0;
 		  default:
 			return EEL_XWRONGTYPE;
@@ -979,7 +970,7 @@ static inline EEL_xno do_vmul(EEL_object *eo, EEL_value *op1, EEL_object *to)
 	EEL_real rv;
 	EEL_vector *source = o2EEL_vector(eo);
 	EEL_vector *target = o2EEL_vector(to);
-	switch(op1->classid)
+	switch(EEL_VCLASS(op1))
 	{
 	  case EEL_CNIL:
 		if(target == source)
@@ -998,27 +989,27 @@ static inline EEL_xno do_vmul(EEL_object *eo, EEL_value *op1, EEL_object *to)
 		  case EEL_CVECTOR_S8:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u8[i] = source->buffer.u8[i] *
-						op1->integer.v;
+						EEL_VINT(op1);
 			return 0;
 		  case EEL_CVECTOR_U16:
 		  case EEL_CVECTOR_S16:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u16[i] = source->buffer.u16[i] *
-						op1->integer.v;
+						EEL_VINT(op1);
 			return 0;
 		  case EEL_CVECTOR_U32:
 		  case EEL_CVECTOR_S32:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u32[i] = source->buffer.u32[i] *
-						op1->integer.v;
+						EEL_VINT(op1);
 			return 0;
 		  case EEL_CVECTOR_F:
-			rv = op1->integer.v;
+			rv = EEL_VINT(op1);
 			for(i = 0; i < source->length; ++i)
 				target->buffer.f[i] = source->buffer.f[i] * rv;
 			return 0;
 		  case EEL_CVECTOR_D:
-			rv = op1->integer.v;
+			rv = EEL_VINT(op1);
 			for(i = 0; i < source->length; ++i)
 				target->buffer.d[i] = source->buffer.d[i] * rv;
 			return 0;
@@ -1030,31 +1021,31 @@ static inline EEL_xno do_vmul(EEL_object *eo, EEL_value *op1, EEL_object *to)
 		{
 		  case EEL_CVECTOR_U8:
 		  case EEL_CVECTOR_S8:
-			iv = floor(op1->real.v);
+			iv = floor(EEL_VREAL(op1));
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u8[i] = source->buffer.u8[i] * iv;
 			return 0;
 		  case EEL_CVECTOR_U16:
 		  case EEL_CVECTOR_S16:
-			iv = floor(op1->real.v);
+			iv = floor(EEL_VREAL(op1));
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u16[i] = source->buffer.u16[i] * iv;
 			return 0;
 		  case EEL_CVECTOR_U32:
 		  case EEL_CVECTOR_S32:
-			iv = floor(op1->real.v);
+			iv = floor(EEL_VREAL(op1));
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u32[i] = source->buffer.u32[i] * iv;
 			return 0;
 		  case EEL_CVECTOR_F:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.f[i] = source->buffer.f[i] *
-						op1->real.v;
+						EEL_VREAL(op1);
 			return 0;
 		  case EEL_CVECTOR_D:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.d[i] = source->buffer.d[i] *
-						op1->real.v;
+						EEL_VREAL(op1);
 			return 0;
 		  default:
 			return EEL_XINTERNAL;
@@ -1068,29 +1059,29 @@ static inline EEL_xno do_vmul(EEL_object *eo, EEL_value *op1, EEL_object *to)
 		  case EEL_CVECTOR_S8:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u8[i] = source->buffer.u8[i] *
-						get_ivalue(op1->objref.v, i);
+						get_ivalue(eel_v2o(op1), i);
 			return 0;
 		  case EEL_CVECTOR_U16:
 		  case EEL_CVECTOR_S16:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u16[i] = source->buffer.u16[i] *
-						get_ivalue(op1->objref.v, i);
+						get_ivalue(eel_v2o(op1), i);
 			return 0;
 		  case EEL_CVECTOR_U32:
 		  case EEL_CVECTOR_S32:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.u32[i] = source->buffer.u32[i] *
-						get_ivalue(op1->objref.v, i);
+						get_ivalue(eel_v2o(op1), i);
 			return 0;
 		  case EEL_CVECTOR_F:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.f[i] = source->buffer.f[i] *
-						get_rvalue(op1->objref.v, i);
+						get_rvalue(eel_v2o(op1), i);
 			return 0;
 		  case EEL_CVECTOR_D:
 			for(i = 0; i < source->length; ++i)
 				target->buffer.d[i] = source->buffer.d[i] *
-						get_rvalue(op1->objref.v, i);
+						get_rvalue(eel_v2o(op1), i);
 			return 0;
 		  default:
 			return EEL_XWRONGTYPE;
@@ -1136,7 +1127,7 @@ static inline EEL_xno v__append(EEL_object *eo, EEL_value *op1, EEL_object *to)
 	EEL_xno x;
 	EEL_vector *vec = o2EEL_vector(eo);
 	int start = vec->length;
-	int len = EEL_IS_OBJREF(op1->classid) ? eel_length(op1->objref.v) : -1;
+	int len = EEL_IS_OBJREF(EEL_VCLASS(op1)) ? eel_length(eel_v2o(op1)) : -1;
 	if(!len)
 		return 0;	/* Nothing to do! */
 	if(len > 0)
@@ -1151,7 +1142,7 @@ static inline EEL_xno v__append(EEL_object *eo, EEL_value *op1, EEL_object *to)
 		{
 			EEL_value v;
 			eel_l2v(&v, i);
-			x = eel_o__metamethod(op1->objref.v, EEL_MM_GETINDEX, &v, &v);
+			x = eel_o__metamethod(eel_v2o(op1), EEL_MM_GETINDEX, &v, &v);
 			if(x)
 				return x;
 			x = write_index(eo, start + i, &v);
@@ -32,12 +32,19 @@
 #include "e_vector.h"
 #include "e_operate.h"
 #include "e_array.h"
+#include "e_table.h"
 #include "e_function.h"
+#include "e_jit.h"
 
 #ifdef DEBUG
 #	include <stdio.h>
 #endif
 
+#include <time.h>
+#ifdef EEL_VM_SEGHEAP
+#	include <sys/mman.h>
+#endif
+
 #if defined(EEL_PROFILING) || defined(EEL_VM_PROFILING)
 #	include <sys/io.h>
 #	include <sys/time.h>
@@ -54,8 +61,7 @@
 static inline void eel__throw(EEL_vm *vm, EEL_xno x)
 {
         eel_v_disown_nz(&VMP->exception);  /* Free any old object */
-        VMP->exception.classid = EEL_CINTEGER;
-        VMP->exception.integer.v = x;
+        eel_l2v(&VMP->exception, x);
         DBG5B(eel_vmdump(vm, "(DEBUG: Exception %s thrown.)",
 			eel_v_stringrep(vm, &VMP->exception));)
 }
@@ -91,10 +97,7 @@ static void dump_callframe(EEL_vm *vm, EEL_callframe *cf, const char *where)
 	printf("   |     argc = %u\n", cf->argc);
 	printf("   |   result = %d\n", cf->result);
 	printf("   | cleantab = %u\n", cf->cleantab);
-	printf("   | upvalues = %d\n", cf->upvalues);
-	printf("   |    flags = %.8x\n", cf->flags);
-	printf("   | - - - - - - - - - - - - - - - - - - - -\n");
-	printf("   |  catcher = %p\n", cf->catcher);
+	printf("   | upvalues = %d\n", cf->upvalues[0]);
 	printf("   '------------------------------------------\n");
 	printf("      |  base = %u\n", vm->base);
 	printf("      |    pc = %u\n", vm->pc);
@@ -122,37 +125,68 @@ static void check_callframe(EEL_vm *vm, EEL_callframe *cf)
 #endif
 
 
+static inline EEL_callframe *b2callframe(EEL_vm *vm, int base)
+{
+	return (EEL_callframe *)(vm->heap + base - EEL_CFREGS);
+}
+
+
+/*
+ * Get the register frame base of upvalue level 'uvlevel' (1 or higher) of the
+ * current function. The nearest EEL_UV_DISPLAY levels are in the display of
+ * the current call frame. Beyond that, we walk the level 1 links of the
+ * frames further out. Returns -1 if the levels run past the root frame.
+ */
 static inline int get_uv_base(EEL_vm *vm, unsigned uvlevel)
 {
-	int b = vm->base;
-	while(uvlevel--)
-	{
-		EEL_callframe *ucf;
+	EEL_callframe *cf = b2callframe(vm, vm->base);
+	int b;
 #ifdef EEL_VM_CHECKING
-		if(!b)
-		{
-			printf("get_base(): Tried to get callframe of initial "
-					"state!\n");
-			return -1;
-		}
+	if(!uvlevel)
+	{
+		printf("get_uv_base(): Called for level 0!\n");
+		return vm->base;
+	}
 #endif
-		ucf = (EEL_callframe *)(vm->heap + b - EEL_CFREGS);
-		b = ucf->upvalues;
-#ifdef EEL_VM_CHECKING
-		if(b < 0)
-		{
-			printf("get_base(): uvlevel exhausted the call stack!\n");
+	if(uvlevel <= EEL_UV_DISPLAY)
+		return cf->upvalues[uvlevel - 1];
+	b = cf->upvalues[EEL_UV_DISPLAY - 1];
+	uvlevel -= EEL_UV_DISPLAY;
+	while(uvlevel--)
+	{
+		if(b <= 0)
 			return -1;
-		}
-#endif
+		b = b2callframe(vm, b)->upvalues[0];
 	}
 	return b;
 }
 
 
-static inline EEL_callframe *b2callframe(EEL_vm *vm, int base)
+/*
+ * Set up the upvalue display of 'cf', with 'b' as the level 1 frame. The
+ * outer levels are the nearest levels of that frame.
+ */
+static inline void set_uv_display(EEL_vm *vm, EEL_callframe *cf, int b)
 {
-	return (EEL_callframe *)(vm->heap + base - EEL_CFREGS);
+	cf->upvalues[0] = b;
+	if(b > 0)
+		memcpy(cf->upvalues + 1, b2callframe(vm, b)->upvalues,
+				(EEL_UV_DISPLAY - 1) * sizeof(EEL_int32));
+	else
+	{
+		int i;
+		for(i = 1; i < EEL_UV_DISPLAY; ++i)
+			cf->upvalues[i] = -1;
+	}
+}
+
+
+/* Set the heap size, and keep track of the peak size */
+static inline void heap_resized(EEL_vm *vm, int size)
+{
+	vm->heapsize = size;
+	if(size > VMP->heappeak)
+		VMP->heappeak = size;
 }
 
 
@@ -180,6 +214,148 @@ static void relocate_limbo(EEL_vm *vm, EEL_uint32 frame, EEL_value *oldheap)
 }
 
 
+/*
+ * VMs opened with eel_open_pool() keep their heaps in the pool, so that
+ * growing a heap makes no system calls. Heaps start at EEL_THREADHEAPSEGMENT
+ * values, and double in size as needed.
+ * Returns 1 if the heap was moved to a different address,
+ * 0 if it's at the same address, or -1 in case of failure.
+ */
+static int pool_set_heap(EEL_vm *vm, int size)
+{
+	EEL_value *oh = vm->heap;
+	EEL_value *h;
+	int n = vm->heapsize ? vm->heapsize : EEL_THREADHEAPSEGMENT;
+	while(n < size)
+		n <<= 1;
+	if(n <= vm->heapsize)
+		return 0;
+	h = (EEL_value *)eel_realloc(vm, oh, n * sizeof(EEL_value));
+	if(!h)
+		return -1;
+#ifdef EEL_VM_CHECKING
+	if(VMP->weakrefs)
+		fprintf(stderr, "INTERNAL ERROR: %d weakrefs in heap while "
+				"resizing!\n", VMP->weakrefs);
+#endif
+	vm->heap = h;
+	heap_resized(vm, n);
+	if(oh && (vm->heap != oh))
+	{
+		relocate_limbo(vm, vm->base, oh);
+		return 1;
+	}
+	return 0;
+}
+
+
+#ifdef EEL_VM_SEGHEAP
+/*
+ * Reserve address space for 'values' heap values, and commit the first
+ * 'size' of them. Returns NULL on failure.
+ */
+static EEL_value *map_heap(int values, int size)
+{
+	EEL_value *h = (EEL_value *)mmap(NULL, values * sizeof(EEL_value),
+			PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+			-1, 0);
+	if(h == MAP_FAILED)
+		return NULL;
+	if(mprotect(h, size * sizeof(EEL_value), PROT_READ | PROT_WRITE) < 0)
+	{
+		munmap(h, values * sizeof(EEL_value));
+		return NULL;
+	}
+	return h;
+}
+
+
+/*
+ * Make the heap at least 'size' value elements, rounded up to a whole number
+ * of segments. The heap is only moved if the reservation is too small.
+ * Returns 1 if the heap was moved to a different address,
+ * 0 if it's at the same address, or -1 in case of failure.
+ *
+ * If there is no heap, a new one is created, with a reservation of
+ * VMP->heapreserve values, or EEL_HEAPRESERVE if that is 0.
+ */
+static int set_heap(EEL_vm *vm, int size)
+{
+	EEL_value *oh = vm->heap;
+	int reserve = VMP->heapreserve;
+	int segment = EEL_HEAPSEGMENT;
+	if(VMP->state->pool)
+		return pool_set_heap(vm, size);
+	if(reserve && (reserve < EEL_HEAPRESERVE))
+		segment = EEL_THREADHEAPSEGMENT;
+	size = (size + segment - 1) / segment * segment;
+	if(size <= vm->heapsize)
+		return 0;
+	if(oh && (size <= reserve))
+	{
+		/* Commit more segments in place */
+		if(mprotect(vm->heap + vm->heapsize,
+				(size - vm->heapsize) * sizeof(EEL_value),
+				PROT_READ | PROT_WRITE) < 0)
+			return -1;
+		heap_resized(vm, size);
+		return 0;
+	}
+
+	/* Out of address space! Move to a bigger reservation. */
+	if(!reserve)
+		reserve = EEL_HEAPRESERVE;
+	while(reserve < size)
+		reserve <<= 1;
+	vm->heap = map_heap(reserve, size);
+	if(!vm->heap)
+	{
+		vm->heap = oh;
+		return -1;
+	}
+	if(!oh)
+	{
+		heap_resized(vm, size);
+		VMP->heapreserve = reserve;
+		return 0;
+	}
+#ifdef EEL_VM_CHECKING
+	if(VMP->weakrefs)
+		fprintf(stderr, "INTERNAL ERROR: %d weakrefs in heap while "
+				"resizing!\n", VMP->weakrefs);
+#endif
+	memcpy(vm->heap, oh, vm->heapsize * sizeof(EEL_value));
+	munmap(oh, VMP->heapreserve * sizeof(EEL_value));
+	heap_resized(vm, size);
+	VMP->heapreserve = reserve;
+	relocate_limbo(vm, vm->base, oh);
+	return 1;
+}
+
+
+static void free_heap(EEL_vm *vm)
+{
+	if(vm->heap && VMP->state->pool)
+		eel_free(vm, vm->heap);
+	else if(vm->heap)
+		munmap(vm->heap, VMP->heapreserve * sizeof(EEL_value));
+	vm->heap = NULL;
+	vm->heapsize = VMP->heapreserve = 0;
+}
+
+
+/*
+ * Ensure that the heap is at least 'minsize' value elements.
+ * Returns 1 if the heap was moved to a different address,
+ * 0 if it's at the same address, or -1 in case of failure.
+ */
+static inline int grow_heap(EEL_vm *vm, int minsize)
+{
+	if(minsize <= vm->heapsize)
+		return 0;
+	return set_heap(vm, minsize);
+}
+#else /* EEL_VM_SEGHEAP */
 /*
  * Realocate heap to 'size' value elements.
  * Returns 1 if the heap was moved to a different address,
@@ -188,7 +364,10 @@ static void relocate_limbo(EEL_vm *vm, EEL_uint32 frame, EEL_value *oldheap)
 static int set_heap(EEL_vm *vm, int size)
 {
 	EEL_value *oh = vm->heap;
-	EEL_value *h = (EEL_value *)realloc(vm->heap, size * sizeof(EEL_value));
+	EEL_value *h;
+	if(VMP->state->pool)
+		return pool_set_heap(vm, size);
+	h = (EEL_value *)realloc(vm->heap, size * sizeof(EEL_value));
 	if(!h)
 		return -1;
 #ifdef EEL_VM_CHECKING
@@ -197,7 +376,7 @@ static int set_heap(EEL_vm *vm, int size)
 				"resizing!\n", VMP->weakrefs);
 #endif
 	vm->heap = h;
-	vm->heapsize = size;
+	heap_resized(vm, size);
 	if(oh && (vm->heap != oh))
 	{
 		relocate_limbo(vm, vm->base, oh);
@@ -242,6 +421,18 @@ static inline int grow_heap(EEL_vm *vm, int minsize)
 }
 
 
+static void free_heap(EEL_vm *vm)
+{
+	if(vm->heap && VMP->state->pool)
+		eel_free(vm, vm->heap);
+	else
+		free(vm->heap);
+	vm->heap = NULL;
+	vm->heapsize = 0;
+}
+#endif /* EEL_VM_SEGHEAP */
+
+
 /* Remove all argument stack items */
 static inline void stack_clear(EEL_vm *vm)
 {
@@ -261,6 +452,68 @@ static inline void stack_clear(EEL_vm *vm)
 }
 
 
+/*
+ * Push 'count' items of the indexable object 'v', starting at item 'first',
+ * onto the argument stack. A negative 'count' means all items from 'first' to
+ * the end. Items of arrays are copied straight from the array storage; other
+ * objects are read item by item through their GETINDEX metamethod.
+ *
+ * NOTE:
+ *	May reallocate the heap!
+ */
+static EEL_xno push_items(EEL_vm *vm, EEL_value *v, int first, int count)
+{
+	EEL_object *o;
+	EEL_value len, ind, item;
+	EEL_xno x;
+	int i, length;
+	if(!EEL_IS_OBJREF(EEL_VCLASS(v)))
+		return EEL_XCANTINDEX;
+	o = eel_v2o(v);
+	if(o->classid == EEL_CARRAY)
+		length = o2EEL_array(o)->length;
+	else
+	{
+		if((x = eel_o__metamethod(o, EEL_MM_LENGTH, NULL, &len)))
+			return x;
+		if(EEL_VCLASS(&len) != EEL_CINTEGER)
+		{
+			eel_v_disown_nz(&len);
+			return EEL_XWRONGTYPE;
+		}
+		length = EEL_VINT(&len);
+	}
+	if(first < 0)
+		return EEL_XLOWINDEX;
+	if(first > length)
+		return EEL_XHIGHINDEX;
+	if(count < 0)
+		count = length - first;
+	if(count > length - first)
+		return EEL_XHIGHINDEX;
+	if(grow_heap(vm, vm->sp + count) < 0)
+		return EEL_XMEMORY;
+	if(o->classid == EEL_CARRAY)
+	{
+		EEL_value *src = o2EEL_array(o)->values + first;
+		EEL_value *dst = vm->heap + vm->sp;
+		for(i = 0; i < count; ++i)
+			eel_v_copy(dst + i, src + i);
+		vm->sp += count;
+		return 0;
+	}
+	for(i = 0; i < count; ++i)
+	{
+		/* (The metamethod may run code that moves the heap!) */
+		eel_l2v(&ind, first + i);
+		if((x = eel_o__metamethod(o, EEL_MM_GETINDEX, &ind, &item)))
+			return x;
+		vm->heap[vm->sp++] = item;
+	}
+	return 0;
+}
+
+
 /* Release objects owned by local variables */
 static inline void clean(EEL_vm *vm, unsigned char *ctab, int downto)
 {
@@ -310,20 +563,18 @@ static inline void limbo_clean(EEL_vm *vm, EEL_callframe *cf)
 
 static inline EEL_xno get_function(EEL_vm *vm, EEL_value *ref, EEL_object **o)
 {
-	if(!EEL_IS_OBJREF(ref->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(ref)))
 		return EEL_XNEEDOBJECT;
-	*o = ref->objref.v;
+	*o = eel_v2o(ref);
 	if((*o)->classid != EEL_CFUNCTION)
 		return EEL_XNEEDCALLABLE;
 	return 0;
 }
 
 
-static inline EEL_xno check_args(EEL_vm *vm, EEL_object *fo)
+static inline EEL_xno check_argc(EEL_object *fo, int argc)
 {
 	EEL_function *f = o2EEL_function(fo);
-	int argc = vm->sp - vm->sbase;
-	/* Check argument count */
 	if(argc < f->common.reqargs)
 		return EEL_XFEWARGS;
 	if(f->common.tupargs)
@@ -339,6 +590,13 @@ static inline EEL_xno check_args(EEL_vm *vm, EEL_object *fo)
 }
 
 
+/* Check the argument count of the argument stack against 'fo' */
+static inline EEL_xno check_args(EEL_vm *vm, EEL_object *fo)
+{
+	return check_argc(fo, vm->sp - vm->sbase);
+}
+
+
 #if defined(EEL_PROFILING) || defined(EEL_VM_PROFILING)
 #if 0
 inline unsigned long long int rdtsc(void)
@@ -413,6 +671,12 @@ static inline void vmprofile_in(EEL_vm *vm, EEL_opcodes opcode)
 {
 	if(VMP->vmp_opcode != EEL_OILLEGAL_0)
 		vmprofile_out(vm);
+	if(opcode <= EEL_O_LAST)
+	{
+		/* Opcode pair statistics, for picking superinstructions */
+		++VMP->vmpairs[VMP->vmp_prev][opcode];
+		VMP->vmp_prev = opcode;
+	}
 	VMP->vmp_opcode = opcode;
 	VMP->vmp_time = getns();
 }
@@ -452,8 +716,7 @@ static inline EEL_xno push_frame(EEL_vm *vm, unsigned cleansize, unsigned frames
 		int i;
 		for(i = 0; i < framesize; ++i)
 		{
-			vm->heap[base + i].classid = EEL_CILLEGAL;
-			vm->heap[base + i].integer.v = 1002;
+			eel_i2v(&vm->heap[base + i], EEL_CILLEGAL, 1002);
 		}
 	}
 #endif
@@ -477,7 +740,7 @@ static inline EEL_xno push_frame(EEL_vm *vm, unsigned cleansize, unsigned frames
 	((unsigned char *)(vm->heap + ctab))[0] = 0;
 
 	/* Upvalues, level 0 (will be corrected by call_eel() if needed) */
-	ncf->upvalues = vm->base;
+	set_uv_display(vm, ncf, vm->base);
 	
 	/* Point VM at the callie! */
 	vm->base = base;
@@ -495,12 +758,193 @@ printf("==================================\n");
 }
 
 
+#ifdef EEL_VM_PREDECODE
+/*
+ * Build the pre-decoded version of the code of EEL function 'f'.
+ *
+ * NOTE:
+ *	There is one extra ILLEGAL entry at the end, to catch code that runs
+ *	off the end of the function.
+ */
+static EEL_xno predecode(EEL_vm *vm, EEL_function *f)
+{
+	int pc;
+	const void * const *itab = VMP->itab;
+	EEL_dinstruction *dc = (EEL_dinstruction *)eel_malloc(vm,
+			(f->e.codesize + 1) * sizeof(EEL_dinstruction));
+	if(!dc)
+		return EEL_XMEMORY;
+	memset(dc, 0, (f->e.codesize + 1) * sizeof(EEL_dinstruction));
+	for(pc = 0; pc <= f->e.codesize; ++pc)
+		dc[pc].op = itab[EEL_OILLEGAL_0];
+	pc = 0;
+	while(pc < f->e.codesize)
+	{
+		unsigned char *ins = f->e.code + pc;
+		EEL_dinstruction *di = dc + pc;
+		if(ins[0] <= EEL_O_LAST)
+			di->op = itab[ins[0]];
+		switch(eel_i_operands(ins[0]))
+		{
+		  case EEL_OL_ILLEGAL:
+		  case EEL_OL_0:
+			break;
+		  case EEL_OL_A:
+			di->a = EEL_O8(ins, 1);
+			break;
+		  case EEL_OL_Ax:
+		  case EEL_OL_sAx:
+			di->a = EEL_O16(ins, 1);
+			break;
+		  case EEL_OL_AB:
+			di->a = EEL_O8(ins, 1);
+			di->b = EEL_O8(ins, 2);
+			break;
+		  case EEL_OL_ABC:
+			di->a = EEL_O8(ins, 1);
+			di->b = EEL_O8(ins, 2);
+			di->c = EEL_O8(ins, 3);
+			break;
+		  case EEL_OL_ABCD:
+			di->a = EEL_O8(ins, 1);
+			di->b = EEL_O8(ins, 2);
+			di->c = EEL_O8(ins, 3);
+			di->d = EEL_O8(ins, 4);
+			break;
+		  case EEL_OL_ABx:
+		  case EEL_OL_AsBx:
+			di->a = EEL_O8(ins, 1);
+			di->b = EEL_O16(ins, 2);
+			break;
+		  case EEL_OL_AxBx:
+		  case EEL_OL_AxsBx:
+			di->a = EEL_O16(ins, 1);
+			di->b = EEL_O16(ins, 3);
+			break;
+		  case EEL_OL_ABCx:
+		  case EEL_OL_ABsCx:
+			di->a = EEL_O8(ins, 1);
+			di->b = EEL_O8(ins, 2);
+			di->c = EEL_O16(ins, 3);
+			break;
+		  case EEL_OL_ABxCx:
+		  case EEL_OL_ABxsCx:
+			di->a = EEL_O8(ins, 1);
+			di->b = EEL_O16(ins, 2);
+			di->c = EEL_O16(ins, 4);
+			break;
+		  case EEL_OL_ABCDx:
+		  case EEL_OL_ABCsDx:
+			di->a = EEL_O8(ins, 1);
+			di->b = EEL_O8(ins, 2);
+			di->c = EEL_O8(ins, 3);
+			di->d = EEL_O16(ins, 4);
+			break;
+		}
+		pc += eel_i_size(ins[0]);
+	}
+	f->e.dcode = dc;
+	return 0;
+}
+#endif
+
+
+#ifdef EEL_VM_JIT
+/*
+ * Called when 'f' has been called or looped EEL_JIT_THRESHOLD times. If
+ * compiling fails, we just keep interpreting 'f'.
+ */
+static void jit_hot(EEL_vm *vm, EEL_function *f)
+{
+	if(f->common.flags & EEL_FF_NOJIT)
+		return;
+	if(!VMP->jit)
+	{
+		f->e.jithot = 0;	/* Start over, in case it's enabled */
+		return;
+	}
+	eel_jit_compile(vm, f);
+}
+#endif
+
+
+/*----------------------------------------------------------
+	Time slicing (eel_run_slice())
+----------------------------------------------------------*/
+
+/* Slice count when not slicing; checks the state every 2^31 ticks */
+#define	EEL_SLICE_NONE	0x7fffffff
+
+/* Monotonic time in ns, for time slice deadlines */
+static inline long long slice_now(void)
+{
+#ifdef CLOCK_MONOTONIC
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_nsec + (long long)ts.tv_sec * 1000000000LL;
+#else
+	return (long long)clock() * (1000000000LL / CLOCKS_PER_SEC);
+#endif
+}
+
+/* Can the VM switch to another microthread right now? */
+static inline int thread_can_switch(EEL_vm *vm)
+{
+	return (VMP->thread->next != VMP->thread) && (VMP->calldepth <= 1);
+}
+
+/*
+ * Recharge the time slice, if there is anything left of it.
+ * Returns EEL_XCOUNTER if the eel_run_slice() slice is used up, EEL_XYIELD if
+ * it's time to switch to the next microthread, otherwise 0.
+ */
+static EEL_xno slice_refill(EEL_vm *vm)
+{
+	EEL_xno x = 0;
+	int chunk = EEL_SLICE_NONE;
+	if(VMP->slicing)
+	{
+		if(VMP->slicedeadline && (slice_now() >= VMP->slicedeadline))
+			return EEL_XCOUNTER;
+		if(!VMP->sliceticks)
+			return EEL_XCOUNTER;
+		chunk = EEL_SLICE_POLL;
+		if((VMP->sliceticks > 0) && (chunk > VMP->sliceticks))
+			chunk = VMP->sliceticks;
+	}
+	if(thread_can_switch(vm))
+	{
+		x = EEL_XYIELD;		/* Next thread's turn! */
+		if(chunk > EEL_THREAD_QUANTUM)
+			chunk = EEL_THREAD_QUANTUM;
+	}
+	if(VMP->slicing && (VMP->sliceticks > 0))
+		VMP->sliceticks -= chunk;
+	VMP->slice = chunk;
+	return x;
+}
+
+
 /* Call an EEL function */
 static inline EEL_xno call_eel(EEL_vm *vm, EEL_object *fo, int result, int levels)
 {
 	EEL_callframe *cf;
 	EEL_function *f = o2EEL_function(fo);
-	EEL_xno x = push_frame(vm, f->e.cleansize, f->e.framesize);
+	EEL_xno x;
+#ifdef EEL_VM_PREDECODE
+	if(!f->e.dcode)
+	{
+		x = predecode(vm, f);
+		if(x)
+			return x;
+	}
+#endif
+#ifdef EEL_VM_JIT
+	if((f->e.jithot < EEL_JIT_THRESHOLD) &&
+			(++f->e.jithot == EEL_JIT_THRESHOLD))
+		jit_hot(vm, f);
+#endif
+	x = push_frame(vm, f->e.cleansize, f->e.framesize);
 	if(x)
 		return x;
 
@@ -514,8 +958,7 @@ static inline EEL_xno call_eel(EEL_vm *vm, EEL_object *fo, int result, int level
 #ifdef EEL_VM_CHECKING
 		if(cf->result >= 0)
 		{
-			vm->heap[cf->result].classid = EEL_CILLEGAL;
-			vm->heap[cf->result].integer.v = 1003;
+			eel_i2v(&vm->heap[cf->result], EEL_CILLEGAL, 1003);
 		}
 #endif
 	}
@@ -525,8 +968,9 @@ static inline EEL_xno call_eel(EEL_vm *vm, EEL_object *fo, int result, int level
 	/* Prepare upvalue access info */
 	if(levels)
 	{
-		cf->upvalues = get_uv_base(vm, levels + 1);
-		if(cf->upvalues < 0)
+		int b = get_uv_base(vm, levels + 1);
+		set_uv_display(vm, cf, b);
+		if(b < 0)
 		{
 			vm->base = cf->r_base;
 			vm->sp = cf->r_sp;
@@ -535,9 +979,7 @@ static inline EEL_xno call_eel(EEL_vm *vm, EEL_object *fo, int result, int level
 		}
 	}
 
-	cf->flags = 0;
 	cf->f = fo;
-	cf->catcher = NULL;
 	vm->pc = 0;
 
 	DBG4B(printf(".--- ");)
@@ -556,8 +998,14 @@ static inline EEL_xno call_eel(EEL_vm *vm, EEL_object *fo, int result, int level
 }
 
 
-/* Call a C function */
-static inline EEL_xno call_c(EEL_vm *vm, EEL_object *fo, int result, int levels)
+/*
+ * Call a C function. If 'argv' is not negative, the 'argc' arguments are taken
+ * from that position in the heap (normally a register window in the frame of
+ * the caller) instead of from the argument stack. The caller keeps ownership
+ * of window arguments, so nothing is copied or cleaned up.
+ */
+static inline EEL_xno call_c(EEL_vm *vm, EEL_object *fo, int result, int levels,
+		int argv, int argc)
 {
 	EEL_callframe *cf;
 	EEL_function *f = o2EEL_function(fo);
@@ -568,7 +1016,7 @@ static inline EEL_xno call_c(EEL_vm *vm, EEL_object *fo, int result, int levels)
 
 	cf = b2callframe(vm, vm->base);
 	DBG4E(cf->magic = EEL_CALLFRAME_MAGIC_C;)
-	vm->heap[vm->base].classid = EEL_CNIL;
+	eel_nil2v(&vm->heap[vm->base]);
 
 	/*
 	 * Grab result ref
@@ -587,15 +1035,17 @@ static inline EEL_xno call_c(EEL_vm *vm, EEL_object *fo, int result, int levels)
 	else
 		cf->result = vm->base;
 #ifdef EEL_VM_CHECKING
-	vm->heap[cf->result].classid = EEL_CILLEGAL;
-	vm->heap[cf->result].integer.v = 1006;
+	eel_i2v(&vm->heap[cf->result], EEL_CILLEGAL, 1006);
 #endif
 
-	cf->flags = 0;
 	cf->f = fo;
-	cf->catcher = NULL;
 
 	/* Prepare arguments */
+	if(argv >= 0)
+	{
+		cf->argv = argv;
+		cf->argc = argc;
+	}
 /*FIXME: Kill these VM fields and pass them as arguments instead... */
 	vm->resv = cf->result;
 	vm->argv = cf->argv;
@@ -639,11 +1089,11 @@ static inline EEL_xno call_c(EEL_vm *vm, EEL_object *fo, int result, int levels)
 	if(f->common.flags & EEL_FF_RESULTS)
 	{
 #ifdef EEL_VM_CHECKING
-		if(vm->heap[cf->result].classid == EEL_CILLEGAL)
+		if(EEL_VCLASS(&vm->heap[cf->result]) == EEL_CILLEGAL)
 		{
 			eel_vmdump(vm, "C function forgot to return a result! "
 					"(Value source: %d)",
-					vm->heap[cf->result].integer.v);
+					EEL_VINT(&vm->heap[cf->result]));
 			return EEL_XVMCHECK;
 		}
 #endif
@@ -658,68 +1108,172 @@ static inline EEL_xno call_c(EEL_vm *vm, EEL_object *fo, int result, int levels)
 }
 
 
-static inline EEL_xno call_f(EEL_vm *vm, EEL_object *fo, int result, int levels)
+/*
+ * Call leaf C function 'f' directly, without a call frame. The arguments are
+ * read in place, from heap position 'argv', or from the argument stack if
+ * 'argv' is negative. The result goes straight into heap['result'], or into a
+ * dummy, if 'result' is negative.
+ */
+static inline EEL_xno call_leaf(EEL_vm *vm, EEL_function *f, int result,
+		int argv)
+{
+	EEL_xno x;
+	EEL_value dummy;
+	EEL_value *res = result >= 0 ? vm->heap + result : &dummy;
+	DBG4D(printf("Calling leaf C function '%s'\n",
+			eel_o2s(f->common.name));)
+	if(argv >= 0)
+		x = f->c.leaf(vm->heap + argv, res);
+	else
+	{
+		x = f->c.leaf(vm->heap + vm->sbase, res);
+		stack_clear(vm);
+	}
+#ifdef EEL_VM_CHECKING
+	if(!x && EEL_IS_OBJREF(EEL_VCLASS(res)))
+	{
+		eel_vmdump(vm, "Leaf C function '%s' returned an object!",
+				eel_o2s(f->common.name));
+		return EEL_XVMCHECK;
+	}
+#endif
+	return x;
+}
+
+
+/*
+ * Call function 'fo' with the 'argc' arguments at heap position 'argv', or with
+ * the argument stack if 'argv' is negative. C functions read window arguments
+ * in place, whereas EEL functions get copies on the argument stack, as they are
+ * allowed to modify their arguments.
+ */
+static inline EEL_xno call_fw(EEL_vm *vm, EEL_object *fo, int result, int levels,
+		int argv, int argc)
 {
 	EEL_function *f = o2EEL_function(fo);
 	if((result >= 0) && !(f->common.flags & EEL_FF_RESULTS))
 		return EEL_XNORESULT;
+	if(f->common.flags & EEL_FF_LEAF)
+		return call_leaf(vm, f, result, argv);
 	if(f->common.flags & EEL_FF_CFUNC)
 #ifdef EEL_VM_PROFILING
 	{
 		/* Subtract the C function execution time */
 		EEL_xno res;
 		long long t2, t1 = getns();
-		res = call_c(vm, fo, result, levels);
+		res = call_c(vm, fo, result, levels, argv, argc);
 		t2 = getns();
 		VMP->vmp_time += t2 - t1 - VMP->vmp_overhead;
 		return res;
 	}
 #else
-		return call_c(vm, fo, result, levels);
+		return call_c(vm, fo, result, levels, argv, argc);
 #endif
-	else
-		return call_eel(vm, fo, result, levels);
+	if(argv >= 0)
+	{
+		int i;
+		if(grow_heap(vm, vm->sp + argc + EEL_MINSTACK) < 0)
+			return EEL_XMEMORY;
+		for(i = 0; i < argc; ++i)
+			eel_v_copy(vm->heap + vm->sp + i, vm->heap + argv + i);
+		vm->sp += argc;
+	}
+	return call_eel(vm, fo, result, levels);
 }
 
 
-static int call_catcher(EEL_vm *vm, EEL_object *catcher)
+static inline EEL_xno call_f(EEL_vm *vm, EEL_object *fo, int result, int levels)
+{
+	return call_fw(vm, fo, result, levels, -1, 0);
+}
+
+
+/*
+ * Returns 1 if a call to 'fo' can be done as a tail call, replacing the frame
+ * of the current function. C functions are left to call_f(), as
+ * they don't leave any frames around anyway, and functions that use upvalues
+ * may need the frame we would be replacing. Functions with no results are
+ * also left to call_f(), so it can throw EEL_XNORESULT.
+ */
+static inline int can_tail_call(EEL_object *fo)
+{
+	EEL_function *f = o2EEL_function(fo);
+	if(f->common.flags & (EEL_FF_CFUNC | EEL_FF_UPVALUES))
+		return 0;
+	return (f->common.flags & EEL_FF_RESULTS) != 0;
+}
+
+
+/*
+ * Call EEL function 'fo' from the current EEL function, reusing the register
+ * frame of the current function. We leave the current function the way
+ * RETURN does, except the arguments on the argument stack are moved down to
+ * replace the arguments of the current function, and the new function gets
+ * the result index and return info of the current function. Recursion
+ * through tail calls thus runs in constant heap space.
+ *
+ * NOTE:
+ *	Check can_tail_call() first!
+ */
+static inline EEL_xno tail_call(EEL_vm *vm, EEL_object *fo)
 {
+	EEL_callframe *cf;
+	EEL_function *f = o2EEL_function(fo);
+	int argc = vm->sp - vm->sbase;
+	int i, result;
 	EEL_xno x;
-	EEL_value *R;
-	EEL_callframe *cf = b2callframe(vm, vm->base);
-#ifdef EEL_VM_CHECKING
-	if(EEL_OTRY_AxBx != o2EEL_function(cf->f)->e.code[vm->pc -
-			eel_i_size(EEL_OTRY_AxBx)])
+#ifdef EEL_VM_PREDECODE
+	if(!f->e.dcode)
 	{
-		eel_vmdump(vm, "Trying to call catcher by other means than TRY!");
-		return EEL_XVMCHECK;
+		x = predecode(vm, f);
+		if(x)
+			return x;
 	}
 #endif
-/*
-TODO: Fast shortcut instead of dummy/empty catchers!
-*/
 	/*
-	 * This is basically an ordinary function call, except
-	 * we let the catcher inherit the result index, and we...
+	 * Make sure push_frame() cannot fail once our frame is gone. (The new
+	 * frame ends up below the current argument stack top.)
 	 */
-	x = call_eel(vm, catcher, cf->result, 0);
-	if(x)
-		return x;
+	if(grow_heap(vm, vm->sp + (f->e.cleansize + sizeof(EEL_value)) /
+			sizeof(EEL_value) + EEL_CFREGS + f->e.framesize +
+			EEL_MINSTACK) < 0)
+		return EEL_XMEMORY;
+
+	/* The register or argument we got 'fo' from is about to go away! */
+	eel_o_own(fo);
+
 	/*
-	 * ...poke the exception value into R[0], and set EEL_CFF_CATCHER.
-	 * If the exception value is an object, it's ownership is hereby
-	 * transferred from VMP->exception to the catcher.
+	 * Leave the current function. (Grab what we need from the call frame
+	 * first, as the moved arguments may overwrite it!)
 	 */
-	R = vm->heap + vm->base;
-	eel_v_move(&R[0], &VMP->exception);
-	VMP->exception.classid = EEL_CNIL;
-	((EEL_callframe *)(R - EEL_CFREGS))->flags |= EEL_CFF_CATCHER;
-/*printf("### call_catcher(); exception: %s\tresult: %d\n",
-		eel_v_stringrep(vm, &R[0]), cf->result);
-*/
-	return 0;
+	cf = b2callframe(vm, vm->base);
+	result = cf->result;
+	clean(vm, (unsigned char *)(vm->heap + cf->cleantab), 0);
+	limbo_clean(vm, cf);
+	for(i = cf->r_sbase; i < cf->r_sp; ++i)
+		eel_v_disown_nz(vm->heap + i);
+	vm->base = cf->r_base;
+	vm->pc = cf->r_pc;
+	i = vm->sbase;
+	vm->sbase = cf->r_sbase;
+	memmove(vm->heap + vm->sbase, vm->heap + i, argc * sizeof(EEL_value));
+	vm->sp = vm->sbase + argc;
+
+	/* ...and enter the new one in its place */
+	x = call_eel(vm, fo, result, 0);
+	if(x)
+	{
+		eel_o_disown_nz(fo);
+		return x;
+	}
+	if(eel_in_limbo(fo))
+		eel_o_disown_nz(fo);	/* Held by a caller further down */
+	else
+		eel_limbo_push(&b2callframe(vm, vm->base)->limbo, fo);
+	return x;
 }
 
+
 /* Unwind the call stack until we're at call frame 'target'. */
 static void unwind(EEL_vm *vm, int target)
 {
@@ -753,14 +1307,344 @@ static void unwind(EEL_vm *vm, int target)
 }
 
 
+/*
+ * Find the innermost exception handling region of EEL function 'f' that
+ * covers the instruction ending at 'pc'. (The VM has already moved past the
+ * instruction that threw, or the call that is being unwound, when we get
+ * here.) Returns NULL if there is none.
+ */
+static inline EEL_xregion *find_xregion(EEL_function *f, int pc)
+{
+	int i;
+	for(i = 0; i < f->e.nxregions; ++i)
+	{
+		EEL_xregion *xr = &f->e.xregions[i];
+		if((pc > xr->start) && (pc <= xr->end))
+			return xr;
+	}
+	return NULL;
+}
+
+
+/*
+ * Unwind to the frame at 'base', and continue at the handler of region 'xr',
+ * with the exception value in R[xr->xreg]. The exception value is added to
+ * the cleaning table, the same way INIT does it.
+ */
+static void catch_exception(EEL_vm *vm, int base, EEL_xregion *xr)
+{
+	EEL_callframe *cf;
+	unsigned char *ctab;
+	unwind(vm, base);
+	stack_clear(vm);
+	cf = b2callframe(vm, base);
+	clean(vm, (unsigned char *)(vm->heap + cf->cleantab), xr->clean);
+	if(xr->xreg >= 0)
+	{
+		/* (Destructors may have moved the heap!) */
+		cf = b2callframe(vm, base);
+		ctab = (unsigned char *)(vm->heap + cf->cleantab);
+		eel_v_move(vm->heap + base + xr->xreg, &VMP->exception);
+		ctab[++ctab[0]] = xr->xreg;
+	}
+	else
+		eel_v_disown_nz(&VMP->exception);
+	eel_nil2v(&VMP->exception);
+	vm->pc = xr->handler;
+}
+
+
+/*----------------------------------------------------------
+	Microthreads
+----------------------------------------------------------*/
+
+/*
+ * Save and restore the heap and VM registers. Generators use these as well,
+ * so thread_load() leaves VMP->thread alone.
+ */
+static void thread_save(EEL_vm *vm, EEL_vmthread *t)
+{
+	t->heapsize = vm->heapsize;
+	t->heap = vm->heap;
+#ifdef EEL_VM_SEGHEAP
+	t->heapreserve = VMP->heapreserve;
+#endif
+	t->pc = vm->pc;
+	t->base = vm->base;
+	t->sp = vm->sp;
+	t->sbase = vm->sbase;
+	t->resv = vm->resv;
+	t->argv = vm->argv;
+	t->argc = vm->argc;
+}
+
+
+static void thread_load(EEL_vm *vm, EEL_vmthread *t)
+{
+	vm->heapsize = t->heapsize;
+	vm->heap = t->heap;
+#ifdef EEL_VM_SEGHEAP
+	VMP->heapreserve = t->heapreserve;
+#endif
+	vm->pc = t->pc;
+	vm->base = t->base;
+	vm->sp = t->sp;
+	vm->sbase = t->sbase;
+	vm->resv = t->resv;
+	vm->argv = t->argv;
+	vm->argc = t->argc;
+}
+
+
+/* Switch to the next thread in the ring */
+static void thread_next(EEL_vm *vm)
+{
+	thread_save(vm, VMP->thread);
+	VMP->thread = VMP->thread->next;
+	thread_load(vm, VMP->thread);
+}
+
+
+/*
+ * Kill the running thread, which must not be the main thread, and switch to
+ * the next thread.
+ */
+static void thread_end(EEL_vm *vm)
+{
+	EEL_vmthread *t = VMP->thread;
+	unwind(vm, 0);
+	stack_clear(vm);
+	free_heap(vm);
+	eel_o_disown_nz(t->f);
+	t->prev->next = t->next;
+	t->next->prev = t->prev;
+	VMP->thread = t->next;
+	thread_load(vm, VMP->thread);
+	eel_free(vm, t);
+}
+
+
+/* Kill all threads but the main thread */
+static void thread_end_all(EEL_vm *vm)
+{
+	EEL_vmthread *mt = &VMP->mainthread;
+	while(mt->next != mt)
+	{
+		if(VMP->thread == mt)
+			thread_next(vm);
+		thread_end(vm);
+	}
+}
+
+
+/*
+ * Set up 't' with a new heap, holding a call to EEL function 'f' with the
+ * 'argc' arguments at 'args', ready to run from the first instruction. The
+ * running thread is left as it was.
+ */
+static EEL_xno thread_init(EEL_vm *vm, EEL_vmthread *t, EEL_object *f,
+		EEL_value *args, int argc)
+{
+	EEL_vmthread cur;
+	EEL_xno x;
+	int i;
+	if(f->classid != EEL_CFUNCTION)
+		return EEL_XNEEDCALLABLE;
+	if(o2EEL_function(f)->common.flags & EEL_FF_CFUNC)
+		return EEL_XWRONGTYPE;
+	if(o2EEL_function(f)->common.flags & EEL_FF_UPVALUES)
+		return EEL_XUPVALUE;	/* Nothing below us to look at! */
+
+	/* New heap, with a root frame as set up by vm_init() */
+	thread_save(vm, &cur);
+	vm->heap = NULL;
+	vm->heapsize = 0;
+#ifdef EEL_VM_SEGHEAP
+	VMP->heapreserve = EEL_THREADHEAPRESERVE;
+#endif
+	if(set_heap(vm, EEL_INITHEAP + argc) < 0)
+	{
+		thread_load(vm, &cur);
+		return EEL_XMEMORY;
+	}
+	vm->pc = vm->base = 0;
+	vm->sbase = vm->sp = 1;
+	vm->resv = vm->argv = vm->argc = 0;
+	eel_nil2v(&vm->heap[vm->base]);
+
+	/* Enter the function. It starts running when the thread does. */
+	for(i = 0; i < argc; ++i)
+		eel_v_copy(vm->heap + vm->sp++, args + i);
+	x = check_args(vm, f);
+	if(!x)
+		x = call_eel(vm, f, -1, 0);
+	if(x)
+	{
+		stack_clear(vm);
+		free_heap(vm);
+		thread_load(vm, &cur);
+		return x;
+	}
+	thread_save(vm, t);
+	thread_load(vm, &cur);
+	t->f = f;
+	eel_o_own(f);
+	return 0;
+}
+
+
+EEL_xno eel__spawn(EEL_vm *vm, EEL_object *f, EEL_value *args, int argc,
+		int *id)
+{
+	EEL_xno x;
+	EEL_vmthread *t = (EEL_vmthread *)eel_malloc(vm, sizeof(EEL_vmthread));
+	if(!t)
+		return EEL_XMEMORY;
+	x = thread_init(vm, t, f, args, argc);
+	if(x)
+	{
+		eel_free(vm, t);
+		return x;
+	}
+
+	/* Put it last in the ring */
+	t->id = *id = ++VMP->lastthread;
+	t->next = VMP->thread;
+	t->prev = VMP->thread->prev;
+	t->prev->next = t;
+	VMP->thread->prev = t;
+
+	/* Make sure the running thread doesn't hog the VM */
+	if(VMP->slice > EEL_THREAD_QUANTUM)
+		VMP->slice = EEL_THREAD_QUANTUM;
+	return 0;
+}
+
+
+int eel__threads(EEL_vm *vm)
+{
+	int n = 1;
+	EEL_vmthread *t;
+	for(t = VMP->mainthread.next; t != &VMP->mainthread; t = t->next)
+		++n;
+	return n;
+}
+
+
+/*----------------------------------------------------------
+	Generators
+----------------------------------------------------------*/
+
+EEL_xno eel__gen_init(EEL_vm *vm, EEL_generator *g, EEL_object *f,
+		EEL_value *args, int argc)
+{
+	EEL_xno x = thread_init(vm, &g->t, f, args, argc);
+	if(x)
+		return x;
+	g->state = EEL_GS_SUSPENDED;
+	g->result = NULL;
+	g->depth = 0;
+	return 0;
+}
+
+
+EEL_xno eel__gen_resume(EEL_vm *vm, EEL_generator *g, EEL_value *result)
+{
+	EEL_vmthread cur;
+	EEL_generator *pg = VMP->generator;
+	int slicing = VMP->slicing;
+	int slice = VMP->slice;
+	EEL_xno x;
+	switch(g->state)
+	{
+	  case EEL_GS_SUSPENDED:
+		break;
+	  case EEL_GS_RUNNING:
+		return EEL_XBADCONTEXT;
+	  case EEL_GS_DONE:
+		eel_nil2v(result);
+		return 0;
+	}
+
+	/*
+	 * Switch to the generator heap, and run it like a nested call. YIELD
+	 * leaves the VM with EEL_XYIELD, which does not happen otherwise.
+	 */
+	eel_nil2v(result);
+	thread_save(vm, &cur);
+	thread_load(vm, &g->t);
+	g->state = EEL_GS_RUNNING;
+	g->result = result;
+	g->depth = ++VMP->calldepth;
+	VMP->generator = g;
+	VMP->slicing = 0;
+	VMP->slice = 1;
+	while(1)
+	{
+		x = eel_run(vm);
+		if(x != EEL_XOK)
+			break;
+	}
+	VMP->slicing = slicing;
+	VMP->slice = slice;
+	VMP->generator = pg;
+	--VMP->calldepth;
+	g->result = NULL;
+
+	if(x == EEL_XYIELD)
+	{
+		g->state = EEL_GS_SUSPENDED;
+		thread_save(vm, &g->t);
+		x = 0;
+	}
+	else
+	{
+		/* Returned, or threw an exception. Either way, it's over. */
+		unwind(vm, 0);
+		stack_clear(vm);
+		free_heap(vm);
+		g->state = EEL_GS_DONE;
+		eel_o_disown_nz(g->t.f);
+		g->t.f = NULL;
+		if(x == EEL_XEND)
+			x = 0;
+	}
+	thread_load(vm, &cur);
+	return x;
+}
+
+
+void eel__gen_free(EEL_vm *vm, EEL_generator *g)
+{
+	EEL_vmthread cur;
+	if(g->state != EEL_GS_SUSPENDED)
+		return;
+	thread_save(vm, &cur);
+	thread_load(vm, &g->t);
+	unwind(vm, 0);
+	stack_clear(vm);
+	free_heap(vm);
+	thread_load(vm, &cur);
+	eel_o_disown_nz(g->t.f);
+	g->t.f = NULL;
+	g->state = EEL_GS_DONE;
+}
+
+
 /* VM "work state" */
 typedef struct
 {
 	unsigned char	*code;	/* Code buffer */
+#ifdef EEL_VM_PREDECODE
+	EEL_dinstruction *dcode;/* Pre-decoded code */
+#endif
 	EEL_callframe	*cf;	/* Call frame */
 	EEL_value	*r;	/* Register frame */
 	EEL_value	*sv;	/* Static variable array */
 	unsigned char	*ctab;	/* Register variable cleanup table */
+#ifdef EEL_VM_JIT
+	int		*jithot;/* Hot counter of current function */
+#endif
 } EEL_vmstate;
 
 
@@ -773,9 +1657,25 @@ static inline void reload_context(EEL_vm *vm, EEL_vmstate *vms)
 	f = o2EEL_function(vms->cf->f);
 	vms->sv = o2EEL_module(f->common.module)->variables;
 	if(!(f->common.flags & EEL_FF_CFUNC))
+	{
 		vms->code = f->e.code;
+#ifdef EEL_VM_PREDECODE
+		vms->dcode = f->e.dcode;
+#endif
+#ifdef EEL_VM_JIT
+		vms->jithot = &f->e.jithot;
+#endif
+	}
 	else
+	{
 		vms->code = NULL;
+#ifdef EEL_VM_PREDECODE
+		vms->dcode = NULL;
+#endif
+#ifdef EEL_VM_JIT
+		vms->jithot = NULL;
+#endif
+	}
 	switch_function(vm, vms->cf->f);
 	DBG4E(dump_callframe(vm, vms->cf, "reload_context()");)
 }
@@ -792,13 +1692,13 @@ static EEL_xno eel__scheduler(EEL_vm *vm, EEL_vmstate *vms)
 	int x;
 
 	/* Figure out what the exception is about */
-	switch(VMP->exception.classid)
+	switch(EEL_VCLASS(&VMP->exception))
 	{
 	  case EEL_CNIL:
 		x = EEL_XYIELD;
 		break;
 	  case EEL_CINTEGER:
-		x = VMP->exception.integer.v;
+		x = EEL_VINT(&VMP->exception);
 		break;
 	  case EEL_CREAL:
 	  case EEL_CBOOLEAN:
@@ -815,111 +1715,66 @@ static EEL_xno eel__scheduler(EEL_vm *vm, EEL_vmstate *vms)
 	switch(x)
 	{
 	  case EEL_XOK:
+		break;
 	  case EEL_XYIELD:
-/*TODO: Reschedule, if other threads should run some. */
+		eel_nil2v(&VMP->exception);
+		if(thread_can_switch(vm))
+			thread_next(vm);
 		break;
 	  case EEL_XEND:
-/*TODO: If there are other threads, reschedule! */
-		return EEL_XEND;
-	  case EEL_XRETURN:
-	  {
-		/* Leave current function from within try or except block */
-		int base = vm->base;
-		EEL_callframe *cf = b2callframe(vm, base);
-		int result = cf->result;
-
-		/*
-		 * Find the first frame that is NOT a try block or catcher.
-		 * (Try blocks can be nested...!)
-		 */
-		while(1)
+		eel_nil2v(&VMP->exception);
+		if(VMP->generator)
+			return EEL_XEND;	/* Generator function returned */
+		if(VMP->thread != &VMP->mainthread)
 		{
-#ifdef EEL_VM_CHECKING
-			if(!cf->f)
-			{
-				eel_vmdump(vm, "RETX or RETXR used in the wrong place!");
-				return EEL_XVMCHECK;
-			}
-#endif
-			if(!(cf->flags & (EEL_CFF_TRYBLOCK | EEL_CFF_CATCHER)))
-				break;
-			base = cf->r_base;
-			cf = b2callframe(vm, base);
-		}
-
-		DBG5(printf(".------------------------------\n");)
-		DBG5(printf("| XRETURN causes function '%s' to return.\n",
-				eel_o2s(o2EEL_function(cf->f)->common.name));)
-		DBG5(printf("|------------------------------\n");)
-
-		/* The actual RETURN: */
-		base = cf->r_base;
-		cf = b2callframe(vm, base);
-
-		/* Unroll, clean up etc... */
-		unwind(vm, base);
-		stack_clear(vm);
-
-		DBGK4(if(result >= 0)
-			printf("Expecting result in heap[%d].\n", result);)
-#ifdef EEL_VM_CHECKING
-		if((result >= 0) && vm->heap[result].classid == EEL_CILLEGAL)
-		{
-			eel_vmdump(vm, "Exception block forgot to return a "
-					"result!");
-			return EEL_XVMCHECK;
+			/* Microthread returned from its function */
+			thread_end(vm);
+			break;
 		}
-#endif
-		if(!vm->base || (o2EEL_function(
-				cf->f)->common.flags & EEL_FF_CFUNC))
-			return EEL_XEND;
-
-		reload_context(vm, vms);
-		if(result >= 0)
-			eel_v_receive(vm->heap + result);
-		break;
-	  }
+		return EEL_XEND;
+	  case EEL_XCOUNTER:
+		/* Time slice used up. Leave; eel_run() picks up from here. */
+		eel_nil2v(&VMP->exception);
+		return EEL_XCOUNTER;
 	  default:
 	  {
-		/* Try to find the nearest try...except catcher. */
+		/*
+		 * Look for the innermost try region covering the instruction
+		 * that threw, or the call that led to it, in each frame.
+		 */
 		int base = vm->base;
+		int pc = vm->pc;
 		while(base)
 		{
 			EEL_callframe *cf = b2callframe(vm, base);
+			EEL_function *f;
+			EEL_xregion *xr;
 
 			/* Nothing more to unwind? */
 			if(!cf->f)
 				break;
 
-			if(o2EEL_function(cf->f)->common.flags & EEL_FF_CFUNC)
+			f = o2EEL_function(cf->f);
+			if(f->common.flags & EEL_FF_CFUNC)
 				break;
 
-			if(cf->flags & EEL_CFF_UNTRY)
-				break;
+			xr = find_xregion(f, pc);
+			if(xr && (xr->handler < 0))
+				break;		/* 'untry' region */
 
 			/* Check for exception handler */
-			if(cf->catcher && x != EEL_XINTERNAL)
+			if(xr && (x != EEL_XINTERNAL))
 			{
-				EEL_object *catcher = cf->catcher;
 				DBG5(printf(".------------------------------\n");)
-				DBG5(printf("| Handled by catcher '%s'\n",
-						eel_o2s(o2EEL_function(catcher)->
-								common.name));)
+				DBG5(printf("| Handled in '%s' at PC %d\n",
+						eel_o2s(f->common.name),
+						xr->handler);)
 				DBG5(printf("|------------------------------\n");)
-				base = cf->r_base;
-				unwind(vm, base);
-				x = call_catcher(vm, catcher);
-				if(x)
-				{
-					eel__throw(vm, x);
-					return x;
-				}
+				catch_exception(vm, base, xr);
 				reload_context(vm, vms);
-
-				/* Cleaning for exception value. */
-				vms->ctab[++vms->ctab[0]] = 0;
 				return 0;
 			}
+			pc = cf->r_pc;
 			base = cf->r_base;
 		}
 
@@ -927,6 +1782,22 @@ static EEL_xno eel__scheduler(EEL_vm *vm, EEL_vmstate *vms)
 		DBG5(printf(".------------------------------\n");)
 		DBG5(printf("| Exception not caught!\n");)
 		DBG5(printf("|------------------------------\n");)
+		if(!base && VMP->generator)
+		{
+			/* Passed on to the code resuming the generator */
+			unwind(vm, base);
+			return x;
+		}
+		if(!base && (VMP->thread != &VMP->mainthread))
+		{
+			/* Only the microthread dies */
+			eel_vmdump(vm, "Terminating EEL microthread %d!",
+					VMP->thread->id);
+			eel_v_disown_nz(&VMP->exception);
+			eel_nil2v(&VMP->exception);
+			thread_end(vm);
+			break;
+		}
 		eel_vmdump(vm, "Terminating EEL virtual machine!");
 		unwind(vm, base);
 		return x;
@@ -956,6 +1827,119 @@ static EEL_xno eel__scheduler(EEL_vm *vm, EEL_vmstate *vms)
 }
 
 
+#ifdef EEL_VM_QUICKEN
+/*
+ * Operators handled by the quickened BOP instructions.
+ */
+static inline int quick_binop(int op)
+{
+	switch(op)
+	{
+	  case EEL_OP_ADD:
+	  case EEL_OP_SUB:
+	  case EEL_OP_MUL:
+	  case EEL_OP_EQ:
+	  case EEL_OP_NE:
+	  case EEL_OP_GT:
+	  case EEL_OP_GE:
+	  case EEL_OP_LT:
+	  case EEL_OP_LE:
+		return 1;
+	  default:
+		return 0;
+	}
+}
+
+/*
+ * Integer/integer and real/real versions of the quick_binop() operators.
+ * Results are the same as those of eel_operate() for the same operands.
+ */
+static inline void quick_op_ii(int op, EEL_integer l, EEL_integer r,
+		EEL_value *res)
+{
+	switch(op)
+	{
+	  case EEL_OP_ADD:
+		eel_l2v(res, l + r);
+		break;
+	  case EEL_OP_SUB:
+		eel_l2v(res, l - r);
+		break;
+	  case EEL_OP_MUL:
+		eel_l2v(res, l * r);
+		break;
+	  case EEL_OP_EQ:	eel_b2v(res, l == r); break;
+	  case EEL_OP_NE:	eel_b2v(res, l != r); break;
+	  case EEL_OP_GT:	eel_b2v(res, l > r); break;
+	  case EEL_OP_GE:	eel_b2v(res, l >= r); break;
+	  case EEL_OP_LT:	eel_b2v(res, l < r); break;
+	  case EEL_OP_LE:	eel_b2v(res, l <= r); break;
+	}
+}
+
+static inline void quick_op_rr(int op, EEL_real l, EEL_real r,
+		EEL_value *res)
+{
+	switch(op)
+	{
+	  case EEL_OP_ADD:
+		eel_d2v(res, l + r);
+		break;
+	  case EEL_OP_SUB:
+		eel_d2v(res, l - r);
+		break;
+	  case EEL_OP_MUL:
+		eel_d2v(res, l * r);
+		break;
+	  case EEL_OP_EQ:	eel_b2v(res, l == r); break;
+	  case EEL_OP_NE:	eel_b2v(res, l != r); break;
+	  case EEL_OP_GT:	eel_b2v(res, l > r); break;
+	  case EEL_OP_GE:	eel_b2v(res, l >= r); break;
+	  /* As eel_op_lt() and eel_op_le(); true for NaN operands! */
+	  case EEL_OP_LT:	eel_b2v(res, !(l >= r)); break;
+	  case EEL_OP_LE:	eel_b2v(res, !(l > r)); break;
+	}
+}
+#endif /* EEL_VM_QUICKEN */
+
+
+/*
+ * Fallback for IPRELOOP and ILOOP: Cast loop variable 'i', 'step' and
+ * 'limit' to real, turning the loop into a plain PRELOOP/LOOP loop.
+ */
+static inline EEL_xno loop_cast_real(EEL_vm *vm, EEL_value *i,
+		EEL_value *step, EEL_value *limit)
+{
+	EEL_real v;
+#ifdef DEBUG
+	v = 0.0f;
+#endif
+	if(EEL_VCLASS(i) != EEL_CREAL)
+	{
+		EEL_xno x = eel_get_realval(vm, i, &v);
+		if(x)
+			return x;
+		eel_v_disown_nz(i);	/* 'i' is a variable! */
+		eel_d2v(i, v);
+	}
+	if(EEL_VCLASS(step) != EEL_CREAL)
+	{
+		EEL_xno x = eel_get_realval(vm, step, &v);
+		if(x)
+			return x;
+		eel_d2v(step, v);
+	}
+	if(EEL_VCLASS(limit) != EEL_CREAL)
+	{
+		EEL_xno x = eel_get_realval(vm, limit, &v);
+		if(x)
+			return x;
+		eel_d2v(limit, v);
+	}
+	return 0;
+}
+
+
 /*
  * Return default value (pointer to constant) for optional argument 'arg', or
  * NULL if there is no default value for that argument.
@@ -1066,10 +2050,18 @@ EEL_xno eel_run(EEL_vm *vm)
 #undef	EEL_I
 	};
 
+#ifdef EEL_VM_PREDECODE
+#  define	DISPATCH	goto *vms.dcode[PC].op
+#  define	DECODE(y)	EEL_DOPR_##y(vms.dcode + PC)
+#else
+#  define	DISPATCH	goto *gtab[(EEL_opcodes)vms.code[PC]]
+#  define	DECODE(y)	EEL_OPR_##y(vms.code + PC)
+#endif
+
 #define	NEXT								\
 	({								\
 		vmprofile_out(vm);					\
-		goto *gtab[(EEL_opcodes)vms.code[PC]];			\
+		DISPATCH;						\
 	})
 
 #define	BEGIN								\
@@ -1093,11 +2085,29 @@ EEL_xno eel_run(EEL_vm *vm)
 		PREINSTRUCTION;						\
 		vmprofile_in(vm, (EEL_opcodes)vms.code[PC]);		\
 		{							\
-			EEL_OPR_##y(vms.code + PC)			\
+			DECODE(y)					\
 			PC += EEL_OSIZE_##y;				\
 			{						\
 				/* opcode implementation goes here */
 
+#ifdef EEL_VM_QUICKEN
+/* Quickened variant 'x' of an instruction with operand layout 'y' */
+#define	EEL_QI(x, y)							\
+				NEXT;					\
+			}						\
+		}							\
+	}								\
+	lab_Q##x:							\
+	{								\
+		PREINSTRUCTION;						\
+		vmprofile_in(vm, (EEL_opcodes)vms.code[PC]);		\
+		{							\
+			DECODE(y)					\
+			PC += EEL_OSIZE_##y;				\
+			{						\
+				/* opcode implementation goes here */
+#endif
+
 #define	END								\
 				NEXT;					\
 			}						\
@@ -1202,16 +2212,119 @@ EEL_xno eel_run(EEL_vm *vm)
 		RESCHEDULE;			\
 	})
 
+/*--- Quickening (EEL_VM_QUICKEN) -----------------------------------*/
+#ifdef EEL_VM_QUICKEN
+/* Switch the current instruction, of operand layout 'y', to variant 'x' */
+#  define	QUICKEN(y, x)						\
+	({								\
+		vms.dcode[PC - EEL_OSIZE_##y].op = &&lab_Q##x;		\
+	})
+
+/* Quicken to x_II or x_RR if 'l' and 'r' are both integer or both real */
+#  define	QUICKEN2(y, x, l, r)					\
+	({								\
+		if(EEL_VCLASS(&(l)) == EEL_VCLASS(&(r)))				\
+		{							\
+			if(EEL_VCLASS(&(l)) == EEL_CINTEGER)			\
+				QUICKEN(y, x##_II);			\
+			else if(EEL_VCLASS(&(l)) == EEL_CREAL)		\
+				QUICKEN(y, x##_RR);			\
+		}							\
+	})
+
+/* Switch back to generic instruction 'x', and run that instead */
+#  define	UNQUICKEN(y, x)						\
+	({								\
+		PC -= EEL_OSIZE_##y;					\
+		vms.dcode[PC].op = gtab[EEL_O##x##_##y];		\
+		DISPATCH;						\
+	})
+
+/* QUICKEN2(), for BOP instructions with operator 'op' */
+#  define	QUICKENBOP(y, x, op, l, r)				\
+	({								\
+		if(quick_binop(op))					\
+			QUICKEN2(y, x, l, r);				\
+	})
+#else
+#  define	QUICKEN2(y, x, l, r)
+#  define	QUICKENBOP(y, x, op, l, r)
+#endif
+
+/*--- Inline caches (EEL_VM_INLINE_CACHE) ----------------------------*/
+#ifdef EEL_VM_INLINE_CACHE
+/* Cache field of the current instruction, of operand layout 'y' */
+#  define	ICACHE(y)	(&vms.dcode[PC - EEL_OSIZE_##y].d)
+#endif
+
+/*--- Native code (EEL_VM_JIT) ---------------------------------------*/
+#ifdef EEL_VM_JIT
+/* Count a backward jump, compiling the current function when it gets hot */
+#  define	JITHOT							\
+	({								\
+		if((*vms.jithot < EEL_JIT_THRESHOLD) &&			\
+				(++*vms.jithot == EEL_JIT_THRESHOLD))	\
+			jit_hot(vm, o2EEL_function(CALLFRAME->f));	\
+	})
+
+/*
+ * Entry point for native code. eel_jit_compile() points the pre-decoded
+ * entries of all instructions that have native code here.
+ */
+#  define	EEL_JI							\
+				NEXT;					\
+			}						\
+		}							\
+	}								\
+	lab_JIT:							\
+	{								\
+		{							\
+			{
+#else
+#  define	JITHOT
+#endif
+
+/*--- Time slicing (eel_run_slice()) ---------------------------------*/
+/*
+ * Count a tick, leaving the VM if the time slice is used up, or switching to
+ * the next microthread when it's time.
+ */
+#define	SLICE								\
+	({								\
+		if(--VMP->slice <= 0)					\
+		{							\
+			EEL_xno sx = slice_refill(vm);			\
+			if(sx)						\
+				THROW(sx);				\
+		}							\
+	})
+
+/* Take backward jump 'd' */
+#define	BACKJUMP(d)							\
+	({								\
+		JITHOT;							\
+		PC += (d);						\
+		SLICE;							\
+	})
+
 /*--------------------------------------------------------------------*/
 /*--- (End of dispatcher macro horror.) ------------------------------*/
 /*--------------------------------------------------------------------*/
 
+#ifdef EEL_VM_PREDECODE
+	/* predecode() needs this, and it's only available in here. */
+	VMP->itab = gtab;
+#endif
+#ifdef EEL_VM_JIT
+	VMP->jitop = &&lab_JIT;
+#endif
+
 	if(!vm->base)
 		RETURN(EEL_XEND);
 
 	/* Not interested in anything thrown outside the VM... */
 	eel_v_disown_nz(&VMP->exception);
-	VMP->exception.classid = EEL_CNIL;
+	eel_nil2v(&VMP->exception);
 
 	reload_context(vm, &vms);
 	DBG5(printf(">>>>>>>>>>>>>>>> Entering VM >>>>>>>>>>>>>>>>\n");)
@@ -1229,7 +2342,10 @@ EEL_xno eel_run(EEL_vm *vm)
 		if(-eel_i_size(EEL_OJUMP_sAx) == A)
 			DUMP(EEL_XARGUMENTS, "Illegal jump! (Infinite loop)");
 #endif
-		PC += A;
+		if(A < 0)
+			BACKJUMP(A);
+		else
+			PC += A;
 
 	  EEL_IJUMPZ
 #ifdef EEL_VM_CHECKING
@@ -1237,7 +2353,12 @@ EEL_xno eel_run(EEL_vm *vm)
 			DUMP(EEL_XARGUMENTS, "Illegal jump! (Infinite loop)");
 #endif
 		if(!eel_test_nz(vm, &R[A]))
-			PC += B;
+		{
+			if(B < 0)
+				BACKJUMP(B);
+			else
+				PC += B;
+		}
 
 	  EEL_IJUMPNZ
 #ifdef EEL_VM_CHECKING
@@ -1245,6 +2366,127 @@ EEL_xno eel_run(EEL_vm *vm)
 			DUMP(EEL_XARGUMENTS, "Illegal jump! (Infinite loop)");
 #endif
 		if(eel_test_nz(vm, &R[A]))
+		{
+			if(B < 0)
+				BACKJUMP(B);
+			else
+				PC += B;
+		}
+
+	  EEL_IJUMPEQ
+		EEL_value v;
+#ifdef EEL_VM_CHECKING
+		if(-eel_i_size(EEL_OJUMPEQ_ABsCx) == C)
+			DUMP(EEL_XARGUMENTS, "Illegal jump! (Infinite loop)");
+#endif
+		XCHECK(eel_op_eq(&R[A], &R[B], &v));
+		if(EEL_VINT(&v))
+		{
+			if(C < 0)
+				BACKJUMP(C);
+			else
+				PC += C;
+		}
+
+	  EEL_IJUMPNE
+		EEL_value v;
+#ifdef EEL_VM_CHECKING
+		if(-eel_i_size(EEL_OJUMPNE_ABsCx) == C)
+			DUMP(EEL_XARGUMENTS, "Illegal jump! (Infinite loop)");
+#endif
+		XCHECK(eel_op_ne(&R[A], &R[B], &v));
+		if(EEL_VINT(&v))
+		{
+			if(C < 0)
+				BACKJUMP(C);
+			else
+				PC += C;
+		}
+
+	  EEL_IJUMPGE
+		EEL_value v;
+#ifdef EEL_VM_CHECKING
+		if(-eel_i_size(EEL_OJUMPGE_ABsCx) == C)
+			DUMP(EEL_XARGUMENTS, "Illegal jump! (Infinite loop)");
+#endif
+		XCHECK(eel_op_ge(&R[A], &R[B], &v));
+		if(EEL_VINT(&v))
+		{
+			if(C < 0)
+				BACKJUMP(C);
+			else
+				PC += C;
+		}
+
+	  EEL_IJUMPLE
+		EEL_value v;
+#ifdef EEL_VM_CHECKING
+		if(-eel_i_size(EEL_OJUMPLE_ABsCx) == C)
+			DUMP(EEL_XARGUMENTS, "Illegal jump! (Infinite loop)");
+#endif
+		XCHECK(eel_op_le(&R[A], &R[B], &v));
+		if(EEL_VINT(&v))
+		{
+			if(C < 0)
+				BACKJUMP(C);
+			else
+				PC += C;
+		}
+
+	  EEL_IJUMPGT
+		EEL_value v;
+#ifdef EEL_VM_CHECKING
+		if(-eel_i_size(EEL_OJUMPGT_ABsCx) == C)
+			DUMP(EEL_XARGUMENTS, "Illegal jump! (Infinite loop)");
+#endif
+		XCHECK(eel_op_gt(&R[A], &R[B], &v));
+		if(EEL_VINT(&v))
+		{
+			if(C < 0)
+				BACKJUMP(C);
+			else
+				PC += C;
+		}
+
+	  EEL_IJUMPLT
+		EEL_value v;
+#ifdef EEL_VM_CHECKING
+		if(-eel_i_size(EEL_OJUMPLT_ABsCx) == C)
+			DUMP(EEL_XARGUMENTS, "Illegal jump! (Infinite loop)");
+#endif
+		XCHECK(eel_op_lt(&R[A], &R[B], &v));
+		if(EEL_VINT(&v))
+		{
+			if(C < 0)
+				BACKJUMP(C);
+			else
+				PC += C;
+		}
+
+	  EEL_IJUMPZARGI
+		EEL_value *arg;
+#ifdef EEL_VM_CHECKING
+		if(-eel_i_size(EEL_OJUMPZARGI_AsBx) == B)
+			DUMP(EEL_XARGUMENTS, "Illegal jump! (Infinite loop)");
+#endif
+		if(A < CALLFRAME->argc)
+			arg = vm->heap + CALLFRAME->argv + A;
+		else if(!(arg = get_optarg_default(CALLFRAME, A)))
+			THROW(EEL_XHIGHINDEX);
+		if(!eel_test_nz(vm, arg))
+			PC += B;
+
+	  EEL_IJUMPNZARGI
+		EEL_value *arg;
+#ifdef EEL_VM_CHECKING
+		if(-eel_i_size(EEL_OJUMPNZARGI_AsBx) == B)
+			DUMP(EEL_XARGUMENTS, "Illegal jump! (Infinite loop)");
+#endif
+		if(A < CALLFRAME->argc)
+			arg = vm->heap + CALLFRAME->argv + A;
+		else if(!(arg = get_optarg_default(CALLFRAME, A)))
+			THROW(EEL_XHIGHINDEX);
+		if(eel_test_nz(vm, arg))
 			PC += B;
 
 	  EEL_ISWITCH
@@ -1256,7 +2498,7 @@ EEL_xno eel_run(EEL_vm *vm)
 			DUMP(EEL_XARGUMENTS, "Illegal SWITCH default jump!"
 					" (Infinite loop)");
 #endif
-		x = eel_o__metamethod(f->e.constants[B].objref.v,
+		x = eel_o__metamethod(eel_v2o(&f->e.constants[B]),
 				EEL_MM_GETINDEX, &R[A], &offs);
 		/*
 		 * NOTE:
@@ -1264,7 +2506,23 @@ EEL_xno eel_run(EEL_vm *vm)
 		 *	did something really stupid!
 		 */
 		if(!x)
-			PC = offs.integer.v;
+			PC = EEL_VINT(&offs);
+		else
+			PC += C;
+
+	  EEL_ISWITCHD
+		/* See switch_dense() in ec_parser.c for the table layout. */
+		EEL_function *f = o2EEL_function(CALLFRAME->f);
+		EEL_vector *jt = o2EEL_vector(eel_v2o(&f->e.constants[B]));
+		EEL_uint32 i;
+		if(EEL_VCLASS(&R[A]) != (EEL_classes)jt->buffer.s32[0])
+		{
+			PC += C;
+			NEXT;
+		}
+		i = (EEL_uint32)EEL_VINT(&R[A]) - (EEL_uint32)jt->buffer.s32[1];
+		if(i < (EEL_uint32)jt->length - 2)
+			PC = jt->buffer.s32[2 + i];
 		else
 			PC += C;
 
@@ -1273,7 +2531,7 @@ EEL_xno eel_run(EEL_vm *vm)
 		 * Cast all values to real first, so we
 		 * can save some cycles inside the loop.
 		 */
-		if(R[A].classid != EEL_CREAL)
+		if(EEL_VCLASS(&R[A]) != EEL_CREAL)
 		{
 			EEL_real v;
 #ifdef DEBUG
@@ -1281,40 +2539,37 @@ EEL_xno eel_run(EEL_vm *vm)
 #endif
 			XCHECK(eel_get_realval(vm, &R[A], &v));
 			eel_v_disown_nz(&R[A]);	/* R[A] is a variable! */
-			R[A].classid = EEL_CREAL;
-			R[A].real.v = v;
+			eel_d2v(&R[A], v);
 		}
-		if(R[B].classid != EEL_CREAL)
+		if(EEL_VCLASS(&R[B]) != EEL_CREAL)
 		{
 			EEL_real v;
 #ifdef DEBUG
 			v = 0.0f;
 #endif
 			XCHECK(eel_get_realval(vm, &R[B], &v));
-			R[B].classid = EEL_CREAL;
-			R[B].real.v = v;
+			eel_d2v(&R[B], v);
 		}
-		if(R[C].classid != EEL_CREAL)
+		if(EEL_VCLASS(&R[C]) != EEL_CREAL)
 		{
 			EEL_real v;
 #ifdef DEBUG
 			v = 0.0f;
 #endif
 			XCHECK(eel_get_realval(vm, &R[C], &v));
-			R[C].classid = EEL_CREAL;
-			R[C].real.v = v;
+			eel_d2v(&R[C], v);
 		}
 		/*
 		 * Now for the important part: Killing this
 		 * "one iteration no matter what" nonsense!
 		 */
-		if(R[B].real.v < 0.0)
+		if(EEL_VREAL(&R[B]) < 0.0)
 		{
-			if(R[A].real.v < R[C].real.v)
+			if(EEL_VREAL(&R[A]) < EEL_VREAL(&R[C]))
 				PC += D;	/* Skip the loop */
 		}
 		else
-			if(R[A].real.v > R[C].real.v)
+			if(EEL_VREAL(&R[A]) > EEL_VREAL(&R[C]))
 				PC += D;	/* Skip the loop */
 
 	  EEL_ILOOP
@@ -1322,7 +2577,7 @@ EEL_xno eel_run(EEL_vm *vm)
 		 * R[A] is a variable, so someone might
 		 * "damage" it from inside the loop!
 		 */
-		if(R[A].classid != EEL_CREAL)
+		if(EEL_VCLASS(&R[A]) != EEL_CREAL)
 		{
 			EEL_real v;
 #ifdef DEBUG
@@ -1330,19 +2585,95 @@ EEL_xno eel_run(EEL_vm *vm)
 #endif
 			XCHECK(eel_get_realval(vm, &R[A], &v));
 			eel_v_disown_nz(&R[A]);
-			R[A].classid = EEL_CREAL;
-			R[A].real.v = v;
+			eel_d2v(&R[A], v);
 		}
-		R[A].real.v += R[B].real.v;
-		if(R[B].real.v < 0.0f)
+		eel_d2v(&R[A], EEL_VREAL(&R[A]) + EEL_VREAL(&R[B]));
+		if(EEL_VREAL(&R[B]) < 0.0f)
 		{
-			if(R[A].real.v < R[C].real.v)
+			if(EEL_VREAL(&R[A]) < EEL_VREAL(&R[C]))
 				NEXT;	/* Stop! */
 		}
 		else
-			if(R[A].real.v > R[C].real.v)
+			if(EEL_VREAL(&R[A]) > EEL_VREAL(&R[C]))
 				NEXT;	/* Stop! */
-		PC += D;		/* Loop! */
+		BACKJUMP(D);		/* Loop! */
+
+	  EEL_IIPRELOOP
+		/*
+		 * The compiler says everything is integer, but a
+		 * cast or metamethod may still hand us a real, so
+		 * we double check, and fall back to PRELOOP style
+		 * real loops if needed. ILOOP follows along.
+		 */
+		if((EEL_VCLASS(&R[A]) == EEL_CINTEGER) &&
+				(EEL_VCLASS(&R[B]) == EEL_CINTEGER) &&
+				(EEL_VCLASS(&R[C]) == EEL_CINTEGER))
+		{
+			if(EEL_VINT(&R[B]) < 0)
+			{
+				if(EEL_VINT(&R[A]) < EEL_VINT(&R[C]))
+					PC += D;	/* Skip the loop */
+			}
+			else
+				if(EEL_VINT(&R[A]) > EEL_VINT(&R[C]))
+					PC += D;	/* Skip the loop */
+			NEXT;
+		}
+		XCHECK(loop_cast_real(vm, &R[A], &R[B], &R[C]));
+		if(EEL_VREAL(&R[B]) < 0.0)
+		{
+			if(EEL_VREAL(&R[A]) < EEL_VREAL(&R[C]))
+				PC += D;	/* Skip the loop */
+		}
+		else
+			if(EEL_VREAL(&R[A]) > EEL_VREAL(&R[C]))
+				PC += D;	/* Skip the loop */
+
+	  EEL_IILOOP
+		/*
+		 * Step and limit are both integer or both real, as
+		 * set up by IPRELOOP, but again, R[A] is a variable.
+		 *
+		 * The distance to the limit is calculated unsigned,
+		 * so we can run all the way to the end of the
+		 * integer range without overflowing the counter.
+		 * (Only the value left in R[A] after the loop can
+		 * wrap around in that case.)
+		 */
+		if((EEL_VCLASS(&R[A]) == EEL_CINTEGER) &&
+				(EEL_VCLASS(&R[B]) == EEL_CINTEGER))
+		{
+			EEL_integer i = EEL_VINT(&R[A]);
+			EEL_integer step = EEL_VINT(&R[B]);
+			EEL_integer limit = EEL_VINT(&R[C]);
+			eel_l2v(&R[A], (EEL_integer)((EEL_uint32)i +
+					(EEL_uint32)step));
+			if(step < 0)
+			{
+				if((i < limit) || ((EEL_uint32)i -
+						(EEL_uint32)limit <
+						-(EEL_uint32)step))
+					NEXT;	/* Stop! */
+			}
+			else
+				if((i > limit) || ((EEL_uint32)limit -
+						(EEL_uint32)i <
+						(EEL_uint32)step))
+					NEXT;	/* Stop! */
+			BACKJUMP(D);	/* Loop! */
+			NEXT;
+		}
+		XCHECK(loop_cast_real(vm, &R[A], &R[B], &R[C]));
+		eel_d2v(&R[A], EEL_VREAL(&R[A]) + EEL_VREAL(&R[B]));
+		if(EEL_VREAL(&R[B]) < 0.0f)
+		{
+			if(EEL_VREAL(&R[A]) < EEL_VREAL(&R[C]))
+				NEXT;	/* Stop! */
+		}
+		else
+			if(EEL_VREAL(&R[A]) > EEL_VREAL(&R[C]))
+				NEXT;	/* Stop! */
+		BACKJUMP(D);		/* Loop! */
 
 	  /* Argument stack operations */
 	  EEL_IPUSH
@@ -1373,25 +2704,22 @@ EEL_xno eel_run(EEL_vm *vm)
 
 	  EEL_IPUSHI
 		CHECK_STACK(1);
-		S[0].classid = EEL_CINTEGER;
-		S[0].integer.v = A;
+		eel_l2v(&S[0], A);
 		++vm->sp;
 
 	  EEL_IPHTRUE
 		CHECK_STACK(1);
-		S[0].classid = EEL_CBOOLEAN;
-		S[0].integer.v = 1;
+		eel_b2v(&S[0], 1);
 		++vm->sp;
 
 	  EEL_IPHFALSE
 		CHECK_STACK(1);
-		S[0].classid = EEL_CBOOLEAN;
-		S[0].integer.v = 0;
+		eel_b2v(&S[0], 0);
 		++vm->sp;
 
 	  EEL_IPUSHNIL
 		CHECK_STACK(1);
-		S[0].classid = EEL_CNIL;
+		eel_nil2v(&S[0]);
 		++vm->sp;
 
 	  EEL_IPUSHC
@@ -1410,8 +2738,7 @@ EEL_xno eel_run(EEL_vm *vm)
 	  EEL_IPUSHIC
 		EEL_function *f = o2EEL_function(CALLFRAME->f);
 		CHECK_STACK(2);
-		S[0].classid = EEL_CINTEGER;
-		S[0].integer.v = B;
+		eel_l2v(&S[0], B);
 		eel_v_copy(S + 1, &f->e.constants[A]);
 		vm->sp += 2;
 
@@ -1419,8 +2746,7 @@ EEL_xno eel_run(EEL_vm *vm)
 		EEL_function *f = o2EEL_function(CALLFRAME->f);
 		CHECK_STACK(2);
 		eel_v_copy(S, &f->e.constants[A]);
-		S[1].classid = EEL_CINTEGER;
-		S[1].integer.v = B;
+		eel_l2v(&S[1], B);
 		vm->sp += 2;
 
 	  EEL_IPHVAR
@@ -1475,48 +2801,166 @@ EEL_xno eel_run(EEL_vm *vm)
 			vm->sp += argc;
 		}
 
-	  /* Function calls */
-	  EEL_ICALL
+	  EEL_IPUSHA
+		XCHECK(push_items(vm, &R[A], 0, -1));
+		reload_context(vm, &vms);
+
+	  EEL_IPUSHAS
+		XCHECK(push_items(vm, &R[A], B, C ? C : -1));
+		reload_context(vm, &vms);
+
+	  EEL_IPUSHASR
+		XCHECK(push_items(vm, &R[A], eel_v2l(&R[B]),
+				EEL_VCLASS(&R[C]) == EEL_CNIL ? -1 : eel_v2l(&R[C])));
+		reload_context(vm, &vms);
+
+	  /* Function calls */
+	  EEL_ICALL
+		EEL_object *f;
+		DBG4E(dump_callframe(vm, CALLFRAME, "CALL");)
+		XCHECK(get_function(vm, &R[A], &f));
+		XCHECK(check_args(vm, f));
+		XCHECK(call_f(vm, f, -1, 0));
+		reload_context(vm, &vms);
+		SLICE;
+
+	  EEL_ICALLR
+		EEL_object *f;
+		DBG4E(dump_callframe(vm, CALLFRAME, "CALLR");)
+		XCHECK(get_function(vm, &R[A], &f));
+		XCHECK(check_args(vm, f));
+		XCHECK(call_f(vm, f, vm->base + B, 0));
+		reload_context(vm, &vms);
+		SLICE;
+
+	  EEL_ICCALL
+		EEL_function *f = o2EEL_function(CALLFRAME->f);
+		DBG4E(dump_callframe(vm, CALLFRAME, "CCALL");)
+#ifdef EEL_VM_CHECKING
+		if(!EEL_IS_OBJREF(EEL_VCLASS(&f->e.constants[B])))
+			DUMP(EEL_XARGUMENTS, "CCALL: Constant is not an object "
+					"reference!");
+		if(eel_v2o(&f->e.constants[B])->classid != EEL_CFUNCTION)
+			DUMP(EEL_XARGUMENTS, "CCALL: Object is not a function!");
+#endif
+		XCHECK(call_f(vm, eel_v2o(&f->e.constants[B]), -1, A));
+		reload_context(vm, &vms);
+		SLICE;
+
+	  EEL_ICCALLR
+		EEL_function *f = o2EEL_function(CALLFRAME->f);
+		DBG4E(dump_callframe(vm, CALLFRAME, "CCALLR");)
+#ifdef EEL_VM_CHECKING
+		if(!EEL_IS_OBJREF(EEL_VCLASS(&f->e.constants[C])))
+			DUMP(EEL_XARGUMENTS, "CCALL: Constant is not an object "
+					"reference!");
+		if(eel_v2o(&f->e.constants[C])->classid != EEL_CFUNCTION)
+			DUMP(EEL_XARGUMENTS, "CCALL: Object is not a function!");
+#endif
+		XCHECK(call_f(vm, eel_v2o(&f->e.constants[C]), vm->base + B, A));
+		reload_context(vm, &vms);
+		SLICE;
+
+	  EEL_ITAILCALL
+		EEL_object *f;
+		DBG4E(dump_callframe(vm, CALLFRAME, "TAILCALL");)
+		XCHECK(get_function(vm, &R[A], &f));
+		XCHECK(check_args(vm, f));
+		if(can_tail_call(f))
+			XCHECK(tail_call(vm, f));
+		else
+			XCHECK(call_f(vm, f, vm->base + B, 0));
+		reload_context(vm, &vms);
+		SLICE;
+
+	  EEL_ICTAILCALL
+		EEL_function *f = o2EEL_function(CALLFRAME->f);
+		EEL_object *fo = eel_v2o(&f->e.constants[C]);
+		DBG4E(dump_callframe(vm, CALLFRAME, "CTAILCALL");)
+#ifdef EEL_VM_CHECKING
+		if(!EEL_IS_OBJREF(EEL_VCLASS(&f->e.constants[C])))
+			DUMP(EEL_XARGUMENTS, "CTAILCALL: Constant is not an "
+					"object reference!");
+		if(fo->classid != EEL_CFUNCTION)
+			DUMP(EEL_XARGUMENTS, "CTAILCALL: Object is not a "
+					"function!");
+#endif
+		if(can_tail_call(fo))
+			XCHECK(tail_call(vm, fo));
+		else
+			XCHECK(call_f(vm, fo, vm->base + B, A));
+		reload_context(vm, &vms);
+		SLICE;
+
+	  EEL_ICALLRW
 		EEL_object *f;
-		DBG4E(dump_callframe(vm, CALLFRAME, "CALL");)
+		DBG4E(dump_callframe(vm, CALLFRAME, "CALLRW");)
 		XCHECK(get_function(vm, &R[A], &f));
-		XCHECK(check_args(vm, f));
-		XCHECK(call_f(vm, f, -1, 0));
+		XCHECK(check_argc(f, C));
+		XCHECK(call_fw(vm, f, -1, 0, vm->base + B, C));
 		reload_context(vm, &vms);
+		SLICE;
 
-	  EEL_ICALLR
+	  EEL_ICALLRWR
 		EEL_object *f;
-		DBG4E(dump_callframe(vm, CALLFRAME, "CALLR");)
+		DBG4E(dump_callframe(vm, CALLFRAME, "CALLRWR");)
 		XCHECK(get_function(vm, &R[A], &f));
-		XCHECK(check_args(vm, f));
-		XCHECK(call_f(vm, f, vm->base + B, 0));
+		XCHECK(check_argc(f, D));
+		XCHECK(call_fw(vm, f, vm->base + B, 0, vm->base + C, D));
 		reload_context(vm, &vms);
+		SLICE;
 
-	  EEL_ICCALL
+	  EEL_ICCALLRW
 		EEL_function *f = o2EEL_function(CALLFRAME->f);
-		DBG4E(dump_callframe(vm, CALLFRAME, "CCALL");)
+		DBG4E(dump_callframe(vm, CALLFRAME, "CCALLRW");)
 #ifdef EEL_VM_CHECKING
-		if(!EEL_IS_OBJREF(f->e.constants[B].classid))
-			DUMP(EEL_XARGUMENTS, "CCALL: Constant is not an object "
-					"reference!");
-		if(f->e.constants[B].objref.v->classid != EEL_CFUNCTION)
-			DUMP(EEL_XARGUMENTS, "CCALL: Object is not a function!");
+		if(!EEL_IS_OBJREF(EEL_VCLASS(&f->e.constants[C])))
+			DUMP(EEL_XARGUMENTS, "CCALLRW: Constant is not an "
+					"object reference!");
+		if(eel_v2o(&f->e.constants[C])->classid != EEL_CFUNCTION)
+			DUMP(EEL_XARGUMENTS, "CCALLRW: Object is not a "
+					"function!");
 #endif
-		XCHECK(call_f(vm, f->e.constants[B].objref.v, -1, A));
+		XCHECK(call_fw(vm, eel_v2o(&f->e.constants[C]), -1, 0,
+				vm->base + A, B));
 		reload_context(vm, &vms);
+		SLICE;
 
-	  EEL_ICCALLR
+	  EEL_ICCALLRWR
 		EEL_function *f = o2EEL_function(CALLFRAME->f);
-		DBG4E(dump_callframe(vm, CALLFRAME, "CCALLR");)
+		DBG4E(dump_callframe(vm, CALLFRAME, "CCALLRWR");)
 #ifdef EEL_VM_CHECKING
-		if(!EEL_IS_OBJREF(f->e.constants[C].classid))
-			DUMP(EEL_XARGUMENTS, "CCALL: Constant is not an object "
-					"reference!");
-		if(f->e.constants[C].objref.v->classid != EEL_CFUNCTION)
-			DUMP(EEL_XARGUMENTS, "CCALL: Object is not a function!");
+		if(!EEL_IS_OBJREF(EEL_VCLASS(&f->e.constants[D])))
+			DUMP(EEL_XARGUMENTS, "CCALLRWR: Constant is not an "
+					"object reference!");
+		if(eel_v2o(&f->e.constants[D])->classid != EEL_CFUNCTION)
+			DUMP(EEL_XARGUMENTS, "CCALLRWR: Object is not a "
+					"function!");
 #endif
-		XCHECK(call_f(vm, f->e.constants[C].objref.v, vm->base + B, A));
+		XCHECK(call_fw(vm, eel_v2o(&f->e.constants[D]), vm->base + A,
+				0, vm->base + B, C));
+		reload_context(vm, &vms);
+		SLICE;
+
+	  EEL_ITAILCALLRW
+		EEL_object *f;
+		DBG4E(dump_callframe(vm, CALLFRAME, "TAILCALLRW");)
+		XCHECK(get_function(vm, &R[A], &f));
+		XCHECK(check_argc(f, D));
+		if(can_tail_call(f))
+		{
+			/* tail_call() takes the arguments from the stack */
+			int i;
+			CHECK_STACK(D);
+			for(i = 0; i < D; ++i)
+				eel_v_copy(S + i, &R[C + i]);
+			vm->sp += D;
+			XCHECK(tail_call(vm, f));
+		}
+		else
+			XCHECK(call_fw(vm, f, vm->base + B, 0, vm->base + C, D));
 		reload_context(vm, &vms);
+		SLICE;
 
 	  EEL_IRETURN
 		clean(vm, CLEANTABLE, 0);
@@ -1533,7 +2977,7 @@ EEL_xno eel_run(EEL_vm *vm)
 		stack_clear(vm);
 		DBG4E(dump_callframe(vm, CALLFRAME, "RETURN (from)");)
 		if(!vm->base)
-			RETURN(EEL_XEND);	/* Root ==> no callframe! */
+			THROW(EEL_XEND);	/* Root ==> no callframe! */
 		CALLFRAME = b2callframe(vm, vm->base);
 		DBG4E(dump_callframe(vm, CALLFRAME, "RETURN (to)");)
 		if((o2EEL_function(CALLFRAME->f)->common.flags & EEL_FF_CFUNC))
@@ -1561,7 +3005,7 @@ EEL_xno eel_run(EEL_vm *vm)
 		stack_clear(vm);
 		DBG4E(dump_callframe(vm, CALLFRAME, "RETURNR (from)");)
 		if(!vm->base)
-			RETURN(EEL_XEND);	/* Root ==> no callframe! */
+			THROW(EEL_XEND);	/* Root ==> no callframe! */
 		CALLFRAME = b2callframe(vm, vm->base);
 		DBG4E(dump_callframe(vm, CALLFRAME, "RETURNR (to)");)
 		if((o2EEL_function(CALLFRAME->f)->common.flags & EEL_FF_CFUNC))
@@ -1571,14 +3015,20 @@ EEL_xno eel_run(EEL_vm *vm)
 		if(ri >=0)
 			eel_v_receive(vm->heap + ri);
 
+	  EEL_IYIELD
+		EEL_generator *g = VMP->generator;
+		if(!g || (g->depth != VMP->calldepth))
+			THROW(EEL_XBADCONTEXT);
+		eel_v_copy(g->result, &R[A]);
+		RETURN(EEL_XYIELD);
+
 	  /* Memory management */
 	  EEL_ICLEAN
 		clean(vm, CLEANTABLE, A);
 
 	  /* Optional/tuple argument checking */
 	  EEL_IARGC
-		R[A].classid = EEL_CINTEGER;
-		R[A].integer.v = CALLFRAME->argc;
+		eel_l2v(&R[A], CALLFRAME->argc);
 
 	  EEL_ITUPC
 		EEL_function *f = o2EEL_function(CALLFRAME->f);
@@ -1586,14 +3036,11 @@ EEL_xno eel_run(EEL_vm *vm)
 		if(!f->common.tupargs)
 			DUMP(EEL_XVMCHECK, "TUPC in function with no tuple args!");
 #endif
-		R[A].classid = EEL_CINTEGER;
-		R[A].integer.v = CALLFRAME->argc;
-		R[A].integer.v -= f->common.reqargs;
-		R[A].integer.v /= f->common.tupargs;
+		eel_l2v(&R[A], ((EEL_integer)CALLFRAME->argc -
+				f->common.reqargs) / f->common.tupargs);
 
 	  EEL_ISPEC
-		R[B].classid = EEL_CBOOLEAN;
-		R[B].integer.v = A < CALLFRAME->argc;
+		eel_b2v(&R[B], A < CALLFRAME->argc);
 
 	  EEL_ITSPEC
 		/*
@@ -1614,24 +3061,20 @@ EEL_xno eel_run(EEL_vm *vm)
 			THROW(EEL_XLOWINDEX);
 		tupc -= f->common.reqargs;
 		tupc /= f->common.tupargs;
-		R[B].classid = EEL_CBOOLEAN;
-		R[B].integer.v = ind < tupc;
+		eel_b2v(&R[B], ind < tupc);
 
 	  /* Immediate values, constants etc */
 	  EEL_ILDI
-		R[A].classid = EEL_CINTEGER;
-		R[A].integer.v = B;
+		eel_l2v(&R[A], B);
 
 	  EEL_ILDTRUE
-		R[A].classid = EEL_CBOOLEAN;
-		R[A].integer.v = 1;
+		eel_b2v(&R[A], 1);
 
 	  EEL_ILDFALSE
-		R[A].classid = EEL_CBOOLEAN;
-		R[A].integer.v = 0;
+		eel_b2v(&R[A], 0);
 
 	  EEL_ILDNIL
-		R[A].classid = EEL_CNIL;
+		eel_nil2v(&R[A]);
 
 	  EEL_ILDC
 		EEL_function *f = o2EEL_function(CALLFRAME->f);
@@ -1647,12 +3090,11 @@ EEL_xno eel_run(EEL_vm *vm)
 		ADDCLEAN(A);
 
 	  EEL_IINITI
-		R[A].classid = EEL_CINTEGER;
-		R[A].integer.v = B;
+		eel_l2v(&R[A], B);
 		ADDCLEAN(A);
 
 	  EEL_IINITNIL
-		R[A].classid = EEL_CNIL;
+		eel_nil2v(&R[A]);
 		ADDCLEAN(A);
 
 	  EEL_IINITC
@@ -1666,12 +3108,11 @@ EEL_xno eel_run(EEL_vm *vm)
 
 	  EEL_IASSIGNI
 		eel_v_disown_nz(&R[A]);
-		R[A].classid = EEL_CINTEGER;
-		R[A].integer.v = B;
+		eel_l2v(&R[A], B);
 
 	  EEL_IASNNIL
 		eel_v_disown_nz(&R[A]);
-		R[A].classid = EEL_CNIL;
+		eel_nil2v(&R[A]);
 
 	  EEL_IASSIGNC
 		EEL_function *f = o2EEL_function(CALLFRAME->f);
@@ -1700,15 +3141,14 @@ EEL_xno eel_run(EEL_vm *vm)
 
 	  /* Indexed access (array/table)  */
 	  EEL_IINDGETI
-		switch(R[C].classid)
+		switch(EEL_VCLASS(&R[C]))
 		{
 		  case EEL_COBJREF:
 		  case EEL_CWEAKREF:
 		  {
 			EEL_value i;
-			i.classid = EEL_CINTEGER;
-			i.integer.v = B;
-			XCHECK(eel_o__metamethod(R[C].objref.v,
+			eel_l2v(&i, B);
+			XCHECK(eel_o__metamethod(eel_v2o(&R[C]),
 					EEL_MM_GETINDEX, &i, &R[A]));
 			eel_v_receive(&R[A]);
 			NEXT;
@@ -1718,15 +3158,14 @@ EEL_xno eel_run(EEL_vm *vm)
 		}
 
 	  EEL_IINDSETI
-		switch(R[C].classid)
+		switch(EEL_VCLASS(&R[C]))
 		{
 		  case EEL_CWEAKREF:
 		  case EEL_COBJREF:
 		  {
 			EEL_value i;
-			i.classid = EEL_CINTEGER;
-			i.integer.v = B;
-			XCHECK(eel_o__metamethod(R[C].objref.v,
+			eel_l2v(&i, B);
+			XCHECK(eel_o__metamethod(eel_v2o(&R[C]),
 					EEL_MM_SETINDEX, &i, &R[A]));
 			NEXT;
 		  }
@@ -1735,11 +3174,11 @@ EEL_xno eel_run(EEL_vm *vm)
 		}
 
 	  EEL_IINDGET
-		switch(R[C].classid)
+		switch(EEL_VCLASS(&R[C]))
 		{
 		  case EEL_COBJREF:
 		  case EEL_CWEAKREF:
-			XCHECK(eel_o__metamethod(R[C].objref.v,
+			XCHECK(eel_o__metamethod(eel_v2o(&R[C]),
 					EEL_MM_GETINDEX, &R[B], &R[A]));
 			eel_v_receive(&R[A]);
 			NEXT;
@@ -1748,11 +3187,11 @@ EEL_xno eel_run(EEL_vm *vm)
 		}
 
 	  EEL_IINDSET
-		switch(R[C].classid)
+		switch(EEL_VCLASS(&R[C]))
 		{
 		  case EEL_COBJREF:
 		  case EEL_CWEAKREF:
-			XCHECK(eel_o__metamethod(R[C].objref.v,
+			XCHECK(eel_o__metamethod(eel_v2o(&R[C]),
 					EEL_MM_SETINDEX, &R[B], &R[A]));
 			NEXT;
 		  default:
@@ -1761,11 +3200,26 @@ EEL_xno eel_run(EEL_vm *vm)
 
 	  EEL_IINDGETC
 		EEL_function *f = o2EEL_function(CALLFRAME->f);
-		switch(R[B].classid)
+		switch(EEL_VCLASS(&R[B]))
 		{
 		  case EEL_COBJREF:
 		  case EEL_CWEAKREF:
-			XCHECK(eel_o__metamethod(R[B].objref.v,
+#ifdef EEL_VM_INLINE_CACHE
+			if(eel_v2o(&R[B])->classid == EEL_CTABLE)
+			{
+				EEL_value *v = eel_table_cache_get(
+						eel_v2o(&R[B]),
+						&f->e.constants[C],
+						ICACHE(ABCx));
+				if(v)
+				{
+					eel_v_copy(&R[A], v);
+					eel_v_receive(&R[A]);
+					NEXT;
+				}
+			}
+#endif
+			XCHECK(eel_o__metamethod(eel_v2o(&R[B]),
 					EEL_MM_GETINDEX, &f->e.constants[C],
 					&R[A]));
 			eel_v_receive(&R[A]);
@@ -1776,11 +3230,27 @@ EEL_xno eel_run(EEL_vm *vm)
 
 	  EEL_IINDSETC
 		EEL_function *f = o2EEL_function(CALLFRAME->f);
-		switch(R[B].classid)
+		switch(EEL_VCLASS(&R[B]))
 		{
 		  case EEL_COBJREF:
 		  case EEL_CWEAKREF:
-			XCHECK(eel_o__metamethod(R[B].objref.v,
+#ifdef EEL_VM_INLINE_CACHE
+			if(eel_v2o(&R[B])->classid == EEL_CTABLE)
+			{
+				EEL_value *v = eel_table_cache_get(
+						eel_v2o(&R[B]),
+						&f->e.constants[C],
+						ICACHE(ABCx));
+				if(v)
+				{
+					/* Replace the value of existing item */
+					eel_v_disown_nz(v);
+					eel_v_copy(v, &R[A]);
+					NEXT;
+				}
+			}
+#endif
+			XCHECK(eel_o__metamethod(eel_v2o(&R[B]),
 					EEL_MM_SETINDEX, &f->e.constants[C],
 					&R[A]));
 			NEXT;
@@ -1834,6 +3304,42 @@ EEL_xno eel_run(EEL_vm *vm)
 		arg = vm->heap + CALLFRAME->argv + B;
 		eel_v_disown_nz(arg);
 		eel_v_copy(arg, &R[A]);
+
+	  EEL_IARGINDGETC
+		EEL_function *f = o2EEL_function(CALLFRAME->f);
+		EEL_value *arg;
+		if(B < CALLFRAME->argc)
+			arg = vm->heap + CALLFRAME->argv + B;
+		else if(!(arg = get_optarg_default(CALLFRAME, B)))
+			THROW(EEL_XHIGHINDEX);
+		switch(EEL_VCLASS(arg))
+		{
+		  case EEL_COBJREF:
+		  case EEL_CWEAKREF:
+#ifdef EEL_VM_INLINE_CACHE
+			if(eel_v2o(arg)->classid == EEL_CTABLE)
+			{
+				EEL_value *v = eel_table_cache_get(
+						eel_v2o(arg),
+						&f->e.constants[C],
+						ICACHE(ABCx));
+				if(v)
+				{
+					eel_v_copy(&R[A], v);
+					eel_v_receive(&R[A]);
+					NEXT;
+				}
+			}
+#endif
+			XCHECK(eel_o__metamethod(eel_v2o(arg),
+					EEL_MM_GETINDEX, &f->e.constants[C],
+					&R[A]));
+			eel_v_receive(&R[A]);
+			NEXT;
+		  default:
+			THROW(EEL_XCANTINDEX);
+		}
+
 #if 0
 	  EEL_IGETARG
 		EEL_value *arg;
@@ -2032,9 +3538,23 @@ EEL_xno eel_run(EEL_vm *vm)
 #endif
 	  /* Operators */
 	  EEL_IBOP
+		QUICKENBOP(ABCD, BOP, C, R[B], R[D]);
 		XCHECK(eel_operate(&R[B], C, &R[D], &R[A]));
 		eel_v_receive(&R[A]);
 
+#ifdef EEL_VM_QUICKEN
+	  EEL_QI(BOP_II, ABCD)
+		if((EEL_VCLASS(&R[B]) != EEL_CINTEGER) ||
+				(EEL_VCLASS(&R[D]) != EEL_CINTEGER))
+			UNQUICKEN(ABCD, BOP);
+		quick_op_ii(C, EEL_VINT(&R[B]), EEL_VINT(&R[D]), &R[A]);
+
+	  EEL_QI(BOP_RR, ABCD)
+		if((EEL_VCLASS(&R[B]) != EEL_CREAL) || (EEL_VCLASS(&R[D]) != EEL_CREAL))
+			UNQUICKEN(ABCD, BOP);
+		quick_op_rr(C, EEL_VREAL(&R[B]), EEL_VREAL(&R[D]), &R[A]);
+#endif
+
 	  EEL_IPHBOP
 		CHECK_STACK(1);
 		XCHECK(eel_operate(&R[A], B, &R[C], S));
@@ -2045,40 +3565,88 @@ EEL_xno eel_run(EEL_vm *vm)
 		eel_v_receive(&R[A]);
 
 	  EEL_IBOPS
+		QUICKENBOP(ABCsDx, BOPS, C, R[B], SV[D]);
 		XCHECK(eel_operate(&R[B], C, &SV[D], &R[A]));
 		eel_v_receive(&R[A]);
 
+#ifdef EEL_VM_QUICKEN
+	  EEL_QI(BOPS_II, ABCsDx)
+		if((EEL_VCLASS(&R[B]) != EEL_CINTEGER) ||
+				(EEL_VCLASS(&SV[D]) != EEL_CINTEGER))
+			UNQUICKEN(ABCsDx, BOPS);
+		quick_op_ii(C, EEL_VINT(&R[B]), EEL_VINT(&SV[D]), &R[A]);
+
+	  EEL_QI(BOPS_RR, ABCsDx)
+		if((EEL_VCLASS(&R[B]) != EEL_CREAL) || (EEL_VCLASS(&SV[D]) != EEL_CREAL))
+			UNQUICKEN(ABCsDx, BOPS);
+		quick_op_rr(C, EEL_VREAL(&R[B]), EEL_VREAL(&SV[D]), &R[A]);
+#endif
+
 	  EEL_IIPBOPS
 		XCHECK(eel_ipoperate(&R[B], C, &SV[D], &R[A]));
 		eel_v_receive(&R[A]);
 
 	  EEL_IBOPI
 		EEL_value iv;
-		iv.classid = EEL_CINTEGER;
-		iv.integer.v = D;
+		eel_l2v(&iv, D);
+#ifdef EEL_VM_QUICKEN
+		if(quick_binop(C))
+		{
+			if(EEL_VCLASS(&R[B]) == EEL_CINTEGER)
+				QUICKEN(ABCsDx, BOPI_I);
+			else if(EEL_VCLASS(&R[B]) == EEL_CREAL)
+				QUICKEN(ABCsDx, BOPI_R);
+		}
+#endif
 		XCHECK(eel_operate(&R[B], C, &iv, &R[A]));
 		eel_v_receive(&R[A]);
 
+#ifdef EEL_VM_QUICKEN
+	  EEL_QI(BOPI_I, ABCsDx)
+		if(EEL_VCLASS(&R[B]) != EEL_CINTEGER)
+			UNQUICKEN(ABCsDx, BOPI);
+		quick_op_ii(C, EEL_VINT(&R[B]), D, &R[A]);
+
+	  EEL_QI(BOPI_R, ABCsDx)
+		if(EEL_VCLASS(&R[B]) != EEL_CREAL)
+			UNQUICKEN(ABCsDx, BOPI);
+		quick_op_rr(C, EEL_VREAL(&R[B]), D, &R[A]);
+#endif
+
 	  EEL_IPHBOPI
 		EEL_value iv;
-		iv.classid = EEL_CINTEGER;
-		iv.integer.v = C;
+		eel_l2v(&iv, C);
 		CHECK_STACK(1);
 		XCHECK(eel_operate(&R[A], B, &iv, S));
 		++vm->sp;
 
 	  EEL_IIPBOPI
 		EEL_value iv;
-		iv.classid = EEL_CINTEGER;
-		iv.integer.v = D;
+		eel_l2v(&iv, D);
 		XCHECK(eel_ipoperate(&R[B], C, &iv, &R[A]));
 		eel_v_receive(&R[A]);
 
 	  EEL_IBOPC
 		EEL_function *f = o2EEL_function(CALLFRAME->f);
+		QUICKENBOP(ABCDx, BOPC, C, R[B], f->e.constants[D]);
 		XCHECK(eel_operate(&R[B], C, &f->e.constants[D], &R[A]));
 		eel_v_receive(&R[A]);
 
+#ifdef EEL_VM_QUICKEN
+	  EEL_QI(BOPC_II, ABCDx)
+		EEL_function *f = o2EEL_function(CALLFRAME->f);
+		if(EEL_VCLASS(&R[B]) != EEL_CINTEGER)
+			UNQUICKEN(ABCDx, BOPC);
+		quick_op_ii(C, EEL_VINT(&R[B]), EEL_VINT(&f->e.constants[D]),
+				&R[A]);
+
+	  EEL_QI(BOPC_RR, ABCDx)
+		EEL_function *f = o2EEL_function(CALLFRAME->f);
+		if(EEL_VCLASS(&R[B]) != EEL_CREAL)
+			UNQUICKEN(ABCDx, BOPC);
+		quick_op_rr(C, EEL_VREAL(&R[B]), EEL_VREAL(&f->e.constants[D]), &R[A]);
+#endif
+
 	  EEL_INEG
 		XCHECK(eel_op_neg(&R[B], &R[A]));
 
@@ -2102,7 +3670,7 @@ EEL_xno eel_run(EEL_vm *vm)
 
 	  EEL_ICAST
 		EEL_value *right = &R[B];
-		switch(right->classid)
+		switch(EEL_VCLASS(right))
 		{
 		  case EEL_CNIL:
 		  case EEL_CREAL:
@@ -2111,9 +3679,9 @@ EEL_xno eel_run(EEL_vm *vm)
 		  case EEL_CCLASSID:
 		  case EEL_COBJREF:
 		  case EEL_CWEAKREF:
-			if(EEL_CCLASSID != R[C].classid)
+			if(EEL_CCLASSID != EEL_VCLASS(&R[C]))
 				THROW(EEL_XWRONGTYPE);
-			XCHECK(eel_cast(vm, right, &R[A], R[C].integer.v));
+			XCHECK(eel_cast(vm, right, &R[A], EEL_VINT(&R[C])));
 			eel_v_receive(&R[A]);
 			NEXT;
 		  default:
@@ -2127,31 +3695,95 @@ EEL_xno eel_run(EEL_vm *vm)
 		XCHECK(eel_op_sizeof(&R[B], &R[A]));
 
 	  EEL_IWEAKREF
-		if(R[B].classid == EEL_CNIL)
-			R[A].classid = EEL_CNIL;
+		if(EEL_VCLASS(&R[B]) == EEL_CNIL)
+			eel_nil2v(&R[A]);
 		else
 		{
-			if(R[B].classid != EEL_COBJREF)
+			if(EEL_VCLASS(&R[B]) != EEL_COBJREF)
 				THROW(EEL_XNEEDOBJECT);
-			eel_o2wr(&R[A], R[B].objref.v);
+			eel_o2wr(&R[A], eel_v2o(&R[B]));
 		}
 
 	  EEL_IADD
+		QUICKEN2(ABC, ADD, R[B], R[C]);
 		XCHECK(eel_op_add(&R[B], &R[C], &R[A]));
 		eel_v_receive(&R[A]);
 
+#ifdef EEL_VM_QUICKEN
+	  EEL_QI(ADD_II, ABC)
+		if((EEL_VCLASS(&R[B]) != EEL_CINTEGER) ||
+				(EEL_VCLASS(&R[C]) != EEL_CINTEGER))
+			UNQUICKEN(ABC, ADD);
+		eel_l2v(&R[A], EEL_VINT(&R[B]) + EEL_VINT(&R[C]));
+
+	  EEL_QI(ADD_RR, ABC)
+		if((EEL_VCLASS(&R[B]) != EEL_CREAL) || (EEL_VCLASS(&R[C]) != EEL_CREAL))
+			UNQUICKEN(ABC, ADD);
+		eel_d2v(&R[A], EEL_VREAL(&R[B]) + EEL_VREAL(&R[C]));
+#endif
+
 	  EEL_ISUB
+		QUICKEN2(ABC, SUB, R[B], R[C]);
 		XCHECK(eel_op_sub(&R[B], &R[C], &R[A]));
 		eel_v_receive(&R[A]);
 
+#ifdef EEL_VM_QUICKEN
+	  EEL_QI(SUB_II, ABC)
+		if((EEL_VCLASS(&R[B]) != EEL_CINTEGER) ||
+				(EEL_VCLASS(&R[C]) != EEL_CINTEGER))
+			UNQUICKEN(ABC, SUB);
+		eel_l2v(&R[A], EEL_VINT(&R[B]) - EEL_VINT(&R[C]));
+
+	  EEL_QI(SUB_RR, ABC)
+		if((EEL_VCLASS(&R[B]) != EEL_CREAL) || (EEL_VCLASS(&R[C]) != EEL_CREAL))
+			UNQUICKEN(ABC, SUB);
+		eel_d2v(&R[A], EEL_VREAL(&R[B]) - EEL_VREAL(&R[C]));
+#endif
+
 	  EEL_IMUL
+		QUICKEN2(ABC, MUL, R[B], R[C]);
 		XCHECK(eel_op_mul(&R[B], &R[C], &R[A]));
 		eel_v_receive(&R[A]);
 
+#ifdef EEL_VM_QUICKEN
+	  EEL_QI(MUL_II, ABC)
+		if((EEL_VCLASS(&R[B]) != EEL_CINTEGER) ||
+				(EEL_VCLASS(&R[C]) != EEL_CINTEGER))
+			UNQUICKEN(ABC, MUL);
+		eel_l2v(&R[A], EEL_VINT(&R[B]) * EEL_VINT(&R[C]));
+
+	  EEL_QI(MUL_RR, ABC)
+		if((EEL_VCLASS(&R[B]) != EEL_CREAL) || (EEL_VCLASS(&R[C]) != EEL_CREAL))
+			UNQUICKEN(ABC, MUL);
+		eel_d2v(&R[A], EEL_VREAL(&R[B]) * EEL_VREAL(&R[C]));
+#endif
+
 	  EEL_IDIV
+		QUICKEN2(ABC, DIV, R[B], R[C]);
 		XCHECK(eel_op_div(&R[B], &R[C], &R[A]));
 		eel_v_receive(&R[A]);
 
+#ifdef EEL_VM_QUICKEN
+	  EEL_QI(DIV_II, ABC)
+		if((EEL_VCLASS(&R[B]) != EEL_CINTEGER) ||
+				(EEL_VCLASS(&R[C]) != EEL_CINTEGER))
+			UNQUICKEN(ABC, DIV);
+		if(!EEL_VINT(&R[C]))
+			THROW(EEL_XDIVBYZERO);
+#  ifdef EEL_PASCAL_IDIV
+		eel_d2v(&R[A], (EEL_real)EEL_VINT(&R[B]) / EEL_VINT(&R[C]));
+#  else
+		eel_l2v(&R[A], EEL_VINT(&R[B]) / EEL_VINT(&R[C]));
+#  endif
+
+	  EEL_QI(DIV_RR, ABC)
+		if((EEL_VCLASS(&R[B]) != EEL_CREAL) || (EEL_VCLASS(&R[C]) != EEL_CREAL))
+			UNQUICKEN(ABC, DIV);
+		if(!EEL_VREAL(&R[C]))
+			THROW(EEL_XDIVBYZERO);
+		eel_d2v(&R[A], EEL_VREAL(&R[B]) / EEL_VREAL(&R[C]));
+#endif
+
 	  EEL_IMOD
 		XCHECK(eel_op_mod(&R[B], &R[C], &R[A]));
 		eel_v_receive(&R[A]);
@@ -2203,101 +3835,37 @@ EEL_xno eel_run(EEL_vm *vm)
 		eel_v_receive(&R[A]);
 
 	  /* Exception handling */
-	  EEL_ITRY
-		EEL_function *f = o2EEL_function(CALLFRAME->f);
-#ifdef EEL_VM_CHECKING
-		if(!EEL_IS_OBJREF(f->e.constants[B].classid))
-			DUMP(EEL_XINTERNAL, "TRY: Try block is not an object!");
-		if(f->e.constants[B].objref.v->classid != EEL_CFUNCTION)
-			DUMP(EEL_XINTERNAL, "TRY: Try block is not a function!");
-		if(!EEL_IS_OBJREF(f->e.constants[A].classid))
-			DUMP(EEL_XINTERNAL, "TRY: Catcher is not an object!");
-		if(f->e.constants[A].objref.v->classid != EEL_CFUNCTION)
-			DUMP(EEL_XINTERNAL, "TRY: Catcher is not a function!");
-#endif
-		DBGK4(printf("TRY passing on result index heap[%d].\n",
-				CALLFRAME->result);)
-		XCHECK(call_eel(vm, f->e.constants[B].objref.v,
-				CALLFRAME->result, 0));
-		reload_context(vm, &vms);
-		CALLFRAME->catcher = f->e.constants[A].objref.v;
-		CALLFRAME->flags |= EEL_CFF_TRYBLOCK;
-
-	  EEL_IUNTRY
-		EEL_function *f = o2EEL_function(CALLFRAME->f);
-#ifdef EEL_VM_CHECKING
-		if(!EEL_IS_OBJREF(f->e.constants[A].classid))
-			DUMP(EEL_XINTERNAL, "UNTRY: Try block is not an object!");
-		if(f->e.constants[A].objref.v->classid != EEL_CFUNCTION)
-			DUMP(EEL_XINTERNAL, "UNTRY: Try block is not a function!");
-#endif
-		DBGK4(printf("UNTRY passing on result index heap[%d].\n",
-				CALLFRAME->result);)
-		XCHECK(call_eel(vm, f->e.constants[A].objref.v,
-				CALLFRAME->result, 0));
-		reload_context(vm, &vms);
-		CALLFRAME->flags |= EEL_CFF_TRYBLOCK | EEL_CFF_UNTRY;
-
 	  EEL_ITHROW
 	        eel_v_disown_nz(&VMP->exception);  /* Free any old object */
 		eel_v_copy(&VMP->exception, &R[A]);
 		DBG5(printf(">>>>>>>>>>> THROW <<<<<<<<<<<\n");)
 		RESCHEDULE;
 
-	  EEL_IRETRY
-#ifdef EEL_VM_CHECKING
-		if(!(CALLFRAME->flags & EEL_CFF_CATCHER))
-			DUMP(EEL_XINTERNAL, "IRETRY used outside catcher!");
-#endif
-	  	clean(vm, CLEANTABLE, 0);
-		limbo_clean(vm, CALLFRAME);
-		vm->base = CALLFRAME->r_base;
-#ifdef EEL_VM_CHECKING
-		if(vm->sp != vm->sbase)
-			DUMP(EEL_XINTERNAL, "RETRY: Garbage in argument stack!");
-#endif
-		vm->sbase = CALLFRAME->r_sbase;
-		vm->sp = CALLFRAME->r_sp;
-		/* Back up and rerun the TRY! */
-		vm->pc = CALLFRAME->r_pc - EEL_OSIZE_AxBx;
-		CALLFRAME = (EEL_callframe *)(vm->heap + vm->base - EEL_CFREGS);
-#ifdef EEL_VM_CHECKING
-		if(!CALLFRAME->f)
-			THROW(EEL_XEND);
-#endif
-		reload_context(vm, &vms);
-
-	  EEL_IRETX
-#ifdef EEL_VM_CHECKING
-		if(vm->sp != vm->sbase)
-			DUMP(EEL_XINTERNAL, "RETX: Garbage left in argument "
-					"stack when leaving block!");
-/*FIXME: Should check the parent function prototype instead! */
-		if(CALLFRAME->result >= 0)
-			DUMP(EEL_XINTERNAL, "RETX (return with no result)"
-					" in function!");
-#endif
-		THROW(EEL_XRETURN);
-
-	  EEL_IRETXR
-#ifdef EEL_VM_CHECKING
-		if(vm->sp != vm->sbase)
-			DUMP(EEL_XINTERNAL, "RETXR: Garbage left in argument "
-					"stack when leaving block!");
-#if 0
-/*FIXME: Should check the parent function prototype instead! */
-		if(CALLFRAME->result < 0)
-			DUMP(EEL_XINTERNAL, "RETXR (return with result)"
-					" in procedure!");
-#endif
-#endif
-		if(CALLFRAME->result >= 0)
+#ifdef EEL_VM_JIT
+	  /* Native code */
+	  EEL_JI
+		EEL_jitstate js;
+		js.r = R;
+		js.args = vm->heap + CALLFRAME->argv;
+		js.argc = CALLFRAME->argc;
+		js.sv = SV;
+		js.ctab = CLEANTABLE;
+		js.slice = &VMP->slice;
+		PC = eel_jit_run(o2EEL_function(CALLFRAME->f)->e.jit, &js, PC);
+		/* Native loops leave when the time slice needs attention */
+		if(VMP->slice <= 0)
 		{
-			DBG6(printf("RETXR copying result from R[%d] to heap[%d]\n",
-					A, CALLFRAME->result);)
-			eel_v_copy(vm->heap + CALLFRAME->result, &R[A]);
+			EEL_xno sx = slice_refill(vm);
+			if(sx)
+				THROW(sx);
 		}
-		THROW(EEL_XRETURN);
+		/*
+		 * If we stopped at an instruction that has native code, it bailed
+		 * out, and we need to run the interpreter version instead.
+		 */
+		if(vms.dcode[PC].op == &&lab_JIT)
+			goto *gtab[(EEL_opcodes)CODE[PC]];
+#endif
 	END
 	/* No exit! */
 }
@@ -2341,6 +3909,85 @@ static void default_free(EEL_vm *vm, void *block)
 	return free(block);
 }
 
+static void *pool_malloc(EEL_vm *vm, int size)
+{
+	return eel_tlsf_malloc(VMP->state->pool, size);
+}
+
+static void *pool_realloc(EEL_vm *vm, void *block, int size)
+{
+	return eel_tlsf_realloc(VMP->state->pool, block, size);
+}
+
+static void pool_free(EEL_vm *vm, void *block)
+{
+	eel_tlsf_free(VMP->state->pool, block);
+}
+
+
+EEL_xno eel_pool_stats(EEL_vm *vm, EEL_poolstats *ps)
+{
+	if(!VMP->state->pool)
+		return EEL_XBADCONTEXT;
+	eel_tlsf_stats(VMP->state->pool, ps);
+	return 0;
+}
+
+
+void eel_get_memstats(EEL_vm *vm, EEL_memstats *ms)
+{
+	int i;
+	long long now = slice_now();
+	double dt = (now - VMP->mstime) * 0.000000001;
+	memset(ms, 0, sizeof(EEL_memstats));
+	for(i = 0; i < VMP->ncstats; ++i)
+	{
+		EEL_classmemstats *cs = VMP->cstats + i;
+		ms->objects += cs->objects;
+		ms->bytes += cs->bytes;
+		ms->allocs += cs->allocs;
+		ms->frees += cs->frees;
+	}
+	if(dt > 0.0)
+	{
+		ms->allocrate = (ms->allocs - VMP->msallocs) / dt;
+		ms->freerate = (ms->frees - VMP->msfrees) / dt;
+	}
+	VMP->mstime = now;
+	VMP->msallocs = ms->allocs;
+	VMP->msfrees = ms->frees;
+
+	ms->strings = VMP->nstrings;
+#ifdef EEL_CACHE_STRINGS
+	ms->cachedstrings = VMP->scache_size;
+#endif
+	ms->stringbytes = VMP->stringbytes;
+
+	ms->heapsize = vm->heapsize;
+	ms->heappeak = VMP->heappeak;
+	ms->valuesize = sizeof(EEL_value);
+
+#ifdef EEL_CYCLE_COLLECTOR
+	ms->cyclecands = VMP->cc.nroots + VMP->cc.ntaken;
+	ms->cyclefrees = VMP->cc.frees;
+#endif
+	ms->deferreditems = VMP->dq.pending;
+}
+
+
+EEL_xno eel_get_classmemstats(EEL_vm *vm, EEL_classes cid,
+		EEL_classmemstats *cms)
+{
+	EEL_state *es = VMP->state;
+	if((cid < 0) || (cid >= es->nclasses) || !es->classes[cid])
+		return EEL_XBADCLASS;
+	if(cid < VMP->ncstats)
+		*cms = VMP->cstats[cid];
+	else
+		memset(cms, 0, sizeof(EEL_classmemstats));
+	return 0;
+}
+
 
 /*----------------------------------------------------------
 	EEL Virtual Machine API
@@ -2355,6 +4002,13 @@ static inline int vm_init(EEL_state *es, EEL_vm *vm, int heap)
 		vm->realloc = es->vm->realloc;
 		vm->free = es->vm->free;
 	}
+	else if(es->pool)
+	{
+		/* Allocate from the memory pool given to eel_open_pool() */
+		vm->malloc = pool_malloc;
+		vm->realloc = pool_realloc;
+		vm->free = pool_free;
+	}
 	else
 	{
 		/* Install default memory manager */
@@ -2378,7 +4032,7 @@ static inline int vm_init(EEL_state *es, EEL_vm *vm, int heap)
 		return -1;
 	}
 	vm->sbase = vm->sp = 1;		/* Leave one register for the result! */
-	vm->heap[vm->base].classid = EEL_CNIL;	/* "Expect no result" mark */
+	eel_nil2v(&vm->heap[vm->base]);	/* "Expect no result" mark */
 	return 0;
 }
 
@@ -2395,6 +4049,18 @@ EEL_vm *eel_vm_open(EEL_state *es, int heap)
 	if(vm_init(es, vm, heap) < 0)
 		return NULL;
 
+#ifdef EEL_VM_PREDECODE
+	/* No context yet, so this just grabs the dispatcher label table. */
+	eel_run(vm);
+#endif
+#ifdef EEL_VM_JIT
+	VMP->jit = 1;
+#endif
+	VMP->slice = EEL_SLICE_NONE;
+	VMP->mstime = slice_now();
+	VMP->mainthread.next = VMP->mainthread.prev = &VMP->mainthread;
+	VMP->thread = &VMP->mainthread;
+
 #ifdef EEL_VM_PROFILING
 	for(i = 0; i < EEL_VMP_POINTS; ++i)
 	{
@@ -2423,6 +4089,18 @@ EEL_vm *eel_vm_open(EEL_state *es, int heap)
 
 void eel_vm_cleanup(EEL_vm *vm)
 {
+	EEL_slicecall *sc;
+	thread_end_all(vm);
+	while((sc = VMP->slicecalls))
+	{
+		VMP->slicecalls = sc->prev;
+		eel_free(vm, sc);
+	}
+	while((sc = VMP->slicepool))
+	{
+		VMP->slicepool = sc->prev;
+		eel_free(vm, sc);
+	}
 	eel_v_disown_nz(&VMP->exception);
 	eel_ps_close(vm);
 }
@@ -2514,10 +4192,43 @@ void eel_vm_close(EEL_vm *vm)
 	printf("|--- -- - - -  -  -\n");
 	printf("|       Opcodes available in VM: %d\n", EEL_O_LAST + 1);
 	printf("|      Opcodes used in this run: %d\n", used);
+	printf("|--- -- - - -  -  -\n");
+	printf("| Most frequent opcode pairs\n");
+	printf("|--- -- - - -  -  -\n");
+	printf("|\tfirst\tsecond\tcount\t(%%)\n");
+	printf("|\t- - - - - - - - - - - - - - - - - - - -\n");
+	for(i = 0; i < 32; ++i)
+	{
+		int j, k;
+		int jmax = 0, kmax = 0;
+		long long cmax = 0;
+		for(j = 0; j <= EEL_O_LAST; ++j)
+			for(k = 0; k <= EEL_O_LAST; ++k)
+				if(VMP->vmpairs[j][k] > cmax)
+				{
+					jmax = j;
+					kmax = k;
+					cmax = VMP->vmpairs[j][k];
+				}
+		if(!cmax)
+			break;
+		printf("|\t%s\t%s\t%lld%s\t%.1f\n",
+				eel_i_name(jmax), eel_i_name(kmax),
+				cmax > 99999 ? cmax / 1000 : cmax,
+				cmax > 99999 ? "k" : "",
+				itotal ? (double)cmax * 100.0f / itotal : 0);
+		VMP->vmpairs[jmax][kmax] = 0;
+	}
 	printf("'----------------------------------"
 			"----------------- -- -- - - -  -  -\n");
 #endif
-	free(vm->heap);
+	free_heap(vm);
+	eel_free(vm, VMP->cstats);
+	eel_defer_close(vm);
+#ifdef EEL_CYCLE_COLLECTOR
+	eel_cc_close(vm);
+#endif
+	eel_slab_close(vm);
 	free(vm);
 }
 
@@ -2529,9 +4240,8 @@ static EEL_object *find_function(EEL_vm *vm, EEL_object *module, const char *nam
 	if(module->classid != EEL_CMODULE)
 		return NULL;
 
-	n.classid = EEL_COBJREF;
-	n.objref.v = eel_ps_new(vm, name);
-	if(!n.objref.v)
+	eel_o2v(&n, eel_ps_new(vm, name));
+	if(!eel_v2o(&n))
 		return NULL;
 
 	x = eel_o__metamethod(module, EEL_MM_GETINDEX, &n, &f);
@@ -2543,14 +4253,14 @@ static EEL_object *find_function(EEL_vm *vm, EEL_object *module, const char *nam
 /*
 FIXME: If modules ever use weakrefs for functions, we need to handle that here!
 */
-	if(f.objref.v->classid != EEL_CFUNCTION)
+	if(eel_v2o(&f)->classid != EEL_CFUNCTION)
 	{
 		eel_v_disown_nz(&f);
 		eel_v_disown_nz(&n);
 		return NULL;
 	}
 	eel_v_disown_nz(&n);
-	return f.objref.v;
+	return eel_v2o(&f);
 }
 
 
@@ -2567,7 +4277,7 @@ static inline void reset_args(EEL_vm *vm)
  */
 	eel_v_disown_nz(vm->heap + vm->base);
 #endif
-	vm->heap[vm->base].classid = EEL_CNIL;
+	eel_nil2v(&vm->heap[vm->base]);
 }
 
 
@@ -2591,41 +4301,35 @@ EEL_xno eel_vargf(EEL_vm *vm, const char *fmt, va_list args)
 			 * We put a 'true' here to tell eel_call() that we
 			 * expect a result! (Anything non-nil will do.)
 			 */
-			vm->heap[vm->base].classid = EEL_CBOOLEAN;;
-			vm->heap[vm->base].integer.v = 1;
+			eel_b2v(&vm->heap[vm->base], 1);
 			*resv = vm->base;
 			break;
 		  }
 		  case 'n':
-			S->classid = EEL_CNIL;
+			eel_nil2v(S);
 			++vm->sp;
 			break;
 		  case 'i':
-			S->classid = EEL_CINTEGER;
-			S->integer.v = va_arg(args, int);
+			eel_l2v(S, va_arg(args, int));
 			++vm->sp;
 			break;
 		  case 'r':
-			S->classid = EEL_CREAL;
-			S->real.v = va_arg(args, EEL_real);
+			eel_d2v(S, va_arg(args, EEL_real));
 			++vm->sp;
 			break;
 		  case 'b':
-			S->classid = EEL_CBOOLEAN;
-			S->integer.v = va_arg(args, int) != 0;
+			eel_b2v(S, va_arg(args, int) != 0);
 			++vm->sp;
 			break;
 		  case 's':
-			S->classid = EEL_COBJREF;
-			S->objref.v = eel_ps_new(vm, va_arg(args, const char *));
-			if(!S->objref.v)
+			eel_o2v(S, eel_ps_new(vm, va_arg(args, const char *)));
+			if(!eel_v2o(S))
 				return EEL_XCONSTRUCTOR;
 			++vm->sp;
 			break;
 		  case 'o':
-			S->classid = EEL_COBJREF;
-			S->objref.v = va_arg(args, EEL_object *);
-			eel_own(S->objref.v);
+			eel_o2v(S, va_arg(args, EEL_object *));
+			eel_own(eel_v2o(S));
 			++vm->sp;
 			break;
 		  case 'v':
@@ -2663,42 +4367,44 @@ static void call_msg(EEL_object *fo, EEL_emtype t, const char *fmt, ...)
 
 static inline EEL_xno call_do_run(EEL_vm *vm)
 {
+	EEL_xno x;
+	/* Nested calls run to completion, even inside eel_run_slice() */
+	int slicing = VMP->slicing;
+	int slice = VMP->slice;
+	VMP->slicing = 0;
+	VMP->slice = 1;		/* Recalculate on the first tick */
+	++VMP->calldepth;
 	while(1)
 	{
-		EEL_xno x = eel_run(vm);
-		switch(x)
-		{
-		  case EEL_XOK:
-		  case EEL_XYIELD:
-			break;
-		  case EEL_XEND:
-			return 0;
-		  default:
-		  case EEL_XCOUNTER:
-			return x;
-		}
+		x = eel_run(vm);
+		if((x == EEL_XOK) || (x == EEL_XYIELD))
+			continue;
+		if(x == EEL_XEND)
+			x = 0;
+		break;
 	}
+	--VMP->calldepth;
+	VMP->slicing = slicing;
+	VMP->slice = slice;
+	return x;
 }
 
-EEL_xno eel_call(EEL_vm *vm, EEL_object *f)
+/*
+ * Check the arguments and enter function 'f'. C functions are run right away;
+ * EEL functions are left for eel_run() to run.
+ */
+static EEL_xno call_setup(EEL_vm *vm, EEL_object *f)
 {
 	EEL_xno x;
-	EEL_function *func;
 	int result;
-/*FIXME:*/
-	int save_resv = vm->resv;
-	int save_argv = vm->argv;
-	int save_argc = vm->argc;
-/*FIXME:*/
 	eel_clear_errors(VMP->state);
 	if(f->classid != EEL_CFUNCTION)
 	{
 		call_msg(f, EEL_EM_VMERROR, "  Object is not callable!");
 		return EEL_XNEEDCALLABLE;
 	}
-	func = o2EEL_function(f);
 
-	DBG4C(printf("---------- eel_call(%s) ----------\n", eel_o2s(func->common.name));)
+	DBG4C(printf("---------- eel_call(%s) ----------\n", eel_o2s(o2EEL_function(f)->common.name));)
 	x = check_args(vm, f);
 	if(x)
 	{
@@ -2720,35 +4426,40 @@ EEL_xno eel_call(EEL_vm *vm, EEL_object *f)
 		}
 		call_msg(f, EEL_EM_VMERROR, s);
 		reset_args(vm);
-/*FIXME:*/
-		vm->resv = save_resv;
-		vm->argv = save_argv;
-		vm->argc = save_argc;
-/*FIXME:*/
 		return x;
 	}
 
 	/* Enter function */
-	if(vm->heap[vm->base].classid != EEL_CNIL)
+	if(EEL_VCLASS(&vm->heap[vm->base]) != EEL_CNIL)
 		result = vm->base;
 	else
 		result = -1;
 	x = call_f(vm, f, result, 0);
-	if(!x)
-	{
-		/* If it's an EEL function, we actually need to *run* it...! */
-		if(!(func->common.flags & EEL_FF_CFUNC))
-		{
-			x = call_do_run(vm);
-			if(x)
-				call_msg(f, EEL_EM_VMERROR, "  Function "
-						"aborted with exception %s",
-						eel_x_name(vm, x));
-		}
-	}
-	else
+	if(x)
 		call_msg(f, EEL_EM_VMERROR, "  Exception %s was thrown.",
 				eel_x_name(vm, x));
+	return x;
+}
+
+EEL_xno eel_call(EEL_vm *vm, EEL_object *f)
+{
+	EEL_xno x;
+/*FIXME:*/
+	int save_resv = vm->resv;
+	int save_argv = vm->argv;
+	int save_argc = vm->argc;
+/*FIXME:*/
+	x = call_setup(vm, f);
+
+	/* If it's an EEL function, we actually need to *run* it...! */
+	if(!x && !(o2EEL_function(f)->common.flags & EEL_FF_CFUNC))
+	{
+		x = call_do_run(vm);
+		if(x)
+			call_msg(f, EEL_EM_VMERROR, "  Function "
+					"aborted with exception %s",
+					eel_x_name(vm, x));
+	}
 /*FIXME:*/
 	vm->resv = save_resv;
 	vm->argv = save_argv;
@@ -2758,6 +4469,87 @@ EEL_xno eel_call(EEL_vm *vm, EEL_object *f)
 }
 
 
+/* Restore the registers saved by eel_begin_call(), and recycle 'sc' */
+static void slicecall_end(EEL_vm *vm, EEL_slicecall *sc)
+{
+	vm->resv = sc->resv;
+	vm->argv = sc->argv;
+	vm->argc = sc->argc;
+	sc->prev = VMP->slicepool;
+	VMP->slicepool = sc;
+}
+
+
+EEL_xno eel_begin_call(EEL_vm *vm, EEL_object *f)
+{
+	EEL_xno x;
+	EEL_slicecall *sc = VMP->slicepool;
+	if(sc)
+		VMP->slicepool = sc->prev;
+	else if(!(sc = (EEL_slicecall *)eel_malloc(vm,
+			sizeof(EEL_slicecall))))
+	{
+		reset_args(vm);
+		return EEL_XMEMORY;
+	}
+	sc->depth = VMP->calldepth;
+	sc->resv = vm->resv;
+	sc->argv = vm->argv;
+	sc->argc = vm->argc;
+	x = call_setup(vm, f);
+	if(x || (o2EEL_function(f)->common.flags & EEL_FF_CFUNC))
+	{
+		/* Failed, or C function; nothing left to run */
+		slicecall_end(vm, sc);
+		return x;
+	}
+	sc->prev = VMP->slicecalls;
+	VMP->slicecalls = sc;
+	return 0;
+}
+
+
+EEL_xno eel_run_slice(EEL_vm *vm, int budget, long long max_ns)
+{
+	EEL_xno x;
+	EEL_slicecall *sc = VMP->slicecalls;
+	/* We may be inside a C function called from another slice */
+	int slicing = VMP->slicing;
+	int slice = VMP->slice;
+	int sliceticks = VMP->sliceticks;
+	long long slicedeadline = VMP->slicedeadline;
+	if(!sc || (sc->depth != VMP->calldepth))
+		return 0;	/* No call begun at this level */
+	VMP->slicing = 1;
+	VMP->sliceticks = budget > 0 ? budget : -1;
+	VMP->slicedeadline = max_ns > 0 ? slice_now() + max_ns : 0;
+	++VMP->calldepth;
+	if(slice_refill(vm) == EEL_XCOUNTER)
+		x = EEL_XCOUNTER;
+	else
+		while(1)
+		{
+			x = eel_run(vm);
+			if((x == EEL_XOK) || (x == EEL_XYIELD))
+				continue;
+			if(x == EEL_XEND)
+				x = 0;
+			break;
+		}
+	--VMP->calldepth;
+	VMP->slicing = slicing;
+	VMP->slice = slicing ? slice : 1;	/* 1: Recalculate */
+	VMP->sliceticks = sliceticks;
+	VMP->slicedeadline = slicedeadline;
+	if(x != EEL_XCOUNTER)
+	{
+		VMP->slicecalls = sc->prev;
+		slicecall_end(vm, sc);
+	}
+	return x;
+}
+
+
 EEL_xno eel_calln(EEL_vm *vm, EEL_object *m, const char *fn)
 {
 	EEL_xno x;
@@ -2816,6 +4608,31 @@ EEL_xno eel_callnf(EEL_vm *vm, EEL_object *m, const char *fn, const char *fmt, .
 	return x;
 }
 
+
+int eel_set_jit(EEL_vm *vm, int enable)
+{
+#ifdef EEL_VM_JIT
+	int prev = VMP->jit;
+	VMP->jit = enable;
+	if(!enable)
+		eel_jit_free_all(vm);
+	return prev;
+#else
+	return -1;
+#endif
+}
+
+
+EEL_xno eel_reserve_heap(EEL_vm *vm, int values)
+{
+	if(grow_heap(vm, vm->sp + values) < 0)
+		return EEL_XMEMORY;
+	/* Touch it all, so the OS doesn't have to find pages later */
+	memset(vm->heap + vm->sp, 0,
+			(vm->heapsize - vm->sp) * sizeof(EEL_value));
+	return 0;
+}
+
 #if 0
 /*----------------------------------------------------------
 	VM Context Stack
@@ -2842,7 +4659,7 @@ EEL_xno eel_push_vm_context(EEL_vm *vm)
 	vmctx->limbo = VMP->limbo;
 
 	/* Initialize */
-	VMP->exception.classid = EEL_CNIL;
+	eel_nil2v(&VMP->exception);
 	vm->heapsize = 0;
 	vm->heap = NULL;
 	vm_init(VMP->state, vm, EEL_INITHEAP);
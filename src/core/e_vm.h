@@ -25,6 +25,9 @@
 #define	EEL_E_VM_H
 
 #include "e_eel.h"
+#include "e_slab.h"
+#include "e_cycle.h"
+#include "e_defer.h"
 
 
 /*----------------------------------------------------------
@@ -60,8 +63,12 @@
 #define	EEL_IJUMPLE	EEL_I(JUMPLE, ABsCx)	/* If R[A] <= R[B] then PC += sCx; */
 #define	EEL_IJUMPGT	EEL_I(JUMPGT, ABsCx)	/* If R[A] > R[B] then PC += sCx; */
 #define	EEL_IJUMPLT	EEL_I(JUMPLT, ABsCx)	/* If R[A] < R[B] then PC += sCx; */
+#define	EEL_IJUMPZARGI	EEL_I(JUMPZARGI, AsBx)	/* If !args[A] then PC += sBx; */
+#define	EEL_IJUMPNZARGI	EEL_I(JUMPNZARGI, AsBx)	/* If args[A] then PC += sBx; */
 #define	EEL_ISWITCH	EEL_I(SWITCH, ABxsCx)	/* try PC = c[Bx][R[A]]; */
 						/* except PC += sCx; */
+#define	EEL_ISWITCHD	EEL_I(SWITCHD, ABxsCx)	/* PC = c[Bx][R[A]] if in */
+						/* range, else PC += sCx; */
 #define	EEL_IPRELOOP	EEL_I(PRELOOP, ABCsDx)
 			/* R[A, B, C] = (real)R[A, B, C];
 			 * if R[B] < 0 then
@@ -76,6 +83,14 @@
 			 * else
 			 *	if R[A] <= R[C] PC += sDx;
 			 */
+#define	EEL_IIPRELOOP	EEL_I(IPRELOOP, ABCsDx)
+			/* PRELOOP for integer R[A, B, C]. (Casts
+			 * to real, like PRELOOP, if they're not.)
+			 */
+#define	EEL_IILOOP	EEL_I(ILOOP, ABCsDx)
+			/* LOOP for integer R[A, B, C]. (Loops
+			 * like LOOP if any of them is real.)
+			 */
 
 /* Argument stack operations */
 #define	EEL_IPUSH	EEL_I(PUSH, A)		/* push R[A]; */
@@ -94,6 +109,15 @@
 #define	EEL_IPHUVAL	EEL_I(PHUVAL, AB)	/* push R[A] B levels up; */
 #define	EEL_IPHARGS	EEL_I(PHARGS, 0)	/* push args[]; */
 #define	EEL_IPUSHTUP	EEL_I(PUSHTUP, 0)	/* push tupargs[]; */
+#define	EEL_IPUSHA	EEL_I(PUSHA, A)		/* push R[A][]; */
+#define	EEL_IPUSHAS	EEL_I(PUSHAS, ABC)
+			/* push R[A][B..B + C - 1]; (C == 0 means "to the
+			 * end".)
+			 */
+#define	EEL_IPUSHASR	EEL_I(PUSHASR, ABC)
+			/* push R[A][R[B]..R[B] + R[C] - 1]; (R[C] nil or
+			 * negative means "to the end".)
+			 */
 
 /* Function calls */
 #define	EEL_ICALL	EEL_I(CALL, A)
@@ -117,8 +141,47 @@
 			 * a local function, or that the function called does
 			 * not use upvalues.
 			 */
+#define	EEL_ITAILCALL	EEL_I(TAILCALL, AB)
+			/* As CALLR, but if the object called is an EEL
+			 * function that does not use upvalues, it replaces
+			 * the current call frame, returning directly to our
+			 * caller. Always followed by RETURNR R[B].
+			 */
+#define	EEL_ICTAILCALL	EEL_I(CTAILCALL, ABCx)
+			/* As CCALLR, with the tail call logic of TAILCALL.
+			 * Always followed by RETURNR R[B].
+			 */
+#define	EEL_ICALLRW	EEL_I(CALLRW, ABC)
+			/* Call object referred to by R[A], with the C
+			 * arguments R[B]..R[B + C - 1]. C functions read the
+			 * arguments in place, without copying them to the
+			 * argument stack.
+			 */
+#define	EEL_ICALLRWR	EEL_I(CALLRWR, ABCD)
+			/* As CALLRW, with R[B] being the result register and
+			 * the D arguments R[C]..R[C + D - 1].
+			 */
+#define	EEL_ICCALLRW	EEL_I(CCALLRW, ABCx)
+			/* Call func c[Cx] with the B arguments
+			 * R[A]..R[A + B - 1]. Only for functions that do not
+			 * use upvalues.
+			 */
+#define	EEL_ICCALLRWR	EEL_I(CCALLRWR, ABCDx)
+			/* Call func c[Dx] with R[A] being the result register
+			 * and the C arguments R[B]..R[B + C - 1].
+			 */
+#define	EEL_ITAILCALLRW	EEL_I(TAILCALLRW, ABCD)
+			/* As CALLRWR, with the tail call logic of TAILCALL.
+			 * Always followed by RETURNR R[B].
+			 */
 #define	EEL_IRETURN	EEL_I(RETURN, 0)	/* Clean up and return. */
 #define	EEL_IRETURNR	EEL_I(RETURNR, A)	/* result = R[A]; CLEAN; RETURN; */
+#define	EEL_IYIELD	EEL_I(YIELD, A)
+			/* Hand R[A] to the code resuming the running generator,
+			 * and suspend the generator right after this
+			 * instruction. Throws XBADCONTEXT if there is no
+			 * generator to suspend at this call depth.
+			 */
 
 /* Memory management */
 #define	EEL_ICLEAN	EEL_I(CLEAN, A)		/* Clean variables [A..top] */
@@ -176,6 +239,7 @@
 #define	EEL_IPHARGI	EEL_I(PHARGI, A)	/* push args[A]; */
 #define	EEL_IPHARGI2	EEL_I(PHARGI2, AB)	/* push args[A]; push args[B]; */
 #define	EEL_ISETARGI	EEL_I(SETARGI, AB)	/* args[B] = R[A]; */
+#define	EEL_IARGINDGETC	EEL_I(ARGINDGETC, ABCx)	/* R[A] = args[B][c[Cx]]; */
 #if 0
 #define	EEL_IGETARG	EEL_I(GETARG, AB)	/* R[A] = args[R[B]]; */
 #define	EEL_ISETARG	EEL_I(SETARG, AB)	/* args[R[B]] = R[A]; */
@@ -240,31 +304,14 @@
 			/* R[A] = instance of type B from argument stack */
 #define	EEL_ICLONE	EEL_I(CLONE, AB)	/* R[A] = clone of R[B]; */
 
-/* Exception handling */
-#define	EEL_ITRY	EEL_I(TRY, AxBx)
-			/* Call try block function c[Bx], using function c[Ax]
-			 * as exception catcher. The try block function can have
-			 * no arguments and no return value. Nor can the catcher
-			 * function, but it gets the exception value in R[0]
-			 * (read only!) when called. If the exception value is
-			 * an object, it will be in in the limbo list, as if
-			 * returned from the try block function.
-			 */
-#define	EEL_IUNTRY	EEL_I(UNTRY, Ax)
-			/* Call try block function c[Ax], dumping on any
-			 * exception, even if we're in an outer try block. The
-			 * try block function can have no arguments and no
-			 * return value.
-			 */
+/*
+ * Exception handling
+ *	There are no instructions for entering or leaving 'try' blocks. Each
+ *	function has a table of exception handling regions (EEL_xregion), that
+ *	the VM looks at only when an exception is actually thrown. 'retry' is
+ *	just a CLEAN and a JUMP back to the start of the 'try' block.
+ */
 #define	EEL_ITHROW	EEL_I(THROW, A)		/* Throw R[A] as an exception */
-#define	EEL_IRETRY	EEL_I(RETRY, 0)
-			/* Clean up and return from an exception catcher,
-			 * adjusting pc to rerun the TRY instruction that
-			 * invoked it. Of course, all hell will break lose if
-			 * this is used in a normal function!
-			 */
-#define	EEL_IRETX	EEL_I(RETX, 0)		/* THROW XRETURN; */
-#define	EEL_IRETXR	EEL_I(RETXR, A)		/* result = R[A]; THROW XRETURN; */
 
 /*
  * List of all instruction macros (define EEL_I(name,args) first!)
@@ -272,13 +319,20 @@
 #define	EEL_INSTRUCTIONS						\
 	EEL_IILLEGAL	EEL_INOP					\
 	EEL_IJUMP	EEL_IJUMPZ	EEL_IJUMPNZ	EEL_ISWITCH	\
-	EEL_IPRELOOP	EEL_ILOOP					\
+	EEL_ISWITCHD							\
+	EEL_IJUMPEQ	EEL_IJUMPNE	EEL_IJUMPGE	EEL_IJUMPLE	\
+	EEL_IJUMPGT	EEL_IJUMPLT	EEL_IJUMPZARGI	EEL_IJUMPNZARGI	\
+	EEL_IPRELOOP	EEL_ILOOP	EEL_IIPRELOOP	EEL_IILOOP	\
 	EEL_IPUSH	EEL_IPUSH2	EEL_IPUSH3	EEL_IPUSH4	\
 	EEL_IPUSHI	EEL_IPHTRUE	EEL_IPHFALSE	EEL_IPUSHNIL	\
 	EEL_IPUSHC	EEL_IPUSHC2	EEL_IPUSHIC	EEL_IPUSHCI	\
 	EEL_IPHVAR	EEL_IPHUVAL	EEL_IPUSHTUP	EEL_IPHARGS	\
+	EEL_IPUSHA	EEL_IPUSHAS	EEL_IPUSHASR			\
 	EEL_ICALL	EEL_ICALLR	EEL_ICCALL	EEL_ICCALLR	\
-	EEL_IRETURN	EEL_IRETURNR					\
+	EEL_ITAILCALL	EEL_ICTAILCALL					\
+	EEL_ICALLRW	EEL_ICALLRWR	EEL_ICCALLRW	EEL_ICCALLRWR	\
+	EEL_ITAILCALLRW							\
+	EEL_IRETURN	EEL_IRETURNR	EEL_IYIELD			\
 	EEL_ICLEAN							\
 	EEL_IARGC	EEL_ITUPC	EEL_ISPEC	EEL_ITSPEC	\
 	EEL_ILDI	EEL_ILDTRUE	EEL_ILDFALSE	EEL_ILDNIL	\
@@ -291,6 +345,7 @@
 	EEL_IINDSETI	EEL_IINDGETI	EEL_IINDSET	EEL_IINDGET	\
 	EEL_IINDSETC	EEL_IINDGETC					\
 	EEL_IGETARGI	EEL_IPHARGI	EEL_IPHARGI2	EEL_ISETARGI	\
+	EEL_IARGINDGETC							\
 	EEL_IGETTARGI	EEL_IGETUVARGI	EEL_ISETUVARGI	EEL_IGETUVTARGI	\
 	EEL_IBOP	EEL_IPHBOP	EEL_IIPBOP			\
 	EEL_IBOPS	EEL_IIPBOPS					\
@@ -304,10 +359,9 @@
 	EEL_IPHADD	EEL_IPHSUB	EEL_IPHMUL	EEL_IPHDIV	\
 	EEL_IPHMOD	EEL_IPHPOWER					\
 	EEL_INEW	EEL_ICLONE					\
-	EEL_ITRY	EEL_IUNTRY	EEL_ITHROW	EEL_IRETRY	\
-	EEL_IRETX	EEL_IRETXR
+	EEL_ITHROW
 
-#define	EEL_I_LAST	EEL_IRETXR
+#define	EEL_I_LAST	EEL_ITHROW
 
 
 /*
@@ -446,6 +500,107 @@ typedef enum EEL_opcodes
 #undef EEL_I
 
 
+#ifdef EEL_VM_JIT
+/* Native code of an EEL function. (See e_jit.h.) */
+typedef struct EEL_jitcode EEL_jitcode;
+#endif
+
+/* Suspended function call; see eel__gen_init() */
+typedef struct EEL_generator EEL_generator;
+
+/*
+ * Pre-decoded instructions (EEL_VM_PREDECODE)
+ *
+ *	The pre-decoded code of a function is an array with one entry per
+ *	byte of byte code, so that it can be indexed directly by the PC. Only
+ *	entries at instruction boundaries are valid; the rest point at the
+ *	ILLEGAL instruction.
+ *
+ *	Operands are stored as raw 8 or 16 bit fields. The EEL_DOPR_* macros
+ *	declare the same variables, with the same types and values, as the
+ *	corresponding EEL_OPR_* macros.
+ */
+typedef struct EEL_dinstruction
+{
+	const void	*op;		/* Address of implementation */
+	EEL_uint16	a, b, c, d;	/* Operands */
+} EEL_dinstruction;
+
+#define	EEL_DOPR_0(di)
+
+#define	EEL_DOPR_A(di)			\
+	unsigned A = (di)->a;
+
+#define	EEL_DOPR_Ax(di)			\
+	unsigned A = (di)->a;
+
+#define	EEL_DOPR_AB(di)			\
+	unsigned A = (di)->a;		\
+	unsigned B = (di)->b;
+
+#define	EEL_DOPR_ABC(di)		\
+	unsigned A = (di)->a;		\
+	unsigned B = (di)->b;		\
+	unsigned C = (di)->c;
+
+#define	EEL_DOPR_ABCD(di)		\
+	unsigned A = (di)->a;		\
+	unsigned B = (di)->b;		\
+	unsigned C = (di)->c;		\
+	unsigned D = (di)->d;
+
+#define	EEL_DOPR_sAx(di)		\
+	int A = (EEL_int16)(di)->a;
+
+#define	EEL_DOPR_ABx(di)		\
+	unsigned A = (di)->a;		\
+	unsigned B = (di)->b;
+
+#define	EEL_DOPR_AsBx(di)		\
+	unsigned A = (di)->a;		\
+	int B = (EEL_int16)(di)->b;
+
+#define	EEL_DOPR_AxBx(di)		\
+	unsigned A = (di)->a;		\
+	unsigned B = (di)->b;
+
+#define	EEL_DOPR_AxsBx(di)		\
+	unsigned A = (di)->a;		\
+	unsigned B = (EEL_int16)(di)->b;
+
+#define	EEL_DOPR_ABCx(di)		\
+	unsigned A = (di)->a;		\
+	unsigned B = (di)->b;		\
+	unsigned C = (di)->c;
+
+#define	EEL_DOPR_ABsCx(di)		\
+	unsigned A = (di)->a;		\
+	unsigned B = (di)->b;		\
+	int C = (EEL_int16)(di)->c;
+
+#define	EEL_DOPR_ABxCx(di)		\
+	unsigned A = (di)->a;		\
+	unsigned B = (di)->b;		\
+	unsigned C = (di)->c;
+
+#define	EEL_DOPR_ABxsCx(di)		\
+	unsigned A = (di)->a;		\
+	unsigned B = (di)->b;		\
+	int C = (EEL_int16)(di)->c;
+
+#define	EEL_DOPR_ABCDx(di)		\
+	unsigned A = (di)->a;		\
+	unsigned B = (di)->b;		\
+	unsigned C = (di)->c;		\
+	unsigned D = (di)->d;
+
+#define	EEL_DOPR_ABCsDx(di)		\
+	unsigned A = (di)->a;		\
+	unsigned B = (di)->b;		\
+	unsigned C = (di)->c;		\
+	int D = (EEL_int16)(di)->d;
+
+
 /*----------------------------------------------------------
 	EEL Virtual Machine
 ----------------------------------------------------------*/
@@ -481,17 +636,14 @@ typedef enum EEL_opcodes
  *	  ..	    pc		Previous PC
  *	 R[-1]	    base	Previous register base
  *		    f		Current function
- *		    upvalues	Frame that contains the
- *				"nearest level" upvalues.
+ *		    upvalues	Display; frames that contain
+ *				the upvalues of the nearest
+ *				EEL_UV_DISPLAY levels.
  *		    result	Heap index of result
  *		    limbo	Linked list of new objects to
  *				check when leaving.
  *		    cleantab	Table of registers (variables)
  *				to clean when leaving.
- *		    catcher	Function to handle exceptions
- *				from functions called from here.
- *				('try' and 'except' blocks are
- *				actually functions.)
  *	R[0]		<Work registers start here!>
  *	  ..
  *	 R[m-1]
@@ -535,18 +687,19 @@ typedef enum EEL_opcodes
  *	(This will likely change in future versions.)
  *	   By means of the 'upvalues' field, it is still
  *	possible for functions to access their upvalues when
- *	called from within other functions (including try and
- *	except blocks) declared on the same or lower nesting
- *	level. 'upvalues' is essentially a shortcut through
- *	the callframe chain up to the "home" level register
- *	frame of the function.
+ *	called from within other functions declared on the
+ *	same or lower nesting level. 'upvalues' is essentially
+ *	a shortcut through the callframe chain up to the "home"
+ *	level register frame of the function.
+ *	   upvalues[0] is the level 1 frame, and upvalues[n]
+ *	is upvalues[n - 1] of the level 1 frame, so that a
+ *	frame holds the bases of the EEL_UV_DISPLAY nearest
+ *	levels, and any of them can be reached in one step.
+ *	The display is copied in push_frame(), and redone by
+ *	call_eel() for functions called at an outer level.
+ *	Entries beyond the root frame are -1.
  */
 
-/* For 'flags' */
-#define	EEL_CFF_TRYBLOCK	0x00000001
-#define	EEL_CFF_CATCHER		0x00000002
-#define	EEL_CFF_UNTRY		0x00000004
-
 typedef struct
 {
 	/* Return info */
@@ -567,11 +720,7 @@ typedef struct
 	EEL_uint32	argc;		/* Argument count */
 	EEL_int32	result;		/* Heap index of result */
 	EEL_uint32	cleantab;	/* Variables to clean */
-	EEL_int32	upvalues;	/* Upvalue register frame */
-	EEL_uint32	flags;
-
-	/* Exception handling */
-	EEL_object	*catcher;	/* Exception catcher, if any */
+	EEL_int32	upvalues[EEL_UV_DISPLAY];	/* Upvalue display */
 
 #if DBG4E(1)+0 == 1
 #define	EEL_CALLFRAME_MAGIC_EEL	0xca11fee1
@@ -614,6 +763,40 @@ int eel_vm_init_call(EEL_vm *vm, EEL_object *fo, int base);
  */
 int eel_vm_call(EEL_vm *vm, EEL_object *fo);
 
+/*
+ * Start a new microthread, calling EEL function 'f' with the 'argc' arguments
+ * at 'args'. The thread runs when the running thread yields, or has used up
+ * its time quantum.
+ *
+ * Returns 0 and the ID of the new thread in 'id' on success, or an exception
+ * code if there was an error.
+ */
+EEL_xno eel__spawn(EEL_vm *vm, EEL_object *f, EEL_value *args, int argc,
+		int *id);
+
+/* Number of microthreads of 'vm', including the main thread */
+int eel__threads(EEL_vm *vm);
+
+/*
+ * Set up generator 'g' to call EEL function 'f' with the 'argc' arguments at
+ * 'args'. Nothing runs until the generator is resumed.
+ */
+EEL_xno eel__gen_init(EEL_vm *vm, EEL_generator *g, EEL_object *f,
+		EEL_value *args, int argc);
+
+/*
+ * Resume generator 'g', and run it until it yields a value, which is written
+ * to 'result', or returns. If the generator has already returned, 'result' is
+ * set to nil.
+ *
+ * Returns 0 on success, or the exception code if the generator throws.
+ * The generator is done after returning or throwing.
+ */
+EEL_xno eel__gen_resume(EEL_vm *vm, EEL_generator *g, EEL_value *result);
+
+/* Throw away the call stack of suspended generator 'g' */
+void eel__gen_free(EEL_vm *vm, EEL_generator *g);
+
 #ifdef EEL_VM_PROFILING
 /* Vector item representing one VM instruction opcode */
 typedef struct
@@ -642,6 +825,72 @@ typedef enum
 typedef struct EEL_vm_context EEL_vm_context;
 #endif
 
+/*
+ * Microthread
+ *	The parts of EEL_vm that need one instance per thread; the heap with
+ *	the call stack, and the VM registers. The running thread lives in
+ *	EEL_vm, and is saved here while other threads are running.
+ */
+typedef struct EEL_vmthread EEL_vmthread;
+struct EEL_vmthread
+{
+	EEL_vmthread	*next, *prev;	/* Ring of all threads of the VM */
+	int		id;		/* Thread ID; 0 for the main thread */
+	EEL_object	*f;		/* Function the thread is running */
+
+	/* Saved VM state */
+	int		heapsize;
+	EEL_value	*heap;
+#ifdef EEL_VM_SEGHEAP
+	int		heapreserve;
+#endif
+	int		pc;
+	int		base;
+	int		sp;
+	int		sbase;
+	int		resv;
+	int		argv;
+	int		argc;
+};
+
+/*
+ * Generator
+ *	A function call that runs on its own heap, like a microthread, but is
+ *	run by eel__gen_resume() until it executes YIELD, rather than by the
+ *	microthread scheduler. The call stack stays intact while suspended.
+ */
+typedef enum
+{
+	EEL_GS_SUSPENDED = 0,	/* Waiting to be resumed */
+	EEL_GS_RUNNING,		/* Inside eel__gen_resume() */
+	EEL_GS_DONE		/* Returned or threw, heap freed */
+} EEL_genstates;
+
+struct EEL_generator
+{
+	EEL_vmthread	t;		/* Heap and registers when suspended */
+	EEL_genstates	state;		/* EEL_GS_* */
+	EEL_value	*result;	/* Where YIELD puts the value */
+	int		depth;		/* VMP->calldepth while running */
+};
+EEL_MAKE_CAST(EEL_generator)
+
+/*
+ * eel_begin_call() call in progress
+ *	The VM registers of the caller, restored by eel_run_slice() when the
+ *	call returns or fails, as eel_call() does. Calls begun from C functions
+ *	nest, and are matched to eel_run_slice() by call depth.
+ */
+typedef struct EEL_slicecall EEL_slicecall;
+struct EEL_slicecall
+{
+	EEL_slicecall	*prev;
+	int		depth;		/* VMP->calldepth of eel_begin_call() */
+	int		resv;
+	int		argv;
+	int		argc;
+};
+
 typedef struct
 {
 	EEL_state	*state;
@@ -668,16 +917,61 @@ typedef struct
 	int		resurrected;
 	EEL_object	*afirst, *alast;
 #endif
+#ifdef EEL_SLAB_MAXSIZE
+	EEL_slab	slab;		/* Object memory */
+#endif
+#ifdef EEL_CYCLE_COLLECTOR
+	EEL_cycles	cc;		/* Cycle collector */
+#endif
+	EEL_deferqueue	dq;		/* Deferred destruction */
+
+	/* Memory statistics (eel_get_memstats()) */
+	EEL_classmemstats *cstats;	/* Per class, indexed by class ID */
+	int		ncstats;	/* Size of 'cstats' */
+	int		heappeak;	/* Largest heap size so far, in values */
+	int		nstrings;	/* Strings in the pool */
+	long long	stringbytes;	/* Size of pooled string buffers */
+	long long	mstime;		/* Time of last eel_get_memstats() */
+	long long	msallocs;	/* Objects created at 'mstime' */
+	long long	msfrees;	/* Objects destroyed at 'mstime' */
 
 #ifdef EEL_VM_CHECKING
 	int		weakrefs;	/* Number of weakrefs in heap */
 #endif
+#ifdef EEL_VM_SEGHEAP
+	int		heapreserve;	/* # of values of address space reserved */
+#endif
 #if DBG6B(1)+0 == 1
 	int		instructions;	/* # of VM instructions executed */
 #endif
 
 	int		is_closing;	/* Are we destroying the state? */
 
+#ifdef EEL_VM_PREDECODE
+	const void * const *itab;	/* Opcode ==> label LUT of eel_run() */
+#endif
+
+#ifdef EEL_VM_JIT
+	int		jit;		/* Native code enabled */
+	const void	*jitop;		/* Native code entry label of eel_run() */
+	EEL_jitcode	*jitcodes;	/* All native code compiled by this VM */
+#endif
+
+	/* Microthreads */
+	EEL_vmthread	mainthread;	/* Thread of the host application */
+	EEL_vmthread	*thread;	/* Running thread */
+	int		lastthread;	/* Last thread ID handed out */
+	int		calldepth;	/* eel_call() etc nesting depth */
+	EEL_generator	*generator;	/* Running generator, if any */
+
+	/* Time slicing (eel_run_slice()) */
+	int		slice;		/* Ticks left until the next check */
+	int		slicing;	/* In eel_run_slice() */
+	int		sliceticks;	/* Ticks left after 'slice', or -1 */
+	long long	slicedeadline;	/* Deadline (slice_now()), or 0 */
+	EEL_slicecall	*slicecalls;	/* eel_begin_call() calls in progress */
+	EEL_slicecall	*slicepool;	/* Free EEL_slicecall structs */
+
 #ifdef	EEL_PROFILING
 	EEL_object	*p_current;	/* Currently running function */
 	long long	p_time;		/* Time of entering p_current */
@@ -687,6 +981,8 @@ typedef struct
 	int		vmp_overhead;	/* Profiling overhead correction */
 	EEL_opcodes	vmp_opcode;	/* Opcode currently being timed */
 	EEL_vmpentry	vmprof[EEL_VMP_POINTS];
+	EEL_opcodes	vmp_prev;	/* Previously dispatched opcode */
+	long long	vmpairs[EEL_O_LAST + 1][EEL_O_LAST + 1];
 #endif
 } EEL_vm_private;
 
@@ -705,6 +1001,21 @@ static inline EEL_object *eel__current_function(EEL_vm *vm)
 	return cf->f;
 }
 
+
+/*
+ * Hand the 'count' items at 'items' of a table or array of class 'cid' over
+ * to the deferred destruction queue, if enabled, and if there are enough of
+ * them. Returns 1 if the items were queued, and should be forgotten by the
+ * caller, or 0 if the caller should release them right away.
+ */
+static inline int eel_defer(EEL_vm *vm, EEL_classes cid, void *items,
+		int count)
+{
+	if(!VMP->dq.min || (count < VMP->dq.min))
+		return 0;
+	return eel_defer_queue(vm, cid, items, count);
+}
+
 #ifdef EEL_VM_CHECKING
 # define	EEL_IN_HEAP(vm, v)					\
 		((v >= vm->heap) && (v < vm->heap + vm->heapsize))
@@ -23,6 +23,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "EEL.h"
 #include "e_function.h"
@@ -51,9 +52,9 @@ static EEL_xno find_function(EEL_object *m, const char *name,
 	EEL_value f;
 	if((x = eel_getsindex(m, name, &f)))
 		return x;
-	if(f.objref.v->classid != EEL_CFUNCTION)
+	if(eel_v2o(&f)->classid != EEL_CFUNCTION)
 		return EEL_XWRONGTYPE;
-	*fo = f.objref.v;
+	*fo = eel_v2o(&f);
 	eel_disown(*fo); /* Not going away until the module is unloaded... */
 	return EEL_XOK;
 }
@@ -100,6 +101,8 @@ static void usage(const char *exename)
 			exename);
 	fprintf(stderr, "| Switches:  -c        Compile only; don't run\n");
 	fprintf(stderr, "|            -e        Fail on compiler warnings\n");
+	fprintf(stderr, "|            -i        Interpret only; no native code\n");
+	fprintf(stderr, "|            -m <MB>   Run from a fixed size memory pool\n");
 #if 0
 	fprintf(stderr, "|            -o <file> Write binary to \"file\"\n");
 #endif
@@ -154,7 +157,10 @@ int main(int argc, const char *argv[])
 	int resv = -1;
 	int flags = 0;
 	int run = 1;
+	int jit = 1;
 	int readstdin = 0;
+	int poolmb = 0;
+	void *pool = NULL;
 #ifdef MAIN_AUTOSTART
 	const char *defname = "main";
 	const char *name = defname;
@@ -205,6 +211,27 @@ int main(int argc, const char *argv[])
 			  case 'e':
 				flags |= EEL_SF_WERROR;
 				break;
+			  case 'i':
+				jit = 0;
+				break;
+			  case 'm':
+				if(i + 1 >= argc)
+				{
+					fprintf(stderr, "No memory pool "
+							"size!\n");
+					usage(argv[0]);
+				}
+				++i;
+				poolmb = atoi(argv[i]);
+				if(poolmb < 1 || poolmb > 2047)
+				{
+					fprintf(stderr, "Memory pool size must "
+							"be 1 through 2047 MB!\n");
+					usage(argv[0]);
+				}
+				/* Done with this argument! */
+				j = strlen(argv[i]) - 1;
+				break;
 			  case 'l':
 				flags |= EEL_SF_LIST;
 				break;
@@ -237,13 +264,26 @@ int main(int argc, const char *argv[])
 	}
 
 	/* Init the EEL engine */
-	vm = eel_open(argc, argv);
+	if(poolmb > 0)
+	{
+		pool = malloc(poolmb * 1024 * 1024);
+		if(!pool)
+		{
+			fprintf(stderr, "Could not allocate memory pool!\n");
+			return 2;
+		}
+		vm = eel_open_pool(argc, argv, pool, poolmb * 1024 * 1024);
+	}
+	else
+		vm = eel_open(argc, argv);
 	if(!vm)
 	{
 		eel_perror(NULL, 1);
 		fprintf(stderr, "Could not initialize EEL!\n");
 		return 2;
 	}
+	if(!jit)
+		eel_set_jit(vm, 0);
 
 	/* Install system module */
 	if(eel_system_init(vm, argc, argv))
@@ -413,7 +453,18 @@ int main(int argc, const char *argv[])
 	/* Clean up */
 	if(m)
 		eel_disown(m);
+	if(pool)
+	{
+		EEL_poolstats ps;
+		if(!eel_pool_stats(vm, &ps))
+			fprintf(stderr, "Memory pool: %d of %d bytes used, "
+					"peak %d, %d failed allocations, "
+					"fragmentation %.2f\n", ps.used,
+					ps.size, ps.peak, ps.fails,
+					ps.fragmentation);
+	}
 	eel_close(vm);
+	free(pool);
 #ifdef EEL_HAVE_EELIUM
 	eelium_close_subsystems();
 #endif
@@ -90,15 +90,15 @@ static EEL_xno d_getindex(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 {
 	EEL_directory_cd *cd = (EEL_directory_cd *)eel_get_classdata(eo->vm,
 			eo->classid);
-	if(!EEL_IS_OBJREF(op1->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(op1)))
 		return EEL_XWRONGINDEX;
-	if(op1->objref.v == cd->i_read)
+	if(eel_v2o(op1) == cd->i_read)
 	{
 		eel_own(cd->read);
 		eel_o2v(op2, cd->read);
 		return 0;
 	}
-	if(op1->objref.v == cd->i_close)
+	if(eel_v2o(op1) == cd->i_close)
 	{
 		eel_own(cd->close);
 		eel_o2v(op2, cd->close);
@@ -117,7 +117,7 @@ static EEL_xno d_read(EEL_vm *vm)
 	struct dirent *de;
 	if(EEL_CLASS(arg) != md->dir_cid)
 		return EEL_XWRONGTYPE;
-	d = o2EEL_directory(arg->objref.v);
+	d = o2EEL_directory(eel_v2o(arg));
 	if(!d->handle)
 		return EEL_XFILECLOSED;
 	errno = 0;
@@ -144,7 +144,7 @@ static EEL_xno d_close(EEL_vm *vm)
 	EEL_directory *d;
 	if(EEL_CLASS(arg) != md->dir_cid)
 		return EEL_XWRONGTYPE;
-	d = o2EEL_directory(arg->objref.v);
+	d = o2EEL_directory(eel_v2o(arg));
 	closedir(d->handle);
 	d->handle = NULL;
 	return 0;
@@ -29,6 +29,8 @@ struct kiss_fft_state{
     int nfft;
     int inverse;
     int factors[2*MAXFACTORS];
+    kiss_fft_cpx * tmpbuf;      /* nfft items, for in-place transforms */
+    kiss_fft_cpx * scratchbuf;  /* largest radix items, for kf_bfly_generic() */
     kiss_fft_cpx twiddles[1];
 };
 
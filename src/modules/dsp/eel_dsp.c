@@ -204,7 +204,7 @@ static EEL_xno do_sum(EEL_vm *vm, int *count)
 	  default:
 		return EEL_XWRONGTYPE;
 	}
-	vec = o2EEL_vector(args[0].objref.v);
+	vec = o2EEL_vector(eel_v2o(&args[0]));
 
 	if(!vec->length)
 	{
@@ -299,7 +299,8 @@ static EEL_xno dsp_average(EEL_vm *vm)
 	int count;
 	EEL_xno x = do_sum(vm, &count);
 	if(!x && count)
-		vm->heap[vm->resv].real.v /= count;
+		eel_d2v(&vm->heap[vm->resv],
+				EEL_VREAL(&vm->heap[vm->resv]) / count);
 	return x;
 }
 
@@ -321,6 +322,7 @@ static EEL_xno do_polynomial(EEL_vm *vm, int add, int inclusive)
 	double fx, dfx;
 	int count;
 	int path;
+	int i;
 
 	if(add)
 	{
@@ -337,7 +339,6 @@ static EEL_xno do_polynomial(EEL_vm *vm, int add, int inclusive)
 
 	if(ncoeffs)
 	{
-		int i;
 		coeffs = eel_malloc(vm, sizeof(double) * ncoeffs);
 		if(!coeffs)
 			return EEL_XMEMORY;
@@ -363,7 +364,6 @@ static EEL_xno do_polynomial(EEL_vm *vm, int add, int inclusive)
 	}
 
 
-	eel_l2v(&iv, 0);
 	fx = 0.0f;
 	if(inclusive & (count > 1))
 		dfx = 1.0f / (double)(count - 1);
@@ -385,7 +385,7 @@ static EEL_xno do_polynomial(EEL_vm *vm, int add, int inclusive)
 		}
 	else
 		path = 0;
-	for( ; iv.integer.v < count; ++iv.integer.v)
+	for(i = 0; i < count; ++i)
 	{
 		double out = coeffs[0];
 		double fxx = fx;
@@ -398,35 +398,36 @@ static EEL_xno do_polynomial(EEL_vm *vm, int add, int inclusive)
 		switch(path)
 		{
 		  case 0:
-			vec->buffer.d[iv.integer.v] = out;
+			vec->buffer.d[i] = out;
 			break;
 		  case 1:
-			vec->buffer.u8[iv.integer.v] += out;
+			vec->buffer.u8[i] += out;
 			break;
 		  case 2:
-			vec->buffer.s8[iv.integer.v] += out;
+			vec->buffer.s8[i] += out;
 			break;
 		  case 3:
-			vec->buffer.u16[iv.integer.v] += out;
+			vec->buffer.u16[i] += out;
 			break;
 		  case 4:
-			vec->buffer.s16[iv.integer.v] += out;
+			vec->buffer.s16[i] += out;
 			break;
 		  case 5:
-			vec->buffer.u32[iv.integer.v] += out;
+			vec->buffer.u32[i] += out;
 			break;
 		  case 6:
-			vec->buffer.s32[iv.integer.v] += out;
+			vec->buffer.s32[i] += out;
 			break;
 		  case 7:
-			vec->buffer.f[iv.integer.v] += out;
+			vec->buffer.f[i] += out;
 			break;
 		  case 8:
-			vec->buffer.d[iv.integer.v] += out;
+			vec->buffer.d[i] += out;
 			break;
 		  default:
 		  {
 			EEL_value rv;
+			eel_l2v(&iv, i);
 			x = eel_o__metamethod(o, EEL_MM_GETINDEX, &iv, &v);
 			if(x)
 			{
@@ -516,7 +517,12 @@ static EEL_xno dsp_fft_real(EEL_vm *vm)
 	if(!fo)
 		return EEL_XCONSTRUCTOR;
 	fv = o2EEL_vector(fo);
-	kfc_fftr(tv->length, tv->buffer.d, (kiss_fft_cpx *)fv->buffer.d);
+	if(kfc_fftr((kfc_cache *)eel_get_current_moduledata(vm), tv->length,
+			tv->buffer.d, (kiss_fft_cpx *)fv->buffer.d))
+	{
+		eel_disown(fo);
+		return EEL_XMEMORY;
+	}
 	scale = 1.0f / (double)tv->length;
 	fv->buffer.d[0] *= scale;
 	scale *= 2.0f;
@@ -558,7 +564,15 @@ static EEL_xno dsp_ifft_real(EEL_vm *vm)
 	fv->buffer.d[0] *= 2.0f;
 	fv->buffer.d[fv->length - 2] *= 2.0f;
 	fv->buffer.d[fv->length - 1] *= 2.0f;
-	kfc_ifftr(nfft, (kiss_fft_cpx *)fv->buffer.d, tv->buffer.d);
+	if(kfc_ifftr((kfc_cache *)eel_get_current_moduledata(vm), nfft,
+			(kiss_fft_cpx *)fv->buffer.d, tv->buffer.d))
+	{
+		fv->buffer.d[0] = save[0];
+		fv->buffer.d[fv->length - 2] = save[1];
+		fv->buffer.d[fv->length - 1] = save[2];
+		eel_disown(to);
+		return EEL_XMEMORY;
+	}
 	for(i = 0; i < tv->length; i += 2)
 	{
 		tv->buffer.d[i] *= 0.5f;
@@ -574,8 +588,7 @@ static EEL_xno dsp_ifft_real(EEL_vm *vm)
 
 static EEL_xno dsp_fft_cleanup(EEL_vm *vm)
 {
-	kfc_cleanup();
-	kiss_fft_cleanup();
+	kfc_cleanup((kfc_cache *)eel_get_current_moduledata(vm));
 	return EEL_XOK;
 }
 
@@ -585,7 +598,7 @@ static EEL_xno dsp_c_abs(EEL_vm *vm)
 	EEL_xno x;
 	EEL_value *args = vm->heap + vm->argv;
 	double v[2];
-	if(!EEL_IS_OBJREF(args->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(args)))
 		return EEL_XNEEDOBJECT;
 	x = do_op2(eel_v2o(args), eel_v2l(args + 1) * 2, v, OP_GET);
 	if(x)
@@ -600,7 +613,7 @@ static EEL_xno dsp_c_arg(EEL_vm *vm)
 	EEL_xno x;
 	EEL_value *args = vm->heap + vm->argv;
 	double v[2];
-	if(!EEL_IS_OBJREF(args->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(args)))
 		return EEL_XNEEDOBJECT;
 	x = do_op2(eel_v2o(args), eel_v2l(args + 1) * 2, v, OP_GET);
 	if(x)
@@ -614,7 +627,7 @@ static EEL_xno dsp_c_set(EEL_vm *vm)
 {
 	EEL_value *args = vm->heap + vm->argv;
 	double v[2];
-	if(!EEL_IS_OBJREF(args->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(args)))
 		return EEL_XNEEDOBJECT;
 	v[0] = eel_v2d(args + 2);
 	v[1] = eel_v2d(args + 3);
@@ -628,7 +641,7 @@ static EEL_xno dsp_c_add(EEL_vm *vm)
 {
 	EEL_value *args = vm->heap + vm->argv;
 	double v[2];
-	if(!EEL_IS_OBJREF(args->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(args)))
 		return EEL_XNEEDOBJECT;
 	v[0] = eel_v2d(args + 2);
 	v[1] = eel_v2d(args + 3);
@@ -642,7 +655,7 @@ static EEL_xno dsp_c_set_polar(EEL_vm *vm)
 {
 	EEL_value *args = vm->heap + vm->argv;
 	double m, v[2];
-	if(!EEL_IS_OBJREF(args->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(args)))
 		return EEL_XNEEDOBJECT;
 	m = eel_v2d(args + 2);
 	v[1] = eel_v2d(args + 3);
@@ -658,7 +671,7 @@ static EEL_xno dsp_c_add_polar(EEL_vm *vm)
 {
 	EEL_value *args = vm->heap + vm->argv;
 	double m, v[2];
-	if(!EEL_IS_OBJREF(args->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(args)))
 		return EEL_XNEEDOBJECT;
 	m = eel_v2d(args + 2);
 	v[1] = eel_v2d(args + 3);
@@ -676,7 +689,7 @@ static EEL_xno dsp_c_add_i(EEL_vm *vm)
 	double re, im, frac, v[2];
 	int i;
 	OPS op;
-	if(!EEL_IS_OBJREF(args->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(args)))
 		return EEL_XNEEDOBJECT;
 	re = eel_v2d(args + 2);
 	im = eel_v2d(args + 3);
@@ -703,7 +716,7 @@ static EEL_xno dsp_c_add_polar_i(EEL_vm *vm)
 	double re, im, frac, v[2];
 	int i;
 	OPS op;
-	if(!EEL_IS_OBJREF(args->classid))
+	if(!EEL_IS_OBJREF(EEL_VCLASS(args)))
 		return EEL_XNEEDOBJECT;
 	v[0] = eel_v2d(args + 2);
 	v[1] = eel_v2d(args + 3);
@@ -781,26 +794,37 @@ static EEL_xno gen_cast(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 
 static EEL_xno dsp_unload(EEL_object *m, int closing)
 {
-	kfc_cleanup();
-	kiss_fft_cleanup();
+	kfc_cache *kc = (kfc_cache *)eel_get_moduledata(m);
 	if(closing)
+	{
+		kfc_delete(kc);
 		return 0;
-	else
-		return EEL_XREFUSE;
+	}
+	kfc_cleanup(kc);
+	return EEL_XREFUSE;
 }
 
 
 EEL_xno eel_dsp_init(EEL_vm *vm)
 {
 	EEL_object *m;
+	kfc_cache *kc;
 #if 0
 	EEL_object *c;
 #endif
 
+	/* Each VM gets its own FFT cache, so no locking is needed */
+	kc = kfc_new();
+	if(!kc)
+		return EEL_XMEMORY;
+
 	/* Create module */
-	m = eel_create_module(vm, "dsp", dsp_unload, NULL);
+	m = eel_create_module(vm, "dsp", dsp_unload, kc);
 	if(!m)
+	{
+		kfc_delete(kc);
 		return EEL_XMODULEINIT;
+	}
 
 	/* Statistics */
 	eel_export_cfunction(m, 1, "sum", 1, 3, 0, dsp_sum);
@@ -34,6 +34,11 @@ POSSIBILITY OF SUCH DAMAGE.
 */
 
 /*
+NOTE:
+	* All state lives in a kfc_cache, so that each EEL VM can have its
+	  own, and no locking is needed as long as a cache is only used by
+	  one thread at a time.
+
 TODO:
 	* Merge cached_fft and cached_fftr into one polymorphic struct.
 
@@ -51,9 +56,6 @@ struct cached_fft
     cached_fft *next;
 };
 
-static cached_fft *cache_root = NULL;
-static int ncached=0;
-
 
 typedef struct cached_fftr cached_fftr;
 
@@ -65,14 +67,33 @@ struct cached_fftr
     cached_fftr *next;
 };
 
-static cached_fftr *r_cache_root = NULL;
-static int r_ncached=0;
+
+struct kfc_cache
+{
+    cached_fft *cache_root;
+    int ncached;
+    cached_fftr *r_cache_root;
+    int r_ncached;
+};
+
+
+kfc_cache *kfc_new(void)
+{
+    return (kfc_cache *)calloc(1, sizeof(kfc_cache));
+}
 
 
-static kiss_fft_cfg find_cached_fft(int nfft,int inverse)
+void kfc_delete(kfc_cache *kc)
+{
+    kfc_cleanup(kc);
+    free(kc);
+}
+
+
+static kiss_fft_cfg find_cached_fft(kfc_cache *kc, int nfft,int inverse)
 {
     size_t len = 0;
-    cached_fft *cur = cache_root;
+    cached_fft *cur = kc->cache_root;
     cached_fft *prev = NULL;
     while ( cur ) {
         if ( cur->nfft == nfft && inverse == cur->inverse )
@@ -94,17 +115,17 @@ static kiss_fft_cfg find_cached_fft(int nfft,int inverse)
         if ( prev )
             prev->next = cur;
         else
-            cache_root = cur;
-        ++ncached;
+            kc->cache_root = cur;
+        ++kc->ncached;
     }
     return cur->cfg;
 }
 
 
-static kiss_fftr_cfg find_cached_fftr(int nfft,int inverse)
+static kiss_fftr_cfg find_cached_fftr(kfc_cache *kc, int nfft,int inverse)
 {
     size_t len = 0;
-    cached_fftr *cur = r_cache_root;
+    cached_fftr *cur = kc->r_cache_root;
     cached_fftr *prev = NULL;
     while ( cur ) {
         if ( cur->nfft == nfft && inverse == cur->inverse )
@@ -126,19 +147,19 @@ static kiss_fftr_cfg find_cached_fftr(int nfft,int inverse)
         if ( prev )
             prev->next = cur;
         else
-            r_cache_root = cur;
-        ++ncached;
+            kc->r_cache_root = cur;
+        ++kc->r_ncached;
     }
     return cur->cfg;
 }
 
 
-void kfc_cleanup(void)
+void kfc_cleanup(kfc_cache *kc)
 {
-    cached_fft *cur = cache_root;
+    cached_fft *cur = kc->cache_root;
     cached_fft *next = NULL;
 
-    cached_fftr *r_cur = r_cache_root;
+    cached_fftr *r_cur = kc->r_cache_root;
     cached_fftr *r_next = NULL;
 
     while (cur){
@@ -146,48 +167,64 @@ void kfc_cleanup(void)
         free(cur);
         cur=next;
     }
-    ncached=0;
-    cache_root = NULL;
+    kc->ncached=0;
+    kc->cache_root = NULL;
 
     while (r_cur){
         r_next = r_cur->next;
         free(r_cur);
         r_cur=r_next;
     }
-    r_ncached=0;
-    r_cache_root = NULL;
+    kc->r_ncached=0;
+    kc->r_cache_root = NULL;
 }
 
 
-void kfc_fft(int nfft, const kiss_fft_cpx * fin,kiss_fft_cpx * fout)
+int kfc_fft(kfc_cache *kc, int nfft, const kiss_fft_cpx * fin,kiss_fft_cpx * fout)
 {
-    kiss_fft( find_cached_fft(nfft,0),fin,fout );
+    kiss_fft_cfg cfg = find_cached_fft(kc,nfft,0);
+    if (!cfg)
+        return -1;
+    kiss_fft( cfg,fin,fout );
+    return 0;
 }
 
 
-void kfc_ifft(int nfft, const kiss_fft_cpx * fin,kiss_fft_cpx * fout)
+int kfc_ifft(kfc_cache *kc, int nfft, const kiss_fft_cpx * fin,kiss_fft_cpx * fout)
 {
-    kiss_fft( find_cached_fft(nfft,1),fin,fout );
+    kiss_fft_cfg cfg = find_cached_fft(kc,nfft,1);
+    if (!cfg)
+        return -1;
+    kiss_fft( cfg,fin,fout );
+    return 0;
 }
 
 
-void kfc_fftr(int nfft, const kiss_fft_scalar *timedata, kiss_fft_cpx *fout)
+int kfc_fftr(kfc_cache *kc, int nfft, const kiss_fft_scalar *timedata, kiss_fft_cpx *fout)
 {
-    kiss_fftr( find_cached_fftr(nfft,0),timedata,fout);
+    kiss_fftr_cfg cfg = find_cached_fftr(kc,nfft,0);
+    if (!cfg)
+        return -1;
+    kiss_fftr( cfg,timedata,fout);
+    return 0;
 }
 
 
-void kfc_ifftr(int nfft, const kiss_fft_cpx *fin, kiss_fft_scalar *timedata)
+int kfc_ifftr(kfc_cache *kc, int nfft, const kiss_fft_cpx *fin, kiss_fft_scalar *timedata)
 {
-    kiss_fftri( find_cached_fftr(nfft,1),fin,timedata);
+    kiss_fftr_cfg cfg = find_cached_fftr(kc,nfft,1);
+    if (!cfg)
+        return -1;
+    kiss_fftri( cfg,fin,timedata);
+    return 0;
 }
 
 
 #ifdef KFC_TEST
-static void check(int nc)
+static void check(kfc_cache *kc, int nc)
 {
-    if (ncached != nc) {
-        fprintf(stderr,"ncached should be %d,but it is %d\n",nc,ncached);
+    if (kc->ncached != nc) {
+        fprintf(stderr,"ncached should be %d,but it is %d\n",nc,kc->ncached);
         exit(1);
     }
 }
@@ -195,16 +232,18 @@ static void check(int nc)
 int main(void)
 {
     kiss_fft_cpx buf1[1024],buf2[1024];
+    kfc_cache *kc = kfc_new();
     memset(buf1,0,sizeof(buf1));
-    check(0);
-    kfc_fft(512,buf1,buf2);
-    check(1);
-    kfc_fft(512,buf1,buf2);
-    check(1);
-    kfc_ifft(512,buf1,buf2);
-    check(2);
-    kfc_cleanup();
-    check(0);
+    check(kc,0);
+    kfc_fft(kc,512,buf1,buf2);
+    check(kc,1);
+    kfc_fft(kc,512,buf1,buf2);
+    check(kc,1);
+    kfc_ifft(kc,512,buf1,buf2);
+    check(kc,2);
+    kfc_cleanup(kc);
+    check(kc,0);
+    kfc_delete(kc);
     return 0;
 }
 #endif
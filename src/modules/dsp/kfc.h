@@ -19,6 +19,10 @@ The first time kfc_fft or kfc_ifft for a given FFT size, the cfg
 object is created for it.  All subsequent calls use the cached 
 configuration object.
 
+The cached objects are kept in a kfc_cache, created with kfc_new.
+There is no locking; a kfc_cache must only be used by one thread at a
+time.  Use one cache per thread (or per EEL VM) instead of sharing one.
+
 NOTE:
 You should probably not use this if your program will be using a lot 
 of various sizes of FFTs.  There is a linear search through the
@@ -31,20 +35,29 @@ to large memory usage in a program that uses a lot of *DIFFERENT*
 sized FFTs.  If you want to force all cached cfg objects to be freed,
 call kfc_cleanup.
  
+The transform calls return 0 on success, or -1 if a cfg object could
+not be allocated.
  */
 
+typedef struct kfc_cache kfc_cache;
+
+/*create an empty cache; returns NULL if out of memory */
+kfc_cache *kfc_new(void);
+/*free all cached objects and the cache itself */
+void kfc_delete(kfc_cache *kc);
+
 /*forward complex FFT */
-void kfc_fft(int nfft, const kiss_fft_cpx *fin, kiss_fft_cpx *fout);
+int kfc_fft(kfc_cache *kc, int nfft, const kiss_fft_cpx *fin, kiss_fft_cpx *fout);
 /*reverse complex FFT */
-void kfc_ifft(int nfft, const kiss_fft_cpx *fin, kiss_fft_cpx *fout);
+int kfc_ifft(kfc_cache *kc, int nfft, const kiss_fft_cpx *fin, kiss_fft_cpx *fout);
 
 /*forward real FFT */
-void kfc_fftr(int nfft, const kiss_fft_scalar *timedata, kiss_fft_cpx *fout);
+int kfc_fftr(kfc_cache *kc, int nfft, const kiss_fft_scalar *timedata, kiss_fft_cpx *fout);
 /*reverse real FFT */
-void kfc_ifftr(int nfft, const kiss_fft_cpx *fin, kiss_fft_scalar *timedata);
+int kfc_ifftr(kfc_cache *kc, int nfft, const kiss_fft_cpx *fin, kiss_fft_scalar *timedata);
 
 /*free all cached objects*/
-void kfc_cleanup(void);
+void kfc_cleanup(kfc_cache *kc);
 
 #ifdef __cplusplus
 }
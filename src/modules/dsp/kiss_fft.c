@@ -18,19 +18,11 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
  fixed or floating point complex numbers.  It also delares the kf_ internal functions.
  */
 
-static kiss_fft_cpx *scratchbuf=NULL;
-static size_t nscratchbuf=0;
-static kiss_fft_cpx *tmpbuf=NULL;
-static size_t ntmpbuf=0;
-
-#define CHECKBUF(buf,nbuf,n) \
-    do { \
-        if ( nbuf < (size_t)(n) ) {\
-            free(buf); \
-            buf = (kiss_fft_cpx*)KISS_FFT_MALLOC(sizeof(kiss_fft_cpx)*(n)); \
-            nbuf = (size_t)(n); \
-        } \
-   }while(0)
+/*
+ * Temporary buffers are allocated with the cfg, rather than kept in static
+ * variables, so that different threads can run FFTs with different cfgs at
+ * the same time, and so that transforms never allocate memory, or fail.
+ */
 
 
 static void kf_bfly2(
@@ -221,8 +213,7 @@ static void kf_bfly_generic(
     kiss_fft_cpx * twiddles = st->twiddles;
     kiss_fft_cpx t;
     int Norig = st->nfft;
-
-    CHECKBUF(scratchbuf,nscratchbuf,p);
+    kiss_fft_cpx * scratchbuf = st->scratchbuf;
 
     for ( u=0; u<m; ++u ) {
         k=u;
@@ -323,8 +314,21 @@ void kf_factor(int n,int * facbuf)
 kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem )
 {
     kiss_fft_cfg st=NULL;
-    size_t memneeded = sizeof(struct kiss_fft_state)
-        + sizeof(kiss_fft_cpx)*(nfft-1); /* twiddle factors*/
+    int factors[2*MAXFACTORS];
+    int i, maxradix=0;
+    size_t memneeded;
+
+    kf_factor(nfft,factors);
+    for (i=0;;i+=2) {
+        if (factors[i] > maxradix)
+            maxradix = factors[i];
+        if (factors[i+1] <= 1)
+            break;
+    }
+    memneeded = sizeof(struct kiss_fft_state)
+        + sizeof(kiss_fft_cpx)*(nfft-1) /* twiddle factors*/
+        + sizeof(kiss_fft_cpx)*nfft /* tmpbuf */
+        + sizeof(kiss_fft_cpx)*maxradix; /* scratchbuf */
 
     if ( lenmem==NULL ) {
         st = ( kiss_fft_cfg)KISS_FFT_MALLOC( memneeded );
@@ -334,9 +338,10 @@ kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem
         *lenmem = memneeded;
     }
     if (st) {
-        int i;
         st->nfft=nfft;
         st->inverse = inverse_fft;
+        st->tmpbuf = st->twiddles + nfft;
+        st->scratchbuf = st->tmpbuf + nfft;
 
         for (i=0;i<nfft;++i) {
             const double pi=3.14159265358979323846264338327;
@@ -346,7 +351,7 @@ kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem
             kf_cexp(st->twiddles+i, phase );
         }
 
-        kf_factor(nfft,st->factors);
+        memcpy(st->factors,factors,sizeof(factors));
     }
     return st;
 }
@@ -357,9 +362,8 @@ kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem
 void kiss_fft_stride(kiss_fft_cfg st,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,int in_stride)
 {
     if (fin == fout) {
-        CHECKBUF(tmpbuf,ntmpbuf,st->nfft);
-        kf_work(tmpbuf,fin,1,in_stride, st->factors,st);
-        memcpy(fout,tmpbuf,sizeof(kiss_fft_cpx)*st->nfft);
+        kf_work(st->tmpbuf,fin,1,in_stride, st->factors,st);
+        memcpy(fout,st->tmpbuf,sizeof(kiss_fft_cpx)*st->nfft);
     }else{
         kf_work( fout, fin, 1,in_stride, st->factors,st );
     }
@@ -371,15 +375,7 @@ void kiss_fft(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout)
 }
 
 
-/* not really necessary to call, but if someone is doing in-place ffts, they may want to free the 
-   buffers from CHECKBUF
- */ 
+/* there are no static buffers any more; kept for compatibility */
 void kiss_fft_cleanup(void)
 {
-    free(scratchbuf);
-    scratchbuf = NULL;
-    nscratchbuf=0;
-    free(tmpbuf);
-    tmpbuf=NULL;
-    ntmpbuf=0;
 }
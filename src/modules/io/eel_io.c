@@ -170,8 +170,7 @@ static EEL_xno f_length(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	if(res < 0)
 		return EEL_XFILEERROR;
 	fseek(f->handle, pos, SEEK_SET);
-	op2->classid = EEL_CINTEGER;
-	op2->integer.v = res;
+	eel_l2v(op2, res);
 	return 0;
 }
 
@@ -204,7 +203,7 @@ static EEL_xno mf_construct(EEL_vm *vm, EEL_classes cid,
 			eel_o_free(eo);
 			return EEL_XARGUMENTS;
 		}
-		mf->buffer = initv->objref.v;
+		mf->buffer = eel_v2o(initv);
 		eel_o_own(mf->buffer);
 	}
 	mf->position = 0;
@@ -300,7 +299,7 @@ static EEL_xno mf_setindex(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 			return EEL_XNEEDDSTRING;
 		if(mf->buffer)
 			eel_disown(mf->buffer);
-		mf->buffer = op2->objref.v;
+		mf->buffer = eel_v2o(op2);
 		eel_own(mf->buffer);
 		mf->position = 0;
 	}
@@ -317,8 +316,7 @@ static EEL_xno mf_length(EEL_object *eo, EEL_value *op1, EEL_value *op2)
 	if(!mf->buffer)
 		return EEL_XFILECLOSED;
 	buf = o2EEL_dstring(mf->buffer);
-	op2->classid = EEL_CINTEGER;
-	op2->integer.v = buf->length;
+	eel_l2v(op2, buf->length);
 	return 0;
 }
 
@@ -379,7 +377,7 @@ static EEL_xno read_type(EEL_vm *vm)
 	/* Figure out how many bytes to read */
 	if(EEL_CLASS(args + 1) != EEL_CCLASSID)
 		return EEL_XARGUMENTS;
-	switch(args[1].integer.v)
+	switch(EEL_VINT(&args[1]))
 	{
 	  case EEL_CREAL:
 		count = 8;
@@ -395,7 +393,7 @@ static EEL_xno read_type(EEL_vm *vm)
 	if(EEL_CLASS(args) == md->file_cid)
 	{
 		int res;
-		EEL_file *f = o2EEL_file(args->objref.v);
+		EEL_file *f = o2EEL_file(eel_v2o(args));
 		if(!f->handle)
 			return EEL_XFILECLOSED;
 		res = fread(buf, 1, count, f->handle);
@@ -411,7 +409,7 @@ static EEL_xno read_type(EEL_vm *vm)
 	}
 	else if(EEL_CLASS(args) == md->memfile_cid)
 	{
-		EEL_memfile *mf = o2EEL_memfile(args->objref.v);
+		EEL_memfile *mf = o2EEL_memfile(eel_v2o(args));
 		EEL_dstring *fb;
 		if(!mf->buffer)
 			return EEL_XFILECLOSED;
@@ -423,14 +421,14 @@ static EEL_xno read_type(EEL_vm *vm)
 	}
 	else if(EEL_CLASS(args) == EEL_CSTRING)
 	{
-		EEL_string *fb = o2EEL_string(args->objref.v);
+		EEL_string *fb = o2EEL_string(eel_v2o(args));
 		if(count > fb->length)
 			return EEL_XEOF;
 		memcpy(buf, fb->buffer, count);
 	}
 	else if(EEL_CLASS(args) == EEL_CDSTRING)
 	{
-		EEL_dstring *fb = o2EEL_dstring(args->objref.v);
+		EEL_dstring *fb = o2EEL_dstring(eel_v2o(args));
 		if(count > fb->length)
 			return EEL_XEOF;
 		memcpy(buf, fb->buffer, count);
@@ -439,7 +437,7 @@ static EEL_xno read_type(EEL_vm *vm)
 		return EEL_XWRONGTYPE;
 
 	/* Decode! */
-	switch(args[1].integer.v)
+	switch(EEL_VINT(&args[1]))
 	{
 	  case EEL_CREAL:
 	  {
@@ -454,8 +452,7 @@ static EEL_xno read_type(EEL_vm *vm)
 		for(n = 0; n < sizeof(EEL_real); ++n)
 			cvt.c[sizeof(EEL_real) - 1 - n] = buf[n];
 #endif
-		r->real.v = cvt.r;
-		r->classid = EEL_CREAL;
+		eel_d2v(r, cvt.r);
 		return 0;
 	  }
 	  case EEL_CINTEGER:
@@ -472,8 +469,7 @@ static EEL_xno read_type(EEL_vm *vm)
 		cvt.c[1] = buf[2];
 		cvt.c[0] = buf[3];
 #endif
-		r->integer.v = cvt.i;
-		r->classid = EEL_CINTEGER;
+		eel_l2v(r, cvt.i);
 		return 0;
 	  }
 	  default:
@@ -518,7 +514,7 @@ static EEL_xno io_read(EEL_vm *vm)
 	if(EEL_CLASS(args) == md->file_cid)
 	{
 		int res;
-		EEL_file *f = o2EEL_file(args->objref.v);
+		EEL_file *f = o2EEL_file(eel_v2o(args));
 		if(!f->handle)
 		{
 			eel_o_disown_nz(so);
@@ -547,7 +543,7 @@ static EEL_xno io_read(EEL_vm *vm)
 	}
 	else if(EEL_CLASS(args) == md->memfile_cid)
 	{
-		EEL_memfile *mf = o2EEL_memfile(args->objref.v);
+		EEL_memfile *mf = o2EEL_memfile(eel_v2o(args));
 		EEL_dstring *fb;
 		if(!mf->buffer)
 		{
@@ -627,14 +623,14 @@ static EEL_xno io_write(EEL_vm *vm)
 	wrd.count = 0;
 	if(EEL_CLASS(args) == md->file_cid)
 	{
-		wrd.f = o2EEL_file(args->objref.v);
+		wrd.f = o2EEL_file(eel_v2o(args));
 		if(!wrd.f->handle)
 			return EEL_XFILECLOSED;
 		wrd.write = io_write_file;
 	}
 	else if(EEL_CLASS(args) == md->memfile_cid)
 	{
-		wrd.mf = o2EEL_memfile(args->objref.v);
+		wrd.mf = o2EEL_memfile(eel_v2o(args));
 		if(!wrd.mf->buffer)
 			return EEL_XFILECLOSED;
 		wrd.write = io_write_memfile;
@@ -656,12 +652,12 @@ static EEL_xno io_write(EEL_vm *vm)
 				EEL_real	r;
 			} cvt;
 #if EEL_BYTEORDER == EEL_BIG_ENDIAN
-			cvt.r = v->real.v;
+			cvt.r = EEL_VREAL(v);
 			x = wrd.write(vm, &wrd, cvt.c, sizeof(EEL_real));
 #else
 			char lb[sizeof(EEL_real)];
 			int n;
-			cvt.r = v->real.v;
+			cvt.r = EEL_VREAL(v);
 			for(n = 0; n < sizeof(EEL_real); ++n)
 				lb[n] = cvt.c[sizeof(EEL_real) - 1 - n];
 			x = wrd.write(vm, &wrd, lb, sizeof(EEL_real));
@@ -677,11 +673,11 @@ static EEL_xno io_write(EEL_vm *vm)
 				EEL_int32	i;
 			} cvt;
 #if EEL_BYTEORDER == EEL_BIG_ENDIAN
-			cvt.i = v->integer.v;
+			cvt.i = EEL_VINT(v);
 			x = wrd.write(vm, &wrd, cvt.c, 4);
 #else
 			char lb[4];
-			cvt.i = v->integer.v;
+			cvt.i = EEL_VINT(v);
 			lb[0] = cvt.c[3];
 			lb[1] = cvt.c[2];
 			lb[2] = cvt.c[1];
@@ -696,7 +692,7 @@ static EEL_xno io_write(EEL_vm *vm)
 		  case EEL_CDSTRING:
 		  {
 		  	const char *s = eel_v2s(v);
-			int len = eel_length(v->objref.v);
+			int len = eel_length(eel_v2o(v));
 			x = wrd.write(vm, &wrd, s, len);
 			if(x)
 				return x;
@@ -724,7 +720,7 @@ static EEL_xno io_flush(EEL_vm *vm)
 	}
 	if(EEL_CLASS(arg) == md->file_cid)
 	{
-		EEL_file *f = o2EEL_file(arg->objref.v);
+		EEL_file *f = o2EEL_file(eel_v2o(arg));
 		if(!f->handle)
 			return EEL_XFILECLOSED;
 		if(fflush(f->handle))
@@ -745,7 +741,7 @@ static EEL_xno io_close(EEL_vm *vm)
 	EEL_value *arg = vm->heap + vm->argv;
 	if(EEL_CLASS(arg) == md->file_cid)
 	{
-		EEL_file *f = o2EEL_file(arg->objref.v);
+		EEL_file *f = o2EEL_file(eel_v2o(arg));
 		if(!f->handle)
 			return EEL_XFILECLOSED;
 		fclose(f->handle);
@@ -753,10 +749,10 @@ static EEL_xno io_close(EEL_vm *vm)
 	}
 	else if(EEL_CLASS(arg) == md->memfile_cid)
 	{
-		EEL_memfile *mf = o2EEL_memfile(arg->objref.v);
+		EEL_memfile *mf = o2EEL_memfile(eel_v2o(arg));
 		if(!mf->buffer)
 			return EEL_XFILECLOSED;
-		eel_free(vm, mf->buffer);
+		eel_disown(mf->buffer);
 		mf->buffer = NULL;
 		mf->position = 0;
 	}
@@ -57,8 +57,7 @@ static EEL_xno loader__load_binary_module(EEL_vm *vm)
 
 static EEL_xno loader_getmt(EEL_vm *vm)
 {
-	vm->heap[vm->resv].classid = EEL_COBJREF;
-	vm->heap[vm->resv].objref.v = VMP->state->modules;
+	eel_o2v(&vm->heap[vm->resv], VMP->state->modules);
 	eel_o_own(VMP->state->modules);
 	return 0;
 }
@@ -29,11 +29,11 @@
 #include "EEL_register.h"
 #include "e_vector.h"
 
+/* Leaf function wrappers; see eel_export_cleaf() */
 #define	MATHWRAP(x)						\
-static EEL_xno m_##x(EEL_vm *vm)				\
+static EEL_xno m_##x(EEL_value *args, EEL_value *result)	\
 {								\
-	EEL_value *arg = vm->heap + vm->argv;			\
-	eel_d2v(vm->heap + vm->resv, x(eel_v2d(arg)));		\
+	eel_d2v(result, x(eel_v2d(args)));			\
 	return 0;						\
 }
 
@@ -48,11 +48,10 @@ static EEL_xno errno2x(int e)
 }
 
 #define	MATHWRAP_CHECK(x)					\
-static EEL_xno m_##x(EEL_vm *vm)				\
+static EEL_xno m_##x(EEL_value *args, EEL_value *result)	\
 {								\
-	EEL_value *arg = vm->heap + vm->argv;			\
 	errno = 0;						\
-	eel_d2v(vm->heap + vm->resv, x(eel_v2d(arg)));		\
+	eel_d2v(result, x(eel_v2d(args)));			\
 	if(errno)						\
 		return errno2x(errno);				\
 	return 0;						\
@@ -70,10 +69,10 @@ static EEL_xno m_abs(EEL_vm *vm)
 		vm->heap[vm->resv] = *arg;
 		return 0;
 	  case EEL_CINTEGER:
-		eel_l2v(vm->heap + vm->resv, labs(arg->integer.v));
+		eel_l2v(vm->heap + vm->resv, labs(EEL_VINT(arg)));
 		return 0;
 	  case EEL_CREAL:
-		eel_d2v(vm->heap + vm->resv, fabs(arg->real.v));
+		eel_d2v(vm->heap + vm->resv, fabs(EEL_VREAL(arg)));
 		return 0;
 	  case EEL_CVECTOR_U8:
 	  case EEL_CVECTOR_S8:
@@ -85,12 +84,12 @@ static EEL_xno m_abs(EEL_vm *vm)
 	  case EEL_CVECTOR_D:
 	  {
 		EEL_object *o;
-		size = eel_length(arg->objref.v);
+		size = eel_length(eel_v2o(arg));
 		o = eel_cv_new_noinit(vm, EEL_CLASS(arg), size);
 		if(!o)
 			return EEL_XMEMORY;
 		eel_o2v(vm->heap + vm->resv, o);
-		v = o2EEL_vector(arg->objref.v);
+		v = o2EEL_vector(eel_v2o(arg));
 		r = o2EEL_vector(o);
 		break;
 	  }
@@ -135,10 +134,9 @@ MATHWRAP(sqrt)
 MATHWRAP(log)
 MATHWRAP(log10)
 MATHWRAP(exp)
-static EEL_xno m_ldexp(EEL_vm *vm)
+static EEL_xno m_ldexp(EEL_value *args, EEL_value *result)
 {
-	EEL_value *arg = vm->heap + vm->argv;
-	eel_d2v(vm->heap + vm->resv, ldexp(eel_v2d(arg), eel_v2d(arg + 1)));
+	eel_d2v(result, ldexp(eel_v2d(args), eel_v2d(args + 1)));
 	return 0;
 }
 MATHWRAP(sin)
@@ -147,10 +145,9 @@ MATHWRAP(tan)
 MATHWRAP_CHECK(asin)
 MATHWRAP_CHECK(acos)
 MATHWRAP(atan)
-static EEL_xno m_atan2(EEL_vm *vm)
+static EEL_xno m_atan2(EEL_value *args, EEL_value *result)
 {
-	EEL_value *arg = vm->heap + vm->argv;
-	eel_d2v(vm->heap + vm->resv, atan2(eel_v2d(arg), eel_v2d(arg + 1)));
+	eel_d2v(result, atan2(eel_v2d(args), eel_v2d(args + 1)));
 	return 0;
 }
 
@@ -171,20 +168,20 @@ EEL_xno eel_math_init(EEL_vm *vm)
 		return EEL_XMODULEINIT;
 
 	eel_export_cfunction(m, 1, "abs", 1, 0, 0, m_abs);
-	eel_export_cfunction(m, 1, "ceil", 1, 0, 0, m_ceil);
-	eel_export_cfunction(m, 1, "floor", 1, 0, 0, m_floor);
-	eel_export_cfunction(m, 1, "sqrt", 1, 0, 0, m_sqrt);
-	eel_export_cfunction(m, 1, "log", 1, 0, 0, m_log);
-	eel_export_cfunction(m, 1, "log10", 1, 0, 0, m_log10);
-	eel_export_cfunction(m, 1, "exp", 1, 0, 0, m_exp);
-	eel_export_cfunction(m, 1, "ldexp", 2, 0, 0, m_ldexp);
-	eel_export_cfunction(m, 1, "sin", 1, 0, 0, m_sin);
-	eel_export_cfunction(m, 1, "cos", 1, 0, 0, m_cos);
-	eel_export_cfunction(m, 1, "tan", 1, 0, 0, m_tan);
-	eel_export_cfunction(m, 1, "asin", 1, 0, 0, m_asin);
-	eel_export_cfunction(m, 1, "acos", 1, 0, 0, m_acos);
-	eel_export_cfunction(m, 1, "atan", 1, 0, 0, m_atan);
-	eel_export_cfunction(m, 1, "atan2", 2, 0, 0, m_atan2);
+	eel_export_cleaf(m, "ceil", 1, m_ceil);
+	eel_export_cleaf(m, "floor", 1, m_floor);
+	eel_export_cleaf(m, "sqrt", 1, m_sqrt);
+	eel_export_cleaf(m, "log", 1, m_log);
+	eel_export_cleaf(m, "log10", 1, m_log10);
+	eel_export_cleaf(m, "exp", 1, m_exp);
+	eel_export_cleaf(m, "ldexp", 2, m_ldexp);
+	eel_export_cleaf(m, "sin", 1, m_sin);
+	eel_export_cleaf(m, "cos", 1, m_cos);
+	eel_export_cleaf(m, "tan", 1, m_tan);
+	eel_export_cleaf(m, "asin", 1, m_asin);
+	eel_export_cleaf(m, "acos", 1, m_acos);
+	eel_export_cleaf(m, "atan", 1, m_atan);
+	eel_export_cleaf(m, "atan2", 2, m_atan2);
 
 #ifdef M_PIl
 	eel_export_dconstant(m, "PI", M_PIl);
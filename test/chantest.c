@@ -0,0 +1,182 @@
+/*
+---------------------------------------------------------------------------
+	Channel test.
+
+	Opens two VMs in two OS threads, connected by a small channel, and
+	streams values both ways at the same time. Each VM checks that the
+	values from the other one arrive complete and in order.
+
+	Usage: chantest [count]
+
+	'count' is the number of values sent each way, 2000 by default.
+---------------------------------------------------------------------------
+ * This code is in the public domain. NO WARRANTY!
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "EEL.h"
+#include "eel_system.h"
+#include "eel_io.h"
+#include "eel_loader.h"
+
+typedef struct
+{
+	pthread_t	thread;
+	const char	*tag;		/* Tag of the values this VM sends */
+	int		count;
+	int		received;	/* Values received and checked */
+	int		result;		/* 0 if all went well */
+} CHANTHREAD;
+
+
+/*
+ * A channel of 256 bytes only holds a few messages at a time, so the FIFOs
+ * fill up and wrap around all the time.
+ */
+static const char script[] =
+	"function item(tag, i)\n"
+	"{\n"
+	"	switch i % 4\n"
+	"	  case 0\n"
+	"		return i;\n"
+	"	  case 1\n"
+	"		return [tag, i, (string)i];\n"
+	"	  case 2\n"
+	"		return { .tag tag, .i i, .a [i, -i] };\n"
+	"	  default\n"
+	"		return vector_d [i, i * .5];\n"
+	"}\n"
+	"\n"
+	"function same(a, b)\n"
+	"{\n"
+	"	if typeof a != typeof b\n"
+	"		return false;\n"
+	"	switch typeof a\n"
+	"	  case array, vector_d\n"
+	"	  {\n"
+	"		if sizeof a != sizeof b\n"
+	"			return false;\n"
+	"		for local i = 0, sizeof a - 1\n"
+	"			if not same(a[i], b[i])\n"
+	"				return false;\n"
+	"		return true;\n"
+	"	  }\n"
+	"	  case table\n"
+	"	  {\n"
+	"		if sizeof a != sizeof b\n"
+	"			return false;\n"
+	"		for local i = 0, sizeof a - 1\n"
+	"			if not same(index(a, i), b[key(a, i)])\n"
+	"				return false;\n"
+	"		return true;\n"
+	"	  }\n"
+	"	  default\n"
+	"		return a == b;\n"
+	"}\n"
+	"\n"
+	"export function main<args>\n"
+	"{\n"
+	"	local tag = args[1];\n"
+	"	local other = \"a\";\n"
+	"	if tag == \"a\"\n"
+	"		other = \"b\";\n"
+	"	local n = args[2];\n"
+	"	local c = channel [\"chantest\", 256];\n"
+	"	local sent = 0;\n"
+	"	local received = 0;\n"
+	"	while (sent < n) or (received < n)\n"
+	"	{\n"
+	"		if sent < n\n"
+	"			if c:send(item(tag, sent))\n"
+	"				sent = sent + 1;\n"
+	"		while c:ready()\n"
+	"		{\n"
+	"			if received >= n\n"
+	"				throw \"Too many values from \" + other + \"!\";\n"
+	"			if not same(c:receive(), item(other, received))\n"
+	"				throw \"Value \" + (string)received + \" from \" +\n"
+	"						other + \" damaged!\";\n"
+	"			received = received + 1;\n"
+	"		}\n"
+	"	}\n"
+	"	return received;\n"
+	"}\n";
+
+
+static void *chan_thread(void *data)
+{
+	CHANTHREAD *ct = (CHANTHREAD *)data;
+	const char *argv[] = { "chantest" };
+	EEL_object *m;
+	EEL_vm *vm;
+	int resv;
+	ct->result = 1;
+	if(!(vm = eel_open(1, argv)))
+	{
+		fprintf(stderr, "Could not initialize EEL!\n");
+		return NULL;
+	}
+	if(eel_system_init(vm, 1, argv) || eel_io_init(vm) ||
+			eel_loader_init(vm))
+	{
+		fprintf(stderr, "Could not initialize built-in modules!\n");
+		eel_close(vm);
+		return NULL;
+	}
+	if(!(m = eel_load_buffer(vm, script, strlen(script), 0)))
+	{
+		fprintf(stderr, "Could not compile the test script!\n");
+		eel_perror(vm, 1);
+		eel_close(vm);
+		return NULL;
+	}
+	if(eel_callnf(vm, m, "main", "Rssi", &resv, "chantest", ct->tag,
+			ct->count))
+		eel_perror(vm, 1);
+	else
+	{
+		ct->received = eel_v2l(vm->heap + resv);
+		ct->result = 0;
+	}
+	eel_disown(m);
+	eel_close(vm);
+	return NULL;
+}
+
+
+int main(int argc, const char *argv[])
+{
+	CHANTHREAD ct[2];
+	int i, failures = 0;
+	int count = argc >= 2 ? atoi(argv[1]) : 2000;
+	memset(ct, 0, sizeof(ct));
+	ct[0].tag = "a";
+	ct[1].tag = "b";
+	for(i = 0; i < 2; ++i)
+	{
+		ct[i].count = count;
+		if(pthread_create(&ct[i].thread, NULL, chan_thread, &ct[i]))
+		{
+			fprintf(stderr, "Could not create thread %d!\n", i);
+			return 1;
+		}
+	}
+	for(i = 0; i < 2; ++i)
+	{
+		pthread_join(ct[i].thread, NULL);
+		if(ct[i].result || (ct[i].received != count))
+		{
+			fprintf(stderr, "chantest: VM %s received %d of %d "
+					"values!\n", ct[i].tag, ct[i].received,
+					count);
+			++failures;
+		}
+	}
+	if(failures)
+		return 1;
+	printf("chantest: %d values each way, all in order.\n", count);
+	return 0;
+}
@@ -0,0 +1,145 @@
+/*
+---------------------------------------------------------------------------
+	Multithreaded scaling benchmark.
+
+	Runs bench.eel in one VM first, and then in one VM per thread, all at
+	the same time. As VMs share no state, the wall clock time of the second
+	run should stay close to that of the first, up to the number of cores.
+
+	Usage: mtbench [threads [innercount [outercount]]]
+
+	'threads' defaults to the number of online CPUs. The remaining
+	arguments are passed on to bench.eel. Run from the test directory.
+---------------------------------------------------------------------------
+ * This code is in the public domain. NO WARRANTY!
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "EEL.h"
+#include "eel_io.h"
+#include "eel_system.h"
+#include "eel_math.h"
+#include "eel_dir.h"
+#include "eel_dsp.h"
+#include "eel_loader.h"
+
+#define	MAXTHREADS	256
+
+typedef struct
+{
+	pthread_t	thread;
+	const char	*innercount;
+	const char	*outercount;
+	double		seconds;	/* Wall clock time of this VM */
+	int		result;		/* 0 if all went well */
+} BENCHTHREAD;
+
+
+static double now(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 0.000001;
+}
+
+
+static void *bench_thread(void *data)
+{
+	BENCHTHREAD *bt = (BENCHTHREAD *)data;
+	const char *argv[] = { "bench.eel", bt->innercount, bt->outercount };
+	EEL_object *m;
+	EEL_vm *vm;
+	double start = now();
+	bt->result = 1;
+	if(!(vm = eel_open(3, argv)))
+	{
+		fprintf(stderr, "Could not initialize EEL!\n");
+		return NULL;
+	}
+	if(eel_system_init(vm, 3, argv) || eel_io_init(vm) ||
+			eel_math_init(vm) || eel_dir_init(vm) ||
+			eel_dsp_init(vm) || eel_loader_init(vm))
+	{
+		fprintf(stderr, "Could not initialize built-in modules!\n");
+		eel_close(vm);
+		return NULL;
+	}
+	if(!(m = eel_load(vm, "bench.eel", 0)))
+	{
+		fprintf(stderr, "Could not load script!\n");
+		eel_close(vm);
+		return NULL;
+	}
+	if(eel_callnf(vm, m, "main", "sss", argv[0], argv[1], argv[2]))
+		eel_perror(vm, 1);
+	else
+		bt->result = 0;
+	eel_disown(m);
+	eel_close(vm);
+	bt->seconds = now() - start;
+	return NULL;
+}
+
+
+/* Run bench.eel in 'n' threads at once. Returns the wall clock time. */
+static double run(BENCHTHREAD *bt, int n)
+{
+	int i;
+	double start = now();
+	for(i = 0; i < n; ++i)
+		if(pthread_create(&bt[i].thread, NULL, bench_thread, &bt[i]))
+		{
+			fprintf(stderr, "Could not create thread %d!\n", i);
+			exit(1);
+		}
+	for(i = 0; i < n; ++i)
+	{
+		pthread_join(bt[i].thread, NULL);
+		if(bt[i].result)
+		{
+			fprintf(stderr, "Benchmark failed in thread %d!\n", i);
+			exit(1);
+		}
+	}
+	return now() - start;
+}
+
+
+int main(int argc, const char *argv[])
+{
+	BENCHTHREAD bt[MAXTHREADS];
+	double single, multi;
+	int i;
+	int n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if(argc >= 2)
+		n = atoi(argv[1]);
+	if(n < 1)
+		n = 1;
+	else if(n > MAXTHREADS)
+		n = MAXTHREADS;
+	for(i = 0; i < n; ++i)
+	{
+		bt[i].innercount = argc >= 3 ? argv[2] : "1";
+		bt[i].outercount = argc >= 4 ? argv[3] : "1";
+	}
+
+	single = run(bt, 1);
+	multi = run(bt, n);
+
+	fprintf(stderr, "============================================\n");
+	fprintf(stderr, "Scaling results:\n");
+	fprintf(stderr, "  1 VM:\t\t%.3f s\n", single);
+	for(i = 0; i < n; ++i)
+		fprintf(stderr, "  VM %d of %d:\t%.3f s\n", i + 1, n,
+				bt[i].seconds);
+	fprintf(stderr, "  %d VMs:\t%.3f s\n", n, multi);
+	fprintf(stderr, "  Throughput:\t%.2f x single VM\n",
+			n * single / multi);
+	fprintf(stderr, "  Efficiency:\t%.0f%%\n", 100.0 * single / multi);
+	fprintf(stderr, "============================================\n");
+	return 0;
+}
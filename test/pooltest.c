@@ -0,0 +1,169 @@
+/*
+---------------------------------------------------------------------------
+	Memory pool test.
+
+	Runs a VM from a small memory pool, and checks that the VM heap is
+	allocated from the pool. Then makes a script run out of memory, and
+	checks that the pool statistics count the failed allocations, that the
+	VM recovers once the script lets go of its data, and that no objects
+	are left behind.
+
+	Usage: pooltest
+---------------------------------------------------------------------------
+ * This code is in the public domain. NO WARRANTY!
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "EEL.h"
+#include "eel_system.h"
+#include "eel_io.h"
+#include "eel_loader.h"
+
+#define	POOLSIZE	(1024 * 1024)
+
+static int failures = 0;
+
+#define	CHECK(what, ok)	check(what, ok, __LINE__)
+
+static void check(const char *what, int ok, int line)
+{
+	if(ok)
+		return;
+	fprintf(stderr, "pooltest.c:%d: %s failed!\n", line, what);
+	++failures;
+}
+
+
+/* Fill the pool with arrays until an allocation fails */
+static const char script[] =
+	"export function hog<args>\n"
+	"{\n"
+	"	local a = [];\n"
+	"	try\n"
+	"		while true\n"
+	"			a[sizeof a] = [sizeof a, \"item\"];\n"
+	"	except\n"
+	"		if exception_name(exception) != \"XMEMORY\"\n"
+	"			throw exception;\n"
+	"	return sizeof a;\n"
+	"}\n";
+
+
+static int hog(EEL_vm *vm, EEL_object *m)
+{
+	int resv;
+	if(eel_callnf(vm, m, "hog", "R", &resv))
+	{
+		eel_perror(vm, 1);
+		return -1;
+	}
+	return eel_v2l(vm->heap + resv);
+}
+
+
+static void test_pool(void *pool)
+{
+	const char *argv[] = { "pooltest" };
+	EEL_poolstats before, full, after;
+	EEL_memstats ms1, ms2;
+	EEL_object *m;
+	int items, items2;
+	EEL_vm *vm = eel_open_pool(1, argv, pool, POOLSIZE);
+	if(!vm)
+	{
+		fprintf(stderr, "Could not initialize EEL!\n");
+		++failures;
+		return;
+	}
+	if(eel_system_init(vm, 1, argv) || eel_io_init(vm) ||
+			eel_loader_init(vm))
+	{
+		fprintf(stderr, "Could not initialize built-in modules!\n");
+		eel_close(vm);
+		++failures;
+		return;
+	}
+	if(!(m = eel_load_buffer(vm, script, strlen(script), 0)))
+	{
+		fprintf(stderr, "Could not compile the test script!\n");
+		eel_perror(vm, 1);
+		eel_close(vm);
+		++failures;
+		return;
+	}
+
+	CHECK("eel_pool_stats()", eel_pool_stats(vm, &before) == 0);
+	CHECK("pool size", before.size <= POOLSIZE);
+	CHECK("no failures yet", before.fails == 0);
+
+	/* The VM heap is in the pool too */
+	CHECK("eel_reserve_heap()", eel_reserve_heap(vm, 10000) == 0);
+	CHECK("eel_pool_stats()", eel_pool_stats(vm, &full) == 0);
+	CHECK("heap allocated from the pool",
+			full.used >= before.used + 10000 * (int)sizeof(EEL_value));
+	CHECK("eel_pool_stats()", eel_pool_stats(vm, &before) == 0);
+
+	/* Run out of memory, and let go of it all */
+	items = hog(vm, m);
+	CHECK("hog() ran out of memory", items > 0);
+	CHECK("eel_pool_stats()", eel_pool_stats(vm, &full) == 0);
+	CHECK("failed allocations counted", full.fails > before.fails);
+	CHECK("peak near pool size", full.peak > full.size / 2);
+	eel_get_memstats(vm, &ms1);
+
+	/*
+	 * Again. Freed objects are kept in the slabs for reuse, so 'used' does
+	 * not drop, and may even grow by a slab chunk or so, depending on the
+	 * build. Instead, check that the second round fits about as much data,
+	 * and that all objects are gone again.
+	 */
+	items2 = hog(vm, m);
+	CHECK("eel_pool_stats()", eel_pool_stats(vm, &after) == 0);
+	eel_get_memstats(vm, &ms2);
+	CHECK("failed allocations counted again", after.fails > full.fails);
+	CHECK("same amount of data", items2 >= items * 9 / 10);
+	CHECK("all objects destroyed", ms2.objects == ms1.objects);
+	CHECK("as many destroyed as created",
+			ms2.frees - ms1.frees == ms2.allocs - ms1.allocs);
+	printf("pooltest: %d + %d items, %d failed allocations, "
+			"peak %d of %d bytes\n", items, items2, after.fails,
+			after.peak, after.size);
+
+	eel_disown(m);
+	eel_close(vm);
+}
+
+
+int main(int argc, const char *argv[])
+{
+	EEL_poolstats ps;
+	void *pool = malloc(POOLSIZE);
+	EEL_vm *vm;
+	if(!pool)
+	{
+		fprintf(stderr, "Could not allocate memory pool!\n");
+		return 1;
+	}
+	test_pool(pool);
+	free(pool);
+
+	/* Only pool VMs have pool statistics */
+	if((vm = eel_open(1, argv)))
+	{
+		CHECK("eel_pool_stats() without pool",
+				eel_pool_stats(vm, &ps) == EEL_XBADCONTEXT);
+		eel_close(vm);
+	}
+	else
+		CHECK("eel_open()", 0);
+
+	if(failures)
+	{
+		fprintf(stderr, "pooltest: %d check(s) failed!\n", failures);
+		return 1;
+	}
+	printf("pooltest: All checks passed.\n");
+	return 0;
+}
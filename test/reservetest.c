@@ -0,0 +1,332 @@
+/*
+---------------------------------------------------------------------------
+	Memory reservation test.
+
+	Checks that eel_reserve_heap() commits heap space in place while the
+	reserved address space lasts, and moves the heap to a bigger
+	reservation when it runs out, with EEL functions on the call stack.
+
+	Also checks that objects reserved with eel_reserve_objects() are
+	created and destroyed without calling the memory manager.
+
+	Usage: reservetest
+---------------------------------------------------------------------------
+ * This code is in the public domain. NO WARRANTY!
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "EEL.h"
+#include "eel_system.h"
+#include "eel_io.h"
+#include "eel_loader.h"
+#include "e_config.h"
+
+static int failures = 0;
+static int heapmoves = 0;
+
+/* Memory manager calls, counted while the counting wrappers are installed */
+static int mmcalls = 0;
+static void *(*real_malloc)(EEL_vm *vm, int size);
+static void *(*real_realloc)(EEL_vm *vm, void *block, int size);
+static void (*real_free)(EEL_vm *vm, void *block);
+
+/* Instance data of class 'rtpoint' */
+typedef struct
+{
+	double	x, y;
+} RT_point;
+EEL_MAKE_CAST(RT_point)
+
+static EEL_classes rtpoint_cid = -1;
+
+#define	CHECK(what, ok)	check(what, ok, __LINE__)
+
+static void check(const char *what, int ok, int line)
+{
+	if(ok)
+		return;
+	fprintf(stderr, "reservetest.c:%d: %s failed!\n", line, what);
+	++failures;
+}
+
+
+/* reserve_heap(values); reserve heap space from deep inside a script */
+static EEL_xno rt_reserve_heap(EEL_vm *vm)
+{
+	EEL_value *oldheap = vm->heap;
+	EEL_xno x = eel_reserve_heap(vm, eel_v2l(vm->heap + vm->argv));
+	if(vm->heap != oldheap)
+		++heapmoves;
+	return x;
+}
+
+
+static EEL_xno rt_point_construct(EEL_vm *vm, EEL_classes cid,
+		EEL_value *initv, int initc, EEL_value *result)
+{
+	RT_point *p;
+	EEL_object *eo = eel_o_alloc(vm, sizeof(RT_point), cid);
+	if(!eo)
+		return EEL_XMEMORY;
+	p = o2RT_point(eo);
+	p->x = initc >= 1 ? eel_v2d(initv) : 0.0;
+	p->y = initc >= 2 ? eel_v2d(initv + 1) : 0.0;
+	eel_o2v(result, eo);
+	return 0;
+}
+
+
+static EEL_xno rt_point_destruct(EEL_object *eo)
+{
+	return 0;
+}
+
+
+/* Stay loaded until the VM is closed */
+static EEL_xno rt_unload(EEL_object *m, int closing)
+{
+	return closing ? 0 : EEL_XREFUSE;
+}
+
+
+static const char script[] =
+	"import reservetest;\n"
+	"\n"
+	"function deep(n, values)\n"
+	"{\n"
+	"	local a = [n, (string)n];\n"
+	"	local s = ((string)n) + \"!\";\n"
+	"	if n > 0\n"
+	"	{\n"
+	"		local r = deep(n - 1, values);\n"
+	"		if (a[0] != n) or (a[1] != (string)n) or\n"
+	"				(s != (((string)n) + \"!\")) or (r != (n - 1))\n"
+	"			throw \"Frame \" + (string)n + \" damaged!\";\n"
+	"	}\n"
+	"	else\n"
+	"		reserve_heap(values);\n"
+	"	return n;\n"
+	"}\n"
+	"\n"
+	"export function main<args>\n"
+	"{\n"
+	"	return deep(50, args[1]);\n"
+	"}\n";
+
+
+static EEL_vm *open_vm(void)
+{
+	const char *argv[] = { "reservetest" };
+	EEL_object *m;
+	int i;
+	EEL_vm *vm = eel_open(1, argv);
+	if(!vm)
+	{
+		fprintf(stderr, "Could not initialize EEL!\n");
+		return NULL;
+	}
+	if(eel_system_init(vm, 1, argv) || eel_io_init(vm) ||
+			eel_loader_init(vm))
+	{
+		fprintf(stderr, "Could not initialize built-in modules!\n");
+		eel_close(vm);
+		return NULL;
+	}
+	if(!(m = eel_create_module(vm, "reservetest", rt_unload, NULL)))
+	{
+		fprintf(stderr, "Could not create the test module!\n");
+		eel_close(vm);
+		return NULL;
+	}
+	eel_export_cfunction(m, 0, "reserve_heap", 1, 0, 0, rt_reserve_heap);
+
+	/*
+	 * Pad the class table, so that the statistics for 'rtpoint' are not
+	 * set up when the VM is opened.
+	 */
+	for(i = 0; i < 40; ++i)
+	{
+		char name[16];
+		snprintf(name, sizeof(name), "rtpad%d", i);
+		eel_export_class(m, name, -1, NULL, NULL, NULL);
+	}
+	rtpoint_cid = eel_class_cid(eel_export_class(m, "rtpoint", -1,
+			rt_point_construct, rt_point_destruct, NULL));
+	eel_disown(m);
+	return vm;
+}
+
+
+/* Memory manager wrappers that count calls */
+static void *rt_malloc(EEL_vm *vm, int size)
+{
+	++mmcalls;
+	return real_malloc(vm, size);
+}
+
+static void *rt_realloc(EEL_vm *vm, void *block, int size)
+{
+	++mmcalls;
+	return real_realloc(vm, block, size);
+}
+
+static void rt_free(EEL_vm *vm, void *block)
+{
+	++mmcalls;
+	real_free(vm, block);
+}
+
+static void count_mmcalls(EEL_vm *vm, int on)
+{
+	if(on)
+	{
+		real_malloc = vm->malloc;
+		real_realloc = vm->realloc;
+		real_free = vm->free;
+		vm->malloc = rt_malloc;
+		vm->realloc = rt_realloc;
+		vm->free = rt_free;
+		mmcalls = 0;
+	}
+	else
+	{
+		vm->malloc = real_malloc;
+		vm->realloc = real_realloc;
+		vm->free = real_free;
+	}
+}
+
+
+/* Reserve 'values' from the bottom of a 50 calls deep recursion */
+static void deep_reserve(EEL_vm *vm, EEL_object *m, int values)
+{
+	if(eel_callnf(vm, m, "main", "si", "reservetest", values))
+	{
+		eel_perror(vm, 1);
+		CHECK("deep_reserve()", 0);
+	}
+}
+
+
+static void test_heap(void)
+{
+	EEL_value *heap;
+	int size;
+	EEL_object *m;
+	EEL_vm *vm = open_vm();
+	if(!vm)
+	{
+		++failures;
+		return;
+	}
+	if(!(m = eel_load_buffer(vm, script, strlen(script), 0)))
+	{
+		fprintf(stderr, "Could not compile the test script!\n");
+		eel_perror(vm, 1);
+		eel_close(vm);
+		++failures;
+		return;
+	}
+
+	/* Within the reservation */
+	heap = vm->heap;
+	size = vm->heapsize;
+	CHECK("eel_reserve_heap()", eel_reserve_heap(vm, size) == 0);
+	CHECK("heap grown", vm->heapsize >= vm->sp + size);
+#ifdef EEL_VM_SEGHEAP
+	CHECK("heap kept in place", vm->heap == heap);
+#endif
+	deep_reserve(vm, m, EEL_HEAPSEGMENT * 3);
+#ifdef EEL_VM_SEGHEAP
+	CHECK("heap kept in place in script", !heapmoves);
+#endif
+
+	/* Beyond the reservation, from C */
+	heap = vm->heap;
+	CHECK("eel_reserve_heap() beyond reservation",
+			eel_reserve_heap(vm, EEL_HEAPRESERVE + 1) == 0);
+	CHECK("heap relocated", vm->heap != heap);
+	CHECK("relocated heap size", vm->heapsize > EEL_HEAPRESERVE);
+
+	/* Beyond the new reservation, with 50 EEL frames on the stack */
+	heapmoves = 0;
+	deep_reserve(vm, m, 2 * EEL_HEAPRESERVE + 1);
+	CHECK("heap relocated in script", heapmoves == 1);
+	CHECK("relocated heap size in script",
+			vm->heapsize > 2 * EEL_HEAPRESERVE);
+
+	/* ...and the VM still works */
+	deep_reserve(vm, m, 0);
+
+	eel_disown(m);
+	eel_close(vm);
+}
+
+
+#define	NPOINTS	500
+
+/* Create and destroy reserved objects, with the memory manager calls counted */
+static void test_objects(void)
+{
+	EEL_value points[NPOINTS];
+	EEL_classmemstats cms;
+	EEL_memstats before, after;
+	int i, n;
+	EEL_xno x;
+	EEL_vm *vm = open_vm();
+	if(!vm)
+	{
+		++failures;
+		return;
+	}
+	CHECK("class rtpoint", rtpoint_cid >= 0);
+	CHECK("eel_reserve_objects()",
+			eel_reserve_objects(vm, sizeof(RT_point), NPOINTS) == 0);
+	eel_get_memstats(vm, &before);
+	count_mmcalls(vm, 1);
+	for(n = 0; n < NPOINTS; ++n)
+		if(eel_o_construct(vm, rtpoint_cid, NULL, 0, points + n))
+			break;
+	x = eel_get_classmemstats(vm, rtpoint_cid, &cms);
+	for(i = 0; i < n; ++i)
+		eel_v_disown(points + i);
+	count_mmcalls(vm, 0);
+	eel_get_memstats(vm, &after);
+	CHECK("reserved objects created", n == NPOINTS);
+	CHECK("no memory manager calls", mmcalls == 0);
+	if(mmcalls)
+		fprintf(stderr, "reservetest: %d memory manager calls!\n",
+				mmcalls);
+	CHECK("eel_get_classmemstats()", x == 0);
+	CHECK("live objects counted", cms.objects == NPOINTS);
+	CHECK("objects counted", after.allocs - before.allocs == NPOINTS);
+	CHECK("objects destroyed", after.frees - before.frees == NPOINTS);
+
+	/* Too large for the slabs */
+#ifdef EEL_SLAB_MAXSIZE
+	CHECK("eel_reserve_objects() too large",
+			eel_reserve_objects(vm, EEL_SLAB_MAXSIZE + 1, 1) ==
+			EEL_XHIGHVALUE);
+#else
+	CHECK("eel_reserve_objects() without slabs",
+			eel_reserve_objects(vm, sizeof(RT_point), 1) ==
+			EEL_XNOTIMPLEMENTED);
+#endif
+
+	eel_close(vm);
+}
+
+
+int main(int argc, const char *argv[])
+{
+	test_heap();
+	test_objects();
+	if(failures)
+	{
+		fprintf(stderr, "reservetest: %d check(s) failed!\n", failures);
+		return 1;
+	}
+	printf("reservetest: All checks passed.\n");
+	return 0;
+}
@@ -0,0 +1,336 @@
+/*
+---------------------------------------------------------------------------
+	Time slicing test.
+
+	Runs calls set up by eel_begin_call() through eel_run_slice(), with
+	tick budgets, deadlines, exceptions, and from inside a C function
+	called by another call.
+
+	Usage: slicetest
+---------------------------------------------------------------------------
+ * This code is in the public domain. NO WARRANTY!
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "EEL.h"
+#include "eel_system.h"
+#include "eel_io.h"
+#include "eel_loader.h"
+
+static int failures = 0;
+static int ticks = 0;
+static int stopped = 0;
+static EEL_object *spin_f = NULL;
+
+#define	CHECK(what, ok)	check(what, ok, __LINE__)
+
+static void check(const char *what, int ok, int line)
+{
+	if(ok)
+		return;
+	fprintf(stderr, "slicetest.c:%d: %s failed!\n", line, what);
+	++failures;
+}
+
+
+static long long now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_nsec + (long long)ts.tv_sec * 1000000000LL;
+}
+
+
+/* tick(); count calls. (Being a C function, this sets the argument registers.) */
+static EEL_xno st_tick(EEL_vm *vm)
+{
+	++ticks;
+	return 0;
+}
+
+
+/* stopped(); true when the host wants wait() to return */
+static EEL_xno st_stopped(EEL_vm *vm)
+{
+	eel_b2v(vm->heap + vm->resv, stopped);
+	return 0;
+}
+
+
+/*
+ * nested(n); run spin(n) in slices of 10 ticks from in here, and return n,
+ * as read back from our own argument after the call.
+ */
+static EEL_xno st_nested(EEL_vm *vm)
+{
+	int resv = vm->resv;
+	int argv = vm->argv;
+	int argc = vm->argc;
+	int n = eel_v2l(vm->heap + vm->argv);
+	int slices = 0;
+	EEL_xno x;
+	if((x = eel_argf(vm, "*i", n)))
+		return x;
+	if((x = eel_begin_call(vm, spin_f)))
+		return x;
+	while((x = eel_run_slice(vm, 10, 0)) == EEL_XCOUNTER)
+		++slices;
+	if(x)
+		return x;
+	CHECK("nested slices", slices >= n / 10);
+	CHECK("nested resv", vm->resv == resv);
+	CHECK("nested argv", vm->argv == argv);
+	CHECK("nested argc", vm->argc == argc);
+	eel_l2v(vm->heap + vm->resv, eel_v2l(vm->heap + vm->argv));
+	return 0;
+}
+
+
+/* Stay loaded until the VM is closed */
+static EEL_xno st_unload(EEL_object *m, int closing)
+{
+	return closing ? 0 : EEL_XREFUSE;
+}
+
+
+static const char script[] =
+	"import slicetest;\n"
+	"\n"
+	"export function spin(n)\n"
+	"{\n"
+	"	local i = 0;\n"
+	"	while i < n\n"
+	"	{\n"
+	"		tick();\n"
+	"		i = i + 1;\n"
+	"	}\n"
+	"	return i;\n"
+	"}\n"
+	"\n"
+	"export procedure wait\n"
+	"{\n"
+	"	while not stopped()\n"
+	"		tick();\n"
+	"}\n"
+	"\n"
+	"export function boom(n)\n"
+	"{\n"
+	"	spin(n);\n"
+	"	local a = [1, 2, 3];\n"
+	"	return a[n];\n"
+	"}\n"
+	"\n"
+	"export function outer(n)\n"
+	"{\n"
+	"	local a = [n, (string)n];\n"
+	"	local r = nested(n) + spin(3);\n"
+	"	if (a[0] != n) or (a[1] != (string)n)\n"
+	"		throw \"Frame of outer() damaged!\";\n"
+	"	return r;\n"
+	"}\n";
+
+
+static EEL_vm *open_vm(void)
+{
+	const char *argv[] = { "slicetest" };
+	EEL_object *m;
+	EEL_vm *vm = eel_open(1, argv);
+	if(!vm)
+	{
+		fprintf(stderr, "Could not initialize EEL!\n");
+		return NULL;
+	}
+	if(eel_system_init(vm, 1, argv) || eel_io_init(vm) ||
+			eel_loader_init(vm))
+	{
+		fprintf(stderr, "Could not initialize built-in modules!\n");
+		eel_close(vm);
+		return NULL;
+	}
+	if(!(m = eel_create_module(vm, "slicetest", st_unload, NULL)))
+	{
+		fprintf(stderr, "Could not create the test module!\n");
+		eel_close(vm);
+		return NULL;
+	}
+	eel_export_cfunction(m, 0, "tick", 0, 0, 0, st_tick);
+	eel_export_cfunction(m, 1, "stopped", 0, 0, 0, st_stopped);
+	eel_export_cfunction(m, 1, "nested", 1, 0, 0, st_nested);
+	eel_disown(m);
+	return vm;
+}
+
+
+static EEL_object *get_function(EEL_object *m, const char *name)
+{
+	EEL_value v;
+	if(eel_getsindex(m, name, &v))
+	{
+		fprintf(stderr, "Function %s() not found!\n", name);
+		++failures;
+		return NULL;
+	}
+	if(!EEL_IS_OBJREF(EEL_VCLASS(&v)) ||
+			(eel_v2o(&v)->classid != EEL_CFUNCTION))
+	{
+		fprintf(stderr, "%s is not a function!\n", name);
+		eel_v_disown(&v);
+		++failures;
+		return NULL;
+	}
+	return eel_v2o(&v);
+}
+
+
+/* Budget used up, then resumed, until the call returns */
+static void test_budget(EEL_vm *vm, EEL_object *m)
+{
+	int resv, slices = 0;
+	EEL_xno x;
+	EEL_object *f = get_function(m, "spin");
+	if(!f)
+		return;
+	ticks = 0;
+	CHECK("eel_argf()", eel_argf(vm, "*Ri", &resv, 1000) == 0);
+	CHECK("eel_begin_call()", eel_begin_call(vm, f) == 0);
+	CHECK("nothing run by eel_begin_call()", ticks == 0);
+	while((x = eel_run_slice(vm, 50, 0)) == EEL_XCOUNTER)
+	{
+		CHECK("progress per slice", ticks <= (slices + 1) * 50);
+		if(++slices > 1000)
+			break;
+	}
+	CHECK("call returned", x == 0);
+	CHECK("sliced", slices >= 1000 / 50);
+	CHECK("all ticks run", ticks == 1000);
+	CHECK("result", eel_v2l(vm->heap + resv) == 1000);
+
+	/* Nothing left to run */
+	CHECK("eel_run_slice() when done", eel_run_slice(vm, 50, 0) == 0);
+	eel_disown(f);
+}
+
+
+/* Deadline expires in a loop with no tick budget */
+static void test_deadline(EEL_vm *vm, EEL_object *m)
+{
+	long long t;
+	int n;
+	EEL_xno x;
+	EEL_object *f = get_function(m, "wait");
+	if(!f)
+		return;
+	stopped = 0;
+	ticks = 0;
+	CHECK("eel_argf()", eel_argf(vm, "*") == 0);
+	CHECK("eel_begin_call()", eel_begin_call(vm, f) == 0);
+	t = now_ns();
+	x = eel_run_slice(vm, 0, 2000000);
+	t = now_ns() - t;
+	CHECK("deadline expired", x == EEL_XCOUNTER);
+	CHECK("deadline kept", t < 1000000000LL);
+	CHECK("ran until deadline", ticks > 0);
+
+	/* Resume for another slice, and then let it return */
+	n = ticks;
+	CHECK("second slice", eel_run_slice(vm, 0, 1000000) == EEL_XCOUNTER);
+	CHECK("second slice ran", ticks > n);
+	stopped = 1;
+	CHECK("call returned", eel_run_slice(vm, 0, 1000000) == 0);
+	eel_disown(f);
+}
+
+
+/* Exception thrown partway through a slice */
+static void test_exception(EEL_vm *vm, EEL_object *m)
+{
+	int slices = 0;
+	EEL_xno x;
+	EEL_object *f = get_function(m, "boom");
+	if(!f)
+		return;
+	ticks = 0;
+	CHECK("eel_argf()", eel_argf(vm, "*i", 100) == 0);
+	CHECK("eel_begin_call()", eel_begin_call(vm, f) == 0);
+	while((x = eel_run_slice(vm, 30, 0)) == EEL_XCOUNTER)
+		if(++slices > 100)
+			break;
+	CHECK("exception thrown", x == EEL_XHIGHINDEX);
+	CHECK("sliced before exception", slices >= 100 / 30);
+	CHECK("ran up to exception", ticks == 100);
+	CHECK("eel_run_slice() after exception", eel_run_slice(vm, 30, 0) == 0);
+	eel_disown(f);
+
+	/* The VM still works */
+	if(eel_callnf(vm, m, "spin", "i", 10))
+	{
+		eel_perror(vm, 1);
+		CHECK("eel_callnf() after exception", 0);
+	}
+}
+
+
+/* Slices run from inside a C function, called from a sliced call */
+static void test_nested(EEL_vm *vm, EEL_object *m)
+{
+	int resv, slices = 0;
+	EEL_xno x;
+	EEL_object *f = get_function(m, "outer");
+	if(!f)
+		return;
+	CHECK("eel_argf()", eel_argf(vm, "*Ri", &resv, 100) == 0);
+	CHECK("eel_begin_call()", eel_begin_call(vm, f) == 0);
+	while((x = eel_run_slice(vm, 2, 0)) == EEL_XCOUNTER)
+		if(++slices > 100)
+			break;
+	if(x)
+		eel_perror(vm, 1);
+	CHECK("outer call returned", x == 0);
+	CHECK("outer result", eel_v2l(vm->heap + resv) == 103);
+	eel_disown(f);
+
+	/* Same thing, with outer() called normally */
+	resv = -1;
+	if(eel_argf(vm, "*Ri", &resv, 50) || eel_calln(vm, m, "outer"))
+	{
+		eel_perror(vm, 1);
+		CHECK("eel_calln()", 0);
+	}
+	else
+		CHECK("called outer result", eel_v2l(vm->heap + resv) == 53);
+}
+
+
+int main(int argc, const char *argv[])
+{
+	EEL_object *m;
+	EEL_vm *vm = open_vm();
+	if(!vm)
+		return 1;
+	if(!(m = eel_load_buffer(vm, script, strlen(script), 0)))
+	{
+		fprintf(stderr, "Could not compile the test script!\n");
+		eel_perror(vm, 1);
+		eel_close(vm);
+		return 1;
+	}
+	if((spin_f = get_function(m, "spin")))
+	{
+		test_budget(vm, m);
+		test_deadline(vm, m);
+		test_exception(vm, m);
+		test_nested(vm, m);
+		eel_disown(spin_f);
+	}
+	eel_disown(m);
+	eel_close(vm);
+	if(failures)
+	{
+		fprintf(stderr, "slicetest: %d check(s) failed!\n", failures);
+		return 1;
+	}
+	printf("slicetest: All checks passed.\n");
+	return 0;
+}